@@ -0,0 +1,42 @@
+/*********************************************************************************************
+ *  Description : Helpers shared by the benchmarks
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+
+#include <cstddef>
+
+namespace ipb::http::bench
+{
+	/**
+	 * Counts the heap allocations of the timed loop and reports them as the "allocs/op" counter.
+	 * Create it right before `for (auto _ : state)`; the report is written when it goes out of scope.
+	 */
+	class AllocationsPerOp
+	{
+		public:
+			explicit AllocationsPerOp (benchmark::State &state)
+			    : state_ (state)
+			{
+			}
+
+			~AllocationsPerOp ()
+			{
+				state_.counters ["allocs/op"] =
+				    benchmark::Counter (static_cast<double> (counter_.count()), benchmark::Counter::kAvgIterations);
+			}
+
+			AllocationsPerOp (const AllocationsPerOp &)            = delete;
+			AllocationsPerOp &operator= (const AllocationsPerOp &) = delete;
+
+		private:
+			benchmark::State &state_;
+			testutil::AllocationCounter counter_;
+	};
+}    // namespace ipb::http::bench
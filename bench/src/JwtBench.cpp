@@ -0,0 +1,129 @@
+/*********************************************************************************************
+ *  Description : JWT engine benchmarks (verify and sign)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "BenchUtils.h"
+#include "Jwt.h"
+#include "JwtJsonProvider.h"
+#include "JwtTestProviders.h"
+
+#include <ctime>
+#include <string>
+
+namespace ipb::http::bench
+{
+	namespace
+	{
+		constexpr const char *kKid = "k-bench";
+
+		int64_t now ()
+		{
+			return static_cast<int64_t> (std::time (nullptr));
+		}
+
+		/**
+		 * Engine over the fake crypto provider and the JSON provider `TJson`: the fake signature is
+		 * cheap, so the numbers are dominated by the engine (parsing, encoding, policy, buffers).
+		 */
+		template <typename TJson> class BenchEngine
+		{
+			public:
+				explicit BenchEngine (jwt::EngineOptions options = {})
+				    : jwt_ (crypto_, json_, std::move (options))
+				{
+					jwt_.generateKeyPair (kKid, jwt::JwtAlg::HS256);
+				}
+
+				const jwt::Jwt &jwt () const noexcept
+				{
+					return jwt_;
+				}
+
+				std::string sampleToken () const
+				{
+					std::string token;
+					jwt_.token()
+					    .kid (kKid)
+					    .issuer ("https://issuer.example.com")
+					    .subject ("user-1234567890")
+					    .audience ("bench-api")
+					    .claim ("scope", "read write admin")
+					    .issuedAt (now())
+					    .expiresAt (now() + 3600)
+					    .sign (token);
+					return token;
+				}
+
+			private:
+				jwt::FakeCryptoProvider crypto_;
+				TJson json_;
+				jwt::Jwt jwt_;
+		};
+
+		template <typename TJson> void BM_JwtVerify (benchmark::State &state)
+		{
+			jwt::EngineOptions options;
+			options.verifiedCacheCapacity = static_cast<size_t> (state.range (0));
+			BenchEngine<TJson> engine (std::move (options));
+			const std::string token = engine.sampleToken();
+
+			jwt::Verifier verifier;
+			engine.jwt().verify (token, verifier);    // Warm the verifier buffers
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				benchmark::DoNotOptimize (engine.jwt().verify (token, verifier));
+			}
+		}
+		// Argument: verified-token cache capacity (0: every call checks the signature)
+		BENCHMARK (BM_JwtVerify<jwt::FakeJsonProvider>)->Arg (0)->Arg (1024);
+		BENCHMARK (BM_JwtVerify<jwt::JwtJsonProvider>)->Arg (0)->Arg (1024);
+
+		template <typename TJson> void BM_TokenBuilderSign (benchmark::State &state)
+		{
+			BenchEngine<TJson> engine;
+			const int64_t issuedAt = now();
+
+			std::string token;
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				benchmark::DoNotOptimize (engine.jwt()
+				                              .token()
+				                              .kid (kKid)
+				                              .issuer ("https://issuer.example.com")
+				                              .subject ("user-1234567890")
+				                              .claim ("scope", "read write admin")
+				                              .issuedAt (issuedAt)
+				                              .expiresAt (issuedAt + 3600)
+				                              .sign (token));
+			}
+		}
+		BENCHMARK (BM_TokenBuilderSign<jwt::FakeJsonProvider>);
+		BENCHMARK (BM_TokenBuilderSign<jwt::JwtJsonProvider>);
+
+		// Same token as BM_TokenBuilderSign; SigningTemplate needs a JSON payload
+		void BM_SigningTemplateSign (benchmark::State &state)
+		{
+			BenchEngine<jwt::JwtJsonProvider> engine;
+			const int64_t issuedAt = now();
+
+			jwt::ClaimMap fixed;
+			fixed ["iss"]   = std::string ("https://issuer.example.com");
+			fixed ["scope"] = std::string ("read write admin");
+			const jwt::SigningTemplate signer = engine.jwt().signingTemplate (jwt::JwtAlg::HS256, kKid, fixed);
+
+			std::string token;
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				benchmark::DoNotOptimize (signer.sign (
+				    {.subject = "user-1234567890", .expiresAt = issuedAt + 3600, .issuedAt = issuedAt, .jwtId = {}},
+				    token));
+			}
+		}
+		BENCHMARK (BM_SigningTemplateSign);
+	}    // namespace
+}    // namespace ipb::http::bench
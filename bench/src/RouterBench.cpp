@@ -0,0 +1,286 @@
+/*********************************************************************************************
+ *  Description : Router benchmarks (match, execute, static route table, startup, fromMethodString)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "BenchUtils.h"
+#include "Route.h"
+#include "StaticRoutes.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ipb::http::bench
+{
+	namespace
+	{
+		// Keeps the parameter views in fixed storage, so the context itself never allocates
+		class BenchCtx : public ICtx
+		{
+			public:
+				void setParam (std::string_view name, std::string_view value) override
+				{
+					if (count_ < params_.size())
+					{
+						params_ [count_++] = {name, value};
+					}
+				}
+
+				void reset () noexcept
+				{
+					count_ = 0;
+				}
+
+			private:
+				std::array<std::pair<std::string_view, std::string_view>, 8> params_ {};
+				size_t count_ = 0;
+		};
+
+		/**
+		 * Route table shaped like a service API: every fourth route is literal only, the others mix
+		 * typed (<id:int>, <id:uuid>) and generic parameters under shared prefixes.
+		 * `paths` gets one request path per route, shuffled so lookups do not walk the table in order.
+		 */
+		void buildRouteTable (Router &router, size_t routes, std::vector<std::string> &paths)
+		{
+			static const RouteHandler kHandler = [] (ICtx &) {};
+
+			paths.clear();
+			for (size_t i = 0; i < routes; ++i)
+			{
+				const std::string group    = "/api/v" + std::to_string (1 + i % 3) + "/group" + std::to_string (i % 50);
+				const std::string resource = "/resource" + std::to_string (i);
+				switch (i % 4)
+				{
+				case 0:
+					router.add (HttpMethod::GET, group + resource + "/status", kHandler);
+					paths.push_back (group + resource + "/status");
+					break;
+				case 1:
+					router.add (HttpMethod::GET, group + resource + "/<id:int>", kHandler);
+					paths.push_back (group + resource + "/" + std::to_string (i * 7919));
+					break;
+				case 2:
+					router.add (HttpMethod::GET, group + resource + "/<id:uuid>/items/<name>", kHandler);
+					paths.push_back (group + resource + "/123e4567-e89b-12d3-a456-426614174000/items/widget");
+					break;
+				default:
+					router.add (HttpMethod::GET, group + resource + "/<name>", kHandler);
+					paths.push_back (group + resource + "/some-name");
+					break;
+				}
+			}
+			router.freeze();
+
+			std::mt19937 random (42);
+			std::shuffle (paths.begin(), paths.end(), random);
+		}
+
+		void BM_RouterMatch (benchmark::State &state)
+		{
+			Router router;
+			std::vector<std::string> paths;
+			buildRouteTable (router, static_cast<size_t> (state.range (0)), paths);
+
+			BenchCtx ctx;
+			size_t next = 0;
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				ctx.reset();
+				auto route = router.match (HttpMethod::GET, paths [next], ctx);
+				benchmark::DoNotOptimize (route);
+				next = next + 1 == paths.size() ? 0 : next + 1;
+			}
+		}
+		BENCHMARK (BM_RouterMatch)->Arg (100)->Arg (1000)->Arg (10000);
+
+		void BM_RouterMatchMiss (benchmark::State &state)
+		{
+			Router router;
+			std::vector<std::string> paths;
+			buildRouteTable (router, static_cast<size_t> (state.range (0)), paths);
+
+			BenchCtx ctx;
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				ctx.reset();
+				auto route = router.match (HttpMethod::GET, "/api/v1/group7/unknown/path", ctx);
+				benchmark::DoNotOptimize (route);
+			}
+		}
+		BENCHMARK (BM_RouterMatchMiss)->Arg (100)->Arg (10000);
+
+		// Long shared literal prefixes around one typed segment (compressed into single edges by freeze)
+		void BM_RouterMatchDeepPrefix (benchmark::State &state)
+		{
+			static const RouteHandler kHandler = [] (ICtx &) {};
+			const std::string prefix = "/api/v2/tenants/<tid:uuid>/projects/environments/production/deployments/current";
+
+			Router router;
+			std::vector<std::string> paths;
+			for (int64_t i = 0; i < state.range (0); ++i)
+			{
+				const std::string leaf = "/releases/history/entry" + std::to_string (i);
+				router.add (HttpMethod::GET, prefix + leaf, kHandler);
+				paths.push_back ("/api/v2/tenants/550e8400-e29b-41d4-a716-446655440000/projects/environments/production/deployments/current" + leaf);
+			}
+			router.freeze();
+
+			BenchCtx ctx;
+			size_t next = 0;
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				ctx.reset();
+				benchmark::DoNotOptimize (router.match (HttpMethod::GET, paths [next], ctx));
+				next = next + 1 == paths.size() ? 0 : next + 1;
+			}
+		}
+		BENCHMARK (BM_RouterMatchDeepPrefix)->Arg (1)->Arg (100);
+
+		void BM_RouterExecute (benchmark::State &state)
+		{
+			Router router;
+			for (int64_t i = 0; i < state.range (0); ++i)
+			{
+				router.addMiddleware ([] (ICtx &, IMiddlewareNext &next) { next.next(); });
+			}
+			int calls = 0;
+			router.add (HttpMethod::GET, "/users/<id:int>", [&calls] (ICtx &) { ++calls; });
+			router.freeze();
+
+			BenchCtx ctx;
+			const RouteInfo &route = router.match (HttpMethod::GET, "/users/42", ctx)->get();
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				router.execute (route, ctx);
+			}
+			benchmark::DoNotOptimize (calls);
+		}
+		BENCHMARK (BM_RouterExecute)->Arg (0)->Arg (1)->Arg (2)->Arg (4)->Arg (8)->Arg (16);
+
+		// Same 4-step pipeline as BM_RouterExecute/4, registered as one compile-time chain
+		void BM_RouterExecuteStaticChain (benchmark::State &state)
+		{
+			const auto step = [] (ICtx &, IMiddlewareNext &next) { next.next(); };
+
+			Router router;
+			router.use (step, step, step, step);
+			int calls = 0;
+			router.add (HttpMethod::GET, "/users/<id:int>", [&calls] (ICtx &) { ++calls; });
+			router.freeze();
+
+			BenchCtx ctx;
+			const RouteInfo &route = router.match (HttpMethod::GET, "/users/42", ctx)->get();
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				router.execute (route, ctx);
+			}
+			benchmark::DoNotOptimize (calls);
+		}
+		BENCHMARK (BM_RouterExecuteStaticChain);
+
+		// Same routes and paths for the runtime router and the compile-time table
+		constexpr std::array<std::string_view, 6> kSmallApiPaths = {
+		    "/health", "/users/42", "/users/me", "/users/42/posts/7", "/orders/550e8400-e29b-41d4-a716-446655440000", "/files/report"};
+
+		void BM_SmallApiRouterMatch (benchmark::State &state)
+		{
+			static const RouteHandler kHandler = [] (ICtx &) {};
+			Router router;
+			router.add (HttpMethod::GET, "/health", kHandler);
+			router.add (HttpMethod::GET, "/users/me", kHandler);
+			router.add (HttpMethod::GET, "/users/<id:int>", kHandler);
+			router.add (HttpMethod::GET, "/users/<id:int>/posts/<post:int>", kHandler);
+			router.add (HttpMethod::GET, "/orders/<id:uuid>", kHandler);
+			router.add (HttpMethod::GET, "/files/<name>", kHandler);
+			router.freeze();
+
+			BenchCtx ctx;
+			size_t next = 0;
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				ctx.reset();
+				benchmark::DoNotOptimize (router.match (HttpMethod::GET, kSmallApiPaths [next], ctx));
+				next = next + 1 == kSmallApiPaths.size() ? 0 : next + 1;
+			}
+		}
+		BENCHMARK (BM_SmallApiRouterMatch);
+
+		void BM_SmallApiStaticTableMatch (benchmark::State &state)
+		{
+			const auto handler = [] (ICtx &) {};
+			const StaticRouteTable table {
+			    route<"/health"> (HttpMethod::GET, handler),
+			    route<"/users/me"> (HttpMethod::GET, handler),
+			    route<"/users/<id:int>"> (HttpMethod::GET, handler),
+			    route<"/users/<id:int>/posts/<post:int>"> (HttpMethod::GET, handler),
+			    route<"/orders/<id:uuid>"> (HttpMethod::GET, handler),
+			    route<"/files/<name>"> (HttpMethod::GET, handler),
+			};
+
+			BenchCtx ctx;
+			size_t next = 0;
+			AllocationsPerOp allocations (state);
+			for (auto _ : state)
+			{
+				ctx.reset();
+				benchmark::DoNotOptimize (table.match (HttpMethod::GET, kSmallApiPaths [next], ctx));
+				next = next + 1 == kSmallApiPaths.size() ? 0 : next + 1;
+			}
+		}
+		BENCHMARK (BM_SmallApiStaticTableMatch);
+
+		// Startup: register and freeze every route, against loading the image of the same table
+		void BM_RouterStartupRegister (benchmark::State &state)
+		{
+			std::vector<std::string> paths;
+			for (auto _ : state)
+			{
+				Router router;
+				buildRouteTable (router, static_cast<size_t> (state.range (0)), paths);
+				benchmark::DoNotOptimize (router.isFrozen());
+			}
+		}
+		BENCHMARK (BM_RouterStartupRegister)->Arg (1000)->Arg (8000)->Unit (benchmark::kMicrosecond);
+
+		void BM_RouterStartupImage (benchmark::State &state)
+		{
+			Router source;
+			std::vector<std::string> paths;
+			buildRouteTable (source, static_cast<size_t> (state.range (0)), paths);
+			const std::string image = source.image();
+			const std::vector<RouteHandler> handlers (static_cast<size_t> (state.range (0)), [] (ICtx &) {});
+
+			for (auto _ : state)
+			{
+				Router router;
+				benchmark::DoNotOptimize (router.loadImageBytes (image, handlers));
+			}
+			state.counters ["image_bytes"] = static_cast<double> (image.size());
+		}
+		BENCHMARK (BM_RouterStartupImage)->Arg (1000)->Arg (8000)->Unit (benchmark::kMicrosecond);
+
+		void BM_FromMethodString (benchmark::State &state)
+		{
+			static constexpr std::array<std::string_view, 9> kMethods = {"GET",     "POST", "PUT",   "PATCH", "DELETE",
+			                                                             "OPTIONS", "HEAD", "TRACE", "get"};
+			size_t next = 0;
+			for (auto _ : state)
+			{
+				benchmark::DoNotOptimize (Router::fromMethodString (kMethods [next]));
+				next = next + 1 == kMethods.size() ? 0 : next + 1;
+			}
+		}
+		BENCHMARK (BM_FromMethodString);
+	}    // namespace
+}    // namespace ipb::http::bench
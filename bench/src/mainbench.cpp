@@ -0,0 +1,11 @@
+﻿
+#ifdef _DEBUG
+#	define END_LIB_STD "d.lib"
+#else
+#	define END_LIB_STD ".lib"
+#endif
+
+#pragma comment(lib, "HttplibApp" END_LIB_STD)
+#pragma comment(lib, "benchmark" END_LIB_STD)
+#pragma comment(lib, "benchmark_main" END_LIB_STD)
+#pragma comment(lib, "shlwapi.lib")
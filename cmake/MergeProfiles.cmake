@@ -0,0 +1,9 @@
+# Merge the raw Clang profiles of a PGO training run into happ.profdata (cmake -P, see happ_pgo_train)
+# PROFDATA: llvm-profdata executable; DIR: directory of the .profraw files
+
+file (GLOB raw_profiles "${DIR}/*.profraw")
+if (NOT raw_profiles)
+	message (FATAL_ERROR "No .profraw files in ${DIR}: run an instrumented (HAPP_PGO=GENERATE) build first")
+endif ()
+
+execute_process (COMMAND "${PROFDATA}" merge -output=${DIR}/happ.profdata ${raw_profiles} COMMAND_ERROR_IS_FATAL ANY)
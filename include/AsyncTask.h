@@ -0,0 +1,232 @@
+﻿/*********************************************************************************************
+ *  Description : AsyncTask - Coroutine type of asynchronous route handlers and middlewares
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _ASYNC_TASK_H_
+#	define _ASYNC_TASK_H_
+
+#	include <condition_variable>
+#	include <coroutine>
+#	include <exception>
+#	include <mutex>
+#	include <utility>
+
+namespace ipb::http
+{
+	/**
+	 * @brief Lazy coroutine returning nothing: it starts when it is awaited (or by `start` / `wait`).
+	 * Awaiting a task resumes the awaiting coroutine when the task completes (symmetric transfer, so long
+	 * chains do not grow the stack), and rethrows the exception the task ended with.
+	 * A default-constructed task is already complete.
+	 */
+	class [[nodiscard]] AsyncTask
+	{
+		public:
+			class promise_type;
+			using Handle = std::coroutine_handle<promise_type>;
+
+			// Signalled at the final suspension point, for `wait`
+			struct BlockingWaiter
+			{
+					std::mutex mutex;
+					std::condition_variable ready;
+					bool done = false;
+			};
+
+			class promise_type
+			{
+				public:
+					AsyncTask get_return_object () noexcept
+					{
+						return AsyncTask (Handle::from_promise (*this));
+					}
+
+					std::suspend_always initial_suspend () const noexcept
+					{
+						return {};
+					}
+
+					auto final_suspend () const noexcept
+					{
+						struct FinalAwaiter
+						{
+								bool await_ready () const noexcept
+								{
+									return false;
+								}
+
+								std::coroutine_handle<> await_suspend (Handle handle) const noexcept
+								{
+									promise_type &promise = handle.promise();
+									if (BlockingWaiter *waiter = promise.waiter_)
+									{
+										// Notified under the lock: the waiter (and this frame) may be gone once it is released
+										std::lock_guard<std::mutex> lock (waiter->mutex);
+										waiter->done = true;
+										waiter->ready.notify_all();
+										return std::noop_coroutine();
+									}
+									return promise.continuation_ ? promise.continuation_ : std::noop_coroutine();
+								}
+
+								void await_resume () const noexcept
+								{
+								}
+						};
+						return FinalAwaiter {};
+					}
+
+					void return_void () const noexcept
+					{
+					}
+
+					void unhandled_exception () noexcept
+					{
+						exception_ = std::current_exception();
+					}
+
+				private:
+					friend class AsyncTask;
+
+					std::coroutine_handle<> continuation_;
+					BlockingWaiter *waiter_ = nullptr;
+					std::exception_ptr exception_;
+			};
+
+			AsyncTask () noexcept = default;
+
+			AsyncTask (AsyncTask &&other) noexcept
+			    : handle_ (std::exchange (other.handle_, {}))
+			{
+			}
+
+			AsyncTask &operator= (AsyncTask &&other) noexcept
+			{
+				if (this != &other)
+				{
+					destroy();
+					handle_ = std::exchange (other.handle_, {});
+				}
+				return *this;
+			}
+
+			AsyncTask (const AsyncTask &)            = delete;
+			AsyncTask &operator= (const AsyncTask &) = delete;
+
+			~AsyncTask ()
+			{
+				destroy();
+			}
+
+			/**
+			 * True once the coroutine has completed. Read it from the thread that resumes the task (or
+			 * after synchronizing with it).
+			 */
+			bool done () const noexcept
+			{
+				return !handle_ || handle_.done();
+			}
+
+			/**
+			 * Start the task without waiting for it: it runs until its first suspension, and whoever resumes
+			 * it (an event loop, an I/O completion) carries it to the end. Call it at most once, and only on
+			 * a task that is not awaited; the task object must outlive the coroutine (until `done`).
+			 */
+			void start ()
+			{
+				if (handle_ && !handle_.done())
+				{
+					handle_.resume();
+				}
+			}
+
+			/**
+			 * Start the task and block the calling thread until it completes (when it suspends, another
+			 * thread has to resume it). Rethrows the exception the task ended with.
+			 */
+			void wait ()
+			{
+				if (!handle_)
+				{
+					return;
+				}
+
+				if (!handle_.done())
+				{
+					BlockingWaiter waiter;
+					handle_.promise().waiter_ = &waiter;
+					handle_.resume();
+
+					std::unique_lock<std::mutex> lock (waiter.mutex);
+					waiter.ready.wait (lock,
+					                   [&waiter]
+					                   {
+						                   return waiter.done;
+					                   });
+				}
+				rethrow();
+			}
+
+			/**
+			 * Rethrow the exception a completed task ended with (nothing if it returned normally).
+			 */
+			void rethrow () const
+			{
+				if (handle_ && handle_.promise().exception_)
+				{
+					std::rethrow_exception (handle_.promise().exception_);
+				}
+			}
+
+			auto operator co_await () noexcept
+			{
+				struct Awaiter
+				{
+						Handle handle;
+
+						bool await_ready () const noexcept
+						{
+							return !handle || handle.done();
+						}
+
+						std::coroutine_handle<> await_suspend (std::coroutine_handle<> awaiting) const noexcept
+						{
+							handle.promise().continuation_ = awaiting;
+							return handle;
+						}
+
+						void await_resume () const
+						{
+							if (handle && handle.promise().exception_)
+							{
+								std::rethrow_exception (handle.promise().exception_);
+							}
+						}
+				};
+				return Awaiter {handle_};
+			}
+
+		private:
+			explicit AsyncTask (Handle handle) noexcept
+			    : handle_ (handle)
+			{
+			}
+
+			void destroy () noexcept
+			{
+				if (handle_)
+				{
+					handle_.destroy();
+					handle_ = {};
+				}
+			}
+
+			Handle handle_;
+	};
+
+}    // namespace ipb::http
+
+#endif
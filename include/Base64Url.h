@@ -0,0 +1,53 @@
+/*********************************************************************************************
+ *  Description : Base64URL codec (RFC 4648 section 5, unpadded) over caller-supplied buffers
+ *  License     : The unlicense (https://unlicense.org)
+ *  Copyright    (C) 2026  Ignacio Pomar Ballestero
+ *********************************************************************************************/
+
+#pragma once
+#ifndef BASE64_URL_H_
+#	define BASE64_URL_H_
+
+#	include <cstddef>
+#	include <cstdint>
+#	include <optional>
+#	include <span>
+#	include <string_view>
+
+#	include "httplib_app_exportcfg.h"
+
+namespace ipb::http::base64url
+{
+	/**
+	 * Characters produced for `bytes` input bytes (no padding).
+	 */
+	constexpr size_t encodedSize (size_t bytes) noexcept
+	{
+		return (bytes / 3) * 4 + ((bytes % 3) == 0 ? 0 : (bytes % 3) + 1);
+	}
+
+	/**
+	 * Bytes produced for `chars` input characters (exact for valid input).
+	 */
+	constexpr size_t decodedSize (size_t chars) noexcept
+	{
+		return (chars / 4) * 3 + ((chars % 4) == 0 ? 0 : (chars % 4) - 1);
+	}
+
+	/**
+	 * Encode `data` into `out`, which must hold at least encodedSize(data.size()) characters.
+	 * @return Characters written (0 if `out` is too small).
+	 */
+	HAPP_API size_t encode (std::span<const uint8_t> data, std::span<char> out) noexcept;
+
+	/**
+	 * Decode `text` into `out`, which must hold at least decodedSize(text.size()) bytes.
+	 * Strict: padding, characters outside the alphabet, a length of 4n+1 and non-zero unused bits
+	 * are rejected, so every byte string has exactly one accepted encoding.
+	 * @return Bytes written, or nullopt if `text` is not valid Base64URL (or `out` is too small).
+	 */
+	HAPP_API std::optional<size_t> decode (std::string_view text, std::span<uint8_t> out) noexcept;
+
+}    // namespace ipb::http::base64url
+
+#endif
@@ -0,0 +1,64 @@
+﻿/*********************************************************************************************
+ *  Description : CoarseClock - Wall clock in seconds, refreshed once per tick by a background thread
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _COARSE_CLOCK_H_
+#	define _COARSE_CLOCK_H_
+
+#	include <atomic>
+#	include <chrono>
+#	include <condition_variable>
+#	include <cstdint>
+#	include <mutex>
+#	include <thread>
+
+#	include "httplib_app_exportcfg.h"
+
+namespace ipb::http
+{
+	/**
+	 * @brief Epoch seconds for hot paths (token expiry checks): `now` is one relaxed atomic load, and a
+	 * background thread refreshes the value every `tick`, so readers never call the system clock.
+	 * The value lags the wall clock by up to one tick.
+	 */
+	class CoarseClock
+	{
+		public:
+			HAPP_API explicit CoarseClock (std::chrono::milliseconds tick = std::chrono::milliseconds (1000));
+			HAPP_API ~CoarseClock();
+
+			CoarseClock (const CoarseClock &)            = delete;
+			CoarseClock &operator= (const CoarseClock &) = delete;
+
+			int64_t now () const noexcept
+			{
+				return seconds_.load (std::memory_order_relaxed);
+			}
+
+			/**
+			 * Read the system clock now (done by the background thread every tick).
+			 */
+			HAPP_API void update () noexcept;
+
+			/**
+			 * Process-wide clock with a one second tick, started on first use and never stopped.
+			 */
+			HAPP_API static CoarseClock &shared ();
+
+		private:
+			void run ();
+
+			std::atomic<int64_t> seconds_ {0};
+			std::chrono::milliseconds tick_;
+			std::mutex mutex_;
+			std::condition_variable stop_requested_;
+			bool stopping_ = false;
+			std::thread thread_;
+	};
+
+}    // namespace ipb::http
+
+#endif
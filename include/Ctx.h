@@ -0,0 +1,179 @@
+﻿/*********************************************************************************************
+ *  Description : Ctx - Request context for the cpp-httplib integration
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _CTX_H_
+#	define _CTX_H_
+
+#	include <string>
+#	include <string_view>
+#	include <vector>
+
+#	include "httplib_app_exportcfg.h"
+#	include "Jwt.h"
+#	include "RequestArena.h"
+#	include "Route.h"
+
+namespace httplib
+{
+	struct Request;
+	struct Response;
+}    // namespace httplib
+
+namespace ipb::http
+{
+	/**
+	 * @brief ICtx implementation bound to a cpp-httplib request/response pair.
+	 * Request data (method, path, body, parameters) is exposed as views into the `httplib::Request`,
+	 * so nothing is copied; the views are valid until the handler returns.
+	 * Instances are pooled per thread by HttplibApp: storage is reused, not reallocated, across requests.
+	 */
+	class Ctx final : public ICtx
+	{
+		public:
+			struct Param
+			{
+					std::string_view name;
+					std::string_view value;
+					ParamValue decoded;
+			};
+
+			HAPP_API Ctx ();
+
+			Ctx (const Ctx &)            = delete;
+			Ctx &operator= (const Ctx &) = delete;
+
+			// ICtx
+			HAPP_API void setParam (std::string_view name, std::string_view value) override;
+			HAPP_API void setTypedParam (std::string_view name, std::string_view value,
+			                             const ParamValue &decoded) override;
+
+			/**
+			 * The request arena: everything allocated from it is released when the request ends.
+			 */
+			std::pmr::memory_resource &memory () noexcept override
+			{
+				return arena_;
+			}
+
+			RequestArena &arena () noexcept
+			{
+				return arena_;
+			}
+
+			/**
+			 * Route parameter captured by the router (empty if not present).
+			 */
+			HAPP_API std::string_view param (std::string_view name) const noexcept;
+
+			/**
+			 * Route parameter decoded during validation (nullptr if not present).
+			 */
+			HAPP_API const ParamValue *typedParam (std::string_view name) const noexcept;
+
+			const std::vector<Param> &params () const noexcept
+			{
+				return params_;
+			}
+
+			std::string_view method () const noexcept
+			{
+				return method_;
+			}
+
+			std::string_view path () const noexcept
+			{
+				return path_;
+			}
+
+			std::string_view body () const noexcept
+			{
+				return body_;
+			}
+
+			/**
+			 * Request header value (case-insensitive name; empty if not present).
+			 */
+			HAPP_API std::string_view header (const std::string &name) const;
+
+			/**
+			 * Query string parameter value (empty if not present).
+			 */
+			HAPP_API std::string_view query (const std::string &name) const;
+
+			const httplib::Request &request () const noexcept
+			{
+				return *request_;
+			}
+
+			httplib::Response &response () noexcept
+			{
+				return *response_;
+			}
+
+			/**
+			 * Router serving the request: the one of its partition (see `HttplibApp::scope`), or the default one.
+			 * nullptr if the context was bound without a router.
+			 */
+			const Router *router () const noexcept
+			{
+				return router_;
+			}
+
+			/**
+			 * Token verified by the auth middleware of the route (nullptr if the request is not authenticated).
+			 * Its claims are read in place; they are valid until the request ends.
+			 */
+			const jwt::Verifier *auth () const noexcept
+			{
+				return authenticated_ ? &verifier_ : nullptr;
+			}
+
+			/**
+			 * Verifier reused by every request of this (pooled) context; `setAuthenticated` publishes it.
+			 */
+			jwt::Verifier &verifier () noexcept
+			{
+				return verifier_;
+			}
+
+			void setAuthenticated (bool authenticated) noexcept
+			{
+				authenticated_ = authenticated;
+			}
+
+			// Response helpers
+			HAPP_API Ctx &status (int code);
+			HAPP_API Ctx &setHeader (const std::string &name, const std::string &value);
+			HAPP_API Ctx &send (std::string_view content, const char *contentType = "text/plain");
+
+			/**
+			 * Attach the context to a request (done by HttplibApp before matching, with the router it selected).
+			 */
+			HAPP_API void bind (const httplib::Request &request, httplib::Response &response,
+			                    const Router *router = nullptr);
+
+			/**
+			 * Detach the context and rewind its arena, keeping the storage for the next request.
+			 */
+			HAPP_API void reset () noexcept;
+
+		private:
+			const httplib::Request *request_ = nullptr;
+			httplib::Response *response_     = nullptr;
+			const Router *router_            = nullptr;
+			std::string_view method_;
+			std::string_view path_;
+			std::string_view body_;
+			std::vector<Param> params_;
+			RequestArena arena_;
+			jwt::Verifier verifier_;    // Default memory: its buffers outlive the arena rewinds
+			bool authenticated_ = false;
+	};
+
+}    // namespace ipb::http
+
+#endif
@@ -0,0 +1,185 @@
+﻿/*********************************************************************************************
+ *  Description : HttplibApp - Router + middlewares wired into the cpp-httplib server
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _HTTPLIB_APP_H_
+#	define _HTTPLIB_APP_H_
+
+#	include <filesystem>
+#	include <functional>
+#	include <memory>
+#	include <span>
+#	include <string>
+#	include <string_view>
+#	include <vector>
+
+#	include "httplib_app_exportcfg.h"
+#	include "Ctx.h"
+#	include "Route.h"
+#	include "RouterPartitions.h"
+#	include "StaticFiles.h"
+
+namespace httplib
+{
+	class Server;
+}    // namespace httplib
+
+namespace ipb::http
+{
+	/**
+	 * @brief Server settings, applied by `HttplibApp::listen`.
+	 */
+	struct HttpServerConfig
+	{
+			std::string host              = "0.0.0.0";
+			int port                      = 8080;
+			int threads                   = 0;       // Worker threads (0: cpp-httplib default)
+			bool normalize_trailing_slash = true;    // Match "/users/" as "/users"
+			PartitionKey partition_by     = PartitionKey::HOST;    // Selects the router of `scope` partitions
+	};
+
+	/**
+	 * @brief Continuation passed to app middlewares: call it to run the rest of the chain.
+	 */
+	class Next
+	{
+		public:
+			explicit Next (IMiddlewareNext &next) noexcept
+			    : next_ (&next)
+			{
+			}
+
+			void operator() () const
+			{
+				next_->next();
+			}
+
+		private:
+			IMiddlewareNext *next_;
+	};
+
+	using AppHandler    = std::function<void (Ctx &)>;
+	using AppMiddleware = std::function<void (Ctx &, Next)>;
+
+	/**
+	 * @brief cpp-httplib server dispatching through a Router.
+	 * Routes are registered before `listen`, which freezes the router and serves it from the
+	 * pre-routing hook of cpp-httplib (no regex routing). Each request borrows a pooled Ctx.
+	 */
+	class HttplibApp
+	{
+		public:
+			HAPP_API HttplibApp ();
+			HAPP_API explicit HttplibApp (HttpServerConfig config);
+			HAPP_API ~HttplibApp();
+
+			HttplibApp (const HttplibApp &)            = delete;
+			HttplibApp &operator= (const HttplibApp &) = delete;
+
+			HttpServerConfig &config () noexcept
+			{
+				return config_;
+			}
+
+			const HttpServerConfig &config () const noexcept
+			{
+				return config_;
+			}
+
+			Router &router () noexcept
+			{
+				return router_;
+			}
+
+			/**
+			 * Router of a partition (a Host, or a path prefix: see `HttpServerConfig::partition_by`),
+			 * created on first use. Its table can be reloaded on its own with `Router::publish`.
+			 */
+			HAPP_API Router &router (std::string_view partition);
+
+			/**
+			 * Register the routes and middlewares that follow in a partition (`scope ("api.example.com")`);
+			 * `scope ({})` goes back to the default router. A request is served by the router of its
+			 * partition, or by the default router when its Host (or prefix) has no partition, and only
+			 * runs the global middlewares registered in that router.
+			 */
+			HAPP_API HttplibApp &scope (std::string_view partition);
+
+			// Route registration (chainable)
+			HAPP_API HttplibApp &route (HttpMethod method, std::string_view pattern, AppHandler handler,
+			                            const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &get (std::string_view pattern, AppHandler handler,
+			                          const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &post (std::string_view pattern, AppHandler handler,
+			                           const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &put (std::string_view pattern, AppHandler handler,
+			                          const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &patch (std::string_view pattern, AppHandler handler,
+			                            const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &del (std::string_view pattern, AppHandler handler,
+			                          const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &options (std::string_view pattern, AppHandler handler,
+			                              const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &head (std::string_view pattern, AppHandler handler,
+			                           const std::vector<AppMiddleware> &middlewares = {});
+			HAPP_API HttplibApp &any (std::string_view pattern, AppHandler handler,
+			                          const std::vector<AppMiddleware> &middlewares = {});
+
+			/**
+			 * Serve the routes of a route table image (`Router::saveImage`) in the current scope instead of
+			 * registering them one by one: `handlers [id]` serves the route with that ID (its registration order).
+			 * Returns false (nothing changes) if the image is missing or rejected.
+			 */
+			HAPP_API bool loadRoutes (const std::filesystem::path &image, std::span<const AppHandler> handlers);
+
+			/**
+			 * Serve the files under `root` below `prefix` (GET and HEAD on `prefix/<path:path>`, see `staticFiles`).
+			 */
+			HAPP_API HttplibApp &serveStatic (std::string_view prefix, std::string root, StaticFilesConfig config = {});
+
+			/**
+			 * Add a global middleware executed for all routes.
+			 */
+			HAPP_API HttplibApp &use (AppMiddleware middleware);
+
+			/**
+			 * Add a middleware to one route (e.g. a RouteInfo returned by `router().add`).
+			 */
+			HAPP_API HttplibApp &use (RouteInfo &route, AppMiddleware middleware);
+
+			/**
+			 * Match and execute a request. Returns false (response untouched) if no route matches.
+			 * Called by the server for every request; usable directly with any httplib::Request.
+			 * Routes with coroutine steps run through Router::executeAsync, but cpp-httplib needs the response
+			 * when the handler returns, so the worker thread still waits for the task to complete.
+			 */
+			HAPP_API bool dispatch (const httplib::Request &request, httplib::Response &response) const;
+
+			/**
+			 * Freeze the router and serve it (blocks until `stop`).
+			 */
+			HAPP_API bool listen ();
+
+			HAPP_API void stop ();
+
+			/**
+			 * Underlying cpp-httplib server (TLS-less), for settings not covered by HttpServerConfig.
+			 */
+			HAPP_API httplib::Server &server ();
+
+		private:
+			const Router &select (const httplib::Request &request) const noexcept;
+
+			HttpServerConfig config_;
+			Router router_;
+			std::unique_ptr<RouterPartitions> partitions_;    // Created by the first partition
+			Router *target_;                                  // Router of `route` and `use`
+			std::unique_ptr<httplib::Server> server_;
+	};
+
+}    // namespace ipb::http
+
+#endif
@@ -0,0 +1,109 @@
+/*********************************************************************************************
+ *  Description : JWKS client - keeps the Jwt engine keys in sync with a JWKS document
+ *  License     : The unlicense (https://unlicense.org)
+ *  Copyright    (C) 2026  Ignacio Pomar Ballestero
+ *********************************************************************************************/
+
+#pragma once
+#ifndef JWKS_H_
+#	define JWKS_H_
+
+#	include <chrono>
+#	include <cstddef>
+#	include <cstdint>
+#	include <memory>
+#	include <optional>
+#	include <string>
+#	include <string_view>
+
+#	include "httplib_app_exportcfg.h"
+#	include "Jwt.h"
+
+namespace ipb::http::jwt
+{
+	struct JwksDocument
+	{
+		std::string body;
+		std::string cacheControl;    // Cache-Control header of the response (may be empty)
+	};
+
+	/**
+	 * @brief Where the JWKS document comes from (an HTTP client, a file, ...).
+	 * fetch is only called from the refresh path, never from verify.
+	 */
+	class IJwksSource
+	{
+		public:
+			virtual ~IJwksSource ()                           = default;
+			virtual Error fetch (JwksDocument &outDocument) = 0;
+	};
+
+	struct JwksOptions
+	{
+		std::chrono::seconds refreshInterval {300};        // Used when the response has no max-age
+		std::chrono::seconds minRefreshInterval {30};      // Lower bound for max-age and for unknown-kid refreshes
+		std::chrono::seconds maxRefreshInterval {86400};   // Upper bound for max-age
+		std::chrono::seconds retryInterval {10};           // Delay after a failed refresh
+	};
+
+	/**
+	 * @brief max-age directive of a Cache-Control value (no-store / no-cache read as 0).
+	 */
+	HAPP_API std::optional<int64_t> parseMaxAge (std::string_view cacheControl) noexcept;
+
+	/**
+	 * @brief Loads the keys of a JWKS document into a Jwt engine and keeps them fresh.
+	 * Keys are indexed by kid; only added or changed keys are (re)loaded and keys that leave the set are
+	 * removed, so the verified-token cache is only purged for the kids that actually changed.
+	 * The background refresher follows Cache-Control max-age; a token with an unknown kid triggers an
+	 * early refresh, at most once per minRefreshInterval however many requests carry it.
+	 * verify never waits for a refresh: it fails with KeyNotFound until the new key is published.
+	 * The engine must be thread-safe (EngineOptions::threadSafe) when the refresher runs.
+	 */
+	class JwksClient
+	{
+		public:
+			HAPP_API JwksClient (Jwt &jwt, IJwksSource &source, JwksOptions options = {});
+			HAPP_API ~JwksClient ();
+
+			JwksClient (const JwksClient &)            = delete;
+			JwksClient &operator= (const JwksClient &) = delete;
+
+			/**
+			 * Fetch the document and apply it now (on the calling thread).
+			 */
+			HAPP_API Error refresh ();
+
+			/**
+			 * Start the background refresher and hook EngineOptions::onUnknownKid (the callback already
+			 * installed, if any, is still called after the refresh request).
+			 * The first refresh runs immediately unless refresh() already succeeded.
+			 */
+			HAPP_API void start ();
+
+			/**
+			 * Stop the refresher and restore the previous onUnknownKid (also done by the destructor).
+			 */
+			HAPP_API void stop ();
+
+			/**
+			 * Ask the refresher for an early refresh because `kid` is unknown. Never blocks on the fetch.
+			 */
+			HAPP_API void requestRefresh (std::string_view kid);
+
+			HAPP_API bool hasKey (std::string_view kid) const;
+			HAPP_API size_t keyCount () const;
+
+			/**
+			 * Delay until the next scheduled refresh, as derived from the last response.
+			 */
+			HAPP_API std::chrono::seconds refreshDelay () const;
+
+		private:
+			class Impl;
+			std::unique_ptr<Impl> impl_;
+	};
+
+}    // namespace ipb::http::jwt
+
+#endif
@@ -8,14 +8,17 @@
 #ifndef JWT_H_
 #	define JWT_H_
 
+#	include <atomic>
 #	include <cstddef>
 #	include <cstdint>
+#	include <functional>
 #	include <memory>
+#	include <memory_resource>
 #	include <optional>
 #	include <span>
 #	include <string>
 #	include <string_view>
-#	include <unordered_map>
+#	include <utility>
 #	include <variant>
 #	include <vector>
 
@@ -89,24 +92,260 @@ namespace ipb::http::jwt
 		std::string message;
 	};
 
-	using ClaimValue = std::variant<std::nullptr_t, bool, int64_t, double, std::string>;
-	using ClaimMap   = std::unordered_map<std::string, ClaimValue>;
-	using HeaderMap  = std::unordered_map<std::string, ClaimValue>;
+	// Array of strings, e.g. an "aud" naming several audiences (RFC 7519, 4.1.3)
+	using ClaimStrings = std::vector<std::string>;
+
+	/**
+	 * @brief Any other object or array, kept as its JSON text and written back unchanged (the text must
+	 * be valid JSON when it is given to TokenBuilder).
+	 */
+	struct ClaimJson
+	{
+		std::string text;
+
+		bool operator== (const ClaimJson &) const = default;
+	};
+
+	using ClaimValue = std::variant<std::nullptr_t, bool, int64_t, double, std::string, ClaimStrings, ClaimJson>;
+
+	/**
+	 * @brief Flat name/value store for JWT headers and claims (insertion order, unique names).
+	 * Tokens carry a handful of members, so a linear scan over one vector beats hashing into nodes;
+	 * lookups take a string_view (no temporary key), and clear() keeps the storage for reuse.
+	 */
+	class ClaimMap
+	{
+		public:
+			using value_type     = std::pair<std::string, ClaimValue>;
+			using iterator       = std::vector<value_type>::iterator;
+			using const_iterator = std::vector<value_type>::const_iterator;
+
+			// Value of `name`, inserted as null if missing
+			ClaimValue &operator[] (std::string_view name)
+			{
+				if (auto it = find (name); it != items_.end())
+				{
+					return it->second;
+				}
+				return items_.emplace_back (std::string (name), nullptr).second;
+			}
+
+			iterator find (std::string_view name) noexcept
+			{
+				return items_.begin() + static_cast<std::ptrdiff_t> (indexOf (name));
+			}
+
+			const_iterator find (std::string_view name) const noexcept
+			{
+				return items_.begin() + static_cast<std::ptrdiff_t> (indexOf (name));
+			}
+
+			bool contains (std::string_view name) const noexcept
+			{
+				return indexOf (name) != items_.size();
+			}
+
+			size_t count (std::string_view name) const noexcept
+			{
+				return contains (name) ? 1 : 0;
+			}
+
+			size_t erase (std::string_view name)
+			{
+				if (auto it = find (name); it != items_.end())
+				{
+					items_.erase (it);
+					return 1;
+				}
+				return 0;
+			}
+
+			iterator begin () noexcept
+			{
+				return items_.begin();
+			}
+
+			iterator end () noexcept
+			{
+				return items_.end();
+			}
+
+			const_iterator begin () const noexcept
+			{
+				return items_.begin();
+			}
+
+			const_iterator end () const noexcept
+			{
+				return items_.end();
+			}
+
+			size_t size () const noexcept
+			{
+				return items_.size();
+			}
+
+			bool empty () const noexcept
+			{
+				return items_.empty();
+			}
+
+			void clear () noexcept
+			{
+				items_.clear();
+			}
+
+			void reserve (size_t count)
+			{
+				items_.reserve (count);
+			}
+
+			// Position of `name` (size() if absent)
+			size_t indexOf (std::string_view name) const noexcept
+			{
+				size_t i = 0;
+				while (i < items_.size() && items_ [i].first != name)
+				{
+					++i;
+				}
+				return i;
+			}
+
+		private:
+			std::vector<value_type> items_;
+	};
+
+	using HeaderMap = ClaimMap;
+
+	// Registered claim names (RFC 7519, section 4.1)
+	enum class RegisteredClaim : uint8_t
+	{
+		Iss = 0,
+		Sub,
+		Aud,
+		Exp,
+		Nbf,
+		Iat,
+		Jti,
+		Count
+	};
 
 	struct Policy
 	{
 		std::vector<JwtAlg> allowedAlgs;
 		std::optional<std::string> expectedIss;
-		std::optional<std::string> expectedAud;
+		std::optional<std::string> expectedAud;    // A string aud equal to it, or an array aud containing it
 		int64_t leewaySeconds = 0;
 		bool requireExp       = true;
 		bool requireNbf       = false;
 	};
 
+	// Bit of `alg` in CompiledPolicy::algMask
+	inline constexpr uint8_t algBit (JwtAlg alg) noexcept
+	{
+		return static_cast<uint8_t> (1u << static_cast<uint8_t> (alg));
+	}
+
+	class KeyHandle;
+
+	/**
+	 * @brief Policy prepared once for repeated verifications (see compilePolicy).
+	 * The allowed algorithms are a bit mask, and the key can be pinned: tokens naming another kid are
+	 * rejected before their signature is checked. Handles of the pinned key resolved ahead (Jwt::resolveKey)
+	 * are used instead of the engine cache until a key change retires them.
+	 */
+	struct CompiledPolicy
+	{
+		Policy policy;
+		uint8_t algMask = 0xFF; // algBit of every allowed algorithm (all of them if allowedAlgs is empty)
+		std::string kid;        // Pinned key (empty: the kid named by the token)
+		std::vector<std::shared_ptr<const KeyHandle>> keys; // Handles of the pinned key, at most one per algorithm
+	};
+
+	HAPP_API CompiledPolicy compilePolicy (Policy policy, std::string kid = {});
+
+	// How a Verifier keeps the verified token
+	enum class TokenStorage : uint8_t
+	{
+		Copy   = 0,    // The verifier owns a copy (default)
+		Borrow = 1     // The verifier views the caller's token, which must outlive it
+	};
+
+	/**
+	 * threadSafe (fixed when the engine is constructed):
+	 * - true: verify/sign can run on any thread while keys or options change. verify takes no lock: it reads
+	 *   an immutable options snapshot published by setOptions, and the key handle map published in it
+	 *   (copied on write; replaced snapshots and maps are destroyed once no verify uses them). Key
+	 *   operations are serialized. Providers must then be thread-safe themselves.
+	 * - false: single-threaded use; no synchronization is done at all.
+	 * Decode/sign buffers are per call site (the Verifier) or per thread, never shared.
+	 */
 	struct EngineOptions
 	{
 		Policy policy;
 		bool threadSafe = true;
+		size_t verifiedCacheCapacity = 0; // verified tokens kept to skip the signature check (0: disabled)
+
+		// Called on the verifying thread when the provider has no key for a token kid (e.g. to trigger a
+		// JWKS refresh). It must not block, nor change keys or options itself: it runs inside the verification.
+		std::function<void (std::string_view kid)> onUnknownKid;
+	};
+
+	// One key of a JWKS document, as split by IJsonProvider::parseJwks
+	struct JwkEntry
+	{
+		std::string kid;
+		std::string alg;
+		JwtUse use = JwtUse::Sig;
+		std::string json; // The JWK object text, handed to ICryptoProvider::loadPublicKeyFromJwk
+	};
+
+	// One signature to check in ICryptoProvider::verifyBatch
+	struct SignatureCheck
+	{
+		std::span<const uint8_t> data;
+		std::span<const uint8_t> signature;
+	};
+
+	class KeyHandleCache;
+
+	/**
+	 * @brief Key of one kid, resolved once for one algorithm by ICryptoProvider::resolveKey.
+	 * Providers derive from it to keep the parsed key and its reusable operation state (e.g. a per-thread
+	 * verification context), so signing and verifying through the handle skip the lookup by kid and the
+	 * setup of the operation. The engine caches the handles per kid and retires them when the key changes.
+	 */
+	class HAPP_API KeyHandle
+	{
+		public:
+			KeyHandle (std::string kid, JwtAlg alg);
+			virtual ~KeyHandle () = default;
+
+			KeyHandle (const KeyHandle &)            = delete;
+			KeyHandle &operator= (const KeyHandle &) = delete;
+
+			const std::string &kid () const noexcept
+			{
+				return kid_;
+			}
+
+			JwtAlg alg () const noexcept
+			{
+				return alg_;
+			}
+
+			// True once the key of the kid changed in the engine: a pinned handle must be resolved again
+			bool retired () const noexcept
+			{
+				return retired_.load (std::memory_order_acquire);
+			}
+
+		private:
+			friend class KeyHandleCache;
+
+			std::string kid_;
+			JwtAlg alg_;
+			mutable std::atomic<bool> retired_ {false};
 	};
 
 	class HAPP_API ICryptoProvider
@@ -122,6 +361,12 @@ namespace ipb::http::jwt
 			virtual Error generateKeyPair (std::string_view kid, JwtAlg alg, std::string_view params = {})       = 0;
 			virtual Error removeKey (std::string_view kid)                                                         = 0;
 
+			/**
+			 * Load a public key from a JWK object (one entry of a JWKS document).
+			 * The default reports the format as unsupported.
+			 */
+			virtual Error loadPublicKeyFromJwk (std::string_view kid, std::string_view jwkJson, JwtUse use);
+
 			virtual Error sign (JwtAlg alg, std::string_view kid, std::span<const uint8_t> data,
 			                    ByteBuffer &outSignature) const
 			    = 0;
@@ -129,8 +374,30 @@ namespace ipb::http::jwt
 			                      std::span<const uint8_t> signature) const
 			    = 0;
 
-			virtual Error base64UrlEncode (std::span<const uint8_t> data, std::string &outText) const = 0;
-			virtual Error base64UrlDecode (std::string_view text, ByteBuffer &outData) const           = 0;
+			/**
+			 * Resolve the key of `kid` for `alg`, for `signWith` / `verifyWith` (the engine caches the handle).
+			 * Override the three together to keep the parsed key in a KeyHandle subclass. The default handle
+			 * only holds the kid and the algorithm, and the default signWith / verifyWith call sign / verify.
+			 */
+			virtual Error resolveKey (std::string_view kid, JwtAlg alg, std::shared_ptr<const KeyHandle> &outKey) const;
+			virtual Error signWith (const KeyHandle &key, std::span<const uint8_t> data, ByteBuffer &outSignature) const;
+			virtual Error verifyWith (const KeyHandle &key, std::span<const uint8_t> data,
+			                          std::span<const uint8_t> signature) const;
+
+			/**
+			 * Check several signatures made with the key of one handle (`outResults[i]` for `checks[i]`).
+			 * Override it to use batched primitives (e.g. batched Ed25519, multi-buffer SHA-256); the default
+			 * calls `verifyWith` for each entry.
+			 */
+			virtual void verifyBatch (const KeyHandle &key, std::span<const SignatureCheck> checks,
+			                          std::span<Error> outResults) const;
+
+			/**
+			 * Base64URL (unpadded). The defaults use the built-in codec (Base64Url.h), writing straight
+			 * into the output buffer; override them only to use the backend's own.
+			 */
+			virtual Error base64UrlEncode (std::span<const uint8_t> data, std::string &outText) const;
+			virtual Error base64UrlDecode (std::string_view text, ByteBuffer &outData) const;
 	};
 
 	class HAPP_API IJsonProvider
@@ -142,6 +409,11 @@ namespace ipb::http::jwt
 			virtual Error parseClaims (std::string_view text, ClaimMap &outClaims) const   = 0;
 
 			virtual Error toJson (const ClaimMap &values, std::string &outJson) const = 0;
+
+			/**
+			 * Split a JWKS document ({"keys":[...]}) into its keys. The default reports it as unsupported.
+			 */
+			virtual Error parseJwks (std::string_view text, std::vector<JwkEntry> &outKeys) const;
 	};
 
 	class Jwt;
@@ -150,6 +422,12 @@ namespace ipb::http::jwt
 	{
 		public:
 			HAPP_API Verifier ();
+
+			/**
+			 * Verifier whose token copy and decoded header/payload live in `memory` (e.g. `ICtx::memory()`).
+			 * It must not be used after the resource is released; copies of it use the default resource.
+			 */
+			HAPP_API explicit Verifier (std::pmr::memory_resource &memory);
 			HAPP_API ~Verifier ();
 			HAPP_API Verifier (const Verifier &other);
 			HAPP_API Verifier &operator= (const Verifier &other);
@@ -166,6 +444,22 @@ namespace ipb::http::jwt
 			HAPP_API const HeaderMap &header () const noexcept;
 			HAPP_API const ClaimMap &claims () const noexcept;
 
+			// Registered claims, indexed once when the token is decoded
+			HAPP_API std::optional<std::string_view> issuer () const noexcept;
+			HAPP_API std::optional<std::string_view> subject () const noexcept;
+			HAPP_API std::optional<std::string_view> audience () const noexcept;    // Also a one-element array
+			HAPP_API std::optional<std::string_view> jwtId () const noexcept;
+			HAPP_API std::optional<int64_t> expiresAt () const noexcept;
+			HAPP_API std::optional<int64_t> notBefore () const noexcept;
+			HAPP_API std::optional<int64_t> issuedAt () const noexcept;
+
+			/**
+			 * Claim value by name (nullptr if absent); the pointer and string views are valid until the
+			 * verifier is reused. Unlike claimString, claimView does not copy.
+			 */
+			HAPP_API const ClaimValue *claim (std::string_view name) const noexcept;
+			HAPP_API std::optional<std::string_view> claimView (std::string_view name) const noexcept;
+
 			HAPP_API bool hasClaim (std::string_view name) const noexcept;
 			HAPP_API std::optional<std::string> claimString (std::string_view name) const;
 			HAPP_API std::optional<int64_t> claimInt (std::string_view name) const;
@@ -199,6 +493,7 @@ namespace ipb::http::jwt
 			HAPP_API TokenBuilder &issuer (std::string value);
 			HAPP_API TokenBuilder &subject (std::string value);
 			HAPP_API TokenBuilder &audience (std::string value);
+			HAPP_API TokenBuilder &audience (ClaimStrings values);
 			HAPP_API TokenBuilder &jwtId (std::string value);
 			HAPP_API TokenBuilder &expiresAt (int64_t epochSeconds);
 			HAPP_API TokenBuilder &notBefore (int64_t epochSeconds);
@@ -216,6 +511,58 @@ namespace ipb::http::jwt
 			ClaimMap claims_;
 	};
 
+	/**
+	 * @brief Per-token claims written by SigningTemplate::sign (empty / nullopt: not written).
+	 */
+	struct SigningClaims
+	{
+			std::string_view subject;
+			std::optional<int64_t> expiresAt;
+			std::optional<int64_t> issuedAt;
+			std::string_view jwtId;
+	};
+
+	/**
+	 * @brief Signer for tokens that share alg, kid, typ and a set of fixed claims.
+	 * The header segment and the fixed claims are serialized once, at construction; sign() only writes the
+	 * per-token claims, and builds the token in the output buffer (reserved to its final size), signing
+	 * over its "header.payload" prefix. The payload is written as JSON (RFC 7519), so the JSON provider
+	 * must serialize the fixed claims as a JSON object.
+	 * Immutable after construction: sign() can be called from several threads.
+	 */
+	class  SigningTemplate
+	{
+		public:
+			HAPP_API SigningTemplate (const Jwt &jwt, JwtAlg alg, std::string kid, const ClaimMap &fixedClaims = {},
+			                          std::string type = "JWT");
+
+			/**
+			 * Construction result: not Ok if the header or the fixed claims could not be serialized.
+			 */
+			HAPP_API const Error &error () const noexcept;
+
+			/**
+			 * Base64URL header followed by the '.' separator.
+			 */
+			HAPP_API std::string_view headerSegment () const noexcept;
+
+			/**
+			 * Sign a token with the fixed claims plus `claims`. A claim set both here and in the fixed
+			 * claims is rejected (JsonError), since it would be a duplicate member.
+			 */
+			HAPP_API Error sign (const SigningClaims &claims, std::string &outToken) const;
+
+		private:
+			const Jwt &jwt_;
+			JwtAlg alg_;
+			std::string kid_;
+			std::shared_ptr<const KeyHandle> key_;    // Resolved at construction (null if the kid was unknown)
+			std::string headerSegment_;
+			std::string fixedMembers_;         // Fixed claims as JSON members, without the braces
+			uint8_t fixedVariableClaims_ = 0;  // SigningClaims members already in the fixed claims (bit set)
+			Error error_;
+	};
+
 	class  Jwt
 	{
 		public:
@@ -235,13 +582,66 @@ namespace ipb::http::jwt
 			HAPP_API Error savePublicKeyToPemFile (std::string_view kid, std::string_view pemPath, JwtUse use = JwtUse::Sig);
 			HAPP_API Error generateKeyPair (std::string_view kid, JwtAlg alg, std::string_view params = {});
 			HAPP_API Error removeKey (std::string_view kid);
+			HAPP_API Error loadPublicKeyFromJwk (std::string_view kid, std::string_view jwkJson, JwtUse use = JwtUse::Sig);
 
+			/**
+			 * Verify `token` into `outVerifier`. The verifier storage is reused across calls, so keeping one
+			 * verifier per worker (or per request context) avoids reallocating the decode buffers.
+			 * The signature is checked directly over the "header.payload" prefix of `token`.
+			 */
 			HAPP_API Error verify (std::string_view token, Verifier &outVerifier) const;
+			HAPP_API Error verify (std::string_view token, Verifier &outVerifier, TokenStorage storage) const;
+
+			/**
+			 * Verify `token` against `policy` instead of the engine policy, at `now` (epoch seconds, e.g. a
+			 * CoarseClock reading, so no clock is read per token). The verified-token cache and onUnknownKid
+			 * of the engine still apply.
+			 */
+			HAPP_API Error verify (std::string_view token, Verifier &outVerifier, const CompiledPolicy &policy,
+			                       int64_t now, TokenStorage storage = TokenStorage::Copy) const;
+
+			/**
+			 * Verify `tokens[i]` into `outVerifiers[i]` (each verifier holds its own result).
+			 * Signature checks are grouped by algorithm and kid into `ICryptoProvider::verifyBatch` calls, each with
+			 * the cached key handle of its group.
+			 * Returns an error only if the spans differ in size.
+			 */
+			HAPP_API Error verifyBatch (std::span<const std::string_view> tokens, std::span<Verifier> outVerifiers,
+			                            TokenStorage storage = TokenStorage::Copy) const;
 			HAPP_API TokenBuilder token () const;
 
+			/**
+			 * Key handle of `kid` for `alg`, from the engine cache (resolved by the provider on a miss).
+			 * The handle is retired when a key operation changes `kid`.
+			 */
+			HAPP_API Error resolveKey (std::string_view kid, JwtAlg alg, std::shared_ptr<const KeyHandle> &outKey) const;
+
+			/**
+			 * Sign `data` with the cached key handle of `kid` (the raw signature, as TokenBuilder does).
+			 */
+			HAPP_API Error sign (JwtAlg alg, std::string_view kid, std::span<const uint8_t> data,
+			                     ByteBuffer &outSignature) const;
+
+			/**
+			 * Signing template for tokens with this alg, kid and fixed claims (see SigningTemplate).
+			 */
+			HAPP_API SigningTemplate signingTemplate (JwtAlg alg, std::string kid, const ClaimMap &fixedClaims = {}) const;
+
+			/**
+			 * Current options (the reference is invalidated by the next setOptions).
+			 */
 			HAPP_API const EngineOptions &options () const noexcept;
+
+			/**
+			 * Replace the options; the verified-token cache is emptied (and resized).
+			 */
 			HAPP_API void setOptions (EngineOptions options);
 
+			/**
+			 * Number of tokens in the verified-token cache.
+			 */
+			HAPP_API size_t cachedTokenCount () const;
+
 			HAPP_API ICryptoProvider &crypto () noexcept;
 			HAPP_API const ICryptoProvider &crypto () const noexcept;
 			HAPP_API IJsonProvider &json () noexcept;
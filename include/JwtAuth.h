@@ -0,0 +1,52 @@
+﻿/*********************************************************************************************
+ *  Description : JwtAuth - Route-scoped bearer token authentication middleware
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _JWT_AUTH_H_
+#	define _JWT_AUTH_H_
+
+#	include <string>
+
+#	include "httplib_app_exportcfg.h"
+#	include "CoarseClock.h"
+#	include "HttplibApp.h"
+#	include "Jwt.h"
+#	include "Route.h"
+
+namespace ipb::http
+{
+	/**
+	 * @brief Bearer token authentication for routes served by HttplibApp, attached per route as a middleware.
+	 * Each middleware compiles its policy once (algorithm bit mask, pinned key and its key handles) and
+	 * reads the time from a CoarseClock. The token is verified in place (borrowed from the Authorization
+	 * header) into the pooled verifier of the Ctx, so the claims are read through `Ctx::auth()` without
+	 * being copied.
+	 * Requests without a bearer token, or with a token the policy rejects, get 401 and do not call `next`.
+	 */
+	class JwtAuth
+	{
+		public:
+			/**
+			 * `jwt` and `clock` must outlive the middlewares (their engine options and keys can still change).
+			 */
+			HAPP_API explicit JwtAuth (const jwt::Jwt &jwt, const CoarseClock &clock = CoarseClock::shared());
+
+			/**
+			 * Middleware for `HttplibApp::use (route, ...)` or the `middlewares` list of `HttplibApp::route`.
+			 * @param kid Pinned key: tokens naming another key are rejected (empty: any key of the engine). Its
+			 * handle is resolved here for each algorithm of `policy.allowedAlgs`; after a key change (or if the
+			 * key is not loaded yet) the engine cache resolves it instead.
+			 */
+			HAPP_API AppMiddleware middleware (jwt::Policy policy, std::string kid = {}) const;
+
+		private:
+			const jwt::Jwt &jwt_;
+			const CoarseClock &clock_;
+	};
+
+}    // namespace ipb::http
+
+#endif
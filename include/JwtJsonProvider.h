@@ -0,0 +1,49 @@
+/*********************************************************************************************
+ *  Description : Built-in JSON provider for JWT headers, claims and JWKS documents
+ *  License     : The unlicense (https://unlicense.org)
+ *  Copyright    (C) 2026  Ignacio Pomar Ballestero
+ *********************************************************************************************/
+
+#pragma once
+#ifndef JWT_JSON_PROVIDER_H_
+#	define JWT_JSON_PROVIDER_H_
+
+#	include <string>
+#	include <string_view>
+#	include <vector>
+
+#	include "httplib_app_exportcfg.h"
+#	include "Jwt.h"
+
+namespace ipb::http::jwt
+{
+	/**
+	 * @brief IJsonProvider for JWT-sized documents: one flat object parsed in a single pass straight into
+	 * the ClaimMap (no DOM). String scanning looks for quotes, escapes and control characters 16 bytes at a
+	 * time (SSE2 / NEON); strings without escapes are copied in one block.
+	 * - Integers that fit in int64_t are stored as such; other numbers as double.
+	 * - Arrays of strings are read as ClaimStrings; other objects and arrays are kept as ClaimJson text.
+	 * - Duplicate member names are rejected (RFC 7519, section 4).
+	 * Stateless and thread-safe.
+	 */
+	class HAPP_API JwtJsonProvider final : public IJsonProvider
+	{
+		public:
+			Error parseHeader (std::string_view text, HeaderMap &outHeader) const override;
+			Error parseClaims (std::string_view text, ClaimMap &outClaims) const override;
+
+			/**
+			 * Serialize `values` as a flat object; the output is sized before it is written.
+			 * ClaimStrings are written as arrays and ClaimJson text as is (unquoted).
+			 */
+			Error toJson (const ClaimMap &values, std::string &outJson) const override;
+
+			/**
+			 * Split {"keys":[...]} into its keys (kid, alg, use and the raw JWK object).
+			 */
+			Error parseJwks (std::string_view text, std::vector<JwkEntry> &outKeys) const override;
+	};
+
+}    // namespace ipb::http::jwt
+
+#endif
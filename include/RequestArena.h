@@ -0,0 +1,85 @@
+﻿/*********************************************************************************************
+ *  Description : RequestArena - Per-request monotonic memory resource
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _REQUEST_ARENA_H_
+#	define _REQUEST_ARENA_H_
+
+#	include <cstddef>
+#	include <memory>
+#	include <memory_resource>
+#	include <optional>
+
+#	include "httplib_app_exportcfg.h"
+
+namespace ipb::http
+{
+	/**
+	 * @brief Bump allocator for memory that lives as long as one request.
+	 * Allocations are carved from a block owned by the arena; `deallocate` is a no-op and `reset`
+	 * rewinds the whole arena at once. When a request does not fit, the extra memory comes from
+	 * the heap and the block grows (up to `kMaxBlockBytes`) on the next `reset`, so a warmed-up
+	 * arena serves its requests without touching the heap. Not thread-safe: one arena per context.
+	 */
+	class HAPP_API RequestArena final : public std::pmr::memory_resource
+	{
+		public:
+			static constexpr size_t kDefaultBlockBytes = 4 * 1024;
+			static constexpr size_t kMaxBlockBytes     = 256 * 1024;
+
+			explicit RequestArena (size_t blockBytes = kDefaultBlockBytes);
+			~RequestArena() override;
+
+			RequestArena (const RequestArena &)            = delete;
+			RequestArena &operator= (const RequestArena &) = delete;
+
+			/**
+			 * Release everything allocated since the last reset (O(1) unless the block overflowed).
+			 */
+			void reset () noexcept;
+
+			/**
+			 * Size of the block served without heap allocations.
+			 */
+			size_t blockBytes () const noexcept
+			{
+				return block_bytes_;
+			}
+
+			/**
+			 * Heap bytes requested since the last reset because the block was exhausted.
+			 */
+			size_t overflowBytes () const noexcept
+			{
+				return upstream_.bytes;
+			}
+
+		private:
+			// Heap fallback, counting what the block could not serve
+			class Upstream final : public std::pmr::memory_resource
+			{
+				public:
+					size_t bytes = 0;
+
+				private:
+					void *do_allocate (size_t bytes, size_t alignment) override;
+					void do_deallocate (void *p, size_t bytes, size_t alignment) override;
+					bool do_is_equal (const std::pmr::memory_resource &other) const noexcept override;
+			};
+
+			void *do_allocate (size_t bytes, size_t alignment) override;
+			void do_deallocate (void *p, size_t bytes, size_t alignment) override;
+			bool do_is_equal (const std::pmr::memory_resource &other) const noexcept override;
+
+			size_t block_bytes_;
+			std::unique_ptr<std::byte[]> block_;
+			Upstream upstream_;
+			std::optional<std::pmr::monotonic_buffer_resource> buffer_;
+	};
+
+}    // namespace ipb::http
+
+#endif
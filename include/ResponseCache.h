@@ -0,0 +1,100 @@
+﻿/*********************************************************************************************
+ *  Description : ResponseCache - Route-scoped response caching middleware with ETags
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _RESPONSE_CACHE_H_
+#	define _RESPONSE_CACHE_H_
+
+#	include <chrono>
+#	include <cstddef>
+#	include <cstdint>
+#	include <memory>
+#	include <string>
+#	include <string_view>
+#	include <vector>
+
+#	include "httplib_app_exportcfg.h"
+#	include "HttplibApp.h"
+#	include "Route.h"
+
+namespace ipb::http
+{
+	/**
+	 * @brief Settings of a ResponseCache.
+	 */
+	struct ResponseCacheConfig
+	{
+			size_t capacity      = 1024;                // Responses kept (LRU, shared by every route)
+			size_t max_body_size = 1 << 20;             // Larger responses are not stored
+			std::chrono::milliseconds ttl {60'000};     // Time a stored response is served
+			std::vector<std::string> query_keys;        // Query parameters that are part of the key
+	};
+
+	/**
+	 * @brief Counters of a ResponseCache (approximate while serving).
+	 */
+	struct ResponseCacheStats
+	{
+			uint64_t hits        = 0;    // Requests answered from the cache (200 or 304)
+			uint64_t notModified = 0;    // Of them (and of the stored misses), answered with 304
+			uint64_t misses      = 0;    // Requests that ran the rest of the chain
+			uint64_t stores      = 0;    // Responses stored
+	};
+
+	/**
+	 * @brief Response cache for routes served by HttplibApp, attached per route as a middleware.
+	 * The key is the route pattern and the router serving it (the partition, see `HttplibApp::scope`) plus the
+	 * values of its parameters, as captured by the router (and the `query_keys`), so it is compact and already
+	 * normalized: the handler must not depend on anything else of the request. The method is not part of
+	 * the key, since only GET responses are stored (and HEAD is answered from them).
+	 * GET and HEAD requests are answered from a stored response without calling `next`; on a miss the chain
+	 * runs, and a GET answered with 200 and a body is stored, unless it streams its body, sets a cookie or
+	 * says `Cache-Control: no-store` / `private`. Responses carry an ETag (the one set by the handler, or a hash
+	 * of the body) and a matching `If-None-Match` gets 304.
+	 * Entries live in LRU shards, each protected by its own mutex, and expire `ttl` after they are stored.
+	 */
+	class ResponseCache
+	{
+		public:
+			HAPP_API explicit ResponseCache (ResponseCacheConfig config = {});
+			HAPP_API ~ResponseCache();
+
+			ResponseCache (const ResponseCache &)            = delete;
+			ResponseCache &operator= (const ResponseCache &) = delete;
+
+			/**
+			 * Middleware caching the responses of `route`, for `HttplibApp::use (route, ...)`.
+			 * The middleware shares the cache storage, so it may outlive this object.
+			 */
+			HAPP_API AppMiddleware middleware (const RouteInfo &route) const;
+
+			/**
+			 * Same middleware for the `middlewares` list of `HttplibApp::route` (`pattern` is the route pattern).
+			 */
+			HAPP_API AppMiddleware appMiddleware (std::string_view pattern) const;
+
+			/**
+			 * Drop the stored responses of one route pattern (every method, partition and parameter value).
+			 * @return The number of responses dropped.
+			 */
+			HAPP_API size_t invalidate (std::string_view pattern);
+
+			/**
+			 * Drop every stored response.
+			 */
+			HAPP_API void clear ();
+
+			HAPP_API size_t size () const;
+			HAPP_API ResponseCacheStats stats () const noexcept;
+
+		private:
+			class Impl;
+			std::shared_ptr<Impl> impl_;
+	};
+
+}    // namespace ipb::http
+
+#endif
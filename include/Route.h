@@ -8,18 +8,48 @@
 #ifndef _ROUTE_H_
 #	define _ROUTE_H_
 
+#	include <array>
+#	include <cstdint>
+#	include <filesystem>
 #	include <functional>
 #	include <map>
+#	include <memory_resource>
 #	include <optional>
+#	include <span>
 #	include <string>
 #	include <string_view>
+#	include <tuple>
+#	include <type_traits>
+#	include <variant>
 #	include <vector>
 #	include <memory>
 
 #	include "httplib_app_exportcfg.h"
+#	include "AsyncTask.h"
+#	include "RouteMetrics.h"
 
 namespace ipb::http
 {
+	// 16 raw bytes of a <param:uuid> or <param:base64id>
+	using Uuid = std::array<uint8_t, 16>;
+
+	// Value decoded while validating a typed parameter:
+	// int64_t (<param:int>), double (<param:float>), Uuid (<param:uuid>, <param:base64id>).
+	// std::monostate for string/generic parameters, and for ints that do not fit in 64 bits.
+	using ParamValue = std::variant<std::monostate, int64_t, double, Uuid>;
+
+	// Parameter types, in matching priority order (the first type that validates a segment wins)
+	enum class ParamType : uint8_t
+	{
+		INT      = 0,     // <param:int>
+		BASE64ID = 1,     // <param:base64id> (UUID encoded as Base64URL)
+		STRING   = 2,     // <param:string>
+		UUID     = 3,     // <param:uuid>
+		FLOAT    = 4,      // <param:float>
+		GENERIC  = 254,    // <param> typeless
+		PATH     = 255     // <param:path> tail capture: the rest of the path, '/' included (last segment only)
+	};
+
 	/**
 	 * @brief Interface for context objects passed to route handlers and middleware.
 	 */
@@ -27,6 +57,26 @@ namespace ipb::http
 	{
 		public:
 			virtual void setParam (std::string_view name, std::string_view value) = 0;
+
+			/**
+			 * Called by `Router::match` for every captured parameter, with the value decoded during validation.
+			 * Override it to keep the decoded value; the default forwards to `setParam`.
+			 */
+			virtual void setTypedParam (std::string_view name, std::string_view value,
+			                            [[maybe_unused]] const ParamValue &decoded)
+			{
+				setParam (name, value);
+			}
+
+			/**
+			 * Memory for allocations that live as long as the request (router captures, JWT decode
+			 * buffers, handler scratch data). Contexts backed by a RequestArena release it in one step
+			 * when the request ends; the default is the global default resource.
+			 */
+			virtual std::pmr::memory_resource &memory () noexcept
+			{
+				return *std::pmr::get_default_resource();
+			}
 	};
 
 	/**
@@ -39,10 +89,30 @@ namespace ipb::http
 			virtual void next ()        = 0;
 	};
 
+	/**
+	 * @brief "next" of a coroutine middleware: `co_await next()` runs the rest of the chain (which may suspend)
+	 * and resumes the middleware once it has completed. Calls after the first one do nothing.
+	 */
+	class IAsyncMiddlewareNext
+	{
+		public:
+			virtual ~IAsyncMiddlewareNext () = default;
+			virtual AsyncTask next ()        = 0;
+
+			AsyncTask operator() ()
+			{
+				return next();
+			}
+	};
+
 	// Forward declarations
 	using Middleware   = std::function<void (ICtx &, IMiddlewareNext &)>;
 	using RouteHandler = std::function<void (ICtx &)>;
 
+	// Coroutine variants (see Router::addAsync and Router::executeAsync)
+	using AsyncMiddleware   = std::function<AsyncTask (ICtx &, IAsyncMiddlewareNext &)>;
+	using AsyncRouteHandler = std::function<AsyncTask (ICtx &)>;
+
 	struct TypedParam;
 
 	// HTTP Method Enum
@@ -65,6 +135,77 @@ namespace ipb::http
 			HttpMethod method;                      // GET, POST, etc.
 			RouteHandler handler;                   // Route handler
 			std::vector<Middleware> middlewares;    // Route-specific middlewares
+			std::vector<Middleware> pipeline;       // Global + route middlewares, precomposed by Router::freeze
+			bool frozen = false;                    // True for the copies owned by a compiled route table
+			bool async  = false;                    // Compiled copies: the handler or a middleware is a coroutine
+			uint32_t id = 0;                        // Registration order: the route ID of a route table image
+#	if defined(HAPP_ROUTE_METRICS)
+			std::shared_ptr<RouteMetrics> metrics = nullptr;    // Shared with the compiled copies (survives freeze)
+#	endif
+	};
+
+	/**
+	 * @brief Compile-time middleware chain.
+	 * The middlewares are called directly (no std::function per step) and each step is a final class,
+	 * so the compiler can inline the whole chain; it is registered as a single Middleware.
+	 * Calling `next` more than once from a step is ignored.
+	 */
+	template <typename... MW>
+	class StaticMiddlewareChain
+	{
+		public:
+			StaticMiddlewareChain () = default;
+
+			explicit StaticMiddlewareChain (MW... middlewares)
+			    : middlewares_ (std::move (middlewares)...)
+			{
+			}
+
+			void operator() (ICtx &context, IMiddlewareNext &next) const
+			{
+				Step<0> first (*this, context, next);
+				first.next();
+			}
+
+		private:
+			template <size_t I>
+			class Step final : public IMiddlewareNext
+			{
+				public:
+					Step (const StaticMiddlewareChain &chain, ICtx &context, IMiddlewareNext &outer) noexcept
+					    : chain_ (chain)
+					    , context_ (context)
+					    , outer_ (outer)
+					{
+					}
+
+					void next () override
+					{
+						if (called_)
+						{
+							return;
+						}
+						called_ = true;
+
+						if constexpr (I == sizeof...(MW))
+						{
+							outer_.next();
+						}
+						else
+						{
+							Step<I + 1> downstream (chain_, context_, outer_);
+							std::get<I> (chain_.middlewares_) (context_, downstream);
+						}
+					}
+
+				private:
+					const StaticMiddlewareChain &chain_;
+					ICtx &context_;
+					IMiddlewareNext &outer_;
+					bool called_ = false;
+			};
+
+			std::tuple<MW...> middlewares_;
 	};
 
 	// ============================================================================
@@ -72,6 +213,8 @@ namespace ipb::http
 	// ============================================================================
 	class Router
 	{
+			class Impl;
+
 		public:
 			HAPP_API Router ();
 			HAPP_API ~Router();
@@ -84,9 +227,17 @@ namespace ipb::http
 
 			/**
 			 * Add new route
+			 * @throws std::invalid_argument If a `<name:path>` parameter is not the last segment of `pattern`
+			 * (the router is left unchanged; StaticRouteTable rejects the same patterns at compile time).
 			 */
 			HAPP_API RouteInfo &add (HttpMethod method, std::string_view pattern, RouteHandler handler);
 
+			/**
+			 * Add a new route served by a coroutine (same pattern rules as `add`).
+			 * `executeAsync` awaits it; `execute` runs it and blocks until it completes.
+			 */
+			HAPP_API RouteInfo &addAsync (HttpMethod method, std::string_view pattern, AsyncRouteHandler handler);
+
 			/**
 			 * Add a global middleware executed for all routes.
 			 */
@@ -98,7 +249,122 @@ namespace ipb::http
 			HAPP_API bool addMiddleware (RouteInfo &routeInfo, Middleware middleware);
 
 			/**
-			 * Match route and extract parameters
+			 * Add a global coroutine middleware (it keeps its place in the chain among the other middlewares).
+			 */
+			HAPP_API bool addAsyncMiddleware (AsyncMiddleware middleware);
+
+			/**
+			 * Add a coroutine middleware to an existing route.
+			 */
+			HAPP_API bool addAsyncMiddleware (RouteInfo &routeInfo, AsyncMiddleware middleware);
+
+			/**
+			 * Add a compile-time chain of default-constructible middleware types as one global middleware.
+			 */
+			template <typename... MW>
+			    requires (sizeof...(MW) > 0)
+			bool use ()
+			{
+				return addMiddleware (Middleware (StaticMiddlewareChain<MW...> {}));
+			}
+
+			/**
+			 * Add a compile-time chain of middleware objects (e.g. lambdas) as one global middleware.
+			 */
+			template <typename... MW>
+			    requires (sizeof...(MW) > 0 && (std::is_invocable_v<const MW &, ICtx &, IMiddlewareNext &> && ...))
+			bool use (MW... middlewares)
+			{
+				return addMiddleware (Middleware (StaticMiddlewareChain<MW...> (std::move (middlewares)...)));
+			}
+
+			/**
+			 * Add a compile-time chain of middleware objects as one middleware of an existing route.
+			 */
+			template <typename... MW>
+			    requires (sizeof...(MW) > 0 && (std::is_invocable_v<const MW &, ICtx &, IMiddlewareNext &> && ...))
+			bool use (RouteInfo &routeInfo, MW... middlewares)
+			{
+				return addMiddleware (routeInfo,
+				                      Middleware (StaticMiddlewareChain<MW...> (std::move (middlewares)...)));
+			}
+
+			/**
+			 * Compile the registered routes into a flat, read-only table used by `match`.
+			 * Routes added (or middlewares attached) afterwards are only visible after calling `freeze` again.
+			 * The table is published with an atomic swap: see `ReadGuard` to call it while serving.
+			 */
+			HAPP_API void freeze ();
+
+			/**
+			 * Compile the routes (and global middlewares) of `staged` and publish them as the table
+			 * served by this router. Readers keep serving the previous table until the swap, and the
+			 * previous table is destroyed once no `ReadGuard` can still reference it: the call waits for
+			 * that, unless the calling thread holds a `ReadGuard` of this router itself (e.g. a handler
+			 * reloading the routes): the previous table is then destroyed when that guard is released.
+			 * The same applies to `freeze`. `staged` is only read; it must not be modified while the call
+			 * is running.
+			 */
+			HAPP_API void publish (const Router &staged);
+
+			/**
+			 * Binary image of the compiled table (call `freeze` first; empty otherwise): nodes, edges,
+			 * interned segments and the pattern, method and ID of every route, without handlers or middlewares.
+			 * The image only fits builds of the library with the same table layout and byte order.
+			 */
+			HAPP_API std::string image () const;
+
+			/**
+			 * Write `image()` to a file (for `loadImage` on the next start).
+			 */
+			HAPP_API bool saveImage (const std::filesystem::path &file) const;
+
+			/**
+			 * Serve the routes of an image written by `saveImage` instead of registering them: the file is mapped
+			 * read-only and `match` reads the table in place, so startup does not grow with the route count.
+			 * `handlers [id]` serves the route with that ID (`RouteInfo::id`, the registration order of the router
+			 * that wrote the image); the global middlewares of this router run before them.
+			 * The image replaces the served table (`publish`); `freeze` keeps it, unless routes were added since.
+			 * @return False (nothing changes) if the file is missing, corrupt or from another table layout, or
+			 * if a route has no handler.
+			 */
+			HAPP_API bool loadImage (const std::filesystem::path &file, std::span<const RouteHandler> handlers);
+
+			/**
+			 * `loadImage` from an image held in memory (copied).
+			 */
+			HAPP_API bool loadImageBytes (std::string_view image, std::span<const RouteHandler> handlers);
+
+			/**
+			 * Read-side critical section, required around `match` + `execute` when `freeze` or
+			 * `publish` may run concurrently: the matched RouteInfo stays valid while the guard lives.
+			 * Entering never blocks (one atomic increment on a per-thread shard). Leaving does not either,
+			 * except on a thread that called `freeze` / `publish` inside the guard: the outermost guard of
+			 * that thread then waits for the other readers of the tables it replaced, and destroys them.
+			 */
+			class ReadGuard
+			{
+				public:
+					HAPP_API explicit ReadGuard (const Router &router) noexcept;
+					HAPP_API ~ReadGuard();
+
+					ReadGuard (const ReadGuard &)            = delete;
+					ReadGuard &operator= (const ReadGuard &) = delete;
+
+				private:
+					Impl *impl_;
+					uint32_t slot_;
+			};
+
+			/**
+			 * Check if `match` is served by a compiled table.
+			 */
+			HAPP_API bool isFrozen () const noexcept;
+
+			/**
+			 * Match route and extract parameters.
+			 * Performs no heap allocation: the path is tokenized in place and parameters are passed to
+			 * `ICtx::setParam` as views into `path` (any allocation is up to the context implementation).
 			 */
 			HAPP_API std::optional<std::reference_wrapper<const RouteInfo>>
 			    match (HttpMethod method, std::string_view path, ICtx &context) const;
@@ -108,15 +374,40 @@ namespace ipb::http
 			 */
 			HAPP_API static HttpMethod fromMethodString (std::string_view method);
 
+			/**
+			 * Convert HTTP method string to enum (std::nullopt for any other text)
+			 */
+			HAPP_API static std::optional<HttpMethod> parseMethod (std::string_view method);
+
+			/**
+			 * Validate a parameter segment as `match` does, decoding it in the same pass.
+			 */
+			HAPP_API static bool validateParam (ParamType type, std::string_view value, ParamValue &decoded);
+
 			/**
 			 * Execute route middleware chain and final handler.
 			 * Middleware controls flow by calling (or not calling) `next`.
 			 */
 			HAPP_API void execute (const RouteInfo &routeInfo, ICtx &context) const;
 
+			/**
+			 * Execute the route as a coroutine: coroutine middlewares and handlers can suspend (`co_await`)
+			 * without holding the thread, keeping the before/after order of the chain.
+			 * A synchronous middleware cannot suspend, so it holds the thread (`AsyncTask::wait`) while the
+			 * rest of the chain after it is suspended: register coroutine middlewares to avoid it.
+			 * The task is lazy; `routeInfo` and `context` (and the ReadGuard, if any) must outlive it.
+			 */
+			HAPP_API AsyncTask executeAsync (const RouteInfo &routeInfo, ICtx &context) const;
+
+			/**
+			 * Counters of the served routes (the compiled table once frozen), sorted by pattern and method.
+			 * Safe to call while serving; empty unless the library is built with HAPP_ROUTE_METRICS.
+			 * See `toOpenMetrics` for the text export.
+			 */
+			HAPP_API std::vector<RouteMetricsSnapshot> metrics () const;
+
 		private:
 			// The data is contained in a PIMPL (Pointer to Implementation)
-			class Impl;
 			std::unique_ptr<Impl> impl_;
 	};
 
@@ -0,0 +1,85 @@
+﻿/*********************************************************************************************
+ *  Description : Per-route counters and latency histogram, exported as OpenMetrics text
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _ROUTE_METRICS_H_
+#	define _ROUTE_METRICS_H_
+
+#	include <array>
+#	include <atomic>
+#	include <cstddef>
+#	include <cstdint>
+#	include <span>
+#	include <string>
+
+#	include "httplib_app_exportcfg.h"
+
+namespace ipb::http
+{
+	// Upper bounds (inclusive, nanoseconds) of the latency histogram; one more bucket counts the rest (+Inf)
+	inline constexpr std::array<uint64_t, 15> kRouteLatencyBounds = {
+	    10'000,     25'000,     50'000,      100'000,     250'000,     500'000,       1'000'000,    2'500'000,
+	    5'000'000, 10'000'000, 25'000'000, 50'000'000, 100'000'000, 250'000'000, 1'000'000'000};
+
+	/**
+	 * @brief Counters of one route, summed over the threads (see Router::metrics).
+	 */
+	struct RouteMetricsSnapshot
+	{
+			std::string pattern;
+			std::string method;
+			uint64_t matches       = 0;    // Router::match hits
+			uint64_t invocations   = 0;    // Router::execute calls that reached the handler
+			uint64_t shortCircuits = 0;    // Router::execute calls stopped by a middleware
+			uint64_t matchNanoseconds   = 0;    // Time spent in Router::match for the hits
+			uint64_t latencyNanoseconds = 0;    // Time spent in Router::execute (sum of the histogram)
+			std::array<uint64_t, kRouteLatencyBounds.size() + 1> latencyBuckets {};    // Not cumulative
+	};
+
+	/**
+	 * Format `routes` as OpenMetrics text (also accepted by Prometheus), "# EOF" included.
+	 */
+	HAPP_API std::string toOpenMetrics (std::span<const RouteMetricsSnapshot> routes);
+
+#	if defined(HAPP_ROUTE_METRICS)
+	/**
+	 * @brief Live counters of a route, shared by the registered RouteInfo and its compiled copies.
+	 * Every thread writes to its own shard (relaxed atomics, one cache line block per shard), so
+	 * recording never contends; `collect` adds the shards up without stopping the writers.
+	 */
+	class RouteMetrics
+	{
+		public:
+			HAPP_API void recordMatch (uint64_t nanoseconds) noexcept;
+			HAPP_API void recordExecution (bool handlerCalled, uint64_t nanoseconds) noexcept;
+
+			/**
+			 * Add the current counters to `out` (the names are left untouched).
+			 */
+			HAPP_API void collect (RouteMetricsSnapshot &out) const noexcept;
+
+		private:
+			static constexpr size_t kShards = 8;
+
+			struct alignas (64) Shard
+			{
+					std::atomic<uint64_t> matches {0};
+					std::atomic<uint64_t> invocations {0};
+					std::atomic<uint64_t> shortCircuits {0};
+					std::atomic<uint64_t> matchNanoseconds {0};
+					std::atomic<uint64_t> latencyNanoseconds {0};
+					std::array<std::atomic<uint64_t>, kRouteLatencyBounds.size() + 1> latencyBuckets {};
+			};
+
+			Shard &shard () noexcept;
+
+			std::array<Shard, kShards> shards_ {};
+	};
+#	endif
+
+}    // namespace ipb::http
+
+#endif
@@ -0,0 +1,112 @@
+﻿/*********************************************************************************************
+ *  Description : RouterPartitions - One Router per Host (virtual host) or API version prefix
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _ROUTER_PARTITIONS_H_
+#	define _ROUTER_PARTITIONS_H_
+
+#	include <cstddef>
+#	include <cstdint>
+#	include <memory>
+#	include <string>
+#	include <string_view>
+#	include <unordered_map>
+
+#	include "httplib_app_exportcfg.h"
+#	include "Route.h"
+
+namespace ipb::http
+{
+	// What selects the partition of a request
+	enum class PartitionKey : uint8_t
+	{
+		HOST        = 0,    // The Host header: case-insensitive, without the port ("API.example.com:8443")
+		PATH_PREFIX = 1     // The first path segment ("v2" of "/v2/users"), case-sensitive
+	};
+
+	/**
+	 * @brief Top-level dispatch over independent routers, one per partition (tenant host or API version).
+	 * `select` picks the router of a request with a single hash lookup (no allocation), and then the
+	 * request goes through the usual `Router` calls (`ReadGuard`, `match`, `execute`) of that router.
+	 * Each partition has its own compiled table and its own global middlewares, so the tables stay
+	 * small, and `publish` on one partition reloads it without touching the others.
+	 * The path is not rewritten: with PATH_PREFIX the patterns of a partition keep their prefix
+	 * ("/v2/users/<id:int>"), so route keys (metrics, response cache) stay distinct across versions.
+	 * Partitions are created while setting up; `select` is safe to call concurrently as long as no
+	 * partition is added.
+	 */
+	class RouterPartitions
+	{
+		public:
+			HAPP_API explicit RouterPartitions (PartitionKey key = PartitionKey::HOST);
+			HAPP_API ~RouterPartitions();
+
+			RouterPartitions (const RouterPartitions &)            = delete;
+			RouterPartitions &operator= (const RouterPartitions &) = delete;
+
+			PartitionKey key () const noexcept
+			{
+				return key_;
+			}
+
+			/**
+			 * Router of a partition, created empty on first use.
+			 * `name` is normalized as the requests are (HOST: lowercase, port dropped; PATH_PREFIX: first
+			 * segment, so "/v2" and "v2" name the same partition).
+			 */
+			HAPP_API Router &partition (std::string_view name);
+
+			/**
+			 * Router of a partition (`name` normalized as by `partition`), or nullptr if it does not exist.
+			 */
+			HAPP_API const Router *find (std::string_view name) const noexcept;
+
+			/**
+			 * Router serving a request: the partition named by its Host header (`host`) or by the first
+			 * segment of `path`, depending on `key`. Returns nullptr if there is no such partition.
+			 */
+			HAPP_API const Router *select (std::string_view host, std::string_view path) const noexcept;
+
+			/**
+			 * Freeze every partition (see `Router::freeze`).
+			 */
+			HAPP_API void freeze ();
+
+			size_t size () const noexcept
+			{
+				return routers_.size();
+			}
+
+			bool empty () const noexcept
+			{
+				return routers_.empty();
+			}
+
+			/**
+			 * Partition name of a request, as a view into `host` or `path` (before case folding).
+			 */
+			HAPP_API static std::string_view keyOf (PartitionKey key, std::string_view host, std::string_view path) noexcept;
+
+		private:
+			struct NameHash
+			{
+					using is_transparent = void;
+
+					size_t operator() (std::string_view name) const noexcept
+					{
+						return std::hash<std::string_view> {}(name);
+					}
+			};
+
+			const Router *lookup (std::string_view name) const noexcept;
+
+			PartitionKey key_;
+			std::unordered_map<std::string, std::unique_ptr<Router>, NameHash, std::equal_to<>> routers_;
+	};
+
+}    // namespace ipb::http
+
+#endif
@@ -0,0 +1,43 @@
+﻿/*********************************************************************************************
+ *  Description : Static file handler - files served from read-only memory mappings
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _STATIC_FILES_H_
+#	define _STATIC_FILES_H_
+
+#	include <functional>
+#	include <string>
+
+#	include "httplib_app_exportcfg.h"
+#	include "Ctx.h"
+
+namespace ipb::http
+{
+	/**
+	 * @brief Settings of `staticFiles` / `HttplibApp::serveStatic`.
+	 */
+	struct StaticFilesConfig
+	{
+			std::string index_file = "index.html";    // Served for directory paths (empty: directories are not served)
+			std::string cache_control;                 // Cache-Control header of every file (empty: not set)
+	};
+
+	/**
+	 * @brief Handler serving the files under `root`, for routes ending with a path parameter
+	 * (`/static/<path:path>`): the parameter `param` is the file path, relative to `root`.
+	 * The file is mapped into memory and the response streams from the mapping, so its bytes are never copied
+	 * into a body string (cpp-httplib owns the socket, so this is the zero-copy path it allows; Range requests
+	 * are answered by cpp-httplib from the same mapping). Responses carry a weak ETag from the size and
+	 * modification time, and an If-None-Match that matches it ("*" or a list, compared weakly) gets 304.
+	 * Paths with empty, "." or ".." segments, backslashes, ':' or NUL never reach the file system; they get
+	 * 404, like missing files.
+	 */
+	HAPP_API std::function<void (Ctx &)> staticFiles (std::string root, std::string param = "path",
+	                                                  StaticFilesConfig config = {});
+
+}    // namespace ipb::http
+
+#endif
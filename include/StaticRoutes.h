@@ -0,0 +1,472 @@
+﻿/*********************************************************************************************
+ *  Description : Compile-time route table - patterns parsed by consteval code, no runtime trie
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _STATIC_ROUTES_H_
+#	define _STATIC_ROUTES_H_
+
+#	include <algorithm>
+#	include <array>
+#	include <bit>
+#	include <cstddef>
+#	include <cstdint>
+#	include <optional>
+#	include <string_view>
+#	include <tuple>
+#	include <type_traits>
+#	include <utility>
+
+#	include "Route.h"
+
+namespace ipb::http
+{
+	/**
+	 * @brief String literal usable as a template argument: `route<"/users/<id:int>">(...)`.
+	 */
+	template <size_t N>
+	struct FixedString
+	{
+			char value [N] {};
+
+			consteval FixedString (const char (&text) [N])
+			{
+				std::copy_n (text, N, value);
+			}
+
+			constexpr std::string_view view () const noexcept
+			{
+				return std::string_view (value, N - 1);
+			}
+	};
+
+	// One segment of a compile-time pattern: `text` is the literal, or the parameter name
+	struct PatternSegment
+	{
+			bool param     = false;
+			ParamType type = ParamType::GENERIC;
+			std::string_view text;
+	};
+
+	// Not constexpr: reaching it while a pattern is parsed stops the build (the reason shows in the diagnostic)
+	inline void invalidRoutePattern (const char *) {}
+
+	/**
+	 * @brief consteval parsing of route patterns, with the rules of `Router::add`: leading and trailing
+	 * slashes are ignored, parameters are `<name>` or `<name:type>`.
+	 * Empty segments, empty parameter names, unknown types and stray '<' / '>' do not compile.
+	 */
+	struct RoutePatternParser
+	{
+			static consteval std::string_view trim (std::string_view path)
+			{
+				if (path.ends_with ('/') && path.size() > 1)
+				{
+					path.remove_suffix (1);
+				}
+				if (path.starts_with ('/'))
+				{
+					path.remove_prefix (1);
+				}
+				return path;
+			}
+
+			// Index-based: char_traits::find is not a constant expression under some sanitizer builds
+			static consteval size_t find (std::string_view text, char c)
+			{
+				for (size_t i = 0; i < text.size(); ++i)
+				{
+					if (text [i] == c)
+					{
+						return i;
+					}
+				}
+				return std::string_view::npos;
+			}
+
+			static consteval bool hasAngleBracket (std::string_view text)
+			{
+				return find (text, '<') != std::string_view::npos || find (text, '>') != std::string_view::npos;
+			}
+
+			static consteval size_t countSegments (std::string_view path)
+			{
+				return path.empty() ? 0 : static_cast<size_t> (std::count (path.begin(), path.end(), '/')) + 1;
+			}
+
+			static consteval ParamType parseType (std::string_view type)
+			{
+				if (type == "int")
+				{
+					return ParamType::INT;
+				}
+				if (type == "base64id")
+				{
+					return ParamType::BASE64ID;
+				}
+				if (type == "string")
+				{
+					return ParamType::STRING;
+				}
+				if (type == "uuid")
+				{
+					return ParamType::UUID;
+				}
+				if (type == "float")
+				{
+					return ParamType::FLOAT;
+				}
+				if (type == "path")
+				{
+					return ParamType::PATH;
+				}
+				invalidRoutePattern ("unknown parameter type");
+				return ParamType::GENERIC;
+			}
+
+			static consteval PatternSegment parseSegment (std::string_view segment)
+			{
+				if (segment.empty())
+				{
+					invalidRoutePattern ("empty path segment");
+				}
+
+				if (!segment.starts_with ('<') || !segment.ends_with ('>'))
+				{
+					if (hasAngleBracket (segment))
+					{
+						invalidRoutePattern ("'<' or '>' inside a literal segment");
+					}
+					return PatternSegment {.param = false, .type = ParamType::GENERIC, .text = segment};
+				}
+
+				const std::string_view inner = segment.substr (1, segment.size() - 2);
+				const size_t colon           = find (inner, ':');
+				const std::string_view name  = inner.substr (0, colon);
+				if (name.empty() || hasAngleBracket (name))
+				{
+					invalidRoutePattern ("invalid parameter name");
+				}
+
+				const ParamType type = colon == std::string_view::npos ? ParamType::GENERIC : parseType (inner.substr (colon + 1));
+				return PatternSegment {.param = true, .type = type, .text = name};
+			}
+
+			template <size_t Size>
+			static consteval std::array<PatternSegment, Size> parse (std::string_view pattern)
+			{
+				std::array<PatternSegment, Size> segments {};
+				std::string_view rest = trim (pattern);
+				for (size_t i = 0; i < Size; ++i)
+				{
+					const size_t end = find (rest, '/');
+					segments [i]     = parseSegment (rest.substr (0, end));
+					rest             = end == std::string_view::npos ? std::string_view {} : rest.substr (end + 1);
+					if (segments [i].type == ParamType::PATH && i + 1 != Size)
+					{
+						invalidRoutePattern ("a path parameter must be the last segment");
+					}
+				}
+				return segments;
+			}
+
+			// `segments` followed by empty entries, up to Size
+			template <size_t Size, size_t N>
+			static consteval std::array<PatternSegment, Size> pad (const std::array<PatternSegment, N> &segments)
+			{
+				std::array<PatternSegment, Size> row {};
+				std::copy (segments.begin(), segments.end(), row.begin());
+				return row;
+			}
+	};
+
+	/**
+	 * @brief Route pattern parsed at compile time (see RoutePatternParser).
+	 */
+	template <FixedString Pattern>
+	struct RoutePattern
+	{
+			static constexpr std::string_view text = Pattern.view();
+			static constexpr size_t size           = RoutePatternParser::countSegments (RoutePatternParser::trim (text));
+			static constexpr std::array<PatternSegment, size> segments = RoutePatternParser::parse<size> (text);
+	};
+
+	/**
+	 * @brief Route of a StaticRouteTable (see `route`).
+	 */
+	template <FixedString Pattern, typename Handler>
+	struct StaticRoute
+	{
+			using pattern_type = RoutePattern<Pattern>;
+
+			HttpMethod method;
+			Handler handler;
+	};
+
+	/**
+	 * Declare a compile-time route: `route<"/users/<id:int>">(HttpMethod::GET, handler)`.
+	 */
+	template <FixedString Pattern, typename Handler>
+	    requires std::is_invocable_v<const Handler &, ICtx &>
+	constexpr StaticRoute<Pattern, Handler> route (HttpMethod method, Handler handler)
+	{
+		return StaticRoute<Pattern, Handler> {.method = method, .handler = std::move (handler)};
+	}
+
+	/**
+	 * Declare a compile-time route for any method.
+	 */
+	template <FixedString Pattern, typename Handler>
+	    requires std::is_invocable_v<const Handler &, ICtx &>
+	constexpr StaticRoute<Pattern, Handler> route (Handler handler)
+	{
+		return StaticRoute<Pattern, Handler> {.method = HttpMethod::ANY, .handler = std::move (handler)};
+	}
+
+	/**
+	 * @brief Route table built at compile time: `StaticRouteTable table {route<"/a">(...), route<"/b/<id>">(...)};`
+	 * The per-segment decisions (literal texts and parameter types of every route) are constexpr tables, and
+	 * matching narrows a bit set of candidate routes segment by segment, with the priorities of `Router::match`
+	 * (literal, then typed parameters in ParamType order, then generic, then path; specific method, then ANY).
+	 * Handlers are called directly (no std::function); matching neither allocates nor needs any setup.
+	 * Parameters are passed to `ICtx::setTypedParam` only once a route has matched.
+	 */
+	template <typename... Routes>
+	    requires (sizeof...(Routes) > 0 && sizeof...(Routes) <= 64)
+	class StaticRouteTable
+	{
+			using Mask = uint64_t;
+
+			static constexpr size_t kRoutes      = sizeof...(Routes);
+			static constexpr size_t kMaxSegments = std::max ({Routes::pattern_type::size...});
+			static constexpr Mask kAllRoutes     = kRoutes == 64 ? ~Mask {0} : (Mask {1} << kRoutes) - 1;
+
+			// Parameter types in matching priority order (column of Masks::param)
+			static constexpr std::array<ParamType, 7> kParamOrder = {ParamType::INT,     ParamType::BASE64ID,
+			                                                         ParamType::STRING,  ParamType::UUID,
+			                                                         ParamType::FLOAT,   ParamType::GENERIC,
+			                                                         ParamType::PATH};
+
+			static constexpr size_t kPathColumn = kParamOrder.size() - 1;
+
+			using SegmentRow = std::array<PatternSegment, kMaxSegments>;
+
+			// kSegments[route][i]: segment i of each route (valid below kLengths[route])
+			static constexpr std::array<SegmentRow, kRoutes> kSegments = {
+			    RoutePatternParser::pad<kMaxSegments> (Routes::pattern_type::segments)...};
+			static constexpr std::array<size_t, kRoutes> kLengths      = {Routes::pattern_type::size...};
+			static constexpr std::array<std::string_view, kRoutes> kPatterns = {Routes::pattern_type::text...};
+
+			struct Masks
+			{
+					std::array<Mask, kMaxSegments + 1> length {};                        // Exactly n segments
+					std::array<Mask, kMaxSegments> literal {};                           // Literal at segment i
+					std::array<std::array<Mask, kParamOrder.size()>, kMaxSegments> param {};    // Type t at segment i
+			};
+
+			static constexpr Masks kMasks = []
+			{
+				Masks masks {};
+				for (size_t route = 0; route < kRoutes; ++route)
+				{
+					const Mask bit = Mask {1} << route;
+					masks.length [kLengths [route]] |= bit;
+					for (size_t i = 0; i < kLengths [route]; ++i)
+					{
+						const PatternSegment &segment = kSegments [route][i];
+						if (!segment.param)
+						{
+							masks.literal [i] |= bit;
+							continue;
+						}
+						for (size_t t = 0; t < kParamOrder.size(); ++t)
+						{
+							if (kParamOrder [t] == segment.type)
+							{
+								masks.param [i][t] |= bit;
+							}
+						}
+					}
+				}
+				return masks;
+			}();
+
+		public:
+			constexpr explicit StaticRouteTable (Routes... routes)
+			    : methods_ {routes.method...}
+			    , routes_ (std::move (routes)...)
+			{
+			}
+
+			static constexpr size_t size () noexcept
+			{
+				return kRoutes;
+			}
+
+			static constexpr std::string_view pattern (size_t route) noexcept
+			{
+				return kPatterns [route];
+			}
+
+			/**
+			 * Index of the route matching `method` and `path`, whose parameters are passed to `context`.
+			 */
+			std::optional<size_t> match (HttpMethod method, std::string_view path, ICtx &context) const
+			{
+				std::array<std::string_view, kMaxSegments> values {};
+				std::array<ParamValue, kMaxSegments> decoded {};
+
+				// Same normalization as Router::match
+				if (path.ends_with ('/') && path.size() > 1)
+				{
+					path.remove_suffix (1);
+				}
+				if (path.starts_with ('/'))
+				{
+					path.remove_prefix (1);
+				}
+
+				Mask candidates = kAllRoutes;
+				size_t count    = 0;
+				bool done       = path.empty();
+				while (!done)
+				{
+					if (count == kMaxSegments)
+					{
+						return std::nullopt;
+					}
+
+					const size_t end            = path.find ('/');
+					const std::string_view tail = path;
+					std::string_view value      = path.substr (0, end);
+					done                        = end == std::string_view::npos;
+					path.remove_prefix (done ? path.size() : end + 1);
+
+					candidates = narrow (candidates, count, value, decoded [count]);
+					if (candidates == 0)
+					{
+						return std::nullopt;
+					}
+					if ((candidates & kMasks.param [count][kPathColumn]) != 0)
+					{
+						// Tail capture: the rest of the path is the value, and the walk ends here
+						value = tail;
+						done  = true;
+					}
+					values [count++] = value;
+				}
+
+				candidates &= kMasks.length [count];
+				const std::optional<size_t> route = selectMethod (candidates, method);
+				if (!route.has_value())
+				{
+					return std::nullopt;
+				}
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					const PatternSegment &segment = kSegments [*route][i];
+					if (segment.param)
+					{
+						context.setTypedParam (segment.text, values [i], decoded [i]);
+					}
+				}
+				return route;
+			}
+
+			/**
+			 * Run the handler of route `route` (an index returned by `match`).
+			 */
+			void execute (size_t route, ICtx &context) const
+			{
+				executeAt (route, context, std::index_sequence_for<Routes...> {});
+			}
+
+			/**
+			 * Match and execute; false if no route matched.
+			 */
+			bool dispatch (HttpMethod method, std::string_view path, ICtx &context) const
+			{
+				if (const std::optional<size_t> route = match (method, path, context))
+				{
+					execute (*route, context);
+					return true;
+				}
+				return false;
+			}
+
+		private:
+			// Candidates that accept `value` as segment `index`: literals first, then the first parameter type
+			// (in priority order) that validates it
+			static Mask narrow (Mask candidates, size_t index, std::string_view value, ParamValue &decoded)
+			{
+				Mask literals = 0;
+				for (Mask pending = candidates & kMasks.literal [index]; pending != 0; pending &= pending - 1)
+				{
+					const size_t route = static_cast<size_t> (std::countr_zero (pending));
+					if (kSegments [route][index].text == value)
+					{
+						literals |= Mask {1} << route;
+					}
+				}
+				if (literals != 0)
+				{
+					return literals;
+				}
+
+				for (size_t t = 0; t < kParamOrder.size(); ++t)
+				{
+					const Mask typed = candidates & kMasks.param [index][t];
+					if (typed == 0)
+					{
+						continue;
+					}
+					decoded = std::monostate {};
+					if (Router::validateParam (kParamOrder [t], value, decoded))
+					{
+						return typed;
+					}
+				}
+				return 0;
+			}
+
+			// First candidate registered for `method`, else the first one for ANY
+			std::optional<size_t> selectMethod (Mask candidates, HttpMethod method) const noexcept
+			{
+				// Only the bits of registered routes are scanned, so the index is visibly below kRoutes
+				std::optional<size_t> any;
+				for (candidates &= kAllRoutes; candidates != 0; candidates &= candidates - 1)
+				{
+					const size_t route = static_cast<size_t> (std::countr_zero (candidates));
+					if (route >= kRoutes)
+					{
+						break;
+					}
+					if (methods_ [route] == method)
+					{
+						return route;
+					}
+					if (methods_ [route] == HttpMethod::ANY && !any.has_value())
+					{
+						any = route;
+					}
+				}
+				return any;
+			}
+
+			template <size_t... I>
+			void executeAt (size_t route, ICtx &context, std::index_sequence<I...>) const
+			{
+				static_cast<void> (
+				    ((I == route ? (static_cast<void> (std::get<I> (routes_).handler (context)), true) : false) || ...));
+			}
+
+			std::array<HttpMethod, kRoutes> methods_;
+			std::tuple<Routes...> routes_;
+	};
+
+}    // namespace ipb::http
+
+#endif
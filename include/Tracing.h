@@ -0,0 +1,129 @@
+﻿/*********************************************************************************************
+ *  Description : Request tracing - sampled stage spans (router, middlewares, handler, JWT) per thread
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _TRACING_H_
+#	define _TRACING_H_
+
+#	include <array>
+#	include <cstddef>
+#	include <cstdint>
+#	include <span>
+#	include <string>
+#	include <string_view>
+#	include <vector>
+
+#	include "httplib_app_exportcfg.h"
+
+namespace ipb::http
+{
+	// Stage timed by a span
+	enum class TraceStage : uint8_t
+	{
+		Request      = 0,    // The whole request (RequestTrace)
+		Match        = 1,    // Router::match (detail: the matched pattern)
+		Middleware   = 2,    // One middleware and everything after it (index: position in the chain)
+		Handler      = 3,    // The route handler
+		JwtDecode    = 4,    // Base64URL decoding of the token segments
+		JwtParse     = 5,    // JSON parsing of the header and the claims
+		JwtSignature = 6     // Signature check by the crypto provider
+	};
+
+	// Spans kept per thread; the oldest ones are overwritten when a ring is full
+	inline constexpr size_t kTraceRingCapacity = 4096;
+
+	/**
+	 * @brief One timed stage of a sampled request.
+	 * Times are steady clock nanoseconds; the exporters convert them to wall clock time.
+	 */
+	struct TraceSpan
+	{
+			uint64_t traceId          = 0;    // Shared by every span of the request
+			uint64_t spanId           = 0;
+			uint64_t parentId         = 0;    // 0 for the request span
+			uint64_t startNanoseconds = 0;
+			uint64_t endNanoseconds   = 0;
+			uint32_t thread           = 0;    // Index of the recording thread
+			TraceStage stage          = TraceStage::Request;
+			uint16_t index            = 0;
+			uint8_t detailSize        = 0;
+			std::array<char, 40> detail {};    // Truncated copy (the route pattern of Match spans)
+
+			std::string_view detailView () const noexcept
+			{
+				return std::string_view (detail.data(), detailSize);
+			}
+	};
+
+	/**
+	 * Sample one request in `oneIn` (0: off, the default; 1: every request). Threads pick the rate up at
+	 * their next sampling decision (the calling thread right away; others within 1024 requests when
+	 * tracing was off). Nothing is recorded unless the library is built with HAPP_TRACING.
+	 */
+	HAPP_API void setTraceSampleRate (uint32_t oneIn) noexcept;
+	HAPP_API uint32_t traceSampleRate () noexcept;
+
+	/**
+	 * Move the recorded spans out of the per-thread rings (oldest first within each thread).
+	 * Safe to call while serving; spans of requests still running are collected by the next call.
+	 */
+	HAPP_API std::vector<TraceSpan> drainTraceSpans ();
+
+	/**
+	 * Format spans as Chrome trace JSON (chrome://tracing, Perfetto): one complete ("X") event per span.
+	 */
+	HAPP_API std::string toChromeTrace (std::span<const TraceSpan> spans);
+
+	/**
+	 * Format spans as an OpenTelemetry OTLP/JSON export request (body of POST /v1/traces).
+	 */
+	HAPP_API std::string toOtlpJson (std::span<const TraceSpan> spans, std::string_view serviceName = "httplibapp");
+
+	/**
+	 * Span name of a stage ("middleware[2]" with the index of middleware spans).
+	 */
+	HAPP_API std::string traceSpanName (const TraceSpan &span);
+
+	/**
+	 * @brief Request span: opened around match + execute (HttplibApp::dispatch does it) and the sampling point.
+	 * On a sampled request the stages run on this thread until it closes are recorded as its children;
+	 * on the others every stage costs one predicted branch. Nested inside a sampled request, it is a child
+	 * span of it. Coroutine routes (Router::executeAsync) are not traced past their first suspension.
+	 */
+	class RequestTrace
+	{
+		public:
+#	if defined(HAPP_TRACING)
+			HAPP_API RequestTrace () noexcept;
+			HAPP_API ~RequestTrace();
+#	else
+			RequestTrace () noexcept = default;
+#	endif
+
+			RequestTrace (const RequestTrace &)            = delete;
+			RequestTrace &operator= (const RequestTrace &) = delete;
+
+#	if defined(HAPP_TRACING)
+			bool sampled () const noexcept
+			{
+				return spanId_ != 0;
+			}
+
+		private:
+			uint64_t spanId_   = 0;
+			uint64_t parentId_ = 0;
+			uint64_t start_    = 0;
+#	else
+			bool sampled () const noexcept
+			{
+				return false;
+			}
+#	endif
+	};
+
+}    // namespace ipb::http
+
+#endif
@@ -8,8 +8,14 @@
 #ifndef _HAPP_CFG_H_
 #	define _HAPP_CFG_H_
 
-// If the solution is a dinamic library (dll), we need the next macro
-#	define HAPP_DLL
+// If the solution is a dinamic library (dll), we need the next macro (static builds define HAPP_STATIC instead)
+#	if !defined(HAPP_STATIC) && !defined(HAPP_DLL)
+#		define HAPP_DLL
+#	endif
+
+// Per-route hit counters and latency histograms (see RouteMetrics.h). It changes RouteInfo, so the
+// library and its users must agree on it: uncomment it here, or define it in every project.
+// #define HAPP_ROUTE_METRICS
 
 // IMPORTANT: the project who exports must have the preprocessor macro STREAMLOGGER_EXPORTS
 
@@ -0,0 +1,328 @@
+/*********************************************************************************************
+ *  Description : Base64URL codec implementation (AVX2 / NEON blocks, table-driven scalar tail)
+ *  License     : The unlicense (https://unlicense.org)
+ *  Copyright    (C) 2026  Ignacio Pomar Ballestero
+ *********************************************************************************************/
+
+#include "Base64Url.h"
+#include "Simd.h"
+
+#include <array>
+
+namespace ipb::http::base64url
+{
+	namespace
+	{
+		constexpr char kAlphabet [] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+		constexpr uint8_t kInvalid = 0xFF;
+
+		// Character -> 6-bit value (kInvalid outside the alphabet)
+		constexpr std::array<uint8_t, 256> kDecodeTable = []
+		{
+			std::array<uint8_t, 256> table {};
+			table.fill (kInvalid);
+			for (uint8_t i = 0; i < 64; ++i)
+			{
+				table [static_cast<unsigned char> (kAlphabet [i])] = i;
+			}
+			return table;
+		}();
+
+		// ------------------------------------------------------------------------
+		// Scalar (tails, and everything without a vector kernel)
+		// ------------------------------------------------------------------------
+
+		static size_t encodeScalar (const uint8_t *in, size_t size, char *out) noexcept
+		{
+			char *o  = out;
+			size_t i = 0;
+			for (; i + 3 <= size; i += 3, o += 4)
+			{
+				const uint32_t block = (uint32_t (in [i]) << 16) | (uint32_t (in [i + 1]) << 8) | in [i + 2];
+				o [0]                = kAlphabet [(block >> 18) & 0x3F];
+				o [1]                = kAlphabet [(block >> 12) & 0x3F];
+				o [2]                = kAlphabet [(block >> 6) & 0x3F];
+				o [3]                = kAlphabet [block & 0x3F];
+			}
+
+			if (size - i == 1)
+			{
+				*o++ = kAlphabet [in [i] >> 2];
+				*o++ = kAlphabet [(in [i] & 0x03) << 4];
+			}
+			else if (size - i == 2)
+			{
+				*o++ = kAlphabet [in [i] >> 2];
+				*o++ = kAlphabet [((in [i] & 0x03) << 4) | (in [i + 1] >> 4)];
+				*o++ = kAlphabet [(in [i + 1] & 0x0F) << 2];
+			}
+			return static_cast<size_t> (o - out);
+		}
+
+		static inline uint8_t value (char c) noexcept
+		{
+			return kDecodeTable [static_cast<unsigned char> (c)];
+		}
+
+		// `size` is not 4n+1 and `out` holds decodedSize(size) bytes
+		static bool decodeScalar (const char *in, size_t size, uint8_t *out) noexcept
+		{
+			uint8_t invalid = 0;    // kInvalid has the high bit set: one test at the end
+			size_t i        = 0;
+			for (; i + 4 <= size; i += 4, out += 3)
+			{
+				const uint8_t a = value (in [i]), b = value (in [i + 1]), c = value (in [i + 2]), d = value (in [i + 3]);
+				invalid |= a | b | c | d;
+				const uint32_t block = (uint32_t (a) << 18) | (uint32_t (b) << 12) | (uint32_t (c) << 6) | d;
+				out [0]              = static_cast<uint8_t> (block >> 16);
+				out [1]              = static_cast<uint8_t> (block >> 8);
+				out [2]              = static_cast<uint8_t> (block);
+			}
+
+			if (size - i == 2)
+			{
+				const uint8_t a = value (in [i]), b = value (in [i + 1]);
+				invalid |= a | b;
+				invalid |= (b & 0x0F) != 0 ? 0x80 : 0;    // Unused bits must be zero
+				out [0] = static_cast<uint8_t> ((a << 2) | (b >> 4));
+			}
+			else if (size - i == 3)
+			{
+				const uint8_t a = value (in [i]), b = value (in [i + 1]), c = value (in [i + 2]);
+				invalid |= a | b | c;
+				invalid |= (c & 0x03) != 0 ? 0x80 : 0;
+				out [0] = static_cast<uint8_t> ((a << 2) | (b >> 4));
+				out [1] = static_cast<uint8_t> ((b << 4) | (c >> 2));
+			}
+			return (invalid & 0x80) == 0;
+		}
+
+#if defined(HAPP_SIMD_AVX2)
+
+		// Encode and decode in the style of W. Mula / A. Klomp: 24 bytes <-> 32 characters per step
+
+		// 24 input bytes (loaded as 32) -> one 6-bit index per output byte
+		static inline __m256i encodeReshuffle (__m256i input) noexcept
+		{
+			// Lane 0 takes bytes 0..11 at offset 4, lane 1 bytes 12..23 at offset 0
+			input = _mm256_permutevar8x32_epi32 (input, _mm256_setr_epi32 (0, 0, 1, 2, 3, 4, 5, 6));
+			const __m256i in = _mm256_shuffle_epi8 (input, _mm256_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+			                                                                14, 15, 13, 14, 11, 12, 10, 11, 8, 9, 7, 8, 5, 6, 4, 5));
+			const __m256i t0 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x0FC0FC00));
+			const __m256i t1 = _mm256_mulhi_epu16 (t0, _mm256_set1_epi32 (0x04000040));
+			const __m256i t2 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x003F03F0));
+			const __m256i t3 = _mm256_mullo_epi16 (t2, _mm256_set1_epi32 (0x01000010));
+			return _mm256_or_si256 (t1, t3);
+		}
+
+		// 6-bit indices -> characters: index + offset of its range (A-Z, a-z, 0-9, '-', '_')
+		static inline __m256i encodeTranslate (__m256i indices) noexcept
+		{
+			const __m256i offsets = _mm256_setr_epi8 (65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0,
+			                                          65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0);
+			// 0..25 -> 0, 26..51 -> 1, 52..61 -> 2..11, 62 -> 12, 63 -> 13
+			__m256i range = _mm256_subs_epu8 (indices, _mm256_set1_epi8 (51));
+			range         = _mm256_sub_epi8 (range, _mm256_cmpgt_epi8 (indices, _mm256_set1_epi8 (25)));
+			return _mm256_add_epi8 (indices, _mm256_shuffle_epi8 (offsets, range));
+		}
+
+		static size_t encodeBlocks (const uint8_t *in, size_t size, char *out) noexcept
+		{
+			size_t done = 0;
+			for (; size - done >= 32; done += 24, out += 32)
+			{
+				const __m256i bytes = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (in + done));
+				_mm256_storeu_si256 (reinterpret_cast<__m256i *> (out), encodeTranslate (encodeReshuffle (bytes)));
+			}
+			return done;
+		}
+
+		// Validation: a character is invalid when lo[its low nibble] & hi[its high nibble] != 0.
+		// One bit per high nibble 2..7 (the ones holding alphabet characters); 0x80 marks the others.
+		static constexpr uint8_t hiNibbleBit (unsigned hi) noexcept
+		{
+			return (hi >= 2 && hi <= 7) ? static_cast<uint8_t> (1u << (hi - 2)) : 0x80;
+		}
+
+		alignas (16) static constexpr std::array<uint8_t, 16> kHiNibbleBits = []
+		{
+			std::array<uint8_t, 16> table {};
+			for (unsigned hi = 0; hi < 16; ++hi)
+			{
+				table [hi] = hiNibbleBit (hi);
+			}
+			return table;
+		}();
+
+		alignas (16) static constexpr std::array<uint8_t, 16> kLoNibbleInvalid = []
+		{
+			std::array<uint8_t, 16> table {};
+			for (unsigned lo = 0; lo < 16; ++lo)
+			{
+				uint8_t bits = 0x80;
+				for (unsigned hi = 2; hi <= 7; ++hi)
+				{
+					if (kDecodeTable [(hi << 4) | lo] == kInvalid)
+					{
+						bits |= hiNibbleBit (hi);
+					}
+				}
+				table [lo] = bits;
+			}
+			return table;
+		}();
+
+		// Value offset per high nibble ('_' is corrected separately)
+		alignas (16) static constexpr std::array<int8_t, 16> kHiNibbleOffsets = {0, 0, 17, 4, -65, -65, -71, -71,
+		                                                                         0, 0, 0,  0, 0,   0,   0,   0};
+
+		// 32 values (6 bits each) -> 24 bytes in the low 24 bytes
+		static inline __m256i decodeReshuffle (__m256i values) noexcept
+		{
+			const __m256i pairs = _mm256_maddubs_epi16 (values, _mm256_set1_epi32 (0x01400140));
+			__m256i out         = _mm256_madd_epi16 (pairs, _mm256_set1_epi32 (0x00011000));
+			out = _mm256_shuffle_epi8 (out, _mm256_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			                                                  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			return _mm256_permutevar8x32_epi32 (out, _mm256_setr_epi32 (0, 1, 2, 4, 5, 6, -1, -1));
+		}
+
+		// Stops at the first block holding an invalid character (the scalar tail then reports it)
+		static size_t decodeBlocks (const char *in, size_t size, uint8_t *out) noexcept
+		{
+			const __m256i hiBits   = _mm256_broadcastsi128_si256 (_mm_load_si128 (reinterpret_cast<const __m128i *> (kHiNibbleBits.data())));
+			const __m256i loBits   = _mm256_broadcastsi128_si256 (_mm_load_si128 (reinterpret_cast<const __m128i *> (kLoNibbleInvalid.data())));
+			const __m256i offsets  = _mm256_broadcastsi128_si256 (_mm_load_si128 (reinterpret_cast<const __m128i *> (kHiNibbleOffsets.data())));
+			const __m256i nibble   = _mm256_set1_epi8 (0x0F);
+			const __m256i under    = _mm256_set1_epi8 ('_');
+
+			size_t done = 0;
+			// 32 characters per step; the 32-byte store needs 43 characters left for room in `out`
+			for (; size - done >= 43; done += 32, out += 24)
+			{
+				const __m256i chars = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (in + done));
+				const __m256i hi    = _mm256_and_si256 (_mm256_srli_epi32 (chars, 4), nibble);
+				const __m256i lo    = _mm256_and_si256 (chars, nibble);
+				if (!_mm256_testz_si256 (_mm256_shuffle_epi8 (loBits, lo), _mm256_shuffle_epi8 (hiBits, hi)))
+				{
+					break;
+				}
+
+				__m256i offset = _mm256_shuffle_epi8 (offsets, hi);
+				offset         = _mm256_blendv_epi8 (offset, _mm256_set1_epi8 (-32), _mm256_cmpeq_epi8 (chars, under));
+				const __m256i values = _mm256_add_epi8 (chars, offset);
+				_mm256_storeu_si256 (reinterpret_cast<__m256i *> (out), decodeReshuffle (values));
+			}
+			return done;
+		}
+
+#elif defined(HAPP_SIMD_NEON)
+
+		// 48 bytes <-> 64 characters per step: the structured loads split the 3-byte / 4-character groups
+
+		static size_t encodeBlocks (const uint8_t *in, size_t size, char *out) noexcept
+		{
+			const uint8x16x4_t alphabet = vld1q_u8_x4 (reinterpret_cast<const uint8_t *> (kAlphabet));
+			const uint8x16_t mask       = vdupq_n_u8 (0x3F);
+
+			size_t done = 0;
+			for (; size - done >= 48; done += 48, out += 64)
+			{
+				const uint8x16x3_t bytes = vld3q_u8 (in + done);
+				uint8x16x4_t chars;
+				chars.val [0] = vshrq_n_u8 (bytes.val [0], 2);
+				chars.val [1] = vandq_u8 (vorrq_u8 (vshlq_n_u8 (bytes.val [0], 4), vshrq_n_u8 (bytes.val [1], 4)), mask);
+				chars.val [2] = vandq_u8 (vorrq_u8 (vshlq_n_u8 (bytes.val [1], 2), vshrq_n_u8 (bytes.val [2], 6)), mask);
+				chars.val [3] = vandq_u8 (bytes.val [2], mask);
+				for (int i = 0; i < 4; ++i)
+				{
+					chars.val [i] = vqtbl4q_u8 (alphabet, chars.val [i]);
+				}
+				vst4q_u8 (reinterpret_cast<uint8_t *> (out), chars);
+			}
+			return done;
+		}
+
+		static inline uint8x16_t lookup (const uint8x16x4_t &low, const uint8x16x4_t &high, uint8x16_t c) noexcept
+		{
+			// Characters 0..63 from `low`, 64..127 from `high`; bytes >= 0x80 are forced invalid
+			uint8x16_t v = vqtbl4q_u8 (low, c);
+			v            = vqtbx4q_u8 (v, high, vsubq_u8 (c, vdupq_n_u8 (64)));
+			return vorrq_u8 (v, vreinterpretq_u8_s8 (vshrq_n_s8 (vreinterpretq_s8_u8 (c), 7)));
+		}
+
+		static size_t decodeBlocks (const char *in, size_t size, uint8_t *out) noexcept
+		{
+			const uint8x16x4_t low  = vld1q_u8_x4 (kDecodeTable.data());
+			const uint8x16x4_t high = vld1q_u8_x4 (kDecodeTable.data() + 64);
+
+			size_t done = 0;
+			for (; size - done >= 64; done += 64, out += 48)
+			{
+				const uint8x16x4_t chars = vld4q_u8 (reinterpret_cast<const uint8_t *> (in + done));
+				const uint8x16_t a       = lookup (low, high, chars.val [0]);
+				const uint8x16_t b       = lookup (low, high, chars.val [1]);
+				const uint8x16_t c       = lookup (low, high, chars.val [2]);
+				const uint8x16_t d       = lookup (low, high, chars.val [3]);
+				if (vmaxvq_u8 (vorrq_u8 (vorrq_u8 (a, b), vorrq_u8 (c, d))) > 63)
+				{
+					break;
+				}
+
+				uint8x16x3_t bytes;
+				bytes.val [0] = vorrq_u8 (vshlq_n_u8 (a, 2), vshrq_n_u8 (b, 4));
+				bytes.val [1] = vorrq_u8 (vshlq_n_u8 (b, 4), vshrq_n_u8 (c, 2));
+				bytes.val [2] = vorrq_u8 (vshlq_n_u8 (c, 6), d);
+				vst3q_u8 (out, bytes);
+			}
+			return done;
+		}
+
+#else
+
+		static size_t encodeBlocks ([[maybe_unused]] const uint8_t *in, [[maybe_unused]] size_t size,
+		                            [[maybe_unused]] char *out) noexcept
+		{
+			return 0;
+		}
+
+		static size_t decodeBlocks ([[maybe_unused]] const char *in, [[maybe_unused]] size_t size,
+		                            [[maybe_unused]] uint8_t *out) noexcept
+		{
+			return 0;
+		}
+
+#endif
+	}    // namespace
+
+	size_t encode (std::span<const uint8_t> data, std::span<char> out) noexcept
+	{
+		const size_t size = encodedSize (data.size());
+		if (out.size() < size)
+		{
+			return 0;
+		}
+
+		const size_t done = encodeBlocks (data.data(), data.size(), out.data());
+		encodeScalar (data.data() + done, data.size() - done, out.data() + encodedSize (done));
+		return size;
+	}
+
+	std::optional<size_t> decode (std::string_view text, std::span<uint8_t> out) noexcept
+	{
+		const size_t size = decodedSize (text.size());
+		if ((text.size() % 4) == 1 || out.size() < size)
+		{
+			return std::nullopt;
+		}
+
+		// Vector steps consume whole 4-character groups
+		const size_t done = decodeBlocks (text.data(), text.size(), out.data());
+		if (!decodeScalar (text.data() + done, text.size() - done, out.data() + decodedSize (done)))
+		{
+			return std::nullopt;
+		}
+		return size;
+	}
+
+}    // namespace ipb::http::base64url
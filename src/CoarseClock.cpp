@@ -0,0 +1,59 @@
+﻿/*********************************************************************************************
+ *  Description : CoarseClock implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "CoarseClock.h"
+
+#include <ctime>
+
+namespace ipb::http
+{
+	/**
+	 * @brief Read the clock and start the thread refreshing it.
+	 * @param tick Refresh period (the largest lag of `now`).
+	 */
+	CoarseClock::CoarseClock (std::chrono::milliseconds tick)
+	    : tick_ (tick)
+	{
+		update();
+		thread_ = std::thread (&CoarseClock::run, this);
+	}
+
+	CoarseClock::~CoarseClock ()
+	{
+		{
+			std::lock_guard<std::mutex> lock (mutex_);
+			stopping_ = true;
+		}
+		stop_requested_.notify_all();
+		thread_.join();
+	}
+
+	void CoarseClock::update () noexcept
+	{
+		seconds_.store (static_cast<int64_t> (std::time (nullptr)), std::memory_order_relaxed);
+	}
+
+	CoarseClock &CoarseClock::shared ()
+	{
+		// Leaked on purpose: joining a thread while the library unloads can deadlock (Windows loader lock)
+		static CoarseClock *clock = new CoarseClock();
+		return *clock;
+	}
+
+	void CoarseClock::run ()
+	{
+		std::unique_lock<std::mutex> lock (mutex_);
+		while (!stop_requested_.wait_for (lock, tick_,
+		                                  [this]
+		                                  {
+			                                  return stopping_;
+		                                  }))
+		{
+			update();
+		}
+	}
+
+}    // namespace ipb::http
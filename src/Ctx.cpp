@@ -0,0 +1,170 @@
+﻿/*********************************************************************************************
+ *  Description : Ctx implementation (views into the cpp-httplib request)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "Ctx.h"
+
+#include <httplib.h>
+
+namespace ipb::http
+{
+	namespace
+	{
+		// Most routes capture a handful of parameters: reserved once per pooled context
+		constexpr size_t kReservedParams = 8;
+	}    // namespace
+
+	Ctx::Ctx ()
+	{
+		params_.reserve (kReservedParams);
+	}
+
+	/**
+	 * @brief Store a captured parameter (the value is a view into the request path).
+	 * @param name The parameter name (from the route pattern).
+	 * @param value The raw captured value.
+	 */
+	void Ctx::setParam (std::string_view name, std::string_view value)
+	{
+		params_.push_back (Param {.name = name, .value = value, .decoded = {}});
+	}
+
+	/**
+	 * @brief Store a captured parameter together with its decoded value.
+	 * @param name The parameter name (from the route pattern).
+	 * @param value The raw captured value.
+	 * @param decoded The value decoded by the router validator.
+	 */
+	void Ctx::setTypedParam (std::string_view name, std::string_view value, const ParamValue &decoded)
+	{
+		params_.push_back (Param {.name = name, .value = value, .decoded = decoded});
+	}
+
+	/**
+	 * @brief Get a route parameter by name.
+	 * @param name The parameter name.
+	 * @return The raw value, or an empty view if the route has no such parameter.
+	 */
+	std::string_view Ctx::param (std::string_view name) const noexcept
+	{
+		for (const Param &param : params_)
+		{
+			if (param.name == name)
+			{
+				return param.value;
+			}
+		}
+		return {};
+	}
+
+	/**
+	 * @brief Get the decoded value of a route parameter.
+	 * @param name The parameter name.
+	 * @return The decoded value (monostate for untyped parameters), or nullptr if not present.
+	 */
+	const ParamValue *Ctx::typedParam (std::string_view name) const noexcept
+	{
+		for (const Param &param : params_)
+		{
+			if (param.name == name)
+			{
+				return &param.decoded;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief Get a request header.
+	 * @param name The header name (case-insensitive).
+	 * @return A view into the stored header value, or an empty view.
+	 */
+	std::string_view Ctx::header (const std::string &name) const
+	{
+		auto it = request_->headers.find (name);
+		if (it == request_->headers.end())
+		{
+			return {};
+		}
+		return it->second;
+	}
+
+	/**
+	 * @brief Get a query string parameter.
+	 * @param name The parameter name.
+	 * @return A view into the stored (decoded) value, or an empty view.
+	 */
+	std::string_view Ctx::query (const std::string &name) const
+	{
+		auto it = request_->params.find (name);
+		if (it == request_->params.end())
+		{
+			return {};
+		}
+		return it->second;
+	}
+
+	/**
+	 * @brief Set the response status code.
+	 */
+	Ctx &Ctx::status (int code)
+	{
+		response_->status = code;
+		return *this;
+	}
+
+	/**
+	 * @brief Set a response header.
+	 */
+	Ctx &Ctx::setHeader (const std::string &name, const std::string &value)
+	{
+		response_->set_header (name, value);
+		return *this;
+	}
+
+	/**
+	 * @brief Set the response body.
+	 * @param content The body (copied into the response).
+	 * @param contentType The Content-Type header value.
+	 */
+	Ctx &Ctx::send (std::string_view content, const char *contentType)
+	{
+		response_->set_content (content.data(), content.size(), contentType);
+		return *this;
+	}
+
+	/**
+	 * @brief Attach the context to a request/response pair.
+	 * @param request The request; it must outlive the dispatch.
+	 * @param response The response filled by the handlers.
+	 * @param router The router serving the request (the one of its partition).
+	 */
+	void Ctx::bind (const httplib::Request &request, httplib::Response &response, const Router *router)
+	{
+		request_  = &request;
+		response_ = &response;
+		router_   = router;
+		method_   = request.method;
+		path_     = request.path;
+		body_     = request.body;
+	}
+
+	/**
+	 * @brief Detach the context from the current request and rewind its arena, keeping the parameter storage.
+	 */
+	void Ctx::reset () noexcept
+	{
+		request_  = nullptr;
+		response_ = nullptr;
+		router_   = nullptr;
+		method_   = {};
+		path_     = {};
+		body_     = {};
+		params_.clear();
+		arena_.reset();
+		authenticated_ = false;
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,51 @@
+/*********************************************************************************************
+ *  Description : Entity tag comparison shared by the static files and the response cache (internal)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _ENTITY_TAG_H_
+#	define _ENTITY_TAG_H_
+
+#	include <string_view>
+
+namespace ipb::http::etag
+{
+	/**
+	 * @brief The quoted part of an entity tag, without its weak prefix.
+	 */
+	inline std::string_view opaque (std::string_view tag) noexcept
+	{
+		return tag.starts_with ("W/") ? tag.substr (2) : tag;
+	}
+
+	/**
+	 * @brief Whether an If-None-Match value selects `tag`: "*" or a comma-separated list of entity
+	 * tags, compared weakly (RFC 9110, 13.1.2).
+	 */
+	inline bool matchesNoneMatch (std::string_view header, std::string_view tag) noexcept
+	{
+		const std::string_view wanted = opaque (tag);
+		while (!header.empty())
+		{
+			const size_t comma    = header.find (',');
+			std::string_view item = header.substr (0, comma);
+			header                = comma == std::string_view::npos ? std::string_view {} : header.substr (comma + 1);
+
+			const size_t first = item.find_first_not_of (" \t");
+			if (first == std::string_view::npos)
+			{
+				continue;
+			}
+			item = item.substr (first, item.find_last_not_of (" \t") - first + 1);
+			if (item == "*" || opaque (item) == wanted)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}    // namespace ipb::http::etag
+
+#endif
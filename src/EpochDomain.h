@@ -0,0 +1,162 @@
+/*********************************************************************************************
+ *  Description : EpochDomain - Lock-free read-side reclamation for published tables
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _EPOCH_DOMAIN_H_
+#	define _EPOCH_DOMAIN_H_
+
+#	include <algorithm>
+#	include <array>
+#	include <atomic>
+#	include <cstddef>
+#	include <cstdint>
+#	include <functional>
+#	include <mutex>
+#	include <thread>
+
+namespace ipb::http
+{
+	/**
+	 * @brief Sleepable-RCU style grace periods.
+	 * Readers increment a counter of the current parity (sharded per thread, so readers on
+	 * different cores do not share cache lines) and never block. A writer publishes the new
+	 * pointer, then `synchronize` flips the parity twice and waits each time for the readers
+	 * of the old parity to drain: after it returns no reader can still see the old pointer.
+	 * Sections nest on their thread (RAII guards), and each thread tracks the domains it is reading, so a
+	 * writer can tell that `synchronize` would wait for its own section (see `readingOnThisThread`).
+	 */
+	class EpochDomain
+	{
+		public:
+			// Opaque reader slot: shard index (upper bits) + parity (bit 0)
+			using Slot = uint32_t;
+
+			Slot enter () noexcept
+			{
+				const uint32_t shard  = shardIndex();
+				const uint32_t parity = epoch_.load (std::memory_order_seq_cst) & 1u;
+				shards_ [shard].readers [parity].fetch_add (1, std::memory_order_seq_cst);
+
+				ThreadSections &open = threadSections();
+				if (open.depth < open.domains.size())
+				{
+					open.domains [open.depth] = this;
+				}
+				++open.depth;
+				return (shard << 1) | parity;
+			}
+
+			void leave (Slot slot) noexcept
+			{
+				--threadSections().depth;
+				shards_ [slot >> 1].readers [slot & 1u].fetch_sub (1, std::memory_order_seq_cst);
+			}
+
+			/**
+			 * True while the calling thread is inside a read section of this domain: `synchronize` would
+			 * then wait forever for it (also true past the tracked nesting depth, to stay on the safe side).
+			 */
+			bool readingOnThisThread () const noexcept
+			{
+				const ThreadSections &open = threadSections();
+				if (open.depth > open.domains.size())
+				{
+					return true;
+				}
+				return std::find (open.domains.begin(), open.domains.begin() + open.depth, this)
+				       != open.domains.begin() + open.depth;
+			}
+
+			/**
+			 * Wait until every reader that entered before the call has left.
+			 * Writers are serialized; readers are never blocked. Must not be called from a read section of
+			 * the same domain (check `readingOnThisThread`).
+			 */
+			void synchronize ()
+			{
+				std::lock_guard<std::mutex> lock (writer_mutex_);
+
+				for (int phase = 0; phase < 2; ++phase)
+				{
+					const uint32_t old_parity = epoch_.fetch_add (1, std::memory_order_seq_cst) & 1u;
+					while (activeReaders (old_parity) != 0)
+					{
+						std::this_thread::yield();
+					}
+				}
+			}
+
+		private:
+			static constexpr size_t kShards = 16;
+
+			// Read sections open on a thread, innermost last (deeper ones are only counted)
+			struct ThreadSections
+			{
+					std::array<const EpochDomain *, 16> domains {};
+					size_t depth = 0;
+			};
+
+			static ThreadSections &threadSections () noexcept
+			{
+				static thread_local ThreadSections sections;
+				return sections;
+			}
+
+			struct alignas (64) Shard
+			{
+					std::array<std::atomic<uint32_t>, 2> readers {};
+			};
+
+			static uint32_t shardIndex () noexcept
+			{
+				static thread_local const uint32_t index =
+				    static_cast<uint32_t> (std::hash<std::thread::id> {}(std::this_thread::get_id()) % kShards);
+				return index;
+			}
+
+			uint64_t activeReaders (uint32_t parity) const noexcept
+			{
+				uint64_t total = 0;
+				for (const Shard &shard : shards_)
+				{
+					total += shard.readers [parity].load (std::memory_order_seq_cst);
+				}
+				return total;
+			}
+
+			std::array<Shard, kShards> shards_ {};
+			std::atomic<uint32_t> epoch_ {0};
+			std::mutex writer_mutex_;
+	};
+
+	/**
+	 * @brief RAII read-side critical section of an EpochDomain.
+	 */
+	class EpochReadGuard
+	{
+		public:
+			explicit EpochReadGuard (EpochDomain &domain) noexcept
+			    : domain_ (domain)
+			    , slot_ (domain.enter())
+			{
+			}
+
+			~EpochReadGuard ()
+			{
+				domain_.leave (slot_);
+			}
+
+			EpochReadGuard (const EpochReadGuard &)            = delete;
+			EpochReadGuard &operator= (const EpochReadGuard &) = delete;
+
+		private:
+			EpochDomain &domain_;
+			EpochDomain::Slot slot_;
+	};
+
+}    // namespace ipb::http
+
+#endif
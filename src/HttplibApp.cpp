@@ -0,0 +1,358 @@
+﻿/*********************************************************************************************
+ *  Description : HttplibApp implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "HttplibApp.h"
+#include "Tracing.h"
+
+#include <httplib.h>
+
+#include <utility>
+
+namespace ipb::http
+{
+	namespace
+	{
+		// ============================================================================
+		// Per-thread Ctx pool
+		// ============================================================================
+
+		// Free contexts of the current thread; grows to the maximum dispatch nesting (usually 1)
+		thread_local std::vector<std::unique_ptr<Ctx>> t_ctx_pool;
+
+		/**
+		 * @brief Borrows a context of the thread pool for the duration of a dispatch.
+		 */
+		class PooledCtx
+		{
+			public:
+				PooledCtx (const httplib::Request &request, httplib::Response &response, const Router &router)
+				{
+					if (t_ctx_pool.empty())
+					{
+						ctx_ = std::make_unique<Ctx>();
+					}
+					else
+					{
+						ctx_ = std::move (t_ctx_pool.back());
+						t_ctx_pool.pop_back();
+					}
+					ctx_->bind (request, response, &router);
+				}
+
+				~PooledCtx ()
+				{
+					ctx_->reset();
+					t_ctx_pool.push_back (std::move (ctx_));
+				}
+
+				PooledCtx (const PooledCtx &)            = delete;
+				PooledCtx &operator= (const PooledCtx &) = delete;
+
+				Ctx &get () noexcept
+				{
+					return *ctx_;
+				}
+
+			private:
+				std::unique_ptr<Ctx> ctx_;
+		};
+
+		// HttplibApp only dispatches Ctx instances, so the router callbacks can downcast statically
+		RouteHandler adaptHandler (AppHandler handler)
+		{
+			return [handler = std::move (handler)] (ICtx &context)
+			{
+				handler (static_cast<Ctx &> (context));
+			};
+		}
+
+		Middleware adaptMiddleware (AppMiddleware middleware)
+		{
+			return [middleware = std::move (middleware)] (ICtx &context, IMiddlewareNext &next)
+			{
+				middleware (static_cast<Ctx &> (context), Next (next));
+			};
+		}
+	}    // namespace
+
+	// ============================================================================
+	// HttplibApp
+	// ============================================================================
+
+	HttplibApp::HttplibApp ()
+	    : HttplibApp (HttpServerConfig {})
+	{
+	}
+
+	HttplibApp::HttplibApp (HttpServerConfig config)
+	    : config_ (std::move (config))
+	    , target_ (&router_)
+	    , server_ (std::make_unique<httplib::Server>())
+	{
+	}
+
+	HttplibApp::~HttplibApp () = default;
+
+	/**
+	 * @brief Register a route with optional route middlewares.
+	 * @param method The HTTP method.
+	 * @param pattern The route pattern (e.g., "/users/<id:int>").
+	 * @param handler The route handler.
+	 * @param middlewares Route middlewares, executed after the global ones.
+	 * @return The app, for chaining.
+	 */
+	HttplibApp &HttplibApp::route (HttpMethod method, std::string_view pattern, AppHandler handler,
+	                               const std::vector<AppMiddleware> &middlewares)
+	{
+		RouteInfo &info = target_->add (method, pattern, adaptHandler (std::move (handler)));
+		for (const AppMiddleware &middleware : middlewares)
+		{
+			target_->addMiddleware (info, adaptMiddleware (middleware));
+		}
+		return *this;
+	}
+
+	HttplibApp &HttplibApp::get (std::string_view pattern, AppHandler handler,
+	                             const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::GET, pattern, std::move (handler), middlewares);
+	}
+
+	HttplibApp &HttplibApp::post (std::string_view pattern, AppHandler handler,
+	                              const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::POST, pattern, std::move (handler), middlewares);
+	}
+
+	HttplibApp &HttplibApp::put (std::string_view pattern, AppHandler handler,
+	                             const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::PUT, pattern, std::move (handler), middlewares);
+	}
+
+	HttplibApp &HttplibApp::patch (std::string_view pattern, AppHandler handler,
+	                               const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::PATCH, pattern, std::move (handler), middlewares);
+	}
+
+	HttplibApp &HttplibApp::del (std::string_view pattern, AppHandler handler,
+	                             const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::DELETE_, pattern, std::move (handler), middlewares);
+	}
+
+	HttplibApp &HttplibApp::options (std::string_view pattern, AppHandler handler,
+	                                 const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::OPTIONS, pattern, std::move (handler), middlewares);
+	}
+
+	HttplibApp &HttplibApp::head (std::string_view pattern, AppHandler handler,
+	                              const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::HEAD, pattern, std::move (handler), middlewares);
+	}
+
+	HttplibApp &HttplibApp::any (std::string_view pattern, AppHandler handler,
+	                             const std::vector<AppMiddleware> &middlewares)
+	{
+		return route (HttpMethod::ANY, pattern, std::move (handler), middlewares);
+	}
+
+	bool HttplibApp::loadRoutes (const std::filesystem::path &image, std::span<const AppHandler> handlers)
+	{
+		std::vector<RouteHandler> adapted;
+		adapted.reserve (handlers.size());
+		for (const AppHandler &handler : handlers)
+		{
+			adapted.push_back (handler ? adaptHandler (handler) : RouteHandler {});
+		}
+		return target_->loadImage (image, adapted);
+	}
+
+	/**
+	 * @brief Serve a directory below a path prefix.
+	 * @param prefix The path prefix (e.g., "/static").
+	 * @param root The directory served.
+	 * @param config Index file and caching settings.
+	 * @return The app, for chaining.
+	 */
+	HttplibApp &HttplibApp::serveStatic (std::string_view prefix, std::string root, StaticFilesConfig config)
+	{
+		std::string pattern (prefix);
+		if (!pattern.ends_with ('/'))
+		{
+			pattern += '/';
+		}
+		pattern += "<path:path>";
+
+		AppHandler handler = staticFiles (std::move (root), "path", std::move (config));
+		get (pattern, handler);
+		return head (pattern, std::move (handler));
+	}
+
+	/**
+	 * @brief Add a global middleware.
+	 * @param middleware The middleware; it calls `next()` to continue the chain.
+	 * @return The app, for chaining.
+	 */
+	HttplibApp &HttplibApp::use (AppMiddleware middleware)
+	{
+		target_->addMiddleware (adaptMiddleware (std::move (middleware)));
+		return *this;
+	}
+
+	/**
+	 * @brief Add a middleware to one route.
+	 * @param route The route (of any router of the app).
+	 * @param middleware The middleware; it calls `next()` to continue the chain.
+	 * @return The app, for chaining.
+	 */
+	HttplibApp &HttplibApp::use (RouteInfo &route, AppMiddleware middleware)
+	{
+		target_->addMiddleware (route, adaptMiddleware (std::move (middleware)));
+		return *this;
+	}
+
+	/**
+	 * @brief Get (or create) the router of a partition.
+	 * @param partition Host name or path prefix, depending on `HttpServerConfig::partition_by`.
+	 * @return The router of the partition.
+	 */
+	Router &HttplibApp::router (std::string_view partition)
+	{
+		if (!partitions_)
+		{
+			partitions_ = std::make_unique<RouterPartitions> (config_.partition_by);
+		}
+		return partitions_->partition (partition);
+	}
+
+	/**
+	 * @brief Select the router of the routes and middlewares registered next.
+	 * @param partition Host name or path prefix; empty for the default router.
+	 * @return The app, for chaining.
+	 */
+	HttplibApp &HttplibApp::scope (std::string_view partition)
+	{
+		target_ = partition.empty() ? &router_ : &router (partition);
+		return *this;
+	}
+
+	// Router of the request partition, or the default router
+	const Router &HttplibApp::select (const httplib::Request &request) const noexcept
+	{
+		if (!partitions_)
+		{
+			return router_;
+		}
+
+		std::string_view host;
+		if (partitions_->key() == PartitionKey::HOST)
+		{
+			const auto it = request.headers.find ("Host");
+			if (it != request.headers.end())
+			{
+				host = it->second;
+			}
+		}
+
+		const Router *router = partitions_->select (host, request.path);
+		return router != nullptr ? *router : router_;
+	}
+
+	/**
+	 * @brief Match a request against the router and run the matched route.
+	 * @param request The incoming request.
+	 * @param response The response to fill.
+	 * @return True if a route matched (and was executed), false otherwise.
+	 */
+	bool HttplibApp::dispatch (const httplib::Request &request, httplib::Response &response) const
+	{
+		const std::string_view path = request.path;
+		if (!config_.normalize_trailing_slash && path.size() > 1 && path.back() == '/')
+		{
+			return false;
+		}
+
+		// Unknown methods are left to cpp-httplib rather than matched as another method
+		const std::optional<HttpMethod> method = Router::parseMethod (request.method);
+		if (!method.has_value())
+		{
+			return false;
+		}
+
+		const Router &router = select (request);
+
+		Router::ReadGuard guard (router);
+		PooledCtx pooled (request, response, router);
+		[[maybe_unused]] RequestTrace trace;    // Sampling point: the stages below are recorded on sampled requests
+
+		auto result = router.match (*method, path, pooled.get());
+		if (!result.has_value())
+		{
+			return false;
+		}
+
+		// One wait for the whole coroutine chain; cpp-httplib has no way to complete the response later
+		const RouteInfo &route = result.value().get();
+		if (route.async)
+		{
+			router.executeAsync (route, pooled.get()).wait();
+		}
+		else
+		{
+			router.execute (route, pooled.get());
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Freeze the routes and start serving (blocking).
+	 * @return False if the server could not bind/listen.
+	 */
+	bool HttplibApp::listen ()
+	{
+		router_.freeze();
+		if (partitions_)
+		{
+			partitions_->freeze();
+		}
+
+		if (config_.threads > 0)
+		{
+			const size_t threads    = static_cast<size_t> (config_.threads);
+			server_->new_task_queue = [threads]
+			{
+				return new httplib::ThreadPool (threads);
+			};
+		}
+
+		server_->set_pre_routing_handler (
+		    [this] (const httplib::Request &request, httplib::Response &response)
+		    {
+			    return dispatch (request, response) ? httplib::Server::HandlerResponse::Handled
+			                                        : httplib::Server::HandlerResponse::Unhandled;
+		    });
+
+		return server_->listen (config_.host, config_.port);
+	}
+
+	/**
+	 * @brief Stop a running `listen`.
+	 */
+	void HttplibApp::stop ()
+	{
+		server_->stop();
+	}
+
+	httplib::Server &HttplibApp::server ()
+	{
+		return *server_;
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,148 @@
+/*********************************************************************************************
+ *  Description : JSON text scanning and escaping shared by the JSON provider and the signer (internal)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _JSON_TEXT_H_
+#	define _JSON_TEXT_H_
+
+#	include <bit>
+#	include <charconv>
+#	include <cmath>
+#	include <cstdint>
+#	include <string>
+#	include <string_view>
+
+#	include "Jwt.h"
+#	include "Simd.h"
+
+namespace ipb::http::jwt::jsontext
+{
+	inline bool isSpecial (char c) noexcept
+	{
+		return c == '"' || c == '\\' || static_cast<unsigned char> (c) < 0x20;
+	}
+
+	/**
+	 * First quote, backslash or control character in [p, end) (end if none).
+	 * Shared by the reader (end of a string run) and the writers (next character to escape).
+	 */
+	inline const char *findSpecial (const char *p, const char *end) noexcept
+	{
+#if defined(HAPP_SIMD_SSE2)
+		const __m128i quote     = _mm_set1_epi8 ('"');
+		const __m128i backslash = _mm_set1_epi8 ('\\');
+		const __m128i control   = _mm_set1_epi8 (0x1F);
+		while (end - p >= 16)
+		{
+			const __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (p));
+			// v <= 0x1F (unsigned) <=> min(v, 0x1F) == v
+			const __m128i hits = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (v, quote), _mm_cmpeq_epi8 (v, backslash)),
+			                                   _mm_cmpeq_epi8 (_mm_min_epu8 (v, control), v));
+			if (const int mask = _mm_movemask_epi8 (hits); mask != 0)
+			{
+				return p + std::countr_zero (static_cast<unsigned> (mask));
+			}
+			p += 16;
+		}
+#elif defined(HAPP_SIMD_NEON)
+		const uint8x16_t quote     = vdupq_n_u8 ('"');
+		const uint8x16_t backslash = vdupq_n_u8 ('\\');
+		const uint8x16_t control   = vdupq_n_u8 (0x1F);
+		while (end - p >= 16)
+		{
+			const uint8x16_t v    = vld1q_u8 (reinterpret_cast<const uint8_t *> (p));
+			const uint8x16_t hits = vorrq_u8 (vorrq_u8 (vceqq_u8 (v, quote), vceqq_u8 (v, backslash)), vcleq_u8 (v, control));
+			// Narrow each byte to a nibble: 64-bit mask, 4 bits per input byte
+			const uint64_t mask = vget_lane_u64 (vreinterpret_u64_u8 (vshrn_n_u16 (vreinterpretq_u16_u8 (hits), 4)), 0);
+			if (mask != 0)
+			{
+				return p + (std::countr_zero (mask) >> 2);
+			}
+			p += 16;
+		}
+#endif
+		while (p < end && !isSpecial (*p))
+		{
+			++p;
+		}
+		return p;
+	}
+
+	inline size_t escapedSize (std::string_view text) noexcept
+	{
+		size_t size      = text.size();
+		const char *p    = text.data();
+		const char *end  = p + text.size();
+		while ((p = findSpecial (p, end)) != end)
+		{
+			const char c = *p++;
+			const bool shortForm =
+			    c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t';
+			size += shortForm ? 1 : 5;    // "\x" or "\u00XX"
+		}
+		return size + 2;                  // Quotes
+	}
+
+	inline void appendEscaped (std::string &out, std::string_view text)
+	{
+		static constexpr char kHex [] = "0123456789abcdef";
+
+		out.push_back ('"');
+		const char *p   = text.data();
+		const char *end = p + text.size();
+		for (;;)
+		{
+			const char *special = findSpecial (p, end);
+			out.append (p, special);
+			if (special == end)
+			{
+				break;
+			}
+
+			const char c = *special;
+			p            = special + 1;
+			switch (c)
+			{
+			case '"': out.append ("\\\""); break;
+			case '\\': out.append ("\\\\"); break;
+			case '\b': out.append ("\\b"); break;
+			case '\f': out.append ("\\f"); break;
+			case '\n': out.append ("\\n"); break;
+			case '\r': out.append ("\\r"); break;
+			case '\t': out.append ("\\t"); break;
+			default:
+				out.append ("\\u00");
+				out.push_back (kHex [(static_cast<unsigned char> (c) >> 4) & 0x0F]);
+				out.push_back (kHex [static_cast<unsigned char> (c) & 0x0F]);
+				break;
+			}
+		}
+		out.push_back ('"');
+	}
+
+	// Number text in `buffer` (shortest round-trip form); 0 for non-finite doubles
+	template <size_t N> size_t formatNumber (const ClaimValue &value, char (&buffer) [N]) noexcept
+	{
+		std::to_chars_result r {};
+		if (const auto *integer = std::get_if<int64_t> (&value))
+		{
+			r = std::to_chars (buffer, buffer + N, *integer);
+		}
+		else
+		{
+			const double number = std::get<double> (value);
+			if (!std::isfinite (number))
+			{
+				return 0;
+			}
+			r = std::to_chars (buffer, buffer + N, number);
+		}
+		return r.ec == std::errc() ? static_cast<size_t> (r.ptr - buffer) : 0;
+	}
+
+}    // namespace ipb::http::jwt::jsontext
+
+#endif
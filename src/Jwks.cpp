@@ -0,0 +1,373 @@
+/*********************************************************************************************
+ *  Description : JWKS client implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *  Copyright    (C) 2026  Ignacio Pomar Ballestero
+ *********************************************************************************************/
+
+#include "Jwks.h"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ipb::http::jwt
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		static bool equalsIgnoreCase (std::string_view a, std::string_view b) noexcept
+		{
+			return a.size() == b.size()
+			       && std::equal (a.begin(), a.end(), b.begin(),
+			                      [] (char x, char y)
+			                      {
+				                      // ASCII fold: header tokens are ASCII, and the locale must not matter
+				                      const auto fold = [] (char c)
+				                      { return c >= 'A' && c <= 'Z' ? static_cast<char> (c - 'A' + 'a') : c; };
+				                      return fold (x) == fold (y);
+			                      });
+		}
+
+		static std::string_view trim (std::string_view text) noexcept
+		{
+			while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+			{
+				text.remove_prefix (1);
+			}
+			while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+			{
+				text.remove_suffix (1);
+			}
+			return text;
+		}
+	}    // namespace
+
+	/**
+	 * @brief Read the max-age directive of a Cache-Control header value.
+	 * @param cacheControl The header value, e.g. "public, max-age=3600".
+	 * @return The max-age in seconds (0 for no-store / no-cache), or nullopt if not present.
+	 */
+	std::optional<int64_t> parseMaxAge (std::string_view cacheControl) noexcept
+	{
+		std::optional<int64_t> maxAge;
+		while (!cacheControl.empty())
+		{
+			const size_t comma               = cacheControl.find (',');
+			const std::string_view directive = trim (cacheControl.substr (0, comma));
+			cacheControl                     = comma == std::string_view::npos ? std::string_view {}
+			                                                                   : cacheControl.substr (comma + 1);
+
+			if (equalsIgnoreCase (directive, "no-store") || equalsIgnoreCase (directive, "no-cache"))
+			{
+				return 0;
+			}
+
+			const size_t eq = directive.find ('=');
+			if (eq == std::string_view::npos || !equalsIgnoreCase (trim (directive.substr (0, eq)), "max-age"))
+			{
+				continue;
+			}
+
+			std::string_view value = trim (directive.substr (eq + 1));
+			if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+			{
+				value = value.substr (1, value.size() - 2);
+			}
+
+			int64_t seconds = 0;
+			auto r          = std::from_chars (value.data(), value.data() + value.size(), seconds);
+			if (r.ec == std::errc() && r.ptr == value.data() + value.size() && seconds >= 0)
+			{
+				maxAge = seconds;
+			}
+		}
+		return maxAge;
+	}
+
+	class JwksClient::Impl
+	{
+		public:
+			Impl (Jwt &jwt, IJwksSource &source, JwksOptions options)
+			    : jwt_ (jwt)
+			    , source_ (source)
+			    , options_ (options)
+			    , delay_ (options.refreshInterval)
+			{
+			}
+
+			Error refresh ()
+			{
+				// One refresh at a time (background thread or explicit calls)
+				std::lock_guard refreshLock (refreshMutex_);
+				{
+					// Stamped before fetching: unknown kids seen meanwhile wait for this refresh
+					std::lock_guard lock (mutex_);
+					lastAttempt_ = Clock::now();
+				}
+
+				Error error = apply();
+
+				std::lock_guard lock (mutex_);
+				if (error.code == ErrorCode::Ok)
+				{
+					refreshed_ = true;
+				}
+				else
+				{
+					delay_ = std::min (delay_, options_.retryInterval);
+				}
+				return error;
+			}
+
+			void start ()
+			{
+				{
+					std::lock_guard lock (mutex_);
+					if (running_)
+					{
+						return;
+					}
+					running_   = true;
+					requested_ = !refreshed_;
+				}
+
+				// Chained: a callback installed before start keeps being called, and stop puts it back
+				EngineOptions engineOptions = jwt_.options();
+				previousOnUnknownKid_       = engineOptions.onUnknownKid;
+				engineOptions.onUnknownKid  = [this, previous = previousOnUnknownKid_] (std::string_view kid)
+				{
+					requestRefresh (kid);
+					if (previous)
+					{
+						previous (kid);
+					}
+				};
+				jwt_.setOptions (std::move (engineOptions));
+
+				thread_ = std::thread ([this] { run(); });
+			}
+
+			void stop ()
+			{
+				{
+					std::lock_guard lock (mutex_);
+					if (!running_)
+					{
+						return;
+					}
+					running_ = false;
+				}
+				wakeup_.notify_all();
+				thread_.join();
+
+				EngineOptions engineOptions = jwt_.options();
+				engineOptions.onUnknownKid  = std::move (previousOnUnknownKid_);
+				jwt_.setOptions (std::move (engineOptions));
+			}
+
+			void requestRefresh (std::string_view kid)
+			{
+				// Called from verify: only a short critical section, the fetch runs on the refresher thread
+				std::lock_guard lock (mutex_);
+				if (!running_ || requested_ || keys_.find (kid) != keys_.end())
+				{
+					return;
+				}
+				if (lastAttempt_ != Clock::time_point {} && Clock::now() - lastAttempt_ < options_.minRefreshInterval)
+				{
+					return;
+				}
+				requested_ = true;
+				wakeup_.notify_one();
+			}
+
+			bool hasKey (std::string_view kid) const
+			{
+				std::lock_guard lock (mutex_);
+				return keys_.find (kid) != keys_.end();
+			}
+
+			size_t keyCount () const
+			{
+				std::lock_guard lock (mutex_);
+				return keys_.size();
+			}
+
+			std::chrono::seconds refreshDelay () const
+			{
+				std::lock_guard lock (mutex_);
+				return delay_;
+			}
+
+		private:
+			Error apply ()
+			{
+				JwksDocument document;
+				if (Error error = source_.fetch (document); error.code != ErrorCode::Ok)
+				{
+					return error;
+				}
+
+				std::vector<JwkEntry> entries;
+				if (Error error = jwt_.json().parseJwks (document.body, entries); error.code != ErrorCode::Ok)
+				{
+					return error;
+				}
+
+				KeyIndex current;
+				{
+					std::lock_guard lock (mutex_);
+					current = keys_;
+				}
+
+				// Only keys whose JWK text changed are reloaded (each load purges the cache for its kid)
+				Error result {.code = ErrorCode::Ok, .message = {}};
+				KeyIndex next;
+				for (JwkEntry &entry : entries)
+				{
+					if (entry.kid.empty() || entry.use != JwtUse::Sig || next.find (entry.kid) != next.end())
+					{
+						continue;
+					}
+
+					auto it = current.find (entry.kid);
+					if (it == current.end() || it->second != entry.json)
+					{
+						Error error = jwt_.loadPublicKeyFromJwk (entry.kid, entry.json, entry.use);
+						if (error.code != ErrorCode::Ok)
+						{
+							// Keep the previous version of the key, if any; the other keys are still applied
+							if (it != current.end())
+							{
+								next.emplace (entry.kid, it->second);
+							}
+							result = std::move (error);
+							continue;
+						}
+					}
+					next.emplace (std::move (entry.kid), std::move (entry.json));
+				}
+
+				for (const auto &[kid, json] : current)
+				{
+					if (next.find (kid) == next.end())
+					{
+						jwt_.removeKey (kid);
+					}
+				}
+
+				const std::optional<int64_t> maxAge = parseMaxAge (document.cacheControl);
+				std::chrono::seconds delay          = options_.refreshInterval;
+				if (maxAge.has_value())
+				{
+					delay = std::chrono::seconds (maxAge.value());
+				}
+
+				std::lock_guard lock (mutex_);
+				keys_  = std::move (next);
+				delay_ = std::clamp (delay, options_.minRefreshInterval, options_.maxRefreshInterval);
+				return result;
+			}
+
+			void run ()
+			{
+				std::unique_lock lock (mutex_);
+				while (running_)
+				{
+					const Clock::time_point due = lastAttempt_ + delay_;
+					wakeup_.wait_until (lock, due, [this] { return !running_ || requested_; });
+					if (!running_)
+					{
+						break;
+					}
+					requested_ = false;
+
+					lock.unlock();
+					refresh();
+					lock.lock();
+				}
+			}
+
+			struct KidHash
+			{
+					using is_transparent = void;
+
+					size_t operator() (std::string_view kid) const noexcept
+					{
+						return std::hash<std::string_view> {}(kid);
+					}
+			};
+
+			// kid -> JWK text as last loaded into the engine
+			using KeyIndex = std::unordered_map<std::string, std::string, KidHash, std::equal_to<>>;
+
+			Jwt &jwt_;
+			IJwksSource &source_;
+			const JwksOptions options_;
+
+			std::mutex refreshMutex_;
+			mutable std::mutex mutex_;    // Guards everything below
+			std::condition_variable wakeup_;
+			KeyIndex keys_;
+			std::chrono::seconds delay_;
+			Clock::time_point lastAttempt_ {};
+			bool refreshed_ = false;     // A refresh succeeded at least once
+			bool requested_ = false;     // Early refresh pending (single flight)
+			bool running_   = false;
+			std::thread thread_;
+			std::function<void (std::string_view kid)> previousOnUnknownKid_;    // Restored by stop
+	};
+
+	JwksClient::JwksClient (Jwt &jwt, IJwksSource &source, JwksOptions options)
+	    : impl_ (std::make_unique<Impl> (jwt, source, options))
+	{
+	}
+
+	JwksClient::~JwksClient ()
+	{
+		impl_->stop();
+	}
+
+	Error JwksClient::refresh ()
+	{
+		return impl_->refresh();
+	}
+
+	void JwksClient::start ()
+	{
+		impl_->start();
+	}
+
+	void JwksClient::stop ()
+	{
+		impl_->stop();
+	}
+
+	void JwksClient::requestRefresh (std::string_view kid)
+	{
+		impl_->requestRefresh (kid);
+	}
+
+	bool JwksClient::hasKey (std::string_view kid) const
+	{
+		return impl_->hasKey (kid);
+	}
+
+	size_t JwksClient::keyCount () const
+	{
+		return impl_->keyCount();
+	}
+
+	std::chrono::seconds JwksClient::refreshDelay () const
+	{
+		return impl_->refreshDelay();
+	}
+
+}    // namespace ipb::http::jwt
@@ -5,10 +5,19 @@
  *********************************************************************************************/
 
 #include "Jwt.h"
+#include "Base64Url.h"
+#include "EpochDomain.h"
+#include "JsonText.h"
+#include "KeyHandleCache.h"
+#include "TraceScope.h"
+#include "VerifiedTokenCache.h"
 
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <cmath>
 #include <ctime>
+#include <limits>
 #include <utility>
 
 namespace ipb::http::jwt
@@ -30,49 +39,189 @@ namespace ipb::http::jwt
 			return std::span<const uint8_t> (reinterpret_cast<const uint8_t *> (text.data()), text.size());
 		}
 
-		static std::optional<std::string> getStringValue (const HeaderMap &map, std::string_view key)
+		static std::optional<std::string_view> asString (const ClaimValue *value) noexcept
 		{
-			if (auto it = map.find (std::string (key)); it != map.end())
+			if (value != nullptr)
 			{
-				if (auto value = std::get_if<std::string> (&it->second))
+				if (const auto *text = std::get_if<std::string> (value))
 				{
-					return *value;
+					return std::string_view (*text);
 				}
 			}
 			return std::nullopt;
 		}
 
-		static std::optional<int64_t> getIntValue (const ClaimMap &map, std::string_view key)
+		// A string aud is one audience; an array aud lists several
+		static bool hasAudience (const ClaimValue *value, std::string_view expected) noexcept
 		{
-			if (auto it = map.find (std::string (key)); it != map.end())
+			if (value == nullptr)
 			{
-				if (auto value = std::get_if<int64_t> (&it->second))
-				{
-					return *value;
-				}
-				if (auto value = std::get_if<double> (&it->second))
+				return false;
+			}
+			if (const auto *text = std::get_if<std::string> (value))
+			{
+				return *text == expected;
+			}
+			if (const auto *list = std::get_if<ClaimStrings> (value))
+			{
+				return std::ranges::find (*list, expected) != list->end();
+			}
+			return false;
+		}
+
+		static std::optional<int64_t> asInt (const ClaimValue *value) noexcept
+		{
+			if (value == nullptr)
+			{
+				return std::nullopt;
+			}
+			if (const auto *number = std::get_if<int64_t> (value))
+			{
+				return *number;
+			}
+			if (const auto *number = std::get_if<double> (value))
+			{
+				// Integral and within int64 (2^63 itself is not): the cast is undefined otherwise (1e300, NaN)
+				const auto rounded = std::floor (*number);
+				if (rounded == *number && rounded >= -0x1p63 && rounded < 0x1p63)
 				{
-					const auto rounded = std::floor (*value);
-					if (rounded == *value)
-					{
-						return static_cast<int64_t> (rounded);
-					}
+					return static_cast<int64_t> (rounded);
 				}
 			}
 			return std::nullopt;
 		}
 
-		static std::optional<std::string> getStringClaim (const ClaimMap &map, std::string_view key)
+		// Time claims are attacker supplied: adding the leeway must not overflow
+		static int64_t addSaturated (int64_t value, int64_t delta) noexcept
+		{
+			if (delta > 0 && value > std::numeric_limits<int64_t>::max() - delta)
+			{
+				return std::numeric_limits<int64_t>::max();
+			}
+			if (delta < 0 && value < std::numeric_limits<int64_t>::min() - delta)
+			{
+				return std::numeric_limits<int64_t>::min();
+			}
+			return value + delta;
+		}
+
+		static const ClaimValue *findValue (const ClaimMap &map, std::string_view key) noexcept
+		{
+			auto it = map.find (key);
+			return it != map.end() ? &it->second : nullptr;
+		}
+
+		static std::optional<std::string_view> getStringValue (const HeaderMap &map, std::string_view key) noexcept
 		{
-			if (auto it = map.find (std::string (key)); it != map.end())
+			return asString (findValue (map, key));
+		}
+
+		static std::optional<RegisteredClaim> toRegisteredClaim (std::string_view name) noexcept
+		{
+			if (name.size() != 3)
 			{
-				if (auto value = std::get_if<std::string> (&it->second))
+				return std::nullopt;
+			}
+
+			switch (name [0])
+			{
+			case 'i':
+				if (name == "iss")
+				{
+					return RegisteredClaim::Iss;
+				}
+				if (name == "iat")
+				{
+					return RegisteredClaim::Iat;
+				}
+				break;
+			case 's':
+				if (name == "sub")
+				{
+					return RegisteredClaim::Sub;
+				}
+				break;
+			case 'a':
+				if (name == "aud")
+				{
+					return RegisteredClaim::Aud;
+				}
+				break;
+			case 'e':
+				if (name == "exp")
+				{
+					return RegisteredClaim::Exp;
+				}
+				break;
+			case 'n':
+				if (name == "nbf")
+				{
+					return RegisteredClaim::Nbf;
+				}
+				break;
+			case 'j':
+				if (name == "jti")
 				{
-					return *value;
+					return RegisteredClaim::Jti;
 				}
+				break;
+			default: break;
 			}
 			return std::nullopt;
 		}
+	}    // namespace
+
+	// Member of Verifier::Impl, so not in the anonymous namespace (a unity build would warn)
+	namespace detail
+	{
+		// Positions of the registered claims in a ClaimMap, found in one pass when the payload is parsed.
+		// Positions (not pointers) so they stay valid when the Verifier is copied.
+		struct ClaimSlots
+		{
+				static constexpr uint32_t kMissing = UINT32_MAX;
+
+				std::array<uint32_t, static_cast<size_t> (RegisteredClaim::Count)> index;
+
+				ClaimSlots () noexcept
+				{
+					index.fill (kMissing);
+				}
+
+				void build (const ClaimMap &claims) noexcept
+				{
+					index.fill (kMissing);
+					uint32_t position = 0;
+					for (const auto &[name, value] : claims)
+					{
+						if (auto claim = toRegisteredClaim (name); claim.has_value())
+						{
+							index [static_cast<size_t> (claim.value())] = position;
+						}
+						++position;
+					}
+				}
+
+				const ClaimValue *get (const ClaimMap &claims, RegisteredClaim claim) const noexcept
+				{
+					const uint32_t position = index [static_cast<size_t> (claim)];
+					return position == kMissing ? nullptr : &(claims.begin() + position)->second;
+				}
+		};
+	}    // namespace detail
+
+	namespace
+	{
+		using detail::ClaimSlots;
+
+		// Registered names go through the slots, other names through the map
+		static const ClaimValue *findClaim (const ClaimMap &claims, const ClaimSlots &slots, std::string_view name) noexcept
+		{
+			if (auto claim = toRegisteredClaim (name); claim.has_value())
+			{
+				return slots.get (claims, claim.value());
+			}
+			return findValue (claims, name);
+		}
 
 		static std::optional<JwtAlg> fromAlgString (std::string_view alg)
 		{
@@ -108,20 +257,31 @@ namespace ipb::http::jwt
 			}
 		}
 
-		static bool containsAlg (const std::vector<JwtAlg> &allowed, JwtAlg alg)
+		static bool allowsAlg (const CompiledPolicy &policy, JwtAlg alg) noexcept
 		{
-			if (allowed.empty())
+			return (policy.algMask & algBit (alg)) != 0;
+		}
+
+		// The algorithm and kid of a verified header against the policy (for results taken from the cache)
+		static Error checkKey (const CompiledPolicy &policy, const HeaderMap &header)
+		{
+			auto alg = fromAlgString (getStringValue (header, "alg").value_or (std::string_view {}));
+			if (!alg.has_value() || !allowsAlg (policy, alg.value()))
 			{
-				return true;
+				return makeError (ErrorCode::UnsupportedAlg, "Algorithm not allowed by policy");
 			}
-			return std::find (allowed.begin(), allowed.end(), alg) != allowed.end();
+			if (!policy.kid.empty() && getStringValue (header, "kid") != std::string_view (policy.kid))
+			{
+				return makeError (ErrorCode::KeyNotFound, "kid does not match the policy key");
+			}
+			return makeError (ErrorCode::Ok);
 		}
 
-		static Error validatePolicy (const Policy &policy, const ClaimMap &claims)
+		static Error validatePolicy (const Policy &policy, const ClaimMap &claims, const ClaimSlots &slots, int64_t now)
 		{
 			if (policy.expectedIss.has_value())
 			{
-				if (auto iss = getStringClaim (claims, "iss");
+				if (auto iss = asString (slots.get (claims, RegisteredClaim::Iss));
 				    !iss.has_value() || iss.value() != policy.expectedIss.value())
 				{
 					return makeError (ErrorCode::InvalidIssuer, "Issuer claim does not match policy");
@@ -130,75 +290,700 @@ namespace ipb::http::jwt
 
 			if (policy.expectedAud.has_value())
 			{
-				if (auto aud = getStringClaim (claims, "aud");
-				    !aud.has_value() || aud.value() != policy.expectedAud.value())
+				if (!hasAudience (slots.get (claims, RegisteredClaim::Aud), policy.expectedAud.value()))
 				{
 					return makeError (ErrorCode::InvalidAudience, "Audience claim does not match policy");
 				}
 			}
 
-			const int64_t now = static_cast<int64_t> (std::time (nullptr));
-
 			if (policy.requireExp)
 			{
-				auto exp = getIntValue (claims, "exp");
-				if (!exp.has_value())
-				{
-					return makeError (ErrorCode::PolicyViolation, "exp claim is required by policy");
-				}
-				if (now > exp.value() + policy.leewaySeconds)
-				{
-					return makeError (ErrorCode::Expired, "Token has expired");
-				}
+				auto exp = asInt (slots.get (claims, RegisteredClaim::Exp));
+				if (!exp.has_value())
+				{
+					return makeError (ErrorCode::PolicyViolation, "exp claim is required by policy");
+				}
+				if (now > addSaturated (exp.value(), policy.leewaySeconds))
+				{
+					return makeError (ErrorCode::Expired, "Token has expired");
+				}
+			}
+
+			if (policy.requireNbf)
+			{
+				auto nbf = asInt (slots.get (claims, RegisteredClaim::Nbf));
+				if (!nbf.has_value())
+				{
+					return makeError (ErrorCode::PolicyViolation, "nbf claim is required by policy");
+				}
+				if (addSaturated (now, policy.leewaySeconds) < nbf.value())
+				{
+					return makeError (ErrorCode::NotYetValid, "Token not valid yet");
+				}
+			}
+
+			return makeError (ErrorCode::Ok);
+		}
+
+		// Per-thread buffers of TokenBuilder::sign and SigningTemplate::sign: reused, so signing on a warm thread does not reallocate them
+		struct SignScratch
+		{
+				std::string headerJson;
+				std::string payloadJson;
+				std::string headerB64;
+				std::string payloadB64;
+				std::string signingInput;
+				std::string signatureB64;
+				ByteBuffer signature;
+		};
+
+		thread_local SignScratch t_sign_scratch;
+
+		// SigningClaims members in the order SigningTemplate::sign writes them (bit index in fixedVariableClaims_)
+		constexpr std::array<std::string_view, 4> kSigningClaimNames = {"sub", "exp", "iat", "jti"};
+
+		// Largest signature expected per algorithm (RS256: keys up to 4096 bits); only sizes the output
+		static size_t signatureSizeHint (JwtAlg alg) noexcept
+		{
+			switch (alg)
+			{
+			case JwtAlg::HS256: return 32;
+			case JwtAlg::RS256: return 512;
+			default: return 64;
+			}
+		}
+
+		// `"name":`, after a comma unless it is the first member (the names used here need no escaping)
+		static void appendMemberName (std::string &out, std::string_view name)
+		{
+			if (out.size() > 1)
+			{
+				out.push_back (',');
+			}
+			out.push_back ('"');
+			out.append (name);
+			out.append ("\":");
+		}
+
+	}    // namespace
+
+	class Jwt::Impl
+	{
+		public:
+			// State read by verify; replaced as a whole by setOptions, except for the key map
+			struct Snapshot
+			{
+					EngineOptions options;
+					CompiledPolicy policy;                        // options.policy, compiled
+					std::unique_ptr<VerifiedTokenCache> cache;    // Null when disabled
+					std::atomic<const KeyHandleCache *> keys {nullptr};    // Copied on write (owned by the Impl)
+			};
+
+			// Read-side section over the current snapshot (no-op when not thread-safe)
+			class SnapshotReader
+			{
+				public:
+					explicit SnapshotReader (const Impl &impl) noexcept
+					    : domain_ (impl.threadSafe_ ? &impl.epoch_ : nullptr)
+					    , slot_ (domain_ != nullptr ? domain_->enter() : 0)
+					    , snapshot_ (impl.snapshot_.load (impl.threadSafe_ ? std::memory_order_seq_cst
+					                                                        : std::memory_order_relaxed))
+					{
+					}
+
+					~SnapshotReader ()
+					{
+						if (domain_ != nullptr)
+						{
+							domain_->leave (slot_);
+						}
+					}
+
+					SnapshotReader (const SnapshotReader &)            = delete;
+					SnapshotReader &operator= (const SnapshotReader &) = delete;
+
+					const Snapshot *operator->() const noexcept
+					{
+						return snapshot_;
+					}
+
+					const Snapshot &operator* () const noexcept
+					{
+						return *snapshot_;
+					}
+
+					// Published key map: valid until the reader leaves
+					const KeyHandleCache &keys () const noexcept
+					{
+						return *snapshot_->keys.load (std::memory_order_seq_cst);
+					}
+
+				private:
+					EpochDomain *domain_;
+					EpochDomain::Slot slot_;
+					const Snapshot *snapshot_;
+			};
+
+			Impl (ICryptoProvider &cryptoProvider, IJsonProvider &jsonProvider, EngineOptions options)
+			    : crypto_ (cryptoProvider)
+			    , json_ (jsonProvider)
+			    , threadSafe_ (options.threadSafe)
+			    , keys_ (std::make_unique<KeyHandleCache>())
+			{
+				auto snapshot = makeSnapshot (std::move (options));
+				snapshot->keys.store (keys_.get());
+				snapshot_.store (snapshot.release());
+			}
+
+			~Impl ()
+			{
+				delete snapshot_.load (std::memory_order_relaxed);
+			}
+
+			Impl (const Impl &)            = delete;
+			Impl &operator= (const Impl &) = delete;
+
+			std::unique_ptr<Snapshot> makeSnapshot (EngineOptions options) const
+			{
+				options.threadSafe = threadSafe_;    // Fixed at construction
+
+				auto snapshot     = std::make_unique<Snapshot>();
+				snapshot->options = std::move (options);
+				snapshot->policy  = compilePolicy (snapshot->options.policy);
+				if (snapshot->options.verifiedCacheCapacity > 0)
+				{
+					snapshot->cache =
+					    std::make_unique<VerifiedTokenCache> (snapshot->options.verifiedCacheCapacity, threadSafe_);
+				}
+				return snapshot;
+			}
+
+			void setOptions (EngineOptions options)
+			{
+				auto next = makeSnapshot (std::move (options));
+
+				std::unique_lock<std::mutex> lock (writer_mutex_, std::defer_lock);
+				if (threadSafe_)
+				{
+					lock.lock();
+				}
+
+				next->keys.store (keys_.get());    // Resolved handles outlive an options change
+				Snapshot *previous = snapshot_.exchange (next.release(), std::memory_order_seq_cst);
+				if (threadSafe_)
+				{
+					// Verifications that loaded the previous snapshot keep it alive until they finish
+					epoch_.synchronize();
+				}
+				delete previous;
+				retiredKeys_.clear();
+			}
+
+			// Key operations are serialized with each other (the provider may still be read concurrently)
+			template <typename Operation>
+			Error changeKey (std::string_view kid, Operation &&operation)
+			{
+				std::unique_lock<std::mutex> lock (writer_mutex_, std::defer_lock);
+				if (threadSafe_)
+				{
+					lock.lock();
+				}
+
+				Error result = operation();
+
+				// Retire the handles of the kid even on failure: the provider may have dropped the old key
+				auto keys = std::make_unique<KeyHandleCache> (*keys_);
+				keys->purgeKid (kid);
+				publishKeys (std::move (keys));
+
+				// A key changed (or disappeared): cached results verified with it are no longer trusted, purged
+				// in the same cases as the handles
+				const Snapshot &snapshot = *snapshot_.load (std::memory_order_relaxed);
+				if (snapshot.cache)
+				{
+					snapshot.cache->purgeKid (kid);
+				}
+
+				if (!retiredKeys_.empty())
+				{
+					epoch_.synchronize();
+					retiredKeys_.clear();
+				}
+				return result;
+			}
+
+			/**
+			 * Publish a copy of the key map holding `key` (the previous map is freed by the next key or
+			 * options change, once no verification reads it).
+			 * @param observedGeneration `generation()` of the map read before the handle was resolved: if a
+			 * purge happened since, the handle is retired and not stored.
+			 * @param wait False inside a read section: a busy writer may be waiting for that section to end,
+			 * so the handle is then left out (it is resolved again next time).
+			 * @return True if the handle was stored.
+			 */
+			bool insertKey (std::shared_ptr<const KeyHandle> key, uint64_t observedGeneration, bool wait) const
+			{
+				std::unique_lock<std::mutex> lock (writer_mutex_, std::defer_lock);
+				if (threadSafe_)
+				{
+					if (wait)
+					{
+						lock.lock();
+					}
+					else if (!lock.try_lock())
+					{
+						return false;
+					}
+				}
+
+				if (keys_->generation() != observedGeneration)
+				{
+					KeyHandleCache::retire (*key);
+					return false;
+				}
+
+				auto keys = std::make_unique<KeyHandleCache> (*keys_);
+				keys->insert (std::move (key));
+				publishKeys (std::move (keys));
+				return true;
+			}
+
+			// Swap the key map of the current snapshot (writer lock held)
+			void publishKeys (std::unique_ptr<const KeyHandleCache> keys) const
+			{
+				snapshot_.load (std::memory_order_relaxed)->keys.store (keys.get(), std::memory_order_seq_cst);
+				std::unique_ptr<const KeyHandleCache> previous = std::exchange (keys_, std::move (keys));
+				if (threadSafe_)
+				{
+					retiredKeys_.push_back (std::move (previous));
+				}
+			}
+
+			/**
+			 * Run `operation` with the key handle of (kid, alg): the cached one, else one resolved by the provider.
+			 * A resolved handle is cached only once it has signed or verified successfully, so tokens
+			 * naming made-up kids cannot fill the cache.
+			 */
+			template <typename Operation>
+			Error withKey (std::string_view kid, JwtAlg alg, Operation &&operation) const
+			{
+				const SnapshotReader snapshot (*this);
+				if (const KeyHandle *key = snapshot.keys().find (kid, alg))
+				{
+					return operation (*key);
+				}
+
+				const uint64_t generation = snapshot.keys().generation();
+				std::shared_ptr<const KeyHandle> key;
+				if (auto error = crypto_.resolveKey (kid, alg, key); !isOk (error))
+				{
+					return error;
+				}
+				if (!key)
+				{
+					return makeError (ErrorCode::KeyNotFound, "Key not found");
+				}
+
+				Error result = operation (*key);
+				if (isOk (result))
+				{
+					insertKey (std::move (key), generation, false);
+				}
+				return result;
+			}
+
+			Error verifySignature (JwtAlg alg, std::string_view kid, std::span<const uint8_t> data,
+			                       std::span<const uint8_t> signature,
+			                       std::span<const std::shared_ptr<const KeyHandle>> pinned = {}) const
+			{
+				StageScope span (TraceStage::JwtSignature);
+				for (const std::shared_ptr<const KeyHandle> &key : pinned)
+				{
+					// Resolved ahead for a compiled policy; once retired, the engine cache has the new key
+					if (key && key->alg() == alg && key->kid() == kid && !key->retired())
+					{
+						return crypto_.verifyWith (*key, data, signature);
+					}
+				}
+				return withKey (kid, alg,
+				                [&] (const KeyHandle &key)
+				                {
+					                return crypto_.verifyWith (key, data, signature);
+				                });
+			}
+
+			// Result of the first verification phase, when the token still needs its signature checked
+			struct PendingSignature
+			{
+					JwtAlg alg = JwtAlg::HS256;
+					std::string_view kid;                     // View into the verifier header
+					std::span<const uint8_t> signingInput;    // "header.payload" prefix of the token
+					std::span<const uint8_t> signature;       // Decoded into the verifier scratch buffer
+					uint64_t cacheGeneration = 0;
+			};
+
+			// Decode and check the token up to the signature; false if `out` already holds the outcome
+			bool prepare (const Snapshot &snapshot, const CompiledPolicy &compiled, int64_t now, std::string_view token,
+			              Verifier &out, TokenStorage storage, PendingSignature &pending) const;
+
+			// Apply the signature result and the policy, caching the verified token
+			Error finish (const Snapshot &snapshot, const CompiledPolicy &compiled, int64_t now, std::string_view token,
+			              Verifier &out, const PendingSignature &pending, Error signatureResult) const;
+
+			ICryptoProvider &crypto_;
+			IJsonProvider &json_;
+			const bool threadSafe_;
+			std::atomic<Snapshot *> snapshot_ {nullptr};
+			mutable EpochDomain epoch_;
+			mutable std::mutex writer_mutex_;
+			mutable std::unique_ptr<const KeyHandleCache> keys_;    // Published in the snapshot (writer lock)
+			mutable std::vector<std::unique_ptr<const KeyHandleCache>> retiredKeys_;    // Replaced maps still read
+	};
+
+	class Verifier::Impl
+	{
+		public:
+			explicit Impl (std::pmr::memory_resource &memory)
+			    : ownedToken_ (&memory)
+			    , json_ (&memory)
+			{
+			}
+
+			// Clear the previous result, keeping the buffers (and their memory resource)
+			void reset () noexcept
+			{
+				ok_    = false;
+				error_ = {};
+				borrowedToken_ = {};
+				borrowed_      = false;
+				ownedToken_.clear();
+				json_.clear();
+				headerSize_ = 0;
+				header_.clear();
+				claims_.clear();
+				slots_ = {};
+			}
+
+			Error fail (Error error)
+			{
+				ok_    = false;
+				error_ = std::move (error);
+				return error_;
+			}
+
+			// Views are rebuilt on access, so copies of the Impl never point into another instance
+			std::string_view token () const noexcept
+			{
+				return borrowed_ ? borrowedToken_ : std::string_view (ownedToken_);
+			}
+
+			std::string_view headerJson () const noexcept
+			{
+				return std::string_view (json_).substr (0, headerSize_);
+			}
+
+			std::string_view payloadJson () const noexcept
+			{
+				return std::string_view (json_).substr (headerSize_);
+			}
+
+			// Decode a base64url part through `scratch_` and append it to the JSON buffer
+			Error appendDecoded (const ICryptoProvider &crypto, std::string_view part)
+			{
+				if (auto error = crypto.base64UrlDecode (part, scratch_); !isOk (error))
+				{
+					return error;
+				}
+				json_.append (reinterpret_cast<const char *> (scratch_.data()), scratch_.size());
+				return makeError (ErrorCode::Ok);
+			}
+
+			bool ok_ = false;
+			Error error_;
+			bool borrowed_ = false;
+			std::string_view borrowedToken_;
+			std::pmr::string ownedToken_;
+			std::pmr::string json_;    // Header JSON followed by payload JSON
+			size_t headerSize_ = 0;
+			ByteBuffer scratch_;       // Decode buffer (holds the signature once verified)
+			HeaderMap header_;
+			ClaimMap claims_;
+			ClaimSlots slots_;
+	};
+
+	bool Jwt::Impl::prepare (const Snapshot &snapshot, const CompiledPolicy &compiled, int64_t now,
+	                         std::string_view token, Verifier &out, TokenStorage storage,
+	                         PendingSignature &pending) const
+	{
+		if (!out.impl_)
+		{
+			out = Verifier {};
+		}
+
+		Verifier::Impl &result = *out.impl_;
+		result.reset();
+
+		const Policy &policy = compiled.policy;
+		if (snapshot.cache && snapshot.cache->lookup (token, now, out))
+		{
+			// The signature was checked when cached (maybe under another policy); the rest is checked again
+			if (storage == TokenStorage::Borrow)
+			{
+				result.ownedToken_.clear();
+				result.borrowed_      = true;
+				result.borrowedToken_ = token;
+			}
+			if (auto error = checkKey (compiled, result.header_); !isOk (error))
+			{
+				result.fail (std::move (error));
+			}
+			else if (auto error = validatePolicy (policy, result.claims_, result.slots_, now); !isOk (error))
+			{
+				result.fail (std::move (error));
+			}
+			return false;
+		}
+
+		if (storage == TokenStorage::Borrow)
+		{
+			result.borrowed_      = true;
+			result.borrowedToken_ = token;
+		}
+		else
+		{
+			result.ownedToken_.assign (token);
+		}
+
+		const auto firstDot = token.find ('.');
+		if (firstDot == std::string_view::npos)
+		{
+			result.fail (makeError (ErrorCode::InvalidFormat, "Token must contain 3 parts"));
+			return false;
+		}
+
+		const auto secondDot = token.find ('.', firstDot + 1);
+		if (secondDot == std::string_view::npos || token.find ('.', secondDot + 1) != std::string_view::npos)
+		{
+			result.fail (makeError (ErrorCode::InvalidFormat, "Token must contain exactly 3 parts"));
+			return false;
+		}
+
+		const std::string_view headerPart    = token.substr (0, firstDot);
+		const std::string_view payloadPart   = token.substr (firstDot + 1, secondDot - firstDot - 1);
+		const std::string_view signaturePart = token.substr (secondDot + 1);
+
+		StageScope decodeSpan (TraceStage::JwtDecode);
+		if (auto error = result.appendDecoded (crypto_, headerPart); !isOk (error))
+		{
+			result.fail (std::move (error));
+			return false;
+		}
+		result.headerSize_ = result.json_.size();
+
+		if (auto error = result.appendDecoded (crypto_, payloadPart); !isOk (error))
+		{
+			result.fail (std::move (error));
+			return false;
+		}
+
+		if (auto error = crypto_.base64UrlDecode (signaturePart, result.scratch_); !isOk (error))
+		{
+			result.fail (std::move (error));
+			return false;
+		}
+		decodeSpan.end();
+
+		StageScope parseSpan (TraceStage::JwtParse);
+
+		if (auto error = json_.parseHeader (result.headerJson(), result.header_); !isOk (error))
+		{
+			result.fail (std::move (error));
+			return false;
+		}
+
+		if (auto error = json_.parseClaims (result.payloadJson(), result.claims_); !isOk (error))
+		{
+			result.fail (std::move (error));
+			return false;
+		}
+		result.slots_.build (result.claims_);
+		parseSpan.end();
+
+		auto algText = getStringValue (result.header_, "alg");
+		if (!algText.has_value())
+		{
+			result.fail (makeError (ErrorCode::UnsupportedAlg, "Missing alg header"));
+			return false;
+		}
+
+		auto alg = fromAlgString (algText.value());
+		if (!alg.has_value())
+		{
+			result.fail (makeError (ErrorCode::UnsupportedAlg, "Unknown algorithm"));
+			return false;
+		}
+
+		if (!allowsAlg (compiled, alg.value()))
+		{
+			result.fail (makeError (ErrorCode::UnsupportedAlg, "Algorithm not allowed by policy"));
+			return false;
+		}
+
+		auto kidText = getStringValue (result.header_, "kid");
+		if (!kidText.has_value())
+		{
+			result.fail (makeError (ErrorCode::KeyNotFound, "Missing kid header"));
+			return false;
+		}
+
+		if (!compiled.kid.empty() && kidText.value() != compiled.kid)
+		{
+			result.fail (makeError (ErrorCode::KeyNotFound, "kid does not match the policy key"));
+			return false;
+		}
+
+		pending.alg          = alg.value();
+		pending.kid          = kidText.value();
+		pending.signingInput = asBytes (token.substr (0, secondDot));    // "header.payload"
+		pending.signature    = result.scratch_;
+
+		// Observed before the signature check: a key change in between keeps the result out of the cache
+		pending.cacheGeneration = snapshot.cache ? snapshot.cache->generation() : 0;
+		return true;
+	}
+
+	Error Jwt::Impl::finish (const Snapshot &snapshot, const CompiledPolicy &compiled, int64_t now,
+	                         std::string_view token, Verifier &out, const PendingSignature &pending,
+	                         Error signatureResult) const
+	{
+		Verifier::Impl &result = *out.impl_;
+
+		if (!isOk (signatureResult))
+		{
+			if (signatureResult.code == ErrorCode::KeyNotFound && snapshot.options.onUnknownKid)
+			{
+				snapshot.options.onUnknownKid (pending.kid);
+			}
+			return result.fail (std::move (signatureResult));
+		}
+
+		const Policy &policy = compiled.policy;
+		if (auto error = validatePolicy (policy, result.claims_, result.slots_, now); !isOk (error))
+		{
+			return result.fail (std::move (error));
+		}
+
+		result.ok_    = true;
+		result.error_ = makeError (ErrorCode::Ok);
+
+		if (snapshot.cache)
+		{
+			std::optional<int64_t> expiresAt;
+			if (auto exp = asInt (result.slots_.get (result.claims_, RegisteredClaim::Exp)); exp.has_value())
+			{
+				expiresAt = addSaturated (exp.value(), policy.leewaySeconds);
 			}
 
-			if (policy.requireNbf)
+			// The cached copy always owns its token
+			Verifier cached = out;
+			if (cached.impl_->borrowed_)
 			{
-				auto nbf = getIntValue (claims, "nbf");
-				if (!nbf.has_value())
-				{
-					return makeError (ErrorCode::PolicyViolation, "nbf claim is required by policy");
-				}
-				if (now + policy.leewaySeconds < nbf.value())
-				{
-					return makeError (ErrorCode::NotYetValid, "Token not valid yet");
-				}
+				cached.impl_->ownedToken_.assign (token);
+				cached.impl_->borrowed_      = false;
+				cached.impl_->borrowedToken_ = {};
 			}
+			snapshot.cache->insert (token, pending.kid, expiresAt, std::move (cached), pending.cacheGeneration);
+		}
+		return result.error_;
+	}
 
-			return makeError (ErrorCode::Ok);
+	/**
+	 * @brief Compile a policy for repeated verifications.
+	 * @param policy The policy (its allowedAlgs become the algorithm mask).
+	 * @param kid The key every token must name (empty: any key known to the provider).
+	 * @return The compiled policy, for `Jwt::verify (token, verifier, policy, now)`.
+	 */
+	CompiledPolicy compilePolicy (Policy policy, std::string kid)
+	{
+		uint8_t mask = policy.allowedAlgs.empty() ? uint8_t {0xFF} : uint8_t {0};
+		for (JwtAlg alg : policy.allowedAlgs)
+		{
+			mask |= algBit (alg);
 		}
+		return CompiledPolicy {.policy = std::move (policy), .algMask = mask, .kid = std::move (kid), .keys = {}};
+	}
 
-	}    // namespace
+	KeyHandle::KeyHandle (std::string kid, JwtAlg alg)
+	    : kid_ (std::move (kid))
+	    , alg_ (alg)
+	{
+	}
 
-	class Jwt::Impl
+	// Default key handle: kid and algorithm only (signWith / verifyWith fall back to the lookup by kid)
+	Error ICryptoProvider::resolveKey (std::string_view kid, JwtAlg alg, std::shared_ptr<const KeyHandle> &outKey) const
 	{
-		public:
-			Impl (ICryptoProvider &cryptoProvider, IJsonProvider &jsonProvider, EngineOptions options)
-			    : crypto_ (cryptoProvider)
-			    , json_ (jsonProvider)
-			    , options_ (std::move (options))
-			{
-			}
+		outKey = std::make_shared<const KeyHandle> (std::string (kid), alg);
+		return makeError (ErrorCode::Ok);
+	}
 
-			ICryptoProvider &crypto_;
-			IJsonProvider &json_;
-			EngineOptions options_;
-	};
+	Error ICryptoProvider::signWith (const KeyHandle &key, std::span<const uint8_t> data, ByteBuffer &outSignature) const
+	{
+		return sign (key.alg(), key.kid(), data, outSignature);
+	}
 
-	class Verifier::Impl
+	Error ICryptoProvider::verifyWith (const KeyHandle &key, std::span<const uint8_t> data,
+	                                   std::span<const uint8_t> signature) const
 	{
-		public:
-			bool ok_ = false;
-			Error error_;
-			std::string rawToken_;
-			std::string rawHeaderJson_;
-			std::string rawPayloadJson_;
-			HeaderMap header_;
-			ClaimMap claims_;
-	};
+		return verify (key.alg(), key.kid(), data, signature);
+	}
+
+	Error ICryptoProvider::loadPublicKeyFromJwk ([[maybe_unused]] std::string_view kid,
+	                                             [[maybe_unused]] std::string_view jwkJson, [[maybe_unused]] JwtUse use)
+	{
+		return makeError (ErrorCode::CryptoError, "JWK keys are not supported by this crypto provider");
+	}
+
+	Error IJsonProvider::parseJwks ([[maybe_unused]] std::string_view text,
+	                                [[maybe_unused]] std::vector<JwkEntry> &outKeys) const
+	{
+		return makeError (ErrorCode::JsonError, "JWKS documents are not supported by this JSON provider");
+	}
+
+	Error ICryptoProvider::base64UrlEncode (std::span<const uint8_t> data, std::string &outText) const
+	{
+		outText.resize (base64url::encodedSize (data.size()));
+		base64url::encode (data, std::span<char> (outText.data(), outText.size()));
+		return makeError (ErrorCode::Ok);
+	}
+
+	Error ICryptoProvider::base64UrlDecode (std::string_view text, ByteBuffer &outData) const
+	{
+		outData.resize (base64url::decodedSize (text.size()));
+		if (!base64url::decode (text, outData).has_value())
+		{
+			outData.clear();
+			return makeError (ErrorCode::InvalidBase64Url, "Invalid Base64URL text");
+		}
+		return makeError (ErrorCode::Ok);
+	}
+
+	// Default batch verification: one single-token check per entry
+	void ICryptoProvider::verifyBatch (const KeyHandle &key, std::span<const SignatureCheck> checks,
+	                                   std::span<Error> outResults) const
+	{
+		for (size_t i = 0; i < checks.size() && i < outResults.size(); ++i)
+		{
+			outResults [i] = verifyWith (key, checks [i].data, checks [i].signature);
+		}
+	}
 
 	Verifier::Verifier ()
-	    : impl_ (std::make_unique<Impl>())
+	    : impl_ (std::make_unique<Impl> (*std::pmr::get_default_resource()))
+	{
+	}
+
+	Verifier::Verifier (std::pmr::memory_resource &memory)
+	    : impl_ (std::make_unique<Impl> (memory))
 	{
 	}
 
@@ -234,17 +1019,17 @@ namespace ipb::http::jwt
 
 	std::string_view Verifier::rawToken () const noexcept
 	{
-		return impl_->rawToken_;
+		return impl_->token();
 	}
 
 	std::string_view Verifier::rawHeaderJson () const noexcept
 	{
-		return impl_->rawHeaderJson_;
+		return impl_->headerJson();
 	}
 
 	std::string_view Verifier::rawPayloadJson () const noexcept
 	{
-		return impl_->rawPayloadJson_;
+		return impl_->payloadJson();
 	}
 
 	const HeaderMap &Verifier::header () const noexcept
@@ -257,39 +1042,86 @@ namespace ipb::http::jwt
 		return impl_->claims_;
 	}
 
+	std::optional<std::string_view> Verifier::issuer () const noexcept
+	{
+		return asString (impl_->slots_.get (impl_->claims_, RegisteredClaim::Iss));
+	}
+
+	std::optional<std::string_view> Verifier::subject () const noexcept
+	{
+		return asString (impl_->slots_.get (impl_->claims_, RegisteredClaim::Sub));
+	}
+
+	std::optional<std::string_view> Verifier::audience () const noexcept
+	{
+		const ClaimValue *value = impl_->slots_.get (impl_->claims_, RegisteredClaim::Aud);
+		if (const auto *list = value != nullptr ? std::get_if<ClaimStrings> (value) : nullptr)
+		{
+			return list->size() == 1 ? std::optional<std::string_view> (list->front()) : std::nullopt;
+		}
+		return asString (value);
+	}
+
+	std::optional<std::string_view> Verifier::jwtId () const noexcept
+	{
+		return asString (impl_->slots_.get (impl_->claims_, RegisteredClaim::Jti));
+	}
+
+	std::optional<int64_t> Verifier::expiresAt () const noexcept
+	{
+		return asInt (impl_->slots_.get (impl_->claims_, RegisteredClaim::Exp));
+	}
+
+	std::optional<int64_t> Verifier::notBefore () const noexcept
+	{
+		return asInt (impl_->slots_.get (impl_->claims_, RegisteredClaim::Nbf));
+	}
+
+	std::optional<int64_t> Verifier::issuedAt () const noexcept
+	{
+		return asInt (impl_->slots_.get (impl_->claims_, RegisteredClaim::Iat));
+	}
+
+	const ClaimValue *Verifier::claim (std::string_view name) const noexcept
+	{
+		return findClaim (impl_->claims_, impl_->slots_, name);
+	}
+
+	std::optional<std::string_view> Verifier::claimView (std::string_view name) const noexcept
+	{
+		return asString (claim (name));
+	}
+
 	bool Verifier::hasClaim (std::string_view name) const noexcept
 	{
-		return impl_->claims_.find (std::string (name)) != impl_->claims_.end();
+		return claim (name) != nullptr;
 	}
 
 	std::optional<std::string> Verifier::claimString (std::string_view name) const
 	{
-		if (auto it = impl_->claims_.find (std::string (name)); it != impl_->claims_.end())
+		if (auto value = claimView (name); value.has_value())
 		{
-			if (const auto *value = std::get_if<std::string> (&it->second))
-			{
-				return *value;
-			}
+			return std::string (value.value());
 		}
 		return std::nullopt;
 	}
 
 	std::optional<int64_t> Verifier::claimInt (std::string_view name) const
 	{
-		return getIntValue (impl_->claims_, name);
+		return asInt (claim (name));
 	}
 
 	std::optional<double> Verifier::claimDouble (std::string_view name) const
 	{
-		if (auto it = impl_->claims_.find (std::string (name)); it != impl_->claims_.end())
+		if (const ClaimValue *value = claim (name))
 		{
-			if (const auto *value = std::get_if<double> (&it->second))
+			if (const auto *number = std::get_if<double> (value))
 			{
-				return *value;
+				return *number;
 			}
-			if (const auto *intValue = std::get_if<int64_t> (&it->second))
+			if (const auto *number = std::get_if<int64_t> (value))
 			{
-				return static_cast<double> (*intValue);
+				return static_cast<double> (*number);
 			}
 		}
 		return std::nullopt;
@@ -297,11 +1129,11 @@ namespace ipb::http::jwt
 
 	std::optional<bool> Verifier::claimBool (std::string_view name) const
 	{
-		if (auto it = impl_->claims_.find (std::string (name)); it != impl_->claims_.end())
+		if (const ClaimValue *value = claim (name))
 		{
-			if (const auto *value = std::get_if<bool> (&it->second))
+			if (const auto *flag = std::get_if<bool> (value))
 			{
-				return *value;
+				return *flag;
 			}
 		}
 		return std::nullopt;
@@ -383,6 +1215,11 @@ namespace ipb::http::jwt
 		return claim ("aud", std::move (value));
 	}
 
+	TokenBuilder &TokenBuilder::audience (ClaimStrings values)
+	{
+		return claim ("aud", ClaimValue {std::move (values)});
+	}
+
 	TokenBuilder &TokenBuilder::jwtId (std::string value)
 	{
 		return claim ("jti", std::move (value));
@@ -423,46 +1260,44 @@ namespace ipb::http::jwt
 			return makeError (ErrorCode::KeyNotFound, "Missing kid in token header");
 		}
 
-		std::string headerJson;
-		if (auto error = jwt_.json().toJson (header_, headerJson); !isOk (error))
+		SignScratch &scratch = t_sign_scratch;
+
+		if (auto error = jwt_.json().toJson (header_, scratch.headerJson); !isOk (error))
 		{
 			return error;
 		}
 
-		std::string payloadJson;
-		if (auto error = jwt_.json().toJson (claims_, payloadJson); !isOk (error))
+		if (auto error = jwt_.json().toJson (claims_, scratch.payloadJson); !isOk (error))
 		{
 			return error;
 		}
 
-		std::string headerB64;
-		if (auto error = jwt_.crypto().base64UrlEncode (asBytes (headerJson), headerB64); !isOk (error))
+		if (auto error = jwt_.crypto().base64UrlEncode (asBytes (scratch.headerJson), scratch.headerB64); !isOk (error))
 		{
 			return error;
 		}
 
-		std::string payloadB64;
-		if (auto error = jwt_.crypto().base64UrlEncode (asBytes (payloadJson), payloadB64); !isOk (error))
+		if (auto error = jwt_.crypto().base64UrlEncode (asBytes (scratch.payloadJson), scratch.payloadB64);
+		    !isOk (error))
 		{
 			return error;
 		}
 
-		const std::string signingInput = headerB64 + "." + payloadB64;
+		scratch.signingInput.assign (scratch.headerB64).append (1, '.').append (scratch.payloadB64);
 
-		ByteBuffer signature;
-		if (auto error = jwt_.crypto().sign (alg.value(), kidText.value(), asBytes (signingInput), signature);
+		if (auto error = jwt_.sign (alg.value(), kidText.value(), asBytes (scratch.signingInput), scratch.signature);
 		    !isOk (error))
 		{
 			return error;
 		}
 
-		std::string signatureB64;
-		if (auto error = jwt_.crypto().base64UrlEncode (signature, signatureB64); !isOk (error))
+		if (auto error = jwt_.crypto().base64UrlEncode (scratch.signature, scratch.signatureB64); !isOk (error))
 		{
 			return error;
 		}
 
-		outToken = signingInput + "." + signatureB64;
+		outToken.reserve (scratch.signingInput.size() + 1 + scratch.signatureB64.size());
+		outToken.assign (scratch.signingInput).append (1, '.').append (scratch.signatureB64);
 		return makeError (ErrorCode::Ok);
 	}
 
@@ -481,6 +1316,171 @@ namespace ipb::http::jwt
 		claims_.clear();
 	}
 
+	SigningTemplate::SigningTemplate (const Jwt &jwt, JwtAlg alg, std::string kid, const ClaimMap &fixedClaims,
+	                                  std::string type)
+	    : jwt_ (jwt)
+	    , alg_ (alg)
+	    , kid_ (std::move (kid))
+	{
+		std::string algText = toAlgString (alg);
+		if (algText.empty())
+		{
+			error_ = makeError (ErrorCode::UnsupportedAlg, "Unsupported algorithm in signing template");
+			return;
+		}
+
+		HeaderMap header;
+		header ["alg"] = std::move (algText);
+		header ["typ"] = std::move (type);
+		header ["kid"] = kid_;
+
+		std::string json;
+		if (error_ = jwt_.json().toJson (header, json); !isOk (error_))
+		{
+			return;
+		}
+		if (error_ = jwt_.crypto().base64UrlEncode (asBytes (json), headerSegment_); !isOk (error_))
+		{
+			return;
+		}
+		headerSegment_.push_back ('.');
+
+		if (error_ = jwt_.json().toJson (fixedClaims, json); !isOk (error_))
+		{
+			return;
+		}
+		if (json.size() < 2 || json.front() != '{' || json.back() != '}')
+		{
+			error_ = makeError (ErrorCode::JsonError, "Fixed claims are not serialized as a JSON object");
+			return;
+		}
+		fixedMembers_.assign (json, 1, json.size() - 2);
+
+		for (size_t i = 0; i < kSigningClaimNames.size(); ++i)
+		{
+			if (fixedClaims.contains (kSigningClaimNames [i]))
+			{
+				fixedVariableClaims_ |= static_cast<uint8_t> (1u << i);
+			}
+		}
+
+		// Pinned for sign(); an unknown kid is not an error here (the key may be loaded later)
+		if (!isOk (jwt_.resolveKey (kid_, alg_, key_)))
+		{
+			key_.reset();
+		}
+	}
+
+	const Error &SigningTemplate::error () const noexcept
+	{
+		return error_;
+	}
+
+	std::string_view SigningTemplate::headerSegment () const noexcept
+	{
+		return headerSegment_;
+	}
+
+	Error SigningTemplate::sign (const SigningClaims &claims, std::string &outToken) const
+	{
+		if (!isOk (error_))
+		{
+			return error_;
+		}
+
+		char expText [24];
+		char iatText [24];
+		size_t expSize = 0;
+		size_t iatSize = 0;
+		if (claims.expiresAt.has_value())
+		{
+			expSize = static_cast<size_t> (std::to_chars (expText, expText + 24, *claims.expiresAt).ptr - expText);
+		}
+		if (claims.issuedAt.has_value())
+		{
+			iatSize = static_cast<size_t> (std::to_chars (iatText, iatText + 24, *claims.issuedAt).ptr - iatText);
+		}
+
+		// Same order as kSigningClaimNames
+		const std::array<bool, 4> present = {!claims.subject.empty(), claims.expiresAt.has_value(),
+		                                     claims.issuedAt.has_value(), !claims.jwtId.empty()};
+		const std::array<size_t, 4> valueSizes = {present [0] ? jsontext::escapedSize (claims.subject) : 0, expSize,
+		                                          iatSize, present [3] ? jsontext::escapedSize (claims.jwtId) : 0};
+
+		size_t payloadSize = 2 + fixedMembers_.size();
+		size_t members     = fixedMembers_.empty() ? 0 : 1;
+		for (size_t i = 0; i < present.size(); ++i)
+		{
+			if (!present [i])
+			{
+				continue;
+			}
+			if ((fixedVariableClaims_ & (1u << i)) != 0)
+			{
+				return makeError (ErrorCode::JsonError, "Claim is already one of the fixed claims");
+			}
+			payloadSize += 6 + valueSizes [i] + (members++ > 0 ? 1 : 0);    // "xxx": and the comma
+		}
+
+		SignScratch &scratch = t_sign_scratch;
+		std::string &payload = scratch.payloadJson;
+		payload.clear();
+		payload.reserve (payloadSize);
+		payload.push_back ('{');
+		payload.append (fixedMembers_);
+		if (present [0])
+		{
+			appendMemberName (payload, kSigningClaimNames [0]);
+			jsontext::appendEscaped (payload, claims.subject);
+		}
+		if (present [1])
+		{
+			appendMemberName (payload, kSigningClaimNames [1]);
+			payload.append (expText, expSize);
+		}
+		if (present [2])
+		{
+			appendMemberName (payload, kSigningClaimNames [2]);
+			payload.append (iatText, iatSize);
+		}
+		if (present [3])
+		{
+			appendMemberName (payload, kSigningClaimNames [3]);
+			jsontext::appendEscaped (payload, claims.jwtId);
+		}
+		payload.push_back ('}');
+
+		if (auto error = jwt_.crypto().base64UrlEncode (asBytes (payload), scratch.payloadB64); !isOk (error))
+		{
+			return error;
+		}
+
+		// The signing input is built in place: the signature is appended to it
+		outToken.clear();
+		outToken.reserve (headerSegment_.size() + scratch.payloadB64.size() + 1 +
+		                  base64url::encodedSize (signatureSizeHint (alg_)));
+		outToken.append (headerSegment_).append (scratch.payloadB64);
+
+		// The pinned handle skips the key lookup until a key operation on the kid retires it
+		Error signResult = key_ && !key_->retired()
+		                       ? jwt_.crypto().signWith (*key_, asBytes (outToken), scratch.signature)
+		                       : jwt_.sign (alg_, kid_, asBytes (outToken), scratch.signature);
+		if (!isOk (signResult))
+		{
+			outToken.clear();
+			return signResult;
+		}
+
+		if (auto error = jwt_.crypto().base64UrlEncode (scratch.signature, scratch.signatureB64); !isOk (error))
+		{
+			outToken.clear();
+			return error;
+		}
+
+		outToken.append (1, '.').append (scratch.signatureB64);
+		return makeError (ErrorCode::Ok);
+	}
+
 	Jwt::Jwt (ICryptoProvider &cryptoProvider, IJsonProvider &jsonProvider, EngineOptions options)
 	    : impl_ (std::make_unique<Impl> (cryptoProvider, jsonProvider, std::move (options)))
 	{
@@ -492,17 +1492,29 @@ namespace ipb::http::jwt
 
 	Error Jwt::loadPrivateKeyFromPemFile (std::string_view kid, std::string_view pemPath)
 	{
-		return impl_->crypto_.loadPrivateKeyFromPemFile (kid, pemPath);
+		return impl_->changeKey (kid,
+		                         [&]
+		                         {
+			                         return impl_->crypto_.loadPrivateKeyFromPemFile (kid, pemPath);
+		                         });
 	}
 
 	Error Jwt::loadPublicKeyFromPemFile (std::string_view kid, std::string_view pemPath, JwtUse use)
 	{
-		return impl_->crypto_.loadPublicKeyFromPemFile (kid, pemPath, use);
+		return impl_->changeKey (kid,
+		                         [&]
+		                         {
+			                         return impl_->crypto_.loadPublicKeyFromPemFile (kid, pemPath, use);
+		                         });
 	}
 
 	Error Jwt::loadCertificateFromPemFile (std::string_view kid, std::string_view pemPath)
 	{
-		return impl_->crypto_.loadCertificateFromPemFile (kid, pemPath);
+		return impl_->changeKey (kid,
+		                         [&]
+		                         {
+			                         return impl_->crypto_.loadCertificateFromPemFile (kid, pemPath);
+		                         });
 	}
 
 	Error Jwt::savePrivateKeyToPemFile (std::string_view kid, std::string_view pemPath)
@@ -517,136 +1529,221 @@ namespace ipb::http::jwt
 
 	Error Jwt::generateKeyPair (std::string_view kid, JwtAlg alg, std::string_view params)
 	{
-		return impl_->crypto_.generateKeyPair (kid, alg, params);
+		return impl_->changeKey (kid,
+		                         [&]
+		                         {
+			                         return impl_->crypto_.generateKeyPair (kid, alg, params);
+		                         });
 	}
 
 	Error Jwt::removeKey (std::string_view kid)
 	{
-		return impl_->crypto_.removeKey (kid);
+		return impl_->changeKey (kid,
+		                         [&]
+		                         {
+			                         return impl_->crypto_.removeKey (kid);
+		                         });
+	}
+
+	Error Jwt::loadPublicKeyFromJwk (std::string_view kid, std::string_view jwkJson, JwtUse use)
+	{
+		return impl_->changeKey (kid,
+		                         [&]
+		                         {
+			                         return impl_->crypto_.loadPublicKeyFromJwk (kid, jwkJson, use);
+		                         });
 	}
 
 	Error Jwt::verify (std::string_view token, Verifier &outVerifier) const
 	{
-		outVerifier                  = Verifier {};
-		outVerifier.impl_->rawToken_ = std::string (token);
+		return verify (token, outVerifier, TokenStorage::Copy);
+	}
 
-		const auto firstDot = token.find ('.');
-		if (firstDot == std::string_view::npos)
-		{
-			outVerifier.impl_->error_ = makeError (ErrorCode::InvalidFormat, "Token must contain 3 parts");
-			return outVerifier.impl_->error_;
-		}
+	Error Jwt::verify (std::string_view token, Verifier &outVerifier, TokenStorage storage) const
+	{
+		const Impl::SnapshotReader snapshot (*impl_);
+		const int64_t now = static_cast<int64_t> (std::time (nullptr));
 
-		const auto secondDot = token.find ('.', firstDot + 1);
-		if (secondDot == std::string_view::npos || token.find ('.', secondDot + 1) != std::string_view::npos)
+		Impl::PendingSignature pending;
+		if (!impl_->prepare (*snapshot, snapshot->policy, now, token, outVerifier, storage, pending))
 		{
-			outVerifier.impl_->error_ = makeError (ErrorCode::InvalidFormat, "Token must contain exactly 3 parts");
 			return outVerifier.impl_->error_;
 		}
 
-		const std::string_view headerPart    = token.substr (0, firstDot);
-		const std::string_view payloadPart   = token.substr (firstDot + 1, secondDot - firstDot - 1);
-		const std::string_view signaturePart = token.substr (secondDot + 1);
+		Error signatureResult = impl_->verifySignature (pending.alg, pending.kid, pending.signingInput, pending.signature);
+		return impl_->finish (*snapshot, snapshot->policy, now, token, outVerifier, pending,
+		                      std::move (signatureResult));
+	}
 
-		ByteBuffer headerBytes;
-		if (auto error = impl_->crypto_.base64UrlDecode (headerPart, headerBytes); !isOk (error))
-		{
-			outVerifier.impl_->error_ = error;
-			return error;
-		}
+	Error Jwt::verify (std::string_view token, Verifier &outVerifier, const CompiledPolicy &policy, int64_t now,
+	                   TokenStorage storage) const
+	{
+		const Impl::SnapshotReader snapshot (*impl_);
 
-		ByteBuffer payloadBytes;
-		if (auto error = impl_->crypto_.base64UrlDecode (payloadPart, payloadBytes); !isOk (error))
+		Impl::PendingSignature pending;
+		if (!impl_->prepare (*snapshot, policy, now, token, outVerifier, storage, pending))
 		{
-			outVerifier.impl_->error_ = error;
-			return error;
+			return outVerifier.impl_->error_;
 		}
 
-		ByteBuffer signatureBytes;
-		if (auto error = impl_->crypto_.base64UrlDecode (signaturePart, signatureBytes); !isOk (error))
+		Error signatureResult = impl_->verifySignature (pending.alg, pending.kid, pending.signingInput, pending.signature,
+		                                                policy.keys);
+		return impl_->finish (*snapshot, policy, now, token, outVerifier, pending, std::move (signatureResult));
+	}
+
+	Error Jwt::verifyBatch (std::span<const std::string_view> tokens, std::span<Verifier> outVerifiers,
+	                        TokenStorage storage) const
+	{
+		if (tokens.size() != outVerifiers.size())
 		{
-			outVerifier.impl_->error_ = error;
-			return error;
+			return makeError (ErrorCode::InvalidFormat, "verifyBatch needs one verifier per token");
 		}
 
-		outVerifier.impl_->rawHeaderJson_ =
-		    std::string (reinterpret_cast<const char *> (headerBytes.data()), headerBytes.size());
-		outVerifier.impl_->rawPayloadJson_ =
-		    std::string (reinterpret_cast<const char *> (payloadBytes.data()), payloadBytes.size());
+		const Impl::SnapshotReader snapshot (*impl_);
+		const int64_t now = static_cast<int64_t> (std::time (nullptr));
 
-		if (auto error = impl_->json_.parseHeader (outVerifier.impl_->rawHeaderJson_, outVerifier.impl_->header_);
-		    !isOk (error))
+		// Tokens that still need a signature check (the others are already resolved)
+		std::vector<Impl::PendingSignature> pending (tokens.size());
+		std::vector<size_t> order;
+		order.reserve (tokens.size());
+		for (size_t i = 0; i < tokens.size(); ++i)
 		{
-			outVerifier.impl_->error_ = error;
-			return error;
+			if (impl_->prepare (*snapshot, snapshot->policy, now, tokens [i], outVerifiers [i], storage, pending [i]))
+			{
+				order.push_back (i);
+			}
 		}
 
-		if (auto error = impl_->json_.parseClaims (outVerifier.impl_->rawPayloadJson_, outVerifier.impl_->claims_);
-		    !isOk (error))
+		// One provider call per (alg, kid) group, so the key is resolved once per group
+		std::sort (order.begin(), order.end(),
+		           [&pending] (size_t lhs, size_t rhs)
+		           {
+			           if (pending [lhs].alg != pending [rhs].alg)
+			           {
+				           return pending [lhs].alg < pending [rhs].alg;
+			           }
+			           return pending [lhs].kid < pending [rhs].kid;
+		           });
+
+		std::vector<SignatureCheck> checks;
+		std::vector<Error> results;
+		for (size_t begin = 0; begin < order.size();)
 		{
-			outVerifier.impl_->error_ = error;
-			return error;
-		}
+			const Impl::PendingSignature &first = pending [order [begin]];
+			size_t end                          = begin + 1;
+			while (end < order.size() && pending [order [end]].alg == first.alg && pending [order [end]].kid == first.kid)
+			{
+				++end;
+			}
 
-		auto algText = getStringValue (outVerifier.impl_->header_, "alg");
-		if (!algText.has_value())
-		{
-			outVerifier.impl_->error_ = makeError (ErrorCode::UnsupportedAlg, "Missing alg header");
-			return outVerifier.impl_->error_;
-		}
+			checks.clear();
+			for (size_t k = begin; k < end; ++k)
+			{
+				const Impl::PendingSignature &item = pending [order [k]];
+				checks.push_back (SignatureCheck {.data = item.signingInput, .signature = item.signature});
+			}
+			results.assign (checks.size(), makeError (ErrorCode::Ok));
+			{
+				StageScope span (TraceStage::JwtSignature);
+				bool checked = false;
+				Error keyResult = impl_->withKey (first.kid, first.alg,
+				                                  [&] (const KeyHandle &key)
+				                                  {
+					                                  impl_->crypto_.verifyBatch (key, checks, results);
+					                                  checked = true;
+
+					                                  // The handle is cached once one signature of the group checks out
+					                                  const auto valid = std::find_if (results.begin(), results.end(),
+					                                                                   [] (const Error &result) { return isOk (result); });
+					                                  return valid != results.end() ? makeError (ErrorCode::Ok) : results.front();
+				                                  });
+				if (!checked)
+				{
+					results.assign (checks.size(), keyResult);
+				}
+			}
 
-		auto alg = fromAlgString (algText.value());
-		if (!alg.has_value())
-		{
-			outVerifier.impl_->error_ = makeError (ErrorCode::UnsupportedAlg, "Unknown algorithm");
-			return outVerifier.impl_->error_;
+			for (size_t k = begin; k < end; ++k)
+			{
+				const size_t index = order [k];
+				impl_->finish (*snapshot, snapshot->policy, now, tokens [index], outVerifiers [index], pending [index],
+				               std::move (results [k - begin]));
+			}
+			begin = end;
 		}
 
-		if (!containsAlg (impl_->options_.policy.allowedAlgs, alg.value()))
-		{
-			outVerifier.impl_->error_ = makeError (ErrorCode::UnsupportedAlg, "Algorithm not allowed by policy");
-			return outVerifier.impl_->error_;
-		}
+		return makeError (ErrorCode::Ok);
+	}
 
-		auto kidText = getStringValue (outVerifier.impl_->header_, "kid");
-		if (!kidText.has_value())
+	TokenBuilder Jwt::token () const
+	{
+		return TokenBuilder (*this);
+	}
+
+	/**
+	 * @brief Get the key handle of a kid, resolving it on a cache miss.
+	 * @param kid The key id.
+	 * @param alg The algorithm the handle is used with.
+	 * @param outKey The handle (null on error).
+	 * @return Ok, or the error of the provider.
+	 */
+	Error Jwt::resolveKey (std::string_view kid, JwtAlg alg, std::shared_ptr<const KeyHandle> &outKey) const
+	{
+		uint64_t generation = 0;
 		{
-			outVerifier.impl_->error_ = makeError (ErrorCode::KeyNotFound, "Missing kid header");
-			return outVerifier.impl_->error_;
+			const Impl::SnapshotReader snapshot (*impl_);
+			outKey = snapshot.keys().share (kid, alg);
+			if (outKey)
+			{
+				return makeError (ErrorCode::Ok);
+			}
+			generation = snapshot.keys().generation();
 		}
 
-		const std::string signingInput = std::string (headerPart) + "." + std::string (payloadPart);
-		if (auto error = impl_->crypto_.verify (alg.value(), kidText.value(), asBytes (signingInput), signatureBytes);
-		    !isOk (error))
+		if (auto error = impl_->crypto_.resolveKey (kid, alg, outKey); !isOk (error))
 		{
-			outVerifier.impl_->error_ = error;
+			outKey.reset();
 			return error;
 		}
-
-		if (auto error = validatePolicy (impl_->options_.policy, outVerifier.impl_->claims_); !isOk (error))
+		if (!outKey)
 		{
-			outVerifier.impl_->error_ = error;
-			return error;
+			return makeError (ErrorCode::KeyNotFound, "Key not found");
 		}
 
-		outVerifier.impl_->ok_    = true;
-		outVerifier.impl_->error_ = makeError (ErrorCode::Ok);
-		return outVerifier.impl_->error_;
+		// Asked for by the application (not named by a token): cached right away, so a key change retires it
+		impl_->insertKey (outKey, generation, true);
+		return makeError (ErrorCode::Ok);
+	}
+
+	Error Jwt::sign (JwtAlg alg, std::string_view kid, std::span<const uint8_t> data, ByteBuffer &outSignature) const
+	{
+		return impl_->withKey (kid, alg,
+		                       [&] (const KeyHandle &key)
+		                       {
+			                       return impl_->crypto_.signWith (key, data, outSignature);
+		                       });
 	}
 
-	TokenBuilder Jwt::token () const
+	SigningTemplate Jwt::signingTemplate (JwtAlg alg, std::string kid, const ClaimMap &fixedClaims) const
 	{
-		return TokenBuilder (*this);
+		return SigningTemplate (*this, alg, std::move (kid), fixedClaims);
 	}
 
 	const EngineOptions &Jwt::options () const noexcept
 	{
-		return impl_->options_;
+		// Snapshots are only replaced by setOptions, which invalidates this reference
+		return impl_->snapshot_.load (std::memory_order_acquire)->options;
 	}
 
 	void Jwt::setOptions (EngineOptions options)
 	{
-		impl_->options_ = std::move (options);
+		impl_->setOptions (std::move (options));
+	}
+
+	size_t Jwt::cachedTokenCount () const
+	{
+		const Impl::SnapshotReader snapshot (*impl_);
+		return snapshot->cache ? snapshot->cache->size() : 0;
 	}
 
 	ICryptoProvider &Jwt::crypto () noexcept
@@ -0,0 +1,111 @@
+﻿/*********************************************************************************************
+ *  Description : JwtAuth implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "JwtAuth.h"
+
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace ipb::http
+{
+	namespace
+	{
+		// Token of an `Authorization: Bearer <token>` header (the scheme is case-insensitive); empty if none
+		std::string_view bearerToken (std::string_view header) noexcept
+		{
+			constexpr std::string_view kScheme = "bearer";
+			if (header.size() <= kScheme.size() || (header [kScheme.size()] != ' ' && header [kScheme.size()] != '\t'))
+			{
+				return {};
+			}
+			for (size_t i = 0; i < kScheme.size(); ++i)
+			{
+				if ((header [i] | 0x20) != kScheme [i])
+				{
+					return {};
+				}
+			}
+
+			std::string_view token = header.substr (kScheme.size());
+			const size_t first     = token.find_first_not_of (" \t");
+			if (first == std::string_view::npos)
+			{
+				return {};
+			}
+			token = token.substr (first);
+			return token.substr (0, token.find_last_not_of (" \t") + 1);
+		}
+
+		/**
+		 * @brief Verify the bearer token of the request, then run the rest of the chain (or answer 401).
+		 */
+		void authenticate (const jwt::Jwt &jwt, const jwt::CompiledPolicy &policy, const CoarseClock &clock, Ctx &ctx,
+		                   const Next &next)
+		{
+			const std::string_view token = bearerToken (ctx.header ("Authorization"));
+			if (token.empty())
+			{
+				ctx.status (401).setHeader ("WWW-Authenticate", "Bearer");
+				return;
+			}
+
+			// The header outlives the request handling, so the verifier can borrow the token
+			jwt::Verifier &verifier = ctx.verifier();
+			if (jwt.verify (token, verifier, policy, clock.now(), jwt::TokenStorage::Borrow).code != jwt::ErrorCode::Ok)
+			{
+				ctx.status (401).setHeader ("WWW-Authenticate", "Bearer error=\"invalid_token\"");
+				return;
+			}
+
+			ctx.setAuthenticated (true);
+			next();
+		}
+
+		// Compile the policy of a middleware, resolving the handles of its pinned key
+		std::shared_ptr<const jwt::CompiledPolicy> compileRoutePolicy (const jwt::Jwt &jwt, jwt::Policy policy,
+		                                                               std::string kid)
+		{
+			auto compiled = std::make_shared<jwt::CompiledPolicy> (jwt::compilePolicy (std::move (policy), std::move (kid)));
+			if (compiled->kid.empty())
+			{
+				return compiled;
+			}
+
+			for (const jwt::JwtAlg alg : compiled->policy.allowedAlgs)
+			{
+				std::shared_ptr<const jwt::KeyHandle> key;
+				if (jwt.resolveKey (compiled->kid, alg, key).code == jwt::ErrorCode::Ok)
+				{
+					compiled->keys.push_back (std::move (key));
+				}
+			}
+			return compiled;
+		}
+	}    // namespace
+
+	JwtAuth::JwtAuth (const jwt::Jwt &jwt, const CoarseClock &clock)
+	    : jwt_ (jwt)
+	    , clock_ (clock)
+	{
+	}
+
+	/**
+	 * @brief Build the authentication middleware of a route.
+	 * @param policy The policy of the route (compiled once, here).
+	 * @param kid The key tokens must be signed with (empty: any key of the engine).
+	 * @return The middleware, for `HttplibApp::use (route, ...)` or the `middlewares` list of `HttplibApp::route`.
+	 */
+	AppMiddleware JwtAuth::middleware (jwt::Policy policy, std::string kid) const
+	{
+		auto compiled = compileRoutePolicy (jwt_, std::move (policy), std::move (kid));
+		return [&jwt = jwt_, &clock = clock_, compiled] (Ctx &ctx, Next next)
+		{
+			authenticate (jwt, *compiled, clock, ctx, next);
+		};
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,723 @@
+/*********************************************************************************************
+ *  Description : Built-in JSON provider implementation (single-pass flat object reader/writer)
+ *  License     : The unlicense (https://unlicense.org)
+ *  Copyright    (C) 2026  Ignacio Pomar Ballestero
+ *********************************************************************************************/
+
+#include "JwtJsonProvider.h"
+#include "JsonText.h"
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace ipb::http::jwt
+{
+	namespace
+	{
+		// Nesting accepted inside skipped (raw) values
+		constexpr int kMaxDepth = 64;
+
+		static Error makeJsonError (ErrorCode code, std::string message = {})
+		{
+			return Error {.code = code, .message = std::move (message)};
+		}
+
+		using jsontext::appendEscaped;
+		using jsontext::escapedSize;
+		using jsontext::findSpecial;
+		using jsontext::formatNumber;
+
+		static int hexValue (char c) noexcept
+		{
+			if (c >= '0' && c <= '9')
+			{
+				return c - '0';
+			}
+			if (c >= 'a' && c <= 'f')
+			{
+				return c - 'a' + 10;
+			}
+			if (c >= 'A' && c <= 'F')
+			{
+				return c - 'A' + 10;
+			}
+			return -1;
+		}
+
+		static void appendUtf8 (std::string &out, uint32_t cp)
+		{
+			if (cp < 0x80)
+			{
+				out.push_back (static_cast<char> (cp));
+			}
+			else if (cp < 0x800)
+			{
+				out.push_back (static_cast<char> (0xC0 | (cp >> 6)));
+				out.push_back (static_cast<char> (0x80 | (cp & 0x3F)));
+			}
+			else if (cp < 0x10000)
+			{
+				out.push_back (static_cast<char> (0xE0 | (cp >> 12)));
+				out.push_back (static_cast<char> (0x80 | ((cp >> 6) & 0x3F)));
+				out.push_back (static_cast<char> (0x80 | (cp & 0x3F)));
+			}
+			else
+			{
+				out.push_back (static_cast<char> (0xF0 | (cp >> 18)));
+				out.push_back (static_cast<char> (0x80 | ((cp >> 12) & 0x3F)));
+				out.push_back (static_cast<char> (0x80 | ((cp >> 6) & 0x3F)));
+				out.push_back (static_cast<char> (0x80 | (cp & 0x3F)));
+			}
+		}
+
+		/**
+		 * Cursor over one JSON text. Every method returns false on malformed input.
+		 */
+		class Reader
+		{
+			public:
+				explicit Reader (std::string_view text) noexcept
+				    : p_ (text.data())
+				    , end_ (text.data() + text.size())
+				{
+				}
+
+				const char *position () const noexcept
+				{
+					return p_;
+				}
+
+				char peek () noexcept
+				{
+					skipWhitespace();
+					return p_ < end_ ? *p_ : '\0';
+				}
+
+				bool consume (char c) noexcept
+				{
+					if (peek() != c || p_ == end_)
+					{
+						return false;
+					}
+					++p_;
+					return true;
+				}
+
+				bool atEnd () noexcept
+				{
+					skipWhitespace();
+					return p_ == end_;
+				}
+
+				// String at the cursor, unescaped into `out` (runs without escapes are appended in one block)
+				bool readString (std::string &out)
+				{
+					out.clear();
+					if (!consume ('"'))
+					{
+						return false;
+					}
+
+					for (;;)
+					{
+						const char *special = findSpecial (p_, end_);
+						out.append (p_, special);
+						p_ = special;
+						if (p_ == end_ || *p_ != '\\')
+						{
+							// Closing quote, or a raw control character / truncated text
+							return p_ != end_ && *p_++ == '"';
+						}
+
+						++p_;
+						if (p_ == end_)
+						{
+							return false;
+						}
+						switch (*p_++)
+						{
+						case '"': out.push_back ('"'); break;
+						case '\\': out.push_back ('\\'); break;
+						case '/': out.push_back ('/'); break;
+						case 'b': out.push_back ('\b'); break;
+						case 'f': out.push_back ('\f'); break;
+						case 'n': out.push_back ('\n'); break;
+						case 'r': out.push_back ('\r'); break;
+						case 't': out.push_back ('\t'); break;
+						case 'u':
+							if (!readEscapedCodePoint (out))
+							{
+								return false;
+							}
+							break;
+						default: return false;
+						}
+					}
+				}
+
+				// Value at the cursor: arrays of strings are read as a list, other objects and arrays as raw JSON
+				bool readValue (ClaimValue &out)
+				{
+					switch (peek())
+					{
+					case '"': return readString (out.emplace<std::string>());
+					case 't': out = true; return literal ("true");
+					case 'f': out = false; return literal ("false");
+					case 'n': out = nullptr; return literal ("null");
+					case '[':
+						{
+							const char *start = p_;
+							if (readStrings (out.emplace<ClaimStrings>()))
+							{
+								return true;
+							}
+							p_ = start;
+							[[fallthrough]];
+						}
+					case '{':
+						{
+							const char *start = p_;
+							if (!skipValue (0))
+							{
+								return false;
+							}
+							out = ClaimJson {.text = std::string (start, p_)};
+							return true;
+						}
+					default: return readNumber (out);
+					}
+				}
+
+				// Array whose elements are all strings (false, with the cursor anywhere, for any other array)
+				bool readStrings (ClaimStrings &out)
+				{
+					++p_;    // Opening bracket
+					if (consume (']'))
+					{
+						return true;
+					}
+					do
+					{
+						if (peek() != '"' || !readString (out.emplace_back()))
+						{
+							return false;
+						}
+					} while (consume (','));
+					return consume (']');
+				}
+
+				bool skipValue (int depth)
+				{
+					if (depth > kMaxDepth)
+					{
+						return false;
+					}
+
+					switch (peek())
+					{
+					case '"': return skipString();
+					case 't': return literal ("true");
+					case 'f': return literal ("false");
+					case 'n': return literal ("null");
+					case '{':
+						++p_;
+						if (consume ('}'))
+						{
+							return true;
+						}
+						do
+						{
+							if (peek() != '"' || !skipString() || !consume (':') || !skipValue (depth + 1))
+							{
+								return false;
+							}
+						} while (consume (','));
+						return consume ('}');
+					case '[':
+						++p_;
+						if (consume (']'))
+						{
+							return true;
+						}
+						do
+						{
+							if (!skipValue (depth + 1))
+							{
+								return false;
+							}
+						} while (consume (','));
+						return consume (']');
+					default:
+						{
+							ClaimValue ignored;
+							return readNumber (ignored);
+						}
+					}
+				}
+
+			private:
+				void skipWhitespace () noexcept
+				{
+					while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r'))
+					{
+						++p_;
+					}
+				}
+
+				bool literal (std::string_view word) noexcept
+				{
+					if (static_cast<size_t> (end_ - p_) < word.size() || std::string_view (p_, word.size()) != word)
+					{
+						return false;
+					}
+					p_ += word.size();
+					return true;
+				}
+
+				bool skipString () noexcept
+				{
+					++p_;    // Opening quote
+					for (;;)
+					{
+						p_ = findSpecial (p_, end_);
+						if (p_ == end_ || *p_ != '\\')
+						{
+							return p_ != end_ && *p_++ == '"';
+						}
+						if (end_ - p_ < 2)
+						{
+							return false;
+						}
+						p_ += 2;    // The unescaped text is not needed: only the escape length matters
+						if (p_ [-1] == 'u')
+						{
+							for (int i = 0; i < 4; ++i, ++p_)
+							{
+								if (p_ == end_ || hexValue (*p_) < 0)
+								{
+									return false;
+								}
+							}
+						}
+					}
+				}
+
+				bool readHex4 (uint32_t &out) noexcept
+				{
+					if (end_ - p_ < 4)
+					{
+						return false;
+					}
+					out = 0;
+					for (int i = 0; i < 4; ++i)
+					{
+						const int digit = hexValue (*p_++);
+						if (digit < 0)
+						{
+							return false;
+						}
+						out = (out << 4) | static_cast<uint32_t> (digit);
+					}
+					return true;
+				}
+
+				// After "\u": one code unit, or a surrogate pair written as two escapes
+				bool readEscapedCodePoint (std::string &out)
+				{
+					uint32_t cp = 0;
+					if (!readHex4 (cp) || (cp >= 0xDC00 && cp <= 0xDFFF))
+					{
+						return false;
+					}
+					if (cp >= 0xD800 && cp <= 0xDBFF)
+					{
+						uint32_t low = 0;
+						if (end_ - p_ < 2 || p_ [0] != '\\' || p_ [1] != 'u')
+						{
+							return false;
+						}
+						p_ += 2;
+						if (!readHex4 (low) || low < 0xDC00 || low > 0xDFFF)
+						{
+							return false;
+						}
+						cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					}
+					appendUtf8 (out, cp);
+					return true;
+				}
+
+				// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+				bool readNumber (ClaimValue &out) noexcept
+				{
+					const char *start = p_;
+					bool integral     = true;
+
+					if (p_ < end_ && *p_ == '-')
+					{
+						++p_;
+					}
+					if (p_ == end_ || !isDigit (*p_))
+					{
+						return false;
+					}
+					if (*p_ == '0')
+					{
+						++p_;
+					}
+					else
+					{
+						skipDigits();
+					}
+
+					if (p_ < end_ && *p_ == '.')
+					{
+						integral = false;
+						++p_;
+						if (p_ == end_ || !isDigit (*p_))
+						{
+							return false;
+						}
+						skipDigits();
+					}
+
+					if (p_ < end_ && (*p_ == 'e' || *p_ == 'E'))
+					{
+						integral = false;
+						++p_;
+						if (p_ < end_ && (*p_ == '+' || *p_ == '-'))
+						{
+							++p_;
+						}
+						if (p_ == end_ || !isDigit (*p_))
+						{
+							return false;
+						}
+						skipDigits();
+					}
+
+					if (integral)
+					{
+						int64_t value = 0;
+						if (auto r = std::from_chars (start, p_, value); r.ec == std::errc() && r.ptr == p_)
+						{
+							out = value;
+							return true;
+						}
+						// Out of the int64_t range: read as double below
+					}
+
+					double value = 0;
+					auto r       = std::from_chars (start, p_, value);
+					if (r.ec != std::errc() || r.ptr != p_ || !std::isfinite (value))
+					{
+						return false;    // Includes magnitudes beyond double
+					}
+					out = value;
+					return true;
+				}
+
+				static bool isDigit (char c) noexcept
+				{
+					return static_cast<unsigned char> (c - '0') <= 9;
+				}
+
+				void skipDigits () noexcept
+				{
+					while (p_ < end_ && isDigit (*p_))
+					{
+						++p_;
+					}
+				}
+
+				const char *p_;
+				const char *end_;
+		};
+
+		static Error invalid (ClaimMap &out, const char *message)
+		{
+			out.clear();
+			return makeJsonError (ErrorCode::InvalidJson, message);
+		}
+
+		static Error parseObject (std::string_view text, ClaimMap &out)
+		{
+			out.clear();
+			Reader reader (text);
+			if (!reader.consume ('{'))
+			{
+				return invalid (out, "Expected a JSON object");
+			}
+
+			if (!reader.consume ('}'))
+			{
+				std::string name;
+				do
+				{
+					if (!reader.readString (name) || !reader.consume (':'))
+					{
+						return invalid (out, "Invalid object member");
+					}
+					if (out.contains (name))
+					{
+						return invalid (out, "Duplicate object member");
+					}
+					if (!reader.readValue (out [name]))
+					{
+						return invalid (out, "Invalid value");
+					}
+				} while (reader.consume (','));
+
+				if (!reader.consume ('}'))
+				{
+					return invalid (out, "Unterminated object");
+				}
+			}
+
+			if (!reader.atEnd())
+			{
+				return invalid (out, "Trailing characters after the object");
+			}
+			return makeJsonError (ErrorCode::Ok);
+		}
+
+		// ------------------------------------------------------------------------
+		// Writer: measured first, so the output is allocated once
+		// ------------------------------------------------------------------------
+
+
+		static bool measureValue (const ClaimValue &value, size_t &size) noexcept
+		{
+			if (std::holds_alternative<std::nullptr_t> (value))
+			{
+				size += 4;
+			}
+			else if (const auto *flag = std::get_if<bool> (&value))
+			{
+				size += *flag ? 4 : 5;
+			}
+			else if (const auto *text = std::get_if<std::string> (&value))
+			{
+				size += escapedSize (*text);
+			}
+			else if (const auto *list = std::get_if<ClaimStrings> (&value))
+			{
+				size += list->empty() ? 2 : list->size() + 1;    // Brackets and commas
+				for (const std::string &item : *list)
+				{
+					size += escapedSize (item);
+				}
+			}
+			else if (const auto *json = std::get_if<ClaimJson> (&value))
+			{
+				size += json->text.size();
+			}
+			else
+			{
+				char buffer [32];
+				const size_t length = formatNumber (value, buffer);
+				if (length == 0)
+				{
+					return false;
+				}
+				size += length;
+			}
+			return true;
+		}
+
+		static void appendValue (std::string &out, const ClaimValue &value)
+		{
+			if (std::holds_alternative<std::nullptr_t> (value))
+			{
+				out.append ("null");
+			}
+			else if (const auto *flag = std::get_if<bool> (&value))
+			{
+				out.append (*flag ? "true" : "false");
+			}
+			else if (const auto *text = std::get_if<std::string> (&value))
+			{
+				appendEscaped (out, *text);
+			}
+			else if (const auto *list = std::get_if<ClaimStrings> (&value))
+			{
+				out.push_back ('[');
+				for (size_t i = 0; i < list->size(); ++i)
+				{
+					if (i != 0)
+					{
+						out.push_back (',');
+					}
+					appendEscaped (out, (*list) [i]);
+				}
+				out.push_back (']');
+			}
+			else if (const auto *json = std::get_if<ClaimJson> (&value))
+			{
+				out.append (json->text);
+			}
+			else
+			{
+				char buffer [32];
+				out.append (buffer, formatNumber (value, buffer));
+			}
+		}
+	}    // namespace
+
+	Error JwtJsonProvider::parseHeader (std::string_view text, HeaderMap &outHeader) const
+	{
+		return parseObject (text, outHeader);
+	}
+
+	Error JwtJsonProvider::parseClaims (std::string_view text, ClaimMap &outClaims) const
+	{
+		return parseObject (text, outClaims);
+	}
+
+	Error JwtJsonProvider::toJson (const ClaimMap &values, std::string &outJson) const
+	{
+		size_t size = 2;    // Braces
+		for (const auto &[name, value] : values)
+		{
+			size += escapedSize (name) + 2;    // Colon and comma
+			if (!measureValue (value, size))
+			{
+				return makeJsonError (ErrorCode::JsonError, "Non-finite numbers cannot be written as JSON");
+			}
+		}
+
+		outJson.clear();
+		outJson.reserve (size);
+		outJson.push_back ('{');
+		bool first = true;
+		for (const auto &[name, value] : values)
+		{
+			if (!first)
+			{
+				outJson.push_back (',');
+			}
+			first = false;
+			appendEscaped (outJson, name);
+			outJson.push_back (':');
+			appendValue (outJson, value);
+		}
+		outJson.push_back ('}');
+		return makeJsonError (ErrorCode::Ok);
+	}
+
+	Error JwtJsonProvider::parseJwks (std::string_view text, std::vector<JwkEntry> &outKeys) const
+	{
+		outKeys.clear();
+		Reader reader (text);
+		std::string name;
+		bool hasKeys = false;
+
+		if (!reader.consume ('{'))
+		{
+			return makeJsonError (ErrorCode::InvalidJson, "Expected a JWKS object");
+		}
+
+		if (!reader.consume ('}'))
+		{
+			do
+			{
+				if (!reader.readString (name) || !reader.consume (':'))
+				{
+					return makeJsonError (ErrorCode::InvalidJson, "Invalid JWKS member");
+				}
+
+				if (name != "keys")
+				{
+					if (!reader.skipValue (0))
+					{
+						return makeJsonError (ErrorCode::InvalidJson, "Invalid JWKS member");
+					}
+					continue;
+				}
+
+				hasKeys = true;
+				if (!reader.consume ('['))
+				{
+					return makeJsonError (ErrorCode::InvalidJson, "\"keys\" must be an array");
+				}
+				if (reader.consume (']'))
+				{
+					continue;
+				}
+
+				do
+				{
+					if (reader.peek() != '{')
+					{
+						return makeJsonError (ErrorCode::InvalidJson, "JWKS keys must be objects");
+					}
+
+					JwkEntry entry;
+					const char *start = reader.position();
+					reader.consume ('{');
+					if (!reader.consume ('}'))
+					{
+						do
+						{
+							if (!reader.readString (name) || !reader.consume (':'))
+							{
+								return makeJsonError (ErrorCode::InvalidJson, "Invalid JWK member");
+							}
+
+							std::string *field = name == "kid" ? &entry.kid : name == "alg" ? &entry.alg : nullptr;
+							if (name == "use")
+							{
+								std::string use;
+								if (reader.peek() != '"' || !reader.readString (use))
+								{
+									return makeJsonError (ErrorCode::InvalidJson, "Invalid JWK use");
+								}
+								entry.use = use == "enc" ? JwtUse::Enc : JwtUse::Sig;
+							}
+							else if (field != nullptr && reader.peek() == '"')
+							{
+								if (!reader.readString (*field))
+								{
+									return makeJsonError (ErrorCode::InvalidJson, "Invalid JWK member");
+								}
+							}
+							else if (!reader.skipValue (0))
+							{
+								return makeJsonError (ErrorCode::InvalidJson, "Invalid JWK member");
+							}
+						} while (reader.consume (','));
+
+						if (!reader.consume ('}'))
+						{
+							return makeJsonError (ErrorCode::InvalidJson, "Unterminated JWK object");
+						}
+					}
+
+					entry.json.assign (start, reader.position());
+					outKeys.push_back (std::move (entry));
+				} while (reader.consume (','));
+
+				if (!reader.consume (']'))
+				{
+					return makeJsonError (ErrorCode::InvalidJson, "Unterminated \"keys\" array");
+				}
+			} while (reader.consume (','));
+
+			if (!reader.consume ('}'))
+			{
+				return makeJsonError (ErrorCode::InvalidJson, "Unterminated JWKS object");
+			}
+		}
+
+		if (!reader.atEnd() || !hasKeys)
+		{
+			outKeys.clear();
+			return makeJsonError (ErrorCode::InvalidJson, "Not a JWKS document");
+		}
+		return makeJsonError (ErrorCode::Ok);
+	}
+
+}    // namespace ipb::http::jwt
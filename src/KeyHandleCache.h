@@ -0,0 +1,121 @@
+/*********************************************************************************************
+ *  Description : KeyHandleCache - Key handles resolved by the crypto provider, per kid and algorithm
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _KEY_HANDLE_CACHE_H_
+#	define _KEY_HANDLE_CACHE_H_
+
+#	include <array>
+#	include <atomic>
+#	include <cstddef>
+#	include <cstdint>
+#	include <functional>
+#	include <memory>
+#	include <string>
+#	include <string_view>
+#	include <unordered_map>
+
+#	include "Jwt.h"
+
+namespace ipb::http::jwt
+{
+	/**
+	 * @brief Resolved key handles indexed by kid, one slot per algorithm.
+	 * A published map is never modified: the engine changes a copy and publishes it in its snapshot, so
+	 * verify reads the handles without a lock. Purged handles are retired, which tells the holders of a
+	 * pinned handle (SigningTemplate) to resolve the kid again.
+	 */
+	class KeyHandleCache
+	{
+		public:
+			/**
+			 * Changes on every purge: a handle resolved before a purge must not be inserted after it.
+			 */
+			uint64_t generation () const noexcept
+			{
+				return generation_;
+			}
+
+			// Valid while this map is published (or until the next reclaim of the engine)
+			const KeyHandle *find (std::string_view kid, JwtAlg alg) const
+			{
+				const auto it = keys_.find (kid);
+				return it != keys_.end() ? it->second [slotOf (alg)].get() : nullptr;
+			}
+
+			std::shared_ptr<const KeyHandle> share (std::string_view kid, JwtAlg alg) const
+			{
+				const auto it = keys_.find (kid);
+				return it != keys_.end() ? it->second [slotOf (alg)] : nullptr;
+			}
+
+			/**
+			 * Store a handle under its kid and algorithm (replacing the previous one).
+			 */
+			void insert (std::shared_ptr<const KeyHandle> key)
+			{
+				auto it = keys_.find (std::string_view (key->kid()));
+				if (it == keys_.end())
+				{
+					it = keys_.emplace (key->kid(), Slots {}).first;
+				}
+				it->second [slotOf (key->alg())] = std::move (key);
+			}
+
+			/**
+			 * Drop (and retire) every handle of `kid`.
+			 */
+			void purgeKid (std::string_view kid)
+			{
+				++generation_;
+
+				const auto it = keys_.find (kid);
+				if (it == keys_.end())
+				{
+					return;
+				}
+				for (const std::shared_ptr<const KeyHandle> &key : it->second)
+				{
+					if (key)
+					{
+						retire (*key);
+					}
+				}
+				keys_.erase (it);
+			}
+
+			static void retire (const KeyHandle &key) noexcept
+			{
+				key.retired_.store (true, std::memory_order_release);
+			}
+
+		private:
+			static constexpr size_t kAlgCount = static_cast<size_t> (JwtAlg::EdDSA) + 1;
+
+			using Slots = std::array<std::shared_ptr<const KeyHandle>, kAlgCount>;
+
+			struct KidHash
+			{
+					using is_transparent = void;
+
+					size_t operator() (std::string_view kid) const noexcept
+					{
+						return std::hash<std::string_view> {}(kid);
+					}
+			};
+
+			static size_t slotOf (JwtAlg alg) noexcept
+			{
+				return static_cast<size_t> (alg) % kAlgCount;
+			}
+
+			std::unordered_map<std::string, Slots, KidHash, std::equal_to<>> keys_;
+			uint64_t generation_ = 0;
+	};
+
+}    // namespace ipb::http::jwt
+
+#endif
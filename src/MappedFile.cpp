@@ -0,0 +1,121 @@
+﻿/*********************************************************************************************
+ *  Description : MappedFile implementation (Win32 file mappings, POSIX mmap)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "MappedFile.h"
+
+#if defined _WIN32
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace ipb::http
+{
+#if defined _WIN32
+	FileKind MappedFile::open (const std::filesystem::path &path)
+	{
+		// FILE_FLAG_BACKUP_SEMANTICS lets CreateFile open directories, so they can be told apart
+		HANDLE file = CreateFileW (path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		                           FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return FileKind::Missing;
+		}
+
+		BY_HANDLE_FILE_INFORMATION info;
+		if (!GetFileInformationByHandle (file, &info))
+		{
+			CloseHandle (file);
+			return FileKind::Missing;
+		}
+		if ((info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+		{
+			CloseHandle (file);
+			return FileKind::Directory;
+		}
+
+		size_ = static_cast<size_t> ((static_cast<uint64_t> (info.nFileSizeHigh) << 32) | info.nFileSizeLow);
+		const uint64_t ticks = (static_cast<uint64_t> (info.ftLastWriteTime.dwHighDateTime) << 32)
+		                     | info.ftLastWriteTime.dwLowDateTime;
+		modified_ = static_cast<int64_t> (ticks / 10000000ULL) - 11644473600LL;    // 100 ns since 1601
+
+		// Empty files cannot be mapped (and need no mapping)
+		if (size_ > 0)
+		{
+			HANDLE mapping = CreateFileMappingW (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping != nullptr)
+			{
+				data_ = static_cast<const char *> (MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0));
+				CloseHandle (mapping);
+			}
+		}
+		CloseHandle (file);
+
+		return size_ == 0 || data_ != nullptr ? FileKind::File : FileKind::Missing;
+	}
+
+	MappedFile::~MappedFile ()
+	{
+		if (data_ != nullptr)
+		{
+			UnmapViewOfFile (data_);
+		}
+	}
+#else
+	FileKind MappedFile::open (const std::filesystem::path &path)
+	{
+		const int fd = ::open (path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return FileKind::Missing;
+		}
+
+		struct stat info;
+		if (fstat (fd, &info) != 0 || !(S_ISREG (info.st_mode) || S_ISDIR (info.st_mode)))
+		{
+			::close (fd);
+			return FileKind::Missing;
+		}
+		if (S_ISDIR (info.st_mode))
+		{
+			::close (fd);
+			return FileKind::Directory;
+		}
+
+		size_     = static_cast<size_t> (info.st_size);
+		modified_ = static_cast<int64_t> (info.st_mtime);
+
+		// Empty files cannot be mapped (and need no mapping)
+		if (size_ > 0)
+		{
+			void *mapping = mmap (nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapping != MAP_FAILED)
+			{
+				madvise (mapping, size_, MADV_SEQUENTIAL);
+				data_ = static_cast<const char *> (mapping);
+			}
+		}
+		::close (fd);
+
+		return size_ == 0 || data_ != nullptr ? FileKind::File : FileKind::Missing;
+	}
+
+	MappedFile::~MappedFile ()
+	{
+		if (data_ != nullptr)
+		{
+			munmap (const_cast<char *> (data_), size_);
+		}
+	}
+#endif
+
+}    // namespace ipb::http
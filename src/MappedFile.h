@@ -0,0 +1,67 @@
+/*********************************************************************************************
+ *  Description : MappedFile - Read-only memory mapping of a regular file
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _MAPPED_FILE_H_
+#	define _MAPPED_FILE_H_
+
+#	include <cstddef>
+#	include <cstdint>
+#	include <filesystem>
+
+namespace ipb::http
+{
+	// What MappedFile::open found at the path
+	enum class FileKind
+	{
+		Missing,
+		Directory,
+		File
+	};
+
+	/**
+	 * @brief Read-only mapping of a whole regular file (static files, route table images).
+	 * Unmapped on destruction: share it (std::shared_ptr) with whatever keeps views into it.
+	 */
+	class MappedFile
+	{
+		public:
+			MappedFile () = default;
+			~MappedFile ();
+
+			MappedFile (const MappedFile &)            = delete;
+			MappedFile &operator= (const MappedFile &) = delete;
+
+			/**
+			 * Map the file at `path`; kind is Directory or Missing (and nothing is mapped) when it is not a
+			 * readable regular file.
+			 */
+			FileKind open (const std::filesystem::path &path);
+
+			const char *data () const noexcept
+			{
+				return data_;
+			}
+
+			size_t size () const noexcept
+			{
+				return size_;
+			}
+
+			int64_t modified () const noexcept
+			{
+				return modified_;
+			}
+
+		private:
+			const char *data_ = nullptr;
+			size_t size_      = 0;
+			int64_t modified_ = 0;    // Seconds since the Unix epoch
+	};
+
+}    // namespace ipb::http
+
+#endif
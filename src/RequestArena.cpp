@@ -0,0 +1,81 @@
+﻿/*********************************************************************************************
+ *  Description : RequestArena implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "RequestArena.h"
+
+#include <algorithm>
+
+namespace ipb::http
+{
+	RequestArena::RequestArena (size_t blockBytes)
+	    : block_bytes_ (std::max<size_t> (blockBytes, 64))
+	    , block_ (std::make_unique<std::byte[]> (block_bytes_))
+	{
+		buffer_.emplace (block_.get(), block_bytes_, &upstream_);
+	}
+
+	RequestArena::~RequestArena () = default;
+
+	/**
+	 * @brief Rewind the arena, growing the block if the last requests did not fit in it.
+	 */
+	void RequestArena::reset () noexcept
+	{
+		buffer_->release();
+
+		if (upstream_.bytes != 0 && block_bytes_ < kMaxBlockBytes)
+		{
+			const size_t wanted = std::min (kMaxBlockBytes, std::max (block_bytes_ * 2, block_bytes_ + upstream_.bytes));
+			try
+			{
+				auto block = std::make_unique<std::byte[]> (wanted);
+				buffer_.reset();
+				block_       = std::move (block);
+				block_bytes_ = wanted;
+				buffer_.emplace (block_.get(), block_bytes_, &upstream_);
+			}
+			catch (const std::bad_alloc &)
+			{
+				// Keep the current block: the next overflow retries
+			}
+		}
+		upstream_.bytes = 0;
+	}
+
+	void *RequestArena::do_allocate (size_t bytes, size_t alignment)
+	{
+		return buffer_->allocate (bytes, alignment);
+	}
+
+	void RequestArena::do_deallocate ([[maybe_unused]] void *p, [[maybe_unused]] size_t bytes,
+	                                  [[maybe_unused]] size_t alignment)
+	{
+		// Monotonic: memory is only given back by reset()
+	}
+
+	bool RequestArena::do_is_equal (const std::pmr::memory_resource &other) const noexcept
+	{
+		return this == &other;
+	}
+
+	void *RequestArena::Upstream::do_allocate (size_t bytes, size_t alignment)
+	{
+		void *p = std::pmr::new_delete_resource()->allocate (bytes, alignment);
+		this->bytes += bytes;
+		return p;
+	}
+
+	void RequestArena::Upstream::do_deallocate (void *p, size_t bytes, size_t alignment)
+	{
+		std::pmr::new_delete_resource()->deallocate (p, bytes, alignment);
+	}
+
+	bool RequestArena::Upstream::do_is_equal (const std::pmr::memory_resource &other) const noexcept
+	{
+		return this == &other;
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,310 @@
+﻿/*********************************************************************************************
+ *  Description : ResponseCache implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "ResponseCache.h"
+#include "EntityTag.h"
+#include "ShardedLru.h"
+
+#include <httplib.h>
+
+#include <atomic>
+#include <functional>
+#include <memory_resource>
+#include <utility>
+
+namespace ipb::http
+{
+	namespace
+	{
+		int64_t nowStamp () noexcept
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds> (
+			           std::chrono::steady_clock::now().time_since_epoch())
+			    .count();
+		}
+
+		// Strong entity tag of a body: FNV-1a 64, quoted hex
+		std::string bodyTag (std::string_view body)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			for (unsigned char c : body)
+			{
+				hash = (hash ^ c) * 1099511628211ull;
+			}
+
+			static constexpr char kHex [] = "0123456789abcdef";
+			std::string tag (18, '"');
+			for (size_t i = 0; i < 16; ++i)
+			{
+				tag [16 - i] = kHex [hash & 0xF];
+				hash >>= 4;
+			}
+			return tag;
+		}
+
+		bool containsToken (std::string_view value, std::string_view token) noexcept
+		{
+			const auto lower = [] (char c)
+			{
+				return (c >= 'A' && c <= 'Z') ? static_cast<char> (c - 'A' + 'a') : c;
+			};
+			for (size_t i = 0; i + token.size() <= value.size(); ++i)
+			{
+				size_t j = 0;
+				while (j < token.size() && lower (value [i + j]) == token [j])
+				{
+					++j;
+				}
+				if (j == token.size())
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Only complete, shareable 200 responses are stored
+		bool isStorable (const httplib::Response &response, size_t maxBodySize)
+		{
+			if (response.status != 200 || response.content_provider_ || response.body.size() > maxBodySize
+			    || response.has_header ("Set-Cookie"))
+			{
+				return false;
+			}
+			const std::string cacheControl = response.get_header_value ("Cache-Control");
+			return !containsToken (cacheControl, "no-store") && !containsToken (cacheControl, "private");
+		}
+	}    // namespace
+
+	// ============================================================================
+	// ResponseCache::Impl - Sharded LRU of responses
+	// ============================================================================
+
+	class ResponseCache::Impl
+	{
+		public:
+			explicit Impl (ResponseCacheConfig config)
+			    : config_ (std::move (config))
+			    , responses_ (config_.capacity)
+			    , ttl_ (std::chrono::duration_cast<std::chrono::nanoseconds> (config_.ttl).count())
+			{
+			}
+
+			template <typename NextFn>
+			void handle (Ctx &ctx, std::string_view pattern, const NextFn &next);
+
+			size_t invalidate (std::string_view pattern);
+			void clear ();
+			size_t size ();
+			ResponseCacheStats stats () const noexcept;
+
+		private:
+			// Response stored for one key; shared with the requests writing it, so they copy it out of the lock
+			struct CachedResponse
+			{
+					int status = 200;
+					std::string body;
+					std::string etag;
+					std::vector<std::pair<std::string, std::string>> headers;    // ETag and Content-Type included
+			};
+
+			void respond (Ctx &ctx, const CachedResponse &cached);
+
+			ResponseCacheConfig config_;
+			ShardedLru<std::string, std::shared_ptr<const CachedResponse>> responses_;    // Key: see handle
+			int64_t ttl_;
+
+			std::atomic<uint64_t> hits_ {0};
+			std::atomic<uint64_t> not_modified_ {0};
+			std::atomic<uint64_t> misses_ {0};
+			std::atomic<uint64_t> stores_ {0};
+	};
+
+	/**
+	 * @brief Answer a request from the cache, or run the chain and store its response.
+	 * @param ctx The request context.
+	 * @param pattern The route pattern (first part of the key).
+	 * @param next Runs the rest of the chain.
+	 */
+	template <typename NextFn>
+	void ResponseCache::Impl::handle (Ctx &ctx, std::string_view pattern, const NextFn &next)
+	{
+		const bool head = ctx.method() == "HEAD";
+		if (!head && ctx.method() != "GET")
+		{
+			next();
+			return;
+		}
+
+		// Pattern, then '\0' + the router serving the request, so tenants of different Host partitions
+		// registering the same pattern do not share entries, then the value of every parameter and query
+		// key. Parameter names are fixed by the pattern: the values are enough (views into the path). The
+		// values are decoded and may hold any byte, so each one is prefixed with its size
+		std::pmr::string key (pattern, &ctx.memory());
+		const Router *router = ctx.router();
+		key.push_back ('\0');
+		key.append (reinterpret_cast<const char *> (&router), sizeof (router));
+		const auto appendPart = [&key] (std::string_view part)
+		{
+			const size_t size = part.size();
+			key.append (reinterpret_cast<const char *> (&size), sizeof (size));
+			key.append (part);
+		};
+		for (const Ctx::Param &param : ctx.params())
+		{
+			appendPart (param.value);
+		}
+		for (const std::string &name : config_.query_keys)
+		{
+			appendPart (ctx.query (name));
+		}
+
+		std::shared_ptr<const CachedResponse> cached;
+		if (responses_.lookup (std::string_view (key), nowStamp(),
+		                       [&cached] (const std::shared_ptr<const CachedResponse> &stored) { cached = stored; }))
+		{
+			hits_.fetch_add (1, std::memory_order_relaxed);
+			respond (ctx, *cached);
+			return;
+		}
+
+		misses_.fetch_add (1, std::memory_order_relaxed);
+		next();
+
+		httplib::Response &response = ctx.response();
+		if (head || !isStorable (response, config_.max_body_size))
+		{
+			return;
+		}
+
+		auto stored  = std::make_shared<CachedResponse>();
+		stored->etag = response.get_header_value ("ETag");
+		if (stored->etag.empty())
+		{
+			stored->etag = bodyTag (response.body);
+			ctx.setHeader ("ETag", stored->etag);
+		}
+		stored->status = response.status;
+		stored->body   = response.body;
+		stored->headers.assign (response.headers.begin(), response.headers.end());
+		responses_.insert (std::string_view (key), nowStamp() + ttl_ - 1, std::move (stored));
+		stores_.fetch_add (1, std::memory_order_relaxed);
+
+		if (etag::matchesNoneMatch (ctx.header ("If-None-Match"), response.get_header_value ("ETag")))
+		{
+			not_modified_.fetch_add (1, std::memory_order_relaxed);
+			response.status = 304;
+			response.body.clear();
+		}
+	}
+
+	/**
+	 * @brief Write a stored response (or 304 if the client has it) without running the chain.
+	 */
+	void ResponseCache::Impl::respond (Ctx &ctx, const CachedResponse &cached)
+	{
+		httplib::Response &response = ctx.response();
+		if (etag::matchesNoneMatch (ctx.header ("If-None-Match"), cached.etag))
+		{
+			not_modified_.fetch_add (1, std::memory_order_relaxed);
+			response.status = 304;
+			ctx.setHeader ("ETag", cached.etag);
+			return;
+		}
+
+		response.status = cached.status;
+		for (const auto &[name, value] : cached.headers)
+		{
+			response.headers.emplace (name, value);
+		}
+		response.body = cached.body;
+	}
+
+	size_t ResponseCache::Impl::invalidate (std::string_view pattern)
+	{
+		return responses_.eraseIf (
+		    [pattern] (const std::string &key, const std::shared_ptr<const CachedResponse> &)
+		    { return key.starts_with (pattern) && (key.size() == pattern.size() || key [pattern.size()] == '\0'); });
+	}
+
+	void ResponseCache::Impl::clear ()
+	{
+		responses_.clear();
+	}
+
+	size_t ResponseCache::Impl::size ()
+	{
+		return responses_.size();
+	}
+
+	ResponseCacheStats ResponseCache::Impl::stats () const noexcept
+	{
+		return ResponseCacheStats {.hits        = hits_.load (std::memory_order_relaxed),
+		                           .notModified = not_modified_.load (std::memory_order_relaxed),
+		                           .misses      = misses_.load (std::memory_order_relaxed),
+		                           .stores      = stores_.load (std::memory_order_relaxed)};
+	}
+
+	// ============================================================================
+	// ResponseCache
+	// ============================================================================
+
+	ResponseCache::ResponseCache (ResponseCacheConfig config)
+	    : impl_ (std::make_shared<Impl> (std::move (config)))
+	{
+	}
+
+	ResponseCache::~ResponseCache () = default;
+
+	/**
+	 * @brief Build the caching middleware of a route.
+	 * @param route The route the middleware is attached to (its pattern starts the key).
+	 * @return The middleware, for `HttplibApp::use (route, ...)`.
+	 */
+	AppMiddleware ResponseCache::middleware (const RouteInfo &route) const
+	{
+		return appMiddleware (route.pattern);
+	}
+
+	/**
+	 * @brief Build the caching middleware of a route registered through HttplibApp.
+	 * @param pattern The pattern of the route (starts the key).
+	 * @return The middleware, for the `middlewares` list of `HttplibApp::route`.
+	 */
+	AppMiddleware ResponseCache::appMiddleware (std::string_view pattern) const
+	{
+		return [impl = impl_, pattern = std::string (pattern)] (Ctx &ctx, Next next)
+		{
+			impl->handle (ctx, pattern, next);
+		};
+	}
+
+	/**
+	 * @brief Drop the stored responses of a route pattern.
+	 * @param pattern The route pattern, as registered.
+	 * @return The number of responses dropped.
+	 */
+	size_t ResponseCache::invalidate (std::string_view pattern)
+	{
+		return impl_->invalidate (pattern);
+	}
+
+	void ResponseCache::clear ()
+	{
+		impl_->clear();
+	}
+
+	size_t ResponseCache::size () const
+	{
+		return impl_->size();
+	}
+
+	ResponseCacheStats ResponseCache::stats () const noexcept
+	{
+		return impl_->stats();
+	}
+
+}    // namespace ipb::http
@@ -5,7 +5,21 @@
  ********************************************************************************************/
 
 #include "Route.h"
+#include "EpochDomain.h"
+#include "MappedFile.h"    // Route table images
+#include "Simd.h"          // SIMD kernels for the fixed-size validators
+#include "TraceScope.h"    // Stage spans of sampled requests
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 
 namespace ipb::http
@@ -14,26 +28,229 @@ namespace ipb::http
 	// Internal types (hidden from header)
 	// ============================================================================
 
-	// Parameter Types
-	enum class ParamType : uint8_t
+	// prototype
+	static ParamType fromParamTypeString (std::string_view type_str);
+
+	// ============================================================================
+	// Typed parameter validators
+	// ============================================================================
+
+	// All validators are ASCII only, so they do not depend on the current locale
+	static inline bool isDigit (char c) noexcept
+	{
+		return static_cast<unsigned char> (c - '0') <= 9;
+	}
+
+	// Positions of the hyphens in the 8-4-4-4-12 UUID layout
+	static constexpr bool isUuidHyphenPos (size_t i) noexcept
+	{
+		return i == 8 || i == 13 || i == 18 || i == 23;
+	}
+
+#if defined(HAPP_SIMD_SSE2) || defined(HAPP_SIMD_NEON)
+
+	// A UUID is checked as three 16-byte chunks: at 0, at 16 and an overlapping one at 20 for the tail
+	static constexpr size_t kUuidChunkOffsets [3] = {0, 16, 20};
+
+	// Per-byte masks of the UUID chunks: 0xFF where a hyphen is expected
+	alignas (16) static constexpr std::array<std::array<uint8_t, 16>, 3> kUuidHyphenMasks = []
+	{
+		std::array<std::array<uint8_t, 16>, 3> masks {};
+		for (size_t chunk = 0; chunk < 3; ++chunk)
+		{
+			for (size_t i = 0; i < 16; ++i)
+			{
+				masks [chunk][i] = isUuidHyphenPos (kUuidChunkOffsets [chunk] + i) ? 0xFF : 0;
+			}
+		}
+		return masks;
+	}();
+
+#endif
+
+#if defined(HAPP_SIMD_SSE2)
+
+	static inline __m128i inRange (__m128i v, char lo, char hi) noexcept
+	{
+		// Signed compares: bytes >= 0x80 are negative and never fall in an ASCII range
+		return _mm_and_si128 (_mm_cmpgt_epi8 (v, _mm_set1_epi8 (static_cast<char> (lo - 1))),
+		                      _mm_cmplt_epi8 (v, _mm_set1_epi8 (static_cast<char> (hi + 1))));
+	}
+
+	static inline __m128i hexMask (__m128i v) noexcept
+	{
+		const __m128i lower = _mm_or_si128 (v, _mm_set1_epi8 (0x20));    // 'A'..'F' -> 'a'..'f'
+		return _mm_or_si128 (inRange (v, '0', '9'), inRange (lower, 'a', 'f'));
+	}
+
+	static inline __m128i base64UrlMask (__m128i v) noexcept
+	{
+		const __m128i lower   = _mm_or_si128 (v, _mm_set1_epi8 (0x20));    // 'A'..'Z' -> 'a'..'z'
+		const __m128i alnum   = _mm_or_si128 (inRange (v, '0', '9'), inRange (lower, 'a', 'z'));
+		const __m128i urlsafe = _mm_or_si128 (_mm_cmpeq_epi8 (v, _mm_set1_epi8 ('-')),
+		                                      _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('_')));
+		return _mm_or_si128 (alnum, urlsafe);
+	}
+
+	static inline bool uuidChunkValid (const char *data, size_t chunk) noexcept
+	{
+		const __m128i hyphen = _mm_load_si128 (reinterpret_cast<const __m128i *> (kUuidHyphenMasks [chunk].data()));
+		const __m128i v      = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + kUuidChunkOffsets [chunk]));
+		const __m128i dashes = _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('-'));
+		const __m128i valid  = _mm_or_si128 (_mm_and_si128 (hyphen, dashes), _mm_andnot_si128 (hyphen, hexMask (v)));
+		return _mm_movemask_epi8 (valid) == 0xFFFF;
+	}
+
+	static inline bool uuidKernel (const char *data) noexcept
+	{
+		return uuidChunkValid (data, 0) && uuidChunkValid (data, 1) && uuidChunkValid (data, 2);
+	}
+
+	static inline bool base64IdKernel (const char *data) noexcept
+	{
+		// 22 bytes: chunk at 0 plus an overlapping chunk at 6
+		const __m128i head = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data));
+		const __m128i tail = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 6));
+		return _mm_movemask_epi8 (_mm_and_si128 (base64UrlMask (head), base64UrlMask (tail))) == 0xFFFF;
+	}
+
+#elif defined(HAPP_SIMD_NEON)
+
+	static inline uint8x16_t inRange (uint8x16_t v, char lo, char hi) noexcept
+	{
+		// Unsigned: (v - lo) <= (hi - lo)
+		return vcleq_u8 (vsubq_u8 (v, vdupq_n_u8 (static_cast<uint8_t> (lo))),
+		                 vdupq_n_u8 (static_cast<uint8_t> (hi - lo)));
+	}
+
+	static inline uint8x16_t hexMask (uint8x16_t v) noexcept
+	{
+		const uint8x16_t lower = vorrq_u8 (v, vdupq_n_u8 (0x20));
+		return vorrq_u8 (inRange (v, '0', '9'), inRange (lower, 'a', 'f'));
+	}
+
+	static inline uint8x16_t base64UrlMask (uint8x16_t v) noexcept
+	{
+		const uint8x16_t lower   = vorrq_u8 (v, vdupq_n_u8 (0x20));
+		const uint8x16_t alnum   = vorrq_u8 (inRange (v, '0', '9'), inRange (lower, 'a', 'z'));
+		const uint8x16_t urlsafe = vorrq_u8 (vceqq_u8 (v, vdupq_n_u8 ('-')), vceqq_u8 (v, vdupq_n_u8 ('_')));
+		return vorrq_u8 (alnum, urlsafe);
+	}
+
+	static inline bool uuidChunkValid (const char *data, size_t chunk) noexcept
+	{
+		const uint8x16_t hyphen = vld1q_u8 (kUuidHyphenMasks [chunk].data());
+		const uint8x16_t v      = vld1q_u8 (reinterpret_cast<const uint8_t *> (data + kUuidChunkOffsets [chunk]));
+		const uint8x16_t dashes = vceqq_u8 (v, vdupq_n_u8 ('-'));
+		const uint8x16_t valid  = vbslq_u8 (hyphen, dashes, hexMask (v));
+		return vminvq_u8 (valid) == 0xFF;
+	}
+
+	static inline bool uuidKernel (const char *data) noexcept
+	{
+		return uuidChunkValid (data, 0) && uuidChunkValid (data, 1) && uuidChunkValid (data, 2);
+	}
+
+	static inline bool base64IdKernel (const char *data) noexcept
 	{
-		INT      = 0,     // <param:int>
-		BASE64ID = 1,     // <param:base64id> (UUID encoded as Base64URL)
-		STRING   = 2,     // <param:string>
-		UUID     = 3,     // <param:uuid>
-		FLOAT    = 4,     // <param:float>
-		GENERIC  = 255    // <param> typeless
+		const uint8x16_t head = vld1q_u8 (reinterpret_cast<const uint8_t *> (data));
+		const uint8x16_t tail = vld1q_u8 (reinterpret_cast<const uint8_t *> (data + 6));
+		return vminvq_u8 (vandq_u8 (base64UrlMask (head), base64UrlMask (tail))) == 0xFF;
+	}
+
+#else
+
+	// Scalar fallback (table driven)
+	enum CharClass : uint8_t
+	{
+		CHAR_HEX    = 1 << 0,    // 0-9 a-f A-F
+		CHAR_B64URL = 1 << 1     // 0-9 a-z A-Z - _
 	};
 
-	// prototype
-	static ParamType fromParamTypeString (std::string_view type_str);
+	static constexpr std::array<uint8_t, 256> kCharClasses = []
+	{
+		std::array<uint8_t, 256> table {};
+		for (int c = '0'; c <= '9'; ++c)
+		{
+			table [c] = CHAR_HEX | CHAR_B64URL;
+		}
+		for (int c = 'a'; c <= 'z'; ++c)
+		{
+			table [c]             = CHAR_B64URL;
+			table [c - 'a' + 'A'] = CHAR_B64URL;
+		}
+		for (int c = 'a'; c <= 'f'; ++c)
+		{
+			table [c] |= CHAR_HEX;
+			table [c - 'a' + 'A'] |= CHAR_HEX;
+		}
+		table ['-'] = CHAR_B64URL;
+		table ['_'] = CHAR_B64URL;
+		return table;
+	}();
+
+	static inline bool hasCharClass (char c, uint8_t char_class) noexcept
+	{
+		return (kCharClasses [static_cast<unsigned char> (c)] & char_class) != 0;
+	}
+
+	static inline bool uuidKernel (const char *data) noexcept
+	{
+		for (size_t i = 0; i < 36; ++i)
+		{
+			if (isUuidHyphenPos (i) ? data [i] != '-' : !hasCharClass (data [i], CHAR_HEX))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static inline bool base64IdKernel (const char *data) noexcept
+	{
+		for (size_t i = 0; i < 22; ++i)
+		{
+			if (!hasCharClass (data [i], CHAR_B64URL))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+#endif
+
+	// Value of a hexadecimal digit (input already validated)
+	static inline uint8_t hexValue (char c) noexcept
+	{
+		return isDigit (c) ? static_cast<uint8_t> (c - '0') : static_cast<uint8_t> ((c | 0x20) - 'a' + 10);
+	}
+
+	// Value of a Base64URL digit (input already validated)
+	static inline uint8_t base64UrlValue (char c) noexcept
+	{
+		if (isDigit (c))
+		{
+			return static_cast<uint8_t> (c - '0' + 52);
+		}
+		if (c >= 'a')
+		{
+			return static_cast<uint8_t> (c - 'a' + 26);
+		}
+		if (c >= 'A')
+		{
+			return c == '_' ? 63 : static_cast<uint8_t> (c - 'A');
+		}
+		return 62;    // '-'
+	}
 
 	/**
-	 * @brief Validate an integer parameter.
+	 * @brief Validate and decode an integer parameter.
 	 * @param value The parameter value as a string.
+	 * @param decoded Receives the int64_t value (std::monostate if it does not fit in 64 bits).
 	 * @return True if the value is a valid integer, false otherwise.
 	 */
-	static bool validateIntParam (std::string_view value)
+	static bool validateIntParam (std::string_view value, ParamValue &decoded)
 	{
 		if (value.empty())
 		{
@@ -51,23 +268,38 @@ namespace ipb::http
 			return false;
 		}
 
+		// Accumulate the magnitude while validating; overflow only drops the decoded value
+		uint64_t magnitude = 0;
+		bool overflow      = false;
 		for (size_t i = start; i < value.size(); ++i)
 		{
-			if (!std::isdigit (static_cast<unsigned char> (value [i])))
+			if (!isDigit (value [i]))
 			{
 				return false;
 			}
+
+			const auto digit = static_cast<uint64_t> (value [i] - '0');
+			overflow         = overflow || magnitude > (UINT64_MAX - digit) / 10;
+			magnitude        = magnitude * 10 + digit;
+		}
+
+		const bool negative   = value [0] == '-';
+		const uint64_t limit  = negative ? uint64_t (INT64_MAX) + 1 : uint64_t (INT64_MAX);
+		if (!overflow && magnitude <= limit)
+		{
+			decoded = negative ? static_cast<int64_t> (0 - magnitude) : static_cast<int64_t> (magnitude);
 		}
 
 		return true;
 	}
 
 	/**
-	 * @brief Validate a Base64URL UUID parameter.
+	 * @brief Validate and decode a Base64URL UUID parameter.
 	 * @param value The parameter value as a string.
+	 * @param decoded Receives the 16 decoded bytes (Uuid).
 	 * @return True if the value is a valid Base64URL UUID, false otherwise.
 	 */
-	static bool validateBase64IdParam (std::string_view value)
+	static bool validateBase64IdParam (std::string_view value, ParamValue &decoded)
 	{
 		// Base64URL UUID format:
 		// - unpadded: 22 chars
@@ -77,38 +309,41 @@ namespace ipb::http
 			return false;
 		}
 
-		size_t payload_len = value.size();
-
-		if (value.size() == 24)
+		if (value.size() == 24 && (value [22] != '=' || value [23] != '='))
 		{
-			if (value [22] != '=' || value [23] != '=')
-			{
-				return false;
-			}
-			payload_len = 22;
+			return false;
 		}
 
-		for (size_t i = 0; i < payload_len; ++i)
+		if (!base64IdKernel (value.data()))
 		{
-			const unsigned char c = static_cast<unsigned char> (value [i]);
-			const bool is_alnum   = std::isalnum (c) != 0;
-			const bool is_urlsafe = (c == '-') || (c == '_');
+			return false;
+		}
 
-			if (!is_alnum && !is_urlsafe)
-			{
-				return false;
-			}
+		// 5 groups of 4 digits -> 15 bytes, the last 2 digits carry the 16th byte
+		Uuid bytes;
+		for (size_t group = 0; group < 5; ++group)
+		{
+			const char *digits   = value.data() + group * 4;
+			const uint32_t block = (uint32_t (base64UrlValue (digits [0])) << 18)
+			                       | (uint32_t (base64UrlValue (digits [1])) << 12)
+			                       | (uint32_t (base64UrlValue (digits [2])) << 6) | base64UrlValue (digits [3]);
+			bytes [group * 3]     = static_cast<uint8_t> (block >> 16);
+			bytes [group * 3 + 1] = static_cast<uint8_t> (block >> 8);
+			bytes [group * 3 + 2] = static_cast<uint8_t> (block);
 		}
+		bytes [15] = static_cast<uint8_t> ((base64UrlValue (value [20]) << 2) | (base64UrlValue (value [21]) >> 4));
 
+		decoded = bytes;
 		return true;
 	}
 
 	/**
-	 * @brief Validate a UUID parameter.
+	 * @brief Validate and decode a UUID parameter.
 	 * @param value The parameter value as a string.
+	 * @param decoded Receives the 16 decoded bytes (Uuid).
 	 * @return True if the value is a valid UUID, false otherwise.
 	 */
-	static bool validateUuidParam (std::string_view value)
+	static bool validateUuidParam (std::string_view value, ParamValue &decoded)
 	{
 		// UUID format: 8-4-4-4-12 hexadecimal characters separated by hyphens.
 		if (value.size() != 36)
@@ -116,31 +351,34 @@ namespace ipb::http
 			return false;
 		}
 
-		for (size_t i = 0; i < value.size(); ++i)
+		if (!uuidKernel (value.data()))
 		{
-			const char c = value [i];
-			if (i == 8 || i == 13 || i == 18 || i == 23)
-			{
-				if (c != '-')
-				{
-					return false;
-				}
-			}
-			else if (!std::isxdigit (static_cast<unsigned char> (c)))
+			return false;
+		}
+
+		Uuid bytes;
+		size_t pos = 0;
+		for (auto &byte : bytes)
+		{
+			if (isUuidHyphenPos (pos))
 			{
-				return false;
+				++pos;
 			}
+			byte = static_cast<uint8_t> ((hexValue (value [pos]) << 4) | hexValue (value [pos + 1]));
+			pos += 2;
 		}
 
+		decoded = bytes;
 		return true;
 	}
 
 	/**
-	 * @brief Validate a float parameter.
+	 * @brief Validate and decode a float parameter.
 	 * @param value The parameter value as a string.
+	 * @param decoded Receives the double value.
 	 * @return True if the value is a valid float, false otherwise.
 	 */
-	static bool validateFloatParam (std::string_view value)
+	static bool validateFloatParam (std::string_view value, ParamValue &decoded)
 	{
 		// Float format: optional sign, digits, optional decimal point, more digits.
 		if (value.empty())
@@ -165,7 +403,7 @@ namespace ipb::http
 		for (; i < value.size(); ++i)
 		{
 			const char c = value [i];
-			if (std::isdigit (static_cast<unsigned char> (c)))
+			if (isDigit (c))
 			{
 				has_digit = true;
 			}
@@ -179,7 +417,20 @@ namespace ipb::http
 			}
 		}
 
-		return has_digit;
+		if (!has_digit)
+		{
+			return false;
+		}
+
+		// std::from_chars does not accept a leading '+'
+		const char *first = value.data() + (value [0] == '+' ? 1 : 0);
+		double number     = 0.0;
+		if (auto result = std::from_chars (first, value.data() + value.size(), number); result.ec == std::errc())
+		{
+			decoded = number;
+		}
+
+		return true;
 	}
 
 	// Forward declaration
@@ -189,7 +440,7 @@ namespace ipb::http
 	class TrieNode
 	{
 		public:
-			std::map<std::string, TrieNode> literals;
+			std::map<std::string, TrieNode, std::less<>> literals;    // Transparent: lookup by string_view
 			std::vector<TypedParam> typed_params;    // Sorted by specificity
 			std::map<HttpMethod, RouteInfo> handlers;
 
@@ -204,7 +455,8 @@ namespace ipb::http
 			ParamType type;
 			TrieNode next;
 
-			bool validate (std::string_view value) const;
+			bool validate (std::string_view value, ParamValue &decoded) const;
+			static bool validate (ParamType type, std::string_view value, ParamValue &decoded);
 	};
 
 	// ParsedSegment - Result of parsing a segment
@@ -215,6 +467,304 @@ namespace ipb::http
 			ParamType type = ParamType::GENERIC;
 	};
 
+	// PathTokenizer - Walks the segments of a path without materializing them
+	// (same normalization as Router::Impl::splitPath)
+	class PathTokenizer
+	{
+		public:
+			explicit PathTokenizer (std::string_view path) noexcept;
+
+			bool next (std::string_view &segment) noexcept;
+			bool skip (std::string_view segments) noexcept;
+			std::string_view tail (std::string_view segment) noexcept;
+
+		private:
+			std::string_view rest_;
+			const char *end_ = nullptr;    // End of the normalized path
+			bool done_ = false;
+	};
+
+	// PipelineIterator - Walks a precomposed (contiguous) middleware pipeline, then runs the handler once
+	class PipelineIterator final : public IMiddlewareNext
+	{
+		public:
+			PipelineIterator (const Middleware *first, const Middleware *last, const RouteHandler &handler,
+			                  ICtx &context) noexcept
+			    : current_ (first)
+			    , end_ (last)
+			    , handler_ (handler)
+			    , context_ (context)
+			{
+			}
+
+			void start ()
+			{
+				next();
+			}
+
+			bool handlerCalled () const noexcept
+			{
+				return handler_called_;
+			}
+
+			void next () override
+			{
+				if (current_ == end_)
+				{
+					if (!handler_called_)
+					{
+						handler_called_ = true;
+						StageScope span (TraceStage::Handler);
+						handler_ (context_);
+					}
+					return;
+				}
+
+				const Middleware &middleware = *current_++;
+				StageScope span (TraceStage::Middleware, step_++);
+				middleware (context_, *this);
+			}
+
+		private:
+			const Middleware *current_;
+			const Middleware *end_;
+			const RouteHandler &handler_;
+			ICtx &context_;
+			uint16_t step_       = 0;    // Position of the next middleware (trace spans)
+			bool handler_called_ = false;
+	};
+
+	// AsyncMiddlewareStep / AsyncHandlerStep - Coroutine callbacks stored as the pipeline function types.
+	// executeAsync finds them (std::function::target) and awaits them; called synchronously, they run the
+	// coroutine and block until it completes, so `execute` keeps working on any route.
+	struct AsyncMiddlewareStep
+	{
+			AsyncMiddleware middleware;
+
+			void operator() (ICtx &context, IMiddlewareNext &next) const;
+	};
+
+	struct AsyncHandlerStep
+	{
+			AsyncRouteHandler handler;
+
+			void operator() (ICtx &context) const
+			{
+				handler (context).wait();
+			}
+	};
+
+	// AsyncPipeline - Awaitable walk of a middleware pipeline, then the handler once
+	class AsyncPipeline
+	{
+		public:
+			AsyncPipeline (std::vector<const Middleware *> steps, const RouteHandler &handler, ICtx &context)
+			    : steps_ (std::move (steps))
+			    , handler_ (handler)
+			    , context_ (context)
+			{
+			}
+
+			AsyncTask run (size_t index);
+
+			bool handlerCalled () const noexcept
+			{
+				return handler_called_;
+			}
+
+		private:
+			class AsyncNext;
+			class SyncNext;
+
+			std::vector<const Middleware *> steps_;
+			const RouteHandler &handler_;
+			ICtx &context_;
+			bool handler_called_ = false;
+	};
+
+	// AsyncPipeline::AsyncNext - `next` of a coroutine middleware: awaits the rest of the pipeline once
+	class AsyncPipeline::AsyncNext final : public IAsyncMiddlewareNext
+	{
+		public:
+			AsyncNext (AsyncPipeline &pipeline, size_t index) noexcept
+			    : pipeline_ (pipeline)
+			    , index_ (index)
+			{
+			}
+
+			AsyncTask next () override
+			{
+				if (called_)
+				{
+					return {};
+				}
+				called_ = true;
+				return pipeline_.run (index_);
+			}
+
+		private:
+			AsyncPipeline &pipeline_;
+			size_t index_;
+			bool called_ = false;
+	};
+
+	// AsyncPipeline::SyncNext - `next` of a synchronous middleware: runs the rest of the pipeline to completion
+	class AsyncPipeline::SyncNext final : public IMiddlewareNext
+	{
+		public:
+			SyncNext (AsyncPipeline &pipeline, size_t index) noexcept
+			    : pipeline_ (pipeline)
+			    , index_ (index)
+			{
+			}
+
+			void next () override
+			{
+				if (called_)
+				{
+					return;
+				}
+				called_ = true;
+				pipeline_.run (index_).wait();
+			}
+
+		private:
+			AsyncPipeline &pipeline_;
+			size_t index_;
+			bool called_ = false;
+	};
+
+	// ============================================================================
+	// Compiled route table (flat, read-only layout built by Router::freeze)
+	// ============================================================================
+
+	// FlatNode - Node of the compiled table; child ranges are indices into the table arrays
+	struct FlatNode
+	{
+			uint32_t literal_begin = 0;
+			uint32_t literal_count = 0;
+			uint32_t param_begin   = 0;
+			uint32_t param_count   = 0;
+			uint32_t method_begin  = 0;
+			uint32_t method_count  = 0;
+	};
+
+	// FlatLiteral - Literal edge, text interned in the table pool. Chains of single-child literal nodes are
+	// compressed into one edge, whose text holds every segment of the chain ("api/v2/tenants")
+	struct FlatLiteral
+	{
+			uint32_t text_offset  = 0;
+			uint32_t text_length  = 0;
+			uint32_t first_length = 0;    // Length of the first segment (the search key of the edge)
+			uint32_t child        = 0;
+	};
+
+	// FlatParam - Typed parameter edge, name interned in the table pool
+	struct FlatParam
+	{
+			uint32_t name_offset = 0;
+			uint32_t name_length = 0;
+			ParamType type       = ParamType::GENERIC;
+			uint8_t reserved [3] = {};    // Explicit padding: images are reproducible byte for byte
+			uint32_t child       = 0;
+	};
+
+	// FlatMethod - Method table entry, route is an index into CompiledRouteTable::routes
+	struct FlatMethod
+	{
+			HttpMethod method    = HttpMethod::ANY;
+			uint8_t reserved [3] = {};
+			uint32_t route       = 0;
+	};
+
+	// FlatRoute - Route of a table image (the handler is bound again by id), pattern in the pattern pool
+	struct FlatRoute
+	{
+			uint32_t id             = 0;
+			uint32_t pattern_offset = 0;
+			uint32_t pattern_length = 0;
+			HttpMethod method       = HttpMethod::ANY;
+			uint8_t reserved [3]    = {};
+	};
+
+	// RouteImageHeader - Start of a route table image. The sections follow it in this order, each one 8-byte
+	// aligned: nodes, literals, params, methods, routes, pool, patterns (see ImageSections)
+	struct RouteImageHeader
+	{
+			std::array<char, 8> magic {};
+			uint32_t version       = 0;
+			uint32_t byte_order    = 0;    // kImageByteOrder, as stored by the writer
+			uint32_t layout        = 0;    // Sizes of the flat records (kImageLayout)
+			uint32_t node_count    = 0;
+			uint32_t literal_count = 0;
+			uint32_t param_count   = 0;
+			uint32_t method_count  = 0;
+			uint32_t route_count   = 0;
+			uint32_t pool_size     = 0;
+			uint32_t pattern_size  = 0;
+	};
+
+	// The image is the in-memory layout of the records, so they must not hold padding bytes
+	static_assert (std::has_unique_object_representations_v<FlatNode>);
+	static_assert (std::has_unique_object_representations_v<FlatLiteral>);
+	static_assert (std::has_unique_object_representations_v<FlatParam>);
+	static_assert (std::has_unique_object_representations_v<FlatMethod>);
+	static_assert (std::has_unique_object_representations_v<FlatRoute>);
+	static_assert (std::has_unique_object_representations_v<RouteImageHeader>);
+
+	class CompiledRouteTable
+	{
+		public:
+			// Views into the storage of the table: its own arrays, or a route table image
+			std::span<const FlatNode> nodes;          // nodes[0] is the root
+			std::span<const FlatLiteral> literals;    // Sorted by first segment inside each node range
+			std::span<const FlatParam> params;        // Sorted by specificity inside each node range
+			std::span<const FlatMethod> methods;      // Sorted by method inside each node range
+			std::string_view pool;                    // Interned literal segments and parameter names
+			std::vector<RouteInfo> routes;            // Read-only copies of the registered routes
+
+			static std::unique_ptr<CompiledRouteTable> build (const TrieNode &root,
+			                                                  const std::vector<Middleware> &globalMiddlewares);
+
+			/**
+			 * Table reading a route table image in place (`owner` keeps the image alive).
+			 * Null if the image is invalid or if a route has no handler.
+			 */
+			static std::unique_ptr<CompiledRouteTable> load (std::shared_ptr<const void> owner, std::string_view image,
+			                                                 std::span<const RouteHandler> handlers,
+			                                                 const std::vector<Middleware> &globalMiddlewares);
+
+			// Same table (sharing the storage) with the pipelines composed again
+			std::unique_ptr<CompiledRouteTable> rebind (const std::vector<Middleware> &globalMiddlewares) const;
+
+			std::string image () const;
+
+			std::optional<std::reference_wrapper<const RouteInfo>> match (HttpMethod method, std::string_view path,
+			                                                              ICtx &context) const;
+
+		private:
+			// Arrays of a table compiled from a Trie
+			struct Storage
+			{
+					std::vector<FlatNode> nodes;
+					std::vector<FlatLiteral> literals;
+					std::vector<FlatParam> params;
+					std::vector<FlatMethod> methods;
+					std::string pool;
+			};
+
+			std::shared_ptr<const void> owner_;    // The Storage or the image behind the views
+
+			void compose (const std::vector<Middleware> &globalMiddlewares);
+			bool isConsistent () const noexcept;
+			std::string_view text (uint32_t offset, uint32_t length) const noexcept;
+			static uint32_t intern (Storage &storage, std::string_view value,
+			                        std::map<std::string, uint32_t, std::less<>> &interned);
+			uint32_t compileNode (Storage &storage, const TrieNode &node,
+			                      std::map<std::string, uint32_t, std::less<>> &interned);
+			const FlatLiteral *findLiteral (const FlatNode &node, std::string_view segment) const noexcept;
+	};
+
 	// ============================================================================
 	// Router::Impl - Pimpl implementation
 	// ============================================================================
@@ -224,6 +774,19 @@ namespace ipb::http
 		public:
 			TrieNode root_;
 			std::vector<Middleware> middlewares;    // Global middlewares
+			std::atomic<CompiledRouteTable *> compiled_ {nullptr};    // Published table (owned)
+			mutable EpochDomain epoch_;                               // Reclaims replaced tables
+			std::mutex retired_mutex_;                                // Guards the two members below
+			std::vector<std::unique_ptr<CompiledRouteTable>> retired_;    // Replaced inside a read section
+			std::thread::id deferredBy_;                              // Thread whose section still reads them
+			std::atomic<bool> reclaimPending_ {false};                // retired_ is not empty
+			uint32_t nextRouteId_ = 0;                                // RouteInfo::id of the next route
+			bool servesImage_     = false;    // The table comes from loadImage (and no route was added since)
+
+			Impl () = default;
+			~Impl ();
+			Impl (const Impl &)            = delete;
+			Impl &operator= (const Impl &) = delete;
 
 			// Public API implementation
 			RouteInfo &add (HttpMethod method, std::string_view pattern, RouteHandler handler);
@@ -232,8 +795,20 @@ namespace ipb::http
 			std::optional<std::reference_wrapper<const RouteInfo>> match (HttpMethod method, std::string_view path,
 			                                                              ICtx &context) const;
 			void execute (const RouteInfo &routeInfo, ICtx &context) const;
+			AsyncTask executeAsync (const RouteInfo &routeInfo, ICtx &context) const;
+			void freeze ();
+			void publish (std::unique_ptr<CompiledRouteTable> table);
+			void reclaim (std::unique_ptr<CompiledRouteTable> previous);
+			void reclaimDeferred ();
+			bool load (std::shared_ptr<const void> owner, std::string_view image, std::span<const RouteHandler> handlers);
+			std::vector<RouteMetricsSnapshot> metrics () const;
 
 		private:
+			// match / execute without the metrics; run returns whether the handler was called
+			std::optional<std::reference_wrapper<const RouteInfo>> lookup (HttpMethod method, std::string_view path,
+			                                                               ICtx &context) const;
+			bool run (const RouteInfo &routeInfo, ICtx &context) const;
+
 			// Helper methods
 			static std::vector<std::string_view> splitPath (std::string_view path);
 			static ParsedSegment parseSegment (std::string_view segment);
@@ -280,29 +855,718 @@ namespace ipb::http
 	/**
 	 * @brief Validate a parameter value against the TypedParam's type.
 	 * @param value The parameter value as a string.
+	 * @param decoded Receives the value decoded during validation.
+	 * @return True if the value is valid for the type, false otherwise.
+	 */
+	bool TypedParam::validate (std::string_view value, ParamValue &decoded) const
+	{
+		return validate (type, value, decoded);
+	}
+
+	/**
+	 * @brief Validate a parameter value against a parameter type, decoding it in the same pass.
+	 * @param type The parameter type.
+	 * @param value The parameter value as a string.
+	 * @param decoded Receives the decoded value (left as std::monostate for string/generic parameters).
 	 * @return True if the value is valid for the type, false otherwise.
 	 */
-	bool TypedParam::validate (std::string_view value) const
+	bool TypedParam::validate (ParamType type, std::string_view value, ParamValue &decoded)
 	{
 		switch (type)
 		{
-		case ParamType::INT: return validateIntParam (value);
+		case ParamType::INT: return validateIntParam (value, decoded);
 
-		case ParamType::BASE64ID: return validateBase64IdParam (value);
+		case ParamType::BASE64ID: return validateBase64IdParam (value, decoded);
 
-		case ParamType::UUID: return validateUuidParam (value);
+		case ParamType::UUID: return validateUuidParam (value, decoded);
 
-		case ParamType::FLOAT: return validateFloatParam (value);
+		case ParamType::FLOAT: return validateFloatParam (value, decoded);
+
+		case ParamType::STRING:
+			// String accepts any non-empty value.
+			return !value.empty();
+
+		case ParamType::PATH:
+			// The tail is captured by the caller (see PathTokenizer::tail); it accepts any segment.
+			return true;
+
+		case ParamType::GENERIC:
+		default:
+			// Generic accepts everything.
+			return true;
+		}
+	}
+
+	// ============================================================================
+	// Coroutine pipeline implementation
+	// ============================================================================
+
+	/**
+	 * @brief Run a coroutine middleware from a synchronous chain, blocking until it completes.
+	 * @param context The request context.
+	 * @param next The synchronous continuation, called (at most once) when the middleware awaits `next`.
+	 */
+	void AsyncMiddlewareStep::operator() (ICtx &context, IMiddlewareNext &next) const
+	{
+		class Bridge final : public IAsyncMiddlewareNext
+		{
+			public:
+				explicit Bridge (IMiddlewareNext &next) noexcept
+				    : next_ (next)
+				{
+				}
+
+				AsyncTask next () override
+				{
+					if (!called_)
+					{
+						called_ = true;
+						next_.next();
+					}
+					return {};
+				}
+
+			private:
+				IMiddlewareNext &next_;
+				bool called_ = false;
+		};
+
+		Bridge bridge (next);
+		middleware (context, bridge).wait();
+	}
+
+	/**
+	 * @brief Run the pipeline from a step on, then the handler (once).
+	 * @param index The first step to run; the handler runs once every step has called `next`.
+	 * @return The task, completed once the step (with everything it awaited) has returned.
+	 */
+	AsyncTask AsyncPipeline::run (size_t index)
+	{
+		if (index == steps_.size())
+		{
+			if (handler_called_)
+			{
+				co_return;
+			}
+			handler_called_ = true;
+
+			if (const auto *step = handler_.target<AsyncHandlerStep>())
+			{
+				co_await step->handler (context_);
+			}
+			else
+			{
+				handler_ (context_);
+			}
+			co_return;
+		}
+
+		const Middleware &middleware = *steps_ [index];
+		if (const auto *step = middleware.target<AsyncMiddlewareStep>())
+		{
+			AsyncNext next (*this, index + 1);
+			co_await step->middleware (context_, next);
+		}
+		else
+		{
+			SyncNext next (*this, index + 1);
+			middleware (context_, next);
+		}
+	}
+
+	// ============================================================================
+	// PathTokenizer implementation
+	// ============================================================================
+
+	/**
+	 * @brief Prepare a path for tokenization, removing leading/trailing slashes.
+	 * @param path The input path (e.g., "/users/123/").
+	 */
+	PathTokenizer::PathTokenizer (std::string_view path) noexcept
+	{
+		// Remove trailing slash
+		if (path.ends_with ('/') && path.size() > 1)
+		{
+			path.remove_suffix (1);
+		}
+
+		// Remove leading slash
+		if (path.starts_with ('/'))
+		{
+			path.remove_prefix (1);
+		}
+
+		// Root path has no segments
+		rest_ = path;
+		end_  = path.data() + path.size();
+		done_ = path.empty();
+	}
+
+	/**
+	 * @brief Get the next path segment.
+	 * @param segment Receives the segment (a view into the original path).
+	 * @return True if a segment was produced, false once the path is exhausted.
+	 */
+	bool PathTokenizer::next (std::string_view &segment) noexcept
+	{
+		if (done_)
+		{
+			return false;
+		}
+
+		const size_t end = rest_.find ('/');
+		if (end == std::string_view::npos)
+		{
+			segment = rest_;
+			done_   = true;
+			return true;
+		}
+
+		segment = rest_.substr (0, end);
+		rest_.remove_prefix (end + 1);
+		return true;
+	}
+
+	/**
+	 * @brief Consume the next segments if they are exactly `segments` (a single comparison).
+	 * @param segments One or more segments joined by '/' (e.g., "v2/tenants").
+	 * @return True if they were consumed, false (leaving the tokenizer untouched) otherwise.
+	 */
+	bool PathTokenizer::skip (std::string_view segments) noexcept
+	{
+		if (done_ || !rest_.starts_with (segments))
+		{
+			return false;
+		}
+
+		if (rest_.size() == segments.size())
+		{
+			rest_ = {};
+			done_ = true;
+			return true;
+		}
+
+		if (rest_ [segments.size()] != '/')
+		{
+			return false;
+		}
+
+		rest_.remove_prefix (segments.size() + 1);
+		return true;
+	}
+
+	/**
+	 * @brief Consume the rest of the path.
+	 * @param segment The last segment produced by `next`.
+	 * @return A view from that segment to the end of the path (e.g., "css/site.css").
+	 */
+	std::string_view PathTokenizer::tail (std::string_view segment) noexcept
+	{
+		rest_ = {};
+		done_ = true;
+		return std::string_view (segment.data(), static_cast<size_t> (end_ - segment.data()));
+	}
+
+	// ============================================================================
+	// CompiledRouteTable implementation
+	// ============================================================================
+
+	/**
+	 * @brief Compile a Trie into a flat table.
+	 * @param root The root node of the Trie.
+	 * @param globalMiddlewares The global middlewares, prepended to the pipeline of every route.
+	 * @return The compiled table, with the root at index 0.
+	 */
+	std::unique_ptr<CompiledRouteTable> CompiledRouteTable::build (const TrieNode &root,
+	                                                               const std::vector<Middleware> &globalMiddlewares)
+	{
+		auto table   = std::make_unique<CompiledRouteTable>();
+		auto storage = std::make_shared<Storage>();
+		std::map<std::string, uint32_t, std::less<>> interned;
+
+		table->compileNode (*storage, root, interned);
+
+		table->nodes    = storage->nodes;
+		table->literals = storage->literals;
+		table->params   = storage->params;
+		table->methods  = storage->methods;
+		table->pool     = storage->pool;
+		table->owner_   = std::move (storage);
+
+		table->compose (globalMiddlewares);
+		return table;
+	}
+
+	/**
+	 * @brief Precompose the pipeline of each route: global middlewares first, then the route ones.
+	 * @param globalMiddlewares The global middlewares of the router.
+	 */
+	void CompiledRouteTable::compose (const std::vector<Middleware> &globalMiddlewares)
+	{
+		for (auto &route : routes)
+		{
+			route.pipeline.clear();
+			route.pipeline.reserve (globalMiddlewares.size() + route.middlewares.size());
+			route.pipeline.insert (route.pipeline.end(), globalMiddlewares.begin(), globalMiddlewares.end());
+			route.pipeline.insert (route.pipeline.end(), route.middlewares.begin(), route.middlewares.end());
+			route.frozen = true;
+			route.async  = route.handler.target<AsyncHandlerStep>() != nullptr
+			              || std::ranges::any_of (route.pipeline, [] (const Middleware &middleware)
+			                                      { return middleware.target<AsyncMiddlewareStep>() != nullptr; });
+		}
+	}
+
+	/**
+	 * @brief Copy the table (the views share its storage) with the pipelines composed again.
+	 * @param globalMiddlewares The global middlewares of the router.
+	 * @return The new table.
+	 */
+	std::unique_ptr<CompiledRouteTable> CompiledRouteTable::rebind (const std::vector<Middleware> &globalMiddlewares) const
+	{
+		auto table = std::make_unique<CompiledRouteTable> (*this);
+		table->compose (globalMiddlewares);
+		return table;
+	}
+
+	// ============================================================================
+	// Route table images
+	// ============================================================================
+
+	static constexpr std::array<char, 8> kImageMagic = {'H', 'A', 'P', 'P', 'R', 'T', 'B', 'L'};
+	static constexpr uint32_t kImageVersion          = 1;
+	static constexpr uint32_t kImageByteOrder        = 0x01020304;
+	static constexpr uint32_t kImageLayout =
+	    static_cast<uint32_t> (sizeof (FlatNode) | sizeof (FlatLiteral) << 6 | sizeof (FlatParam) << 12
+	                           | sizeof (FlatMethod) << 18 | sizeof (FlatRoute) << 24);
+
+	// ImageSections - Byte offsets of the sections of an image, and its total size
+	struct ImageSections
+	{
+			uint64_t nodes    = 0;
+			uint64_t literals = 0;
+			uint64_t params   = 0;
+			uint64_t methods  = 0;
+			uint64_t routes   = 0;
+			uint64_t pool     = 0;
+			uint64_t patterns = 0;
+			uint64_t size     = 0;
+
+			// 64-bit arithmetic: the counts of a corrupt header cannot overflow it
+			static ImageSections of (const RouteImageHeader &header) noexcept
+			{
+				ImageSections sections;
+				uint64_t offset    = sizeof (RouteImageHeader);
+				const auto section = [&offset] (uint64_t bytes)
+				{
+					const uint64_t begin = offset;
+					offset               = (offset + bytes + 7) & ~uint64_t {7};
+					return begin;
+				};
+
+				sections.nodes    = section (uint64_t {header.node_count} * sizeof (FlatNode));
+				sections.literals = section (uint64_t {header.literal_count} * sizeof (FlatLiteral));
+				sections.params   = section (uint64_t {header.param_count} * sizeof (FlatParam));
+				sections.methods  = section (uint64_t {header.method_count} * sizeof (FlatMethod));
+				sections.routes   = section (uint64_t {header.route_count} * sizeof (FlatRoute));
+				sections.pool     = section (header.pool_size);
+				sections.patterns = section (header.pattern_size);
+				sections.size     = offset;
+				return sections;
+			}
+	};
+
+	template <typename T>
+	static void storeSection (std::string &image, uint64_t offset, std::span<const T> records)
+	{
+		if (!records.empty())
+		{
+			std::memcpy (image.data() + offset, records.data(), records.size_bytes());
+		}
+	}
+
+	template <typename T>
+	static std::span<const T> viewSection (std::string_view image, uint64_t offset, uint32_t count) noexcept
+	{
+		return std::span<const T> (reinterpret_cast<const T *> (image.data() + offset), count);
+	}
+
+	static bool isParamType (ParamType type) noexcept
+	{
+		switch (type)
+		{
+		case ParamType::INT:
+		case ParamType::BASE64ID:
+		case ParamType::STRING:
+		case ParamType::UUID:
+		case ParamType::FLOAT:
+		case ParamType::GENERIC:
+		case ParamType::PATH: return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Serialize the table: the flat arrays as they are in memory, and the routes without handlers.
+	 * @return The image (the same table always gives the same bytes).
+	 */
+	std::string CompiledRouteTable::image () const
+	{
+		std::vector<FlatRoute> records;
+		records.reserve (routes.size());
+		std::string patterns;
+		for (const RouteInfo &route : routes)
+		{
+			records.push_back (FlatRoute {.id             = route.id,
+			                              .pattern_offset = static_cast<uint32_t> (patterns.size()),
+			                              .pattern_length = static_cast<uint32_t> (route.pattern.size()),
+			                              .method         = route.method});
+			patterns.append (route.pattern);
+		}
+
+		RouteImageHeader header;
+		header.magic         = kImageMagic;
+		header.version       = kImageVersion;
+		header.byte_order    = kImageByteOrder;
+		header.layout        = kImageLayout;
+		header.node_count    = static_cast<uint32_t> (nodes.size());
+		header.literal_count = static_cast<uint32_t> (literals.size());
+		header.param_count   = static_cast<uint32_t> (params.size());
+		header.method_count  = static_cast<uint32_t> (methods.size());
+		header.route_count   = static_cast<uint32_t> (records.size());
+		header.pool_size     = static_cast<uint32_t> (pool.size());
+		header.pattern_size  = static_cast<uint32_t> (patterns.size());
+
+		const ImageSections sections = ImageSections::of (header);
+		std::string image (static_cast<size_t> (sections.size), '\0');
+		std::memcpy (image.data(), &header, sizeof (header));
+		storeSection (image, sections.nodes, nodes);
+		storeSection (image, sections.literals, literals);
+		storeSection (image, sections.params, params);
+		storeSection (image, sections.methods, methods);
+		storeSection (image, sections.routes, std::span<const FlatRoute> (records));
+		storeSection (image, sections.pool, std::span<const char> (pool));
+		storeSection (image, sections.patterns, std::span<const char> (patterns));
+		return image;
+	}
+
+	/**
+	 * @brief Build a table that reads an image in place.
+	 * @param owner Keeps the image memory alive as long as the table (and its copies).
+	 * @param image The image bytes (at least 4-byte aligned).
+	 * @param handlers The handler of each route ID.
+	 * @param globalMiddlewares The global middlewares, prepended to the pipeline of every route.
+	 * @return The table, or nullptr if the image is not valid for this build or a route has no handler.
+	 */
+	std::unique_ptr<CompiledRouteTable> CompiledRouteTable::load (std::shared_ptr<const void> owner,
+	                                                              std::string_view image,
+	                                                              std::span<const RouteHandler> handlers,
+	                                                              const std::vector<Middleware> &globalMiddlewares)
+	{
+		RouteImageHeader header;
+		if (image.size() < sizeof (header) || reinterpret_cast<uintptr_t> (image.data()) % alignof (FlatNode) != 0)
+		{
+			return nullptr;
+		}
+		std::memcpy (&header, image.data(), sizeof (header));
+		if (header.magic != kImageMagic || header.version != kImageVersion || header.byte_order != kImageByteOrder
+		    || header.layout != kImageLayout || header.node_count == 0)
+		{
+			return nullptr;
+		}
+
+		const ImageSections sections = ImageSections::of (header);
+		if (sections.size != image.size())
+		{
+			return nullptr;
+		}
+
+		auto table      = std::make_unique<CompiledRouteTable>();
+		table->nodes    = viewSection<FlatNode> (image, sections.nodes, header.node_count);
+		table->literals = viewSection<FlatLiteral> (image, sections.literals, header.literal_count);
+		table->params   = viewSection<FlatParam> (image, sections.params, header.param_count);
+		table->methods  = viewSection<FlatMethod> (image, sections.methods, header.method_count);
+		table->pool     = image.substr (static_cast<size_t> (sections.pool), header.pool_size);
+		for (const FlatMethod &entry : table->methods)
+		{
+			if (entry.route >= header.route_count)
+			{
+				return nullptr;
+			}
+		}
+		if (!table->isConsistent())
+		{
+			return nullptr;
+		}
+
+		// The routes are the only part copied out of the image: they carry the handlers
+		const std::string_view patterns = image.substr (static_cast<size_t> (sections.patterns), header.pattern_size);
+		table->routes.reserve (header.route_count);
+		for (const FlatRoute &record : viewSection<FlatRoute> (image, sections.routes, header.route_count))
+		{
+			if (uint64_t {record.pattern_offset} + record.pattern_length > patterns.size()
+			    || record.id >= handlers.size() || !handlers [record.id])
+			{
+				return nullptr;
+			}
+
+			RouteInfo &route = table->routes.emplace_back();
+			route.pattern    = patterns.substr (record.pattern_offset, record.pattern_length);
+			route.method     = record.method;
+			route.handler    = handlers [record.id];
+			route.id         = record.id;
+#if defined(HAPP_ROUTE_METRICS)
+			route.metrics = std::make_shared<RouteMetrics>();
+#endif
+		}
+
+		table->owner_ = std::move (owner);
+		table->compose (globalMiddlewares);
+		return table;
+	}
+
+	/**
+	 * @brief Check that every index and text range of the table stays inside it (tables read from an image).
+	 * @return True if matching cannot read out of bounds.
+	 */
+	bool CompiledRouteTable::isConsistent () const noexcept
+	{
+		const auto inside = [] (uint64_t begin, uint64_t count, size_t size) { return begin + count <= size; };
+
+		for (const FlatNode &node : nodes)
+		{
+			if (!inside (node.literal_begin, node.literal_count, literals.size())
+			    || !inside (node.param_begin, node.param_count, params.size())
+			    || !inside (node.method_begin, node.method_count, methods.size()))
+			{
+				return false;
+			}
+		}
+		for (const FlatLiteral &literal : literals)
+		{
+			if (!inside (literal.text_offset, literal.text_length, pool.size())
+			    || literal.first_length > literal.text_length || literal.child >= nodes.size())
+			{
+				return false;
+			}
+		}
+		for (const FlatParam &param : params)
+		{
+			if (!inside (param.name_offset, param.name_length, pool.size()) || !isParamType (param.type)
+			    || param.child >= nodes.size())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Get a view of an interned string.
+	 * @param offset The offset in the pool.
+	 * @param length The length of the string.
+	 * @return A view into the pool.
+	 */
+	std::string_view CompiledRouteTable::text (uint32_t offset, uint32_t length) const noexcept
+	{
+		return pool.substr (offset, length);
+	}
+
+	/**
+	 * @brief Store a string in the pool once, reusing previous copies.
+	 * @param storage The arrays being compiled.
+	 * @param value The string to intern.
+	 * @param interned Offsets of the strings already stored in the pool.
+	 * @return The offset of the string in the pool.
+	 */
+	uint32_t CompiledRouteTable::intern (Storage &storage, std::string_view value,
+	                                     std::map<std::string, uint32_t, std::less<>> &interned)
+	{
+		if (auto it = interned.find (value); it != interned.end())
+		{
+			return it->second;
+		}
+
+		const auto offset = static_cast<uint32_t> (storage.pool.size());
+		storage.pool.append (value);
+		interned.emplace (std::string (value), offset);
+		return offset;
+	}
+
+	/**
+	 * @brief Append a Trie node (and its subtree) to the table.
+	 * @param storage The arrays being compiled.
+	 * @param node The Trie node to compile.
+	 * @param interned Offsets of the strings already stored in the pool.
+	 * @return The index of the compiled node.
+	 */
+	uint32_t CompiledRouteTable::compileNode (Storage &storage, const TrieNode &node,
+	                                          std::map<std::string, uint32_t, std::less<>> &interned)
+	{
+		auto &nodes    = storage.nodes;
+		auto &literals = storage.literals;
+		auto &params   = storage.params;
+		auto &methods  = storage.methods;
+
+		const auto index = static_cast<uint32_t> (nodes.size());
+		nodes.emplace_back();
+
+		// Reserve the child ranges first, so the entries of this node stay contiguous
+		FlatNode flat;
+		flat.literal_begin = static_cast<uint32_t> (literals.size());
+		flat.literal_count = static_cast<uint32_t> (node.literals.size());
+		literals.resize (literals.size() + node.literals.size());
+
+		flat.param_begin = static_cast<uint32_t> (params.size());
+		flat.param_count = static_cast<uint32_t> (node.typed_params.size());
+		params.resize (params.size() + node.typed_params.size());
+
+		flat.method_begin = static_cast<uint32_t> (methods.size());
+		flat.method_count = static_cast<uint32_t> (node.handlers.size());
+		for (const auto &[method, route_info] : node.handlers)
+		{
+			methods.push_back (FlatMethod {.method = method, .route = static_cast<uint32_t> (routes.size())});
+			routes.push_back (route_info);
+		}
+
+		nodes [index] = flat;
+
+		// std::map iterates in lexicographic order, which keeps each literal range sorted
+		uint32_t slot = flat.literal_begin;
+		std::string edge;
+		for (const auto &[segment, child] : node.literals)
+		{
+			// Compress the chain while the nodes below only continue it (one literal, no parameters, no handlers)
+			edge.assign (segment);
+			const TrieNode *tail = &child;
+			while (tail->literals.size() == 1 && tail->typed_params.empty() && tail->handlers.empty())
+			{
+				const auto &[next_segment, next_child] = *tail->literals.begin();
+				edge.append (1, '/').append (next_segment);
+				tail = &next_child;
+			}
+
+			const auto offset = intern (storage, edge, interned);
+			const auto target = compileNode (storage, *tail, interned);
+			literals [slot++] = FlatLiteral {.text_offset  = offset,
+			                                 .text_length  = static_cast<uint32_t> (edge.size()),
+			                                 .first_length = static_cast<uint32_t> (segment.size()),
+			                                 .child        = target};
+		}
+
+		slot = flat.param_begin;
+		for (const auto &typed_param : node.typed_params)
+		{
+			const auto offset = intern (storage, typed_param.name, interned);
+			const auto target = compileNode (storage, typed_param.next, interned);
+			params [slot++]   = FlatParam {.name_offset = offset,
+			                               .name_length = static_cast<uint32_t> (typed_param.name.size()),
+			                               .type        = typed_param.type,
+			                               .child       = target};
+		}
+
+		return index;
+	}
+
+	/**
+	 * @brief Find the literal edge of a node whose first segment matches a segment (binary search).
+	 * @param node The node to search in.
+	 * @param segment The path segment.
+	 * @return The literal edge, or nullptr if there is none.
+	 */
+	const FlatLiteral *CompiledRouteTable::findLiteral (const FlatNode &node, std::string_view segment) const noexcept
+	{
+		const FlatLiteral *first = literals.data() + node.literal_begin;
+		const FlatLiteral *last  = first + node.literal_count;
+
+		auto it = std::lower_bound (first, last, segment,
+		                            [this] (const FlatLiteral &literal, std::string_view value)
+		                            {
+			                            return text (literal.text_offset, literal.first_length) < value;
+		                            });
+
+		if (it != last && text (it->text_offset, it->first_length) == segment)
+		{
+			return it;
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief Match a path against the compiled table (same priorities as the Trie walk, no allocations).
+	 * @param method The HTTP method of the incoming request.
+	 * @param path The request path to match.
+	 * @param context The context object to store extracted parameters.
+	 * @return An optional containing the matched RouteInfo, or std::nullopt if no match.
+	 */
+	std::optional<std::reference_wrapper<const RouteInfo>>
+	    CompiledRouteTable::match (HttpMethod method, std::string_view path, ICtx &context) const
+	{
+		const FlatNode *current = &nodes [0];
+		PathTokenizer tokenizer (path);
+		std::string_view segment;
+
+		while (tokenizer.next (segment))
+		{
+			// 1. Try exact literal first (highest priority); the rest of a compressed edge has no alternative
+			if (const auto *literal = findLiteral (*current, segment))
+			{
+				if (literal->text_length != literal->first_length
+				    && !tokenizer.skip (text (literal->text_offset + literal->first_length + 1,
+				                              literal->text_length - literal->first_length - 1)))
+				{
+					return std::nullopt;
+				}
+				current = &nodes [literal->child];
+				continue;
+			}
+
+			// 2. Try typed parameters (sorted by specificity)
+			const FlatParam *matched = nullptr;
+			ParamValue decoded;
+			for (uint32_t i = 0; i < current->param_count; ++i)
+			{
+				const auto &param = params [current->param_begin + i];
+				if (TypedParam::validate (param.type, segment, decoded))
+				{
+					matched = &param;
+					break;    // First match wins
+				}
+			}
+
+			if (!matched)
+			{
+				return std::nullopt;
+			}
+
+			if (matched->type == ParamType::PATH)
+			{
+				segment = tokenizer.tail (segment);
+			}
+
+			context.setTypedParam (text (matched->name_offset, matched->name_length), segment, decoded);
+			current = &nodes [matched->child];
+		}
 
-		case ParamType::STRING:
-			// String accepts any non-empty value.
-			return !value.empty();
+		// Resolve the handler (specific method first, then ANY fallback)
+		const FlatMethod *any = nullptr;
+		for (uint32_t i = 0; i < current->method_count; ++i)
+		{
+			const auto &entry = methods [current->method_begin + i];
+			if (entry.method == method)
+			{
+				return std::cref (routes [entry.route]);
+			}
+			if (entry.method == HttpMethod::ANY)
+			{
+				any = &entry;
+			}
+		}
 
-		case ParamType::GENERIC:
-		default:
-			// Generic accepts everything.
-			return true;
+		if (any)
+		{
+			return std::cref (routes [any->route]);
 		}
+		return std::nullopt;
 	}
 
 	// ============================================================================
@@ -314,12 +1578,23 @@ namespace ipb::http
 	 * @param pattern The route pattern (e.g., "/users/<id:int>").
 	 * @param handler The route handler function.
 	 * @return A reference to the RouteInfo of the added route.
+	 * @throws std::invalid_argument If a path parameter is not the last segment (nothing is added).
 	 */
 	RouteInfo &Router::Impl::add (HttpMethod method, std::string_view pattern, RouteHandler handler)
 	{
 		auto segments = splitPath (pattern);
 		auto *current = &root_;
 
+		// A path parameter captures the rest of the path, so a segment after it could never match
+		for (size_t i = 0; i + 1 < segments.size(); ++i)
+		{
+			if (parseSegment (segments [i]).type == ParamType::PATH)
+			{
+				throw std::invalid_argument ("Invalid route pattern (a path parameter must be the last segment): "
+				                             + std::string (pattern));
+			}
+		}
+
 		// Traverse/create the tree based on segments
 		for (const auto &segment : segments)
 		{
@@ -327,8 +1602,21 @@ namespace ipb::http
 		}
 
 		// Store the handler in the final node
-		RouteInfo route_info {
-		    .pattern = std::string (pattern), .method = method, .handler = std::move (handler), .middlewares = {}};
+		RouteInfo route_info {.pattern     = std::string (pattern),
+		                      .method      = method,
+		                      .handler     = std::move (handler),
+		                      .middlewares = {},
+		                      .pipeline    = {},
+		                      .frozen      = false};
+
+#if defined(HAPP_ROUTE_METRICS)
+		route_info.metrics = std::make_shared<RouteMetrics>();
+#endif
+
+		// A replaced route keeps its ID
+		const auto existing = current->handlers.find (method);
+		route_info.id       = existing != current->handlers.end() ? existing->second.id : nextRouteId_++;
+		servesImage_        = false;
 
 		current->handlers [method] = std::move (route_info);
 		return current->handlers [method];
@@ -373,19 +1661,49 @@ namespace ipb::http
 	std::optional<std::reference_wrapper<const RouteInfo>>
 	    Router::Impl::match (HttpMethod method, std::string_view path, ICtx &context) const
 	{
-		auto segments           = splitPath (path);
+		StageScope span (TraceStage::Match);
+#if defined(HAPP_ROUTE_METRICS)
+		const auto start = std::chrono::steady_clock::now();
+		auto route       = lookup (method, path, context);
+		if (route.has_value() && route->get().metrics)
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			route->get().metrics->recordMatch (
+			    static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count()));
+		}
+#else
+		auto route = lookup (method, path, context);
+#endif
+		if (route.has_value())
+		{
+			span.annotate (route->get().pattern);
+		}
+		return route;
+	}
+
+	std::optional<std::reference_wrapper<const RouteInfo>>
+	    Router::Impl::lookup (HttpMethod method, std::string_view path, ICtx &context) const
+	{
+		// seq_cst: pairs with the reader counters of the epoch domain (see EpochDomain::synchronize)
+		if (const CompiledRouteTable *table = compiled_.load (std::memory_order_seq_cst))
+		{
+			return table->match (method, path, context);
+		}
+
 		const TrieNode *current = &root_;
+		PathTokenizer tokenizer (path);
+		std::string_view segment;
 
-		// Traverse the Trie
-		for (const auto &segment : segments)
+		// Traverse the Trie, tokenizing the path on the fly
+		while (tokenizer.next (segment))
 		{
 			if (!current)
 			{
 				return std::nullopt;
 			}
 
-			// 1. Try exact literal first (highest priority)
-			if (auto it = current->literals.find (std::string (segment)); it != current->literals.end())
+			// 1. Try exact literal first (highest priority, transparent lookup without a temporary key)
+			if (auto it = current->literals.find (segment); it != current->literals.end())
 			{
 				current = &it->second;
 				continue;
@@ -393,11 +1711,16 @@ namespace ipb::http
 
 			// 2. Try typed parameters (sorted by specificity)
 			bool matched = false;
+			ParamValue decoded;
 			for (const auto &typed_param : current->typed_params)
 			{
-				if (typed_param.validate (segment))
+				if (typed_param.validate (segment, decoded))
 				{
-					context.setParam (typed_param.name, segment);
+					if (typed_param.type == ParamType::PATH)
+					{
+						segment = tokenizer.tail (segment);
+					}
+					context.setTypedParam (typed_param.name, segment, decoded);
 					current = &typed_param.next;
 					matched = true;
 					break;    // First match wins
@@ -425,6 +1748,185 @@ namespace ipb::http
 		return current->getHandler (method);
 	}
 
+	/**
+	 * @brief Compile the Trie into a flat table that serves all the following matches.
+	 */
+	void Router::Impl::freeze ()
+	{
+		// A loaded image has no Trie behind it: keep its table, with the global middlewares added since
+		if (servesImage_)
+		{
+			publish (compiled_.load (std::memory_order_acquire)->rebind (middlewares));
+			return;
+		}
+		publish (CompiledRouteTable::build (root_, middlewares));
+	}
+
+	/**
+	 * @brief Serve the table of a route table image.
+	 * @param owner Keeps the image memory alive.
+	 * @param image The image bytes.
+	 * @param handlers The handler of each route ID.
+	 * @return False (the served table is unchanged) if the image is rejected.
+	 */
+	bool Router::Impl::load (std::shared_ptr<const void> owner, std::string_view image,
+	                         std::span<const RouteHandler> handlers)
+	{
+		auto table = CompiledRouteTable::load (std::move (owner), image, handlers, middlewares);
+		if (!table)
+		{
+			return false;
+		}
+
+		publish (std::move (table));
+		servesImage_ = true;
+		return true;
+	}
+
+	/**
+	 * @brief Atomically replace the served table, reclaiming the previous one after a grace period.
+	 * @param table The new table (already fully built).
+	 */
+	void Router::Impl::publish (std::unique_ptr<CompiledRouteTable> table)
+	{
+		std::unique_ptr<CompiledRouteTable> previous (compiled_.exchange (table.release(), std::memory_order_seq_cst));
+		if (!epoch_.readingOnThisThread())
+		{
+			reclaim (std::move (previous));
+			return;
+		}
+
+		// Called under a ReadGuard (e.g. by a handler): its own section may still read the previous
+		// table, so waiting here would never end. The guard frees it when it leaves (see reclaimDeferred)
+		std::lock_guard<std::mutex> lock (retired_mutex_);
+		if (previous)
+		{
+			retired_.push_back (std::move (previous));
+		}
+		deferredBy_ = std::this_thread::get_id();
+		reclaimPending_.store (!retired_.empty(), std::memory_order_release);
+	}
+
+	/**
+	 * @brief Free a replaced table, and the deferred ones, once no reader can still reference them.
+	 * @param previous The table just replaced (may be null).
+	 */
+	void Router::Impl::reclaim (std::unique_ptr<CompiledRouteTable> previous)
+	{
+		std::vector<std::unique_ptr<CompiledRouteTable>> tables;
+		{
+			std::lock_guard<std::mutex> lock (retired_mutex_);
+			tables.swap (retired_);
+			reclaimPending_.store (false, std::memory_order_relaxed);
+		}
+		if (previous || !tables.empty())
+		{
+			// Readers that loaded these tables entered the domain before they were swapped out
+			epoch_.synchronize();
+		}
+	}
+
+	/**
+	 * @brief Free the tables replaced inside a read section, once the thread that replaced them left it.
+	 */
+	void Router::Impl::reclaimDeferred ()
+	{
+		{
+			std::lock_guard<std::mutex> lock (retired_mutex_);
+			if (deferredBy_ != std::this_thread::get_id())
+			{
+				return;
+			}
+		}
+		if (!epoch_.readingOnThisThread())
+		{
+			reclaim (nullptr);
+		}
+	}
+
+#if defined(HAPP_ROUTE_METRICS)
+	// Method label of the metrics snapshots
+	static std::string_view toMethodString (HttpMethod method)
+	{
+		switch (method)
+		{
+		case HttpMethod::GET: return "GET";
+		case HttpMethod::POST: return "POST";
+		case HttpMethod::PUT: return "PUT";
+		case HttpMethod::PATCH: return "PATCH";
+		case HttpMethod::DELETE_: return "DELETE";
+		case HttpMethod::OPTIONS: return "OPTIONS";
+		case HttpMethod::HEAD: return "HEAD";
+		default: return "ANY";
+		}
+	}
+
+	static void collectRoutes (const TrieNode &node, std::vector<const RouteInfo *> &out)
+	{
+		for (const auto &[method, route] : node.handlers)
+		{
+			out.push_back (&route);
+		}
+		for (const auto &[text, child] : node.literals)
+		{
+			collectRoutes (child, out);
+		}
+		for (const TypedParam &param : node.typed_params)
+		{
+			collectRoutes (param.next, out);
+		}
+	}
+#endif
+
+	/**
+	 * @brief Snapshot the counters of the served routes.
+	 * @return One entry per route, sorted by pattern and method (empty without HAPP_ROUTE_METRICS).
+	 */
+	std::vector<RouteMetricsSnapshot> Router::Impl::metrics () const
+	{
+		std::vector<RouteMetricsSnapshot> snapshots;
+#if defined(HAPP_ROUTE_METRICS)
+		{
+			// The guard keeps the published table (and its RouteInfo copies) alive while reading
+			EpochReadGuard guard (epoch_);
+			std::vector<const RouteInfo *> routes;
+			if (const CompiledRouteTable *table = compiled_.load (std::memory_order_seq_cst))
+			{
+				for (const RouteInfo &route : table->routes)
+				{
+					routes.push_back (&route);
+				}
+			}
+			else
+			{
+				collectRoutes (root_, routes);
+			}
+
+			snapshots.reserve (routes.size());
+			for (const RouteInfo *route : routes)
+			{
+				RouteMetricsSnapshot &snapshot = snapshots.emplace_back();
+				snapshot.pattern               = route->pattern;
+				snapshot.method                = std::string (toMethodString (route->method));
+				if (route->metrics)
+				{
+					route->metrics->collect (snapshot);
+				}
+			}
+		}
+
+		std::sort (snapshots.begin(), snapshots.end(),
+		           [] (const RouteMetricsSnapshot &a, const RouteMetricsSnapshot &b)
+		           { return std::tie (a.pattern, a.method) < std::tie (b.pattern, b.method); });
+#endif
+		return snapshots;
+	}
+
+	Router::Impl::~Impl ()
+	{
+		delete compiled_.load (std::memory_order_relaxed);
+	}
+
 	/**
 	 * @brief Split a path into segments, removing leading/trailing slashes.
 	 * @param path The input path (e.g., "/users/123/").
@@ -564,7 +2066,7 @@ namespace ipb::http
 
 		for (const auto &segment : segments)
 		{
-			if (auto it = current->literals.find (std::string (segment)); it != current->literals.end())
+			if (auto it = current->literals.find (segment); it != current->literals.end())
 			{
 				current = &it->second;
 				continue;
@@ -612,6 +2114,76 @@ namespace ipb::http
 
 	void Router::Impl::execute (const RouteInfo &routeInfo, ICtx &context) const
 	{
+#if defined(HAPP_ROUTE_METRICS)
+		if (routeInfo.metrics)
+		{
+			const auto start   = std::chrono::steady_clock::now();
+			const bool handled = run (routeInfo, context);
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			routeInfo.metrics->recordExecution (
+			    handled, static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count()));
+			return;
+		}
+#endif
+		run (routeInfo, context);
+	}
+
+	/**
+	 * @brief Execute the middleware chain and final handler of a route as a coroutine.
+	 * @param routeInfo The RouteInfo of the matched route.
+	 * @param context The context object to pass to middleware and handler.
+	 * @return The (lazy) task running the route.
+	 */
+	AsyncTask Router::Impl::executeAsync (const RouteInfo &routeInfo, ICtx &context) const
+	{
+		std::vector<const Middleware *> steps;
+		if (routeInfo.frozen)
+		{
+			steps.reserve (routeInfo.pipeline.size());
+			for (const Middleware &middleware : routeInfo.pipeline)
+			{
+				steps.push_back (&middleware);
+			}
+		}
+		else
+		{
+			steps.reserve (middlewares.size() + routeInfo.middlewares.size());
+			for (const Middleware &middleware : middlewares)
+			{
+				steps.push_back (&middleware);
+			}
+			for (const Middleware &middleware : routeInfo.middlewares)
+			{
+				steps.push_back (&middleware);
+			}
+		}
+
+		AsyncPipeline pipeline (std::move (steps), routeInfo.handler, context);
+#if defined(HAPP_ROUTE_METRICS)
+		const auto start = std::chrono::steady_clock::now();
+		co_await pipeline.run (0);
+		if (routeInfo.metrics)
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			routeInfo.metrics->recordExecution (
+			    pipeline.handlerCalled(),
+			    static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count()));
+		}
+#else
+		co_await pipeline.run (0);
+#endif
+	}
+
+	bool Router::Impl::run (const RouteInfo &routeInfo, ICtx &context) const
+	{
+		if (routeInfo.frozen)
+		{
+			const Middleware *first = routeInfo.pipeline.data();
+			PipelineIterator chain (first, first + routeInfo.pipeline.size(), routeInfo.handler, context);
+			chain.start();
+			return chain.handlerCalled();
+		}
+
 		class MiddlewareChainIterator final : public IMiddlewareNext
 		{
 			public:
@@ -632,6 +2204,11 @@ namespace ipb::http
 					next();
 				}
 
+				bool handlerCalled () const noexcept
+				{
+					return handler_called_;
+				}
+
 				void next () override
 				{
 					if (!using_route_middlewares_ && current_ == globalEnd_)
@@ -648,6 +2225,7 @@ namespace ipb::http
 
 					const auto &middleware = *current_;
 					++current_;
+					StageScope span (TraceStage::Middleware, step_++);
 					middleware (context_, *this);
 				}
 
@@ -660,6 +2238,7 @@ namespace ipb::http
 					}
 
 					handler_called_ = true;
+					StageScope span (TraceStage::Handler);
 					handler_ (context_);
 				}
 
@@ -670,12 +2249,14 @@ namespace ipb::http
 
 				const RouteHandler &handler_;
 				ICtx &context_;
+				uint16_t step_                = 0;
 				bool using_route_middlewares_ = false;
 				bool handler_called_          = false;
 		};
 
 		MiddlewareChainIterator chain (middlewares, routeInfo.middlewares, routeInfo.handler, context);
 		chain.start();
+		return chain.handlerCalled();
 	}
 
 	// ============================================================================
@@ -718,6 +2299,39 @@ namespace ipb::http
 		return true;
 	}
 
+	/**
+	 * @brief Add a new route served by a coroutine.
+	 * @param method The HTTP method for the route.
+	 * @param pattern The route pattern (e.g., "/users/<id:int>").
+	 * @param handler The coroutine handler.
+	 * @return A reference to the RouteInfo of the added route.
+	 */
+	RouteInfo &Router::addAsync (HttpMethod method, std::string_view pattern, AsyncRouteHandler handler)
+	{
+		return impl_->add (method, pattern, RouteHandler (AsyncHandlerStep {.handler = std::move (handler)}));
+	}
+
+	/**
+	 * @brief Add a global coroutine middleware to the router.
+	 * @param middleware The coroutine middleware.
+	 * @return True if the middleware was added successfully.
+	 */
+	bool Router::addAsyncMiddleware (AsyncMiddleware middleware)
+	{
+		return impl_->addMiddleware (Middleware (AsyncMiddlewareStep {.middleware = std::move (middleware)}));
+	}
+
+	/**
+	 * @brief Add a coroutine middleware to a specific route.
+	 * @param routeInfo The RouteInfo of the route to add middleware to.
+	 * @param middleware The coroutine middleware.
+	 * @return True if the middleware was added successfully.
+	 */
+	bool Router::addAsyncMiddleware (RouteInfo &routeInfo, AsyncMiddleware middleware)
+	{
+		return addMiddleware (routeInfo, Middleware (AsyncMiddlewareStep {.middleware = std::move (middleware)}));
+	}
+
 	/**
 	 * @brief Add a global middleware to the router.
 	 * @param middleware The middleware function to add.
@@ -738,6 +2352,141 @@ namespace ipb::http
 		impl_->execute (routeInfo, context);
 	}
 
+	/**
+	 * @brief Execute the middleware chain and final handler of a route as a coroutine.
+	 * @param routeInfo The RouteInfo of the matched route.
+	 * @param context The context object to pass to middleware and handler.
+	 * @return The (lazy) task running the route.
+	 */
+	AsyncTask Router::executeAsync (const RouteInfo &routeInfo, ICtx &context) const
+	{
+		return impl_->executeAsync (routeInfo, context);
+	}
+
+	/**
+	 * @brief Snapshot the counters of the served routes.
+	 * @return One entry per route, sorted by pattern and method (empty without HAPP_ROUTE_METRICS).
+	 */
+	std::vector<RouteMetricsSnapshot> Router::metrics () const
+	{
+		return impl_->metrics();
+	}
+
+	/**
+	 * @brief Compile the registered routes into a flat, read-only table.
+	 * Routes added afterwards are not matched until freeze() is called again.
+	 */
+	void Router::freeze ()
+	{
+		impl_->freeze();
+	}
+
+	/**
+	 * @brief Compile the routes of another router and publish them as the table served by this one.
+	 * @param staged The router holding the new set of routes.
+	 */
+	void Router::publish (const Router &staged)
+	{
+		impl_->publish (CompiledRouteTable::build (staged.impl_->root_, staged.impl_->middlewares));
+	}
+
+	/**
+	 * @brief Serialize the served table.
+	 * @return The image, or an empty string if the router is not frozen.
+	 */
+	std::string Router::image () const
+	{
+		const ReadGuard guard (*this);
+		const CompiledRouteTable *table = impl_->compiled_.load (std::memory_order_seq_cst);
+		return table != nullptr ? table->image() : std::string {};
+	}
+
+	/**
+	 * @brief Write the image of the served table to a file.
+	 * @param file The destination (replaced).
+	 * @return False if the router is not frozen or the file cannot be written.
+	 */
+	bool Router::saveImage (const std::filesystem::path &file) const
+	{
+		const std::string bytes = image();
+		if (bytes.empty())
+		{
+			return false;
+		}
+
+		std::ofstream out (file, std::ios::binary | std::ios::trunc);
+		out.write (bytes.data(), static_cast<std::streamsize> (bytes.size()));
+		out.close();
+		return !out.fail();
+	}
+
+	/**
+	 * @brief Map a route table image and serve it.
+	 * @param file The image written by saveImage.
+	 * @param handlers The handler of each route ID.
+	 * @return False if the file cannot be mapped or the image is rejected.
+	 */
+	bool Router::loadImage (const std::filesystem::path &file, std::span<const RouteHandler> handlers)
+	{
+		auto mapped = std::make_shared<MappedFile>();
+		if (mapped->open (file) != FileKind::File)
+		{
+			return false;
+		}
+
+		const std::string_view bytes (mapped->data(), mapped->size());
+		return impl_->load (std::move (mapped), bytes, handlers);
+	}
+
+	/**
+	 * @brief Serve a route table image held in memory.
+	 * @param image The image bytes (copied to aligned storage).
+	 * @param handlers The handler of each route ID.
+	 * @return False if the image is rejected.
+	 */
+	bool Router::loadImageBytes (std::string_view image, std::span<const RouteHandler> handlers)
+	{
+		auto buffer = std::make_shared<uint64_t[]> ((image.size() + 7) / 8);
+		if (!image.empty())
+		{
+			std::memcpy (buffer.get(), image.data(), image.size());
+		}
+
+		const std::string_view bytes (reinterpret_cast<const char *> (buffer.get()), image.size());
+		return impl_->load (std::move (buffer), bytes, handlers);
+	}
+
+	/**
+	 * @brief Enter a read-side critical section of the router.
+	 * @param router The router whose published table must stay alive.
+	 */
+	Router::ReadGuard::ReadGuard (const Router &router) noexcept
+	    : impl_ (router.impl_.get())
+	    , slot_ (impl_ != nullptr ? impl_->epoch_.enter() : 0)
+	{
+	}
+
+	Router::ReadGuard::~ReadGuard ()
+	{
+		if (impl_ != nullptr)
+		{
+			impl_->epoch_.leave (slot_);
+			if (impl_->reclaimPending_.load (std::memory_order_relaxed))
+			{
+				impl_->reclaimDeferred();
+			}
+		}
+	}
+
+	/**
+	 * @brief Check if the router matches against a compiled table.
+	 * @return True if freeze() has been called, false otherwise.
+	 */
+	bool Router::isFrozen () const noexcept
+	{
+		return impl_->compiled_.load (std::memory_order_acquire) != nullptr;
+	}
+
 	/**
 	 * @brief Match an incoming request path to a route and extract parameters.
 	 * @param method The HTTP method of the incoming request.
@@ -751,12 +2500,34 @@ namespace ipb::http
 		return impl_->match (method, path, context);
 	}
 
+	/**
+	 * @brief Validate a parameter value against a parameter type, decoding it in the same pass.
+	 * @param type The parameter type.
+	 * @param value The parameter value as a string.
+	 * @param decoded Receives the decoded value (left as std::monostate for string/generic parameters).
+	 * @return True if the value is valid for the type, false otherwise.
+	 */
+	bool Router::validateParam (ParamType type, std::string_view value, ParamValue &decoded)
+	{
+		return TypedParam::validate (type, value, decoded);
+	}
+
 	/**
 	 * @brief Convert an HTTP method string to the corresponding HttpMethod enum value.
 	 * @param method The HTTP method as a string (e.g., "GET", "POST").
 	 * @return The corresponding HttpMethod enum value, or HttpMethod::GET as a default fallback for invalid input.
 	 */
 	HttpMethod Router::fromMethodString (std::string_view method)
+	{
+		return parseMethod (method).value_or (HttpMethod::GET);    // Default fallback
+	}
+
+	/**
+	 * @brief Convert an HTTP method string to the corresponding HttpMethod enum value.
+	 * @param method The HTTP method as a string (e.g., "GET", "POST").
+	 * @return The corresponding HttpMethod enum value, or std::nullopt for any other method.
+	 */
+	std::optional<HttpMethod> Router::parseMethod (std::string_view method)
 	{
 		static const std::unordered_map<std::string_view, HttpMethod> method_map = {
 		    {"GET",     HttpMethod::GET    },
@@ -773,7 +2544,7 @@ namespace ipb::http
 			return it->second;
 		}
 
-		return HttpMethod::GET;    // Default fallback
+		return std::nullopt;
 	}
 
 	static ParamType fromParamTypeString (std::string_view type_str)
@@ -783,7 +2554,8 @@ namespace ipb::http
 		    {"base64id", ParamType::BASE64ID},
 		    {"string",   ParamType::STRING  },
 		    {"uuid",     ParamType::UUID    },
-		    {"float",    ParamType::FLOAT   }
+		    {"float",    ParamType::FLOAT   },
+		    {"path",     ParamType::PATH    }
         };
 
 		if (auto it = type_map.find (type_str); it != type_map.end())
@@ -0,0 +1,181 @@
+﻿/*********************************************************************************************
+ *  Description : Per-route counters and OpenMetrics export implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "RouteMetrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <string_view>
+#include <thread>
+
+namespace ipb::http
+{
+	namespace
+	{
+		// `le` labels of kRouteLatencyBounds, in seconds
+		constexpr std::array<std::string_view, kRouteLatencyBounds.size()> kBoundLabels = {
+		    "0.00001", "0.000025", "0.00005", "0.0001", "0.00025", "0.0005", "0.001", "0.0025",
+		    "0.005",   "0.01",     "0.025",   "0.05",   "0.1",     "0.25",   "1"};
+
+		// Label value with the OpenMetrics escapes (backslash, quote, line feed)
+		static void appendLabel (std::string &out, std::string_view name, std::string_view value)
+		{
+			out.append (name);
+			out.append ("=\"");
+			for (char c : value)
+			{
+				switch (c)
+				{
+				case '\\': out.append ("\\\\"); break;
+				case '"': out.append ("\\\""); break;
+				case '\n': out.append ("\\n"); break;
+				default: out.push_back (c); break;
+				}
+			}
+			out.push_back ('"');
+		}
+
+		static void appendNumber (std::string &out, uint64_t value)
+		{
+			char buffer [24];
+			out.append (buffer, std::to_chars (buffer, buffer + sizeof (buffer), value).ptr);
+		}
+
+		static void appendSeconds (std::string &out, uint64_t nanoseconds)
+		{
+			char buffer [32];
+			const double seconds = static_cast<double> (nanoseconds) / 1e9;
+			out.append (buffer, std::to_chars (buffer, buffer + sizeof (buffer), seconds).ptr);
+		}
+
+		// `name{method="...",route="..."[,le="..."]} `
+		static void appendSample (std::string &out, std::string_view name, const RouteMetricsSnapshot &route,
+		                          std::string_view le = {})
+		{
+			out.append (name);
+			out.push_back ('{');
+			appendLabel (out, "method", route.method);
+			out.push_back (',');
+			appendLabel (out, "route", route.pattern);
+			if (!le.empty())
+			{
+				out.push_back (',');
+				appendLabel (out, "le", le);
+			}
+			out.append ("} ");
+		}
+
+		static void appendCounter (std::string &out, std::string_view family, std::string_view help,
+		                           std::span<const RouteMetricsSnapshot> routes,
+		                           uint64_t RouteMetricsSnapshot::*field, bool seconds)
+		{
+			out.append ("# TYPE ").append (family).append (" counter\n");
+			out.append ("# HELP ").append (family).append (" ").append (help).append ("\n");
+			const std::string sample = std::string (family) + "_total";
+			for (const RouteMetricsSnapshot &route : routes)
+			{
+				appendSample (out, sample, route);
+				if (seconds)
+				{
+					appendSeconds (out, route.*field);
+				}
+				else
+				{
+					appendNumber (out, route.*field);
+				}
+				out.push_back ('\n');
+			}
+		}
+	}    // namespace
+
+	std::string toOpenMetrics (std::span<const RouteMetricsSnapshot> routes)
+	{
+		std::string out;
+		out.reserve (routes.size() * 2048 + 64);
+
+		appendCounter (out, "happ_route_matches", "Router::match hits.", routes, &RouteMetricsSnapshot::matches,
+		               false);
+		appendCounter (out, "happ_route_invocations", "Handler invocations.", routes,
+		               &RouteMetricsSnapshot::invocations, false);
+		appendCounter (out, "happ_route_short_circuits", "Executions stopped by a middleware.", routes,
+		               &RouteMetricsSnapshot::shortCircuits, false);
+		appendCounter (out, "happ_route_match_seconds", "Time spent matching the route.", routes,
+		               &RouteMetricsSnapshot::matchNanoseconds, true);
+
+		out.append ("# TYPE happ_route_latency_seconds histogram\n");
+		out.append ("# HELP happ_route_latency_seconds Middlewares and handler execution time.\n");
+		for (const RouteMetricsSnapshot &route : routes)
+		{
+			uint64_t cumulative = 0;
+			for (size_t i = 0; i < kBoundLabels.size(); ++i)
+			{
+				cumulative += route.latencyBuckets [i];
+				appendSample (out, "happ_route_latency_seconds_bucket", route, kBoundLabels [i]);
+				appendNumber (out, cumulative);
+				out.push_back ('\n');
+			}
+			cumulative += route.latencyBuckets.back();
+			appendSample (out, "happ_route_latency_seconds_bucket", route, "+Inf");
+			appendNumber (out, cumulative);
+			out.push_back ('\n');
+
+			appendSample (out, "happ_route_latency_seconds_count", route);
+			appendNumber (out, cumulative);
+			out.push_back ('\n');
+			appendSample (out, "happ_route_latency_seconds_sum", route);
+			appendSeconds (out, route.latencyNanoseconds);
+			out.push_back ('\n');
+		}
+
+		out.append ("# EOF\n");
+		return out;
+	}
+
+#if defined(HAPP_ROUTE_METRICS)
+	RouteMetrics::Shard &RouteMetrics::shard () noexcept
+	{
+		static thread_local const size_t index = std::hash<std::thread::id> {}(std::this_thread::get_id()) % kShards;
+		return shards_ [index];
+	}
+
+	void RouteMetrics::recordMatch (uint64_t nanoseconds) noexcept
+	{
+		Shard &current = shard();
+		current.matches.fetch_add (1, std::memory_order_relaxed);
+		current.matchNanoseconds.fetch_add (nanoseconds, std::memory_order_relaxed);
+	}
+
+	void RouteMetrics::recordExecution (bool handlerCalled, uint64_t nanoseconds) noexcept
+	{
+		Shard &current = shard();
+		(handlerCalled ? current.invocations : current.shortCircuits).fetch_add (1, std::memory_order_relaxed);
+		current.latencyNanoseconds.fetch_add (nanoseconds, std::memory_order_relaxed);
+
+		const size_t bucket = static_cast<size_t> (
+		    std::lower_bound (kRouteLatencyBounds.begin(), kRouteLatencyBounds.end(), nanoseconds) -
+		    kRouteLatencyBounds.begin());
+		current.latencyBuckets [bucket].fetch_add (1, std::memory_order_relaxed);
+	}
+
+	void RouteMetrics::collect (RouteMetricsSnapshot &out) const noexcept
+	{
+		for (const Shard &current : shards_)
+		{
+			out.matches += current.matches.load (std::memory_order_relaxed);
+			out.invocations += current.invocations.load (std::memory_order_relaxed);
+			out.shortCircuits += current.shortCircuits.load (std::memory_order_relaxed);
+			out.matchNanoseconds += current.matchNanoseconds.load (std::memory_order_relaxed);
+			out.latencyNanoseconds += current.latencyNanoseconds.load (std::memory_order_relaxed);
+			for (size_t i = 0; i < out.latencyBuckets.size(); ++i)
+			{
+				out.latencyBuckets [i] += current.latencyBuckets [i].load (std::memory_order_relaxed);
+			}
+		}
+	}
+#endif
+
+}    // namespace ipb::http
@@ -0,0 +1,132 @@
+﻿/*********************************************************************************************
+ *  Description : RouterPartitions implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "RouterPartitions.h"
+
+#include <array>
+
+namespace ipb::http
+{
+	namespace
+	{
+		// Longest host name folded on the stack (DNS names have at most 253 characters)
+		constexpr size_t kMaxFoldedHost = 256;
+
+		static char toLowerAscii (char c) noexcept
+		{
+			return (c >= 'A' && c <= 'Z') ? static_cast<char> (c - 'A' + 'a') : c;
+		}
+	}    // namespace
+
+	RouterPartitions::RouterPartitions (PartitionKey key)
+	    : key_ (key)
+	{
+	}
+
+	RouterPartitions::~RouterPartitions () = default;
+
+	/**
+	 * @brief Get (or create) the router of a partition.
+	 * @param name Host name (with or without port) or path prefix, depending on the partition key.
+	 * @return The router of the partition.
+	 */
+	Router &RouterPartitions::partition (std::string_view name)
+	{
+		// Same normalization as the requests: no port for hosts, no slashes for path prefixes
+		std::string normalized (keyOf (key_, name, name));
+		if (key_ == PartitionKey::HOST)
+		{
+			for (char &c : normalized)
+			{
+				c = toLowerAscii (c);
+			}
+		}
+
+		auto it = routers_.find (std::string_view (normalized));
+		if (it == routers_.end())
+		{
+			it = routers_.emplace (std::move (normalized), std::make_unique<Router>()).first;
+		}
+		return *it->second;
+	}
+
+	const Router *RouterPartitions::find (std::string_view name) const noexcept
+	{
+		return select (name, name);
+	}
+
+	/**
+	 * @brief Pick the router of a request.
+	 * @param host Value of the Host header (ignored for PATH_PREFIX).
+	 * @param path Request path (ignored for HOST).
+	 * @return The router of the partition, or nullptr if none matches.
+	 */
+	const Router *RouterPartitions::select (std::string_view host, std::string_view path) const noexcept
+	{
+		const std::string_view name = keyOf (key_, host, path);
+		if (key_ == PartitionKey::PATH_PREFIX)
+		{
+			return lookup (name);
+		}
+
+		// Host names are case-insensitive: fold them on the stack so the lookup does not allocate
+		if (name.size() > kMaxFoldedHost)
+		{
+			return nullptr;
+		}
+		std::array<char, kMaxFoldedHost> folded;
+		for (size_t i = 0; i < name.size(); ++i)
+		{
+			folded[i] = toLowerAscii (name[i]);
+		}
+		return lookup (std::string_view (folded.data(), name.size()));
+	}
+
+	void RouterPartitions::freeze ()
+	{
+		for (auto &[name, router] : routers_)
+		{
+			router->freeze();
+		}
+	}
+
+	/**
+	 * @brief Extract the partition name of a request.
+	 * @param key What selects the partition.
+	 * @param host Value of the Host header: the port (and a trailing dot) are dropped, IPv6 brackets kept.
+	 * @param path Request path: the first segment, without slashes.
+	 * @return A view into `host` or `path`.
+	 */
+	std::string_view RouterPartitions::keyOf (PartitionKey key, std::string_view host, std::string_view path) noexcept
+	{
+		if (key == PartitionKey::PATH_PREFIX)
+		{
+			if (path.starts_with ('/'))
+			{
+				path.remove_prefix (1);
+			}
+			return path.substr (0, path.find ('/'));
+		}
+
+		const size_t end = host.starts_with ('[') ? host.find (']') : host.find (':');
+		if (end != std::string_view::npos)
+		{
+			host = host.substr (0, host.starts_with ('[') ? end + 1 : end);
+		}
+		if (host.ends_with ('.'))
+		{
+			host.remove_suffix (1);
+		}
+		return host;
+	}
+
+	const Router *RouterPartitions::lookup (std::string_view name) const noexcept
+	{
+		const auto it = routers_.find (name);
+		return it != routers_.end() ? it->second.get() : nullptr;
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,203 @@
+/*********************************************************************************************
+ *  Description : ShardedLru - Bounded map split into LRU shards, each behind its own mutex (internal)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _SHARDED_LRU_H_
+#	define _SHARDED_LRU_H_
+
+#	include <algorithm>
+#	include <cstddef>
+#	include <cstdint>
+#	include <functional>
+#	include <limits>
+#	include <list>
+#	include <mutex>
+#	include <unordered_map>
+#	include <utility>
+#	include <vector>
+
+namespace ipb::http
+{
+	/**
+	 * @brief Bounded cache of `Value`s indexed by the hash of their `Key`, shared by the verified-token and
+	 * response caches. A hit also compares the stored key, so a hash collision is a miss (and an insert
+	 * replaces the colliding entry). Every entry has a last valid time, in whatever clock the owner uses;
+	 * expired entries are dropped when they are looked up. Locking can be turned off for single-threaded owners.
+	 */
+	template <typename Key, typename Value>
+	class ShardedLru
+	{
+		public:
+			static constexpr int64_t kNoExpiry = std::numeric_limits<int64_t>::max();
+
+			ShardedLru (size_t capacity, bool synchronized = true)
+			    : shards_ (std::clamp<size_t> (capacity / kMinShardCapacity, 1, kShards))
+			    , shard_capacity_ ((capacity + shards_.size() - 1) / shards_.size())
+			    , synchronized_ (synchronized)
+			{
+			}
+
+			/**
+			 * Call `onHit (value)` with the entry of `key`, under the shard lock (copy out what is needed).
+			 * @return True on hit.
+			 */
+			template <typename KeyView, typename OnHit>
+			bool lookup (const KeyView &key, int64_t now, OnHit &&onHit)
+			{
+				const size_t hash = std::hash<KeyView> {}(key);
+				Shard &shard      = shardFor (hash);
+
+				auto lock = lockShard (shard);
+				auto it   = shard.index.find (hash);
+				if (it == shard.index.end() || it->second->key != key)
+				{
+					return false;
+				}
+
+				if (now > it->second->lastValid)
+				{
+					shard.lru.erase (it->second);
+					shard.index.erase (it);
+					return false;
+				}
+
+				shard.lru.splice (shard.lru.begin(), shard.lru, it->second);
+				onHit (std::as_const (it->second->value));
+				return true;
+			}
+
+			/**
+			 * Store `value` until `lastValid`, evicting the least recently used entry of the shard if it is full.
+			 * `admit ()` is checked under the shard lock: returning false discards the value.
+			 */
+			template <typename KeyView, typename Admit>
+			void insert (const KeyView &key, int64_t lastValid, Value value, Admit &&admit)
+			{
+				if (shard_capacity_ == 0)
+				{
+					return;
+				}
+
+				const size_t hash = std::hash<KeyView> {}(key);
+				Shard &shard      = shardFor (hash);
+
+				auto lock = lockShard (shard);
+				if (!admit())
+				{
+					return;
+				}
+
+				if (auto it = shard.index.find (hash); it != shard.index.end())
+				{
+					shard.lru.erase (it->second);
+					shard.index.erase (it);
+				}
+				else if (shard.lru.size() >= shard_capacity_)
+				{
+					shard.index.erase (shard.lru.back().hash);
+					shard.lru.pop_back();
+				}
+
+				shard.lru.push_front (Entry {.hash = hash, .key = Key (key), .lastValid = lastValid, .value = std::move (value)});
+				shard.index.emplace (hash, shard.lru.begin());
+			}
+
+			template <typename KeyView>
+			void insert (const KeyView &key, int64_t lastValid, Value value)
+			{
+				insert (key, lastValid, std::move (value), [] { return true; });
+			}
+
+			/**
+			 * Drop every entry for which `drop (key, value)` is true.
+			 * @return The number of entries dropped.
+			 */
+			template <typename Drop>
+			size_t eraseIf (Drop &&drop)
+			{
+				size_t dropped = 0;
+				for (Shard &shard : shards_)
+				{
+					auto lock = lockShard (shard);
+					for (auto it = shard.lru.begin(); it != shard.lru.end();)
+					{
+						if (drop (std::as_const (it->key), std::as_const (it->value)))
+						{
+							shard.index.erase (it->hash);
+							it = shard.lru.erase (it);
+							++dropped;
+						}
+						else
+						{
+							++it;
+						}
+					}
+				}
+				return dropped;
+			}
+
+			void clear ()
+			{
+				for (Shard &shard : shards_)
+				{
+					auto lock = lockShard (shard);
+					shard.index.clear();
+					shard.lru.clear();
+				}
+			}
+
+			size_t size ()
+			{
+				size_t total = 0;
+				for (Shard &shard : shards_)
+				{
+					auto lock = lockShard (shard);
+					total += shard.lru.size();
+				}
+				return total;
+			}
+
+		private:
+			static constexpr size_t kShards = 16;
+
+			// Fewer shards for small caches: a full shard evicts even when the others have room
+			static constexpr size_t kMinShardCapacity = 8;
+
+			struct Entry
+			{
+					size_t hash;
+					Key key;
+					int64_t lastValid;
+					Value value;
+			};
+
+			struct Shard
+			{
+					std::mutex mutex;
+					std::list<Entry> lru;    // Most recently used first
+					std::unordered_map<size_t, typename std::list<Entry>::iterator> index;
+			};
+
+			Shard &shardFor (size_t hash) noexcept
+			{
+				// The low bits pick the bucket inside the shard map: use the high ones for the shard
+				const uint64_t wide = static_cast<uint64_t> (hash);
+				return shards_ [static_cast<size_t> ((wide >> 32) ^ (wide >> 8)) % shards_.size()];
+			}
+
+			std::unique_lock<std::mutex> lockShard (Shard &shard) const
+			{
+				return synchronized_ ? std::unique_lock<std::mutex> (shard.mutex) : std::unique_lock<std::mutex> {};
+			}
+
+			std::vector<Shard> shards_;
+			size_t shard_capacity_;
+			bool synchronized_;
+	};
+
+}    // namespace ipb::http
+
+#endif
@@ -0,0 +1,28 @@
+/*********************************************************************************************
+ *  Description : SIMD platform selection shared by the scanners (internal)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _SIMD_H_
+#	define _SIMD_H_
+
+// SSE2 and NEON are part of the x86-64 / AArch64 baselines: no runtime dispatch is needed.
+// Define HAPP_NO_SIMD to force the scalar fallbacks.
+// AVX2 is not in the x86-64 baseline: HAPP_SIMD_AVX2 is only set when the build targets it
+// (-mavx2, -march=x86-64-v3, /arch:AVX2); a kernel that needs it keeps an SSE2 / scalar path.
+#	if defined(HAPP_NO_SIMD)
+#	elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define HAPP_SIMD_SSE2
+#		include <emmintrin.h>
+#		if defined(__AVX2__)
+#			define HAPP_SIMD_AVX2
+#			include <immintrin.h>
+#		endif
+#	elif defined(__aarch64__) || defined(_M_ARM64)
+#		define HAPP_SIMD_NEON
+#		include <arm_neon.h>
+#	endif
+
+#endif
@@ -0,0 +1,191 @@
+﻿/*********************************************************************************************
+ *  Description : Static file handler implementation
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "StaticFiles.h"
+#include "EntityTag.h"
+#include "MappedFile.h"
+
+#include <httplib.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace ipb::http
+{
+	namespace
+	{
+		// ============================================================================
+		// Helpers
+		// ============================================================================
+
+		/**
+		 * @brief Check a request path before it reaches the file system.
+		 * @param path The path relative to the root (e.g., "css/site.css").
+		 * @return False for empty, "." or ".." segments, and for backslashes, ':' or NUL (Windows separators,
+		 * drives and alternate streams).
+		 */
+		bool isSafeRelativePath (std::string_view path) noexcept
+		{
+			if (path.find_first_of (std::string_view ("\\:\0", 3)) != std::string_view::npos)
+			{
+				return false;
+			}
+
+			while (true)
+			{
+				const size_t end             = path.find ('/');
+				const std::string_view piece = path.substr (0, end);
+				if (piece.empty() || piece == "." || piece == "..")
+				{
+					return false;
+				}
+				if (end == std::string_view::npos)
+				{
+					return true;
+				}
+				path.remove_prefix (end + 1);
+			}
+		}
+
+		/**
+		 * @brief Content-Type of a file, from its extension (case-insensitive).
+		 */
+		const char *contentTypeOf (std::string_view path) noexcept
+		{
+			static constexpr std::array<std::pair<std::string_view, const char *>, 20> kTypes = {
+			    {{"html", "text/html; charset=utf-8"},
+			     {"htm", "text/html; charset=utf-8"},
+			     {"css", "text/css; charset=utf-8"},
+			     {"js", "text/javascript; charset=utf-8"},
+			     {"mjs", "text/javascript; charset=utf-8"},
+			     {"json", "application/json"},
+			     {"map", "application/json"},
+			     {"txt", "text/plain; charset=utf-8"},
+			     {"xml", "application/xml"},
+			     {"svg", "image/svg+xml"},
+			     {"png", "image/png"},
+			     {"jpg", "image/jpeg"},
+			     {"jpeg", "image/jpeg"},
+			     {"gif", "image/gif"},
+			     {"webp", "image/webp"},
+			     {"ico", "image/x-icon"},
+			     {"wasm", "application/wasm"},
+			     {"woff", "font/woff"},
+			     {"woff2", "font/woff2"},
+			     {"pdf", "application/pdf"}}
+			};
+
+			const size_t dot = path.rfind ('.');
+			if (dot != std::string_view::npos && path.find ('/', dot) == std::string_view::npos)
+			{
+				const std::string_view extension = path.substr (dot + 1);
+				const auto sameLetter = [] (char known, char c)
+				{
+					return known == (c >= 'A' && c <= 'Z' ? static_cast<char> (c - 'A' + 'a') : c);
+				};
+				for (const auto &[known, type] : kTypes)
+				{
+					if (std::ranges::equal (known, extension, sameLetter))
+					{
+						return type;
+					}
+				}
+			}
+			return "application/octet-stream";
+		}
+
+		/**
+		 * @brief Weak validator of a file version: W/"<size>-<modification time>" in hexadecimal.
+		 * Size and time do not prove two versions byte-identical, hence the weak prefix.
+		 */
+		std::string entityTag (const MappedFile &file)
+		{
+			char text [48];
+			const int length = std::snprintf (text, sizeof (text), "W/\"%zx-%llx\"", file.size(),
+			                                  static_cast<unsigned long long> (file.modified()));
+			return std::string (text, static_cast<size_t> (length));
+		}
+
+		void sendNotFound (Ctx &ctx)
+		{
+			ctx.status (404).send ("Not Found");
+		}
+	}    // namespace
+
+	/**
+	 * @brief Build a handler serving the files under a directory.
+	 * @param root The directory served.
+	 * @param param The route parameter holding the file path (a path parameter, e.g. `<path:path>`).
+	 * @param config Index file and caching settings.
+	 * @return The handler, to be registered for GET (and HEAD).
+	 */
+	std::function<void (Ctx &)> staticFiles (std::string root, std::string param, StaticFilesConfig config)
+	{
+		return [root = std::filesystem::path (std::move (root)), param = std::move (param),
+		        config = std::move (config)] (Ctx &ctx)
+		{
+			const std::string_view relative = ctx.param (param);
+			if (!isSafeRelativePath (relative))
+			{
+				sendNotFound (ctx);
+				return;
+			}
+
+			// Request paths are UTF-8; std::filesystem::path only assumes it for char8_t text
+			const auto *utf8 = reinterpret_cast<const char8_t *> (relative.data());
+			std::filesystem::path path = root / std::u8string_view (utf8, relative.size());
+
+			auto file        = std::make_shared<MappedFile>();
+			const char *type = contentTypeOf (relative);
+			FileKind kind    = file->open (path);
+			if (kind == FileKind::Directory && !config.index_file.empty())
+			{
+				path /= config.index_file;
+				type = contentTypeOf (config.index_file);
+				kind = file->open (path);
+			}
+			if (kind != FileKind::File)
+			{
+				sendNotFound (ctx);
+				return;
+			}
+
+			const std::string tag = entityTag (*file);
+			ctx.setHeader ("ETag", tag);
+			if (!config.cache_control.empty())
+			{
+				ctx.setHeader ("Cache-Control", config.cache_control);
+			}
+			if (etag::matchesNoneMatch (ctx.header ("If-None-Match"), tag))
+			{
+				ctx.status (304);
+				return;
+			}
+
+			ctx.status (200);
+			if (file->size() == 0)
+			{
+				ctx.send ({}, type);
+				return;
+			}
+
+			// The provider keeps the mapping alive until cpp-httplib has written the response
+			ctx.response().set_content_provider (
+			    file->size(), type,
+			    [file] (size_t offset, size_t length, httplib::DataSink &sink)
+			    {
+				    return sink.write (file->data() + offset, length);
+			    });
+		};
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,104 @@
+/*********************************************************************************************
+ *  Description : StageScope - Span of one request stage, recorded only inside a sampled RequestTrace
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _TRACE_SCOPE_H_
+#	define _TRACE_SCOPE_H_
+
+#	include <cstdint>
+#	include <string_view>
+
+#	include "Tracing.h"
+
+namespace ipb::http
+{
+#	if defined(HAPP_TRACING)
+	class TraceRing;
+
+	// Tracing state of a thread (trivial, so reading it costs no TLS initialization check)
+	struct ThreadTrace
+	{
+			bool active        = false;      // A sampled request is open on this thread
+			uint32_t countdown = 1;          // Requests until the next sampling decision
+			uint32_t thread    = 0;          // Index of the thread (assigned with its ring)
+			uint64_t traceId   = 0;
+			uint64_t parentId  = 0;          // Innermost open span
+			uint64_t nextId    = 0;          // Span ids of the thread (the thread index is in the high bits)
+			TraceRing *ring    = nullptr;    // Created by the first sampled request
+	};
+
+	extern constinit thread_local ThreadTrace t_trace;
+
+	/**
+	 * @brief Times one stage of the request: a child of the innermost open span.
+	 * Outside a sampled request the constructor and destructor are one predicted branch each.
+	 */
+	class StageScope
+	{
+		public:
+			explicit StageScope (TraceStage stage, uint16_t index = 0) noexcept
+			{
+				if (t_trace.active) [[unlikely]]
+				{
+					open (stage, index);
+				}
+			}
+
+			~StageScope ()
+			{
+				end();
+			}
+
+			StageScope (const StageScope &)            = delete;
+			StageScope &operator= (const StageScope &) = delete;
+
+			// Text exported with the span (copied, truncated, when the span closes)
+			void annotate (std::string_view detail) noexcept
+			{
+				detail_ = detail;
+			}
+
+			// Close the span before the end of the scope
+			void end () noexcept
+			{
+				if (spanId_ != 0) [[unlikely]]
+				{
+					close();
+				}
+			}
+
+		private:
+			void open (TraceStage stage, uint16_t index) noexcept;
+			void close () noexcept;
+
+			uint64_t spanId_ = 0;
+			uint64_t parentId_;
+			uint64_t start_;
+			std::string_view detail_;
+			TraceStage stage_;
+			uint16_t index_;
+	};
+#	else
+	class StageScope
+	{
+		public:
+			explicit StageScope (TraceStage, uint16_t = 0) noexcept
+			{
+			}
+
+			void annotate (std::string_view) noexcept
+			{
+			}
+
+			void end () noexcept
+			{
+			}
+	};
+#	endif
+
+}    // namespace ipb::http
+
+#endif
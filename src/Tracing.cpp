@@ -0,0 +1,439 @@
+﻿/*********************************************************************************************
+ *  Description : Request tracing implementation: per-thread span rings and the trace exporters
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "Tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+
+#include "JsonText.h"
+#include "TraceScope.h"
+
+namespace ipb::http
+{
+#if defined(HAPP_TRACING)
+	constinit thread_local ThreadTrace t_trace {};
+
+	/**
+	 * @brief Spans recorded by one thread. The mutex is only contended by drainTraceSpans.
+	 */
+	class TraceRing
+	{
+		public:
+			TraceRing ()
+			    : spans_ (kTraceRingCapacity)
+			{
+			}
+
+			void push (const TraceSpan &span) noexcept
+			{
+				std::lock_guard<std::mutex> lock (mutex_);
+				spans_ [head_ % kTraceRingCapacity] = span;
+				if (++head_ - tail_ > kTraceRingCapacity)
+				{
+					tail_ = head_ - kTraceRingCapacity;    // The oldest span was overwritten
+				}
+			}
+
+			// Move the spans out, oldest first
+			void drainInto (std::vector<TraceSpan> &out)
+			{
+				std::lock_guard<std::mutex> lock (mutex_);
+				for (; tail_ != head_; ++tail_)
+				{
+					out.push_back (spans_ [tail_ % kTraceRingCapacity]);
+				}
+			}
+
+			void retire () noexcept
+			{
+				retired_.store (true, std::memory_order_release);
+			}
+
+			bool retired () const noexcept
+			{
+				return retired_.load (std::memory_order_acquire);
+			}
+
+		private:
+			std::mutex mutex_;
+			std::vector<TraceSpan> spans_;
+			uint64_t head_ = 0;
+			uint64_t tail_ = 0;
+			std::atomic<bool> retired_ {false};
+	};
+#endif
+
+	namespace
+	{
+		std::atomic<uint32_t> g_sampleRate {0};
+
+#if defined(HAPP_TRACING)
+		// Requests between two reads of the rate while tracing is off
+		constexpr uint32_t kRecheckWhenOff = 1024;
+
+		struct RingRegistry
+		{
+				std::mutex mutex;
+				std::vector<std::shared_ptr<TraceRing>> rings;
+				uint32_t nextThread = 1;
+		};
+
+		// Never destroyed: threads can still close spans while the process exits
+		static RingRegistry &registry ()
+		{
+			static RingRegistry *instance = new RingRegistry;
+			return *instance;
+		}
+
+		// Retires the ring of the thread when it exits (its spans stay until they are drained)
+		struct RingOwner
+		{
+				std::shared_ptr<TraceRing> ring;
+
+				~RingOwner ()
+				{
+					if (ring)
+					{
+						ring->retire();
+					}
+				}
+		};
+
+		thread_local RingOwner t_ringOwner;
+
+		static uint64_t nowNanoseconds () noexcept
+		{
+			return static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (
+			                                  std::chrono::steady_clock::now().time_since_epoch())
+			                                  .count());
+		}
+
+		// Unique in the process: the thread index fills the high bits
+		static uint64_t newSpanId (ThreadTrace &state) noexcept
+		{
+			return (static_cast<uint64_t> (state.thread) << 40) | ++state.nextId;
+		}
+
+		static void attachRing (ThreadTrace &state)
+		{
+			auto ring = std::make_shared<TraceRing>();
+			RingRegistry &rings = registry();
+			{
+				std::lock_guard<std::mutex> lock (rings.mutex);
+				rings.rings.push_back (ring);
+				state.thread = rings.nextThread++;
+			}
+			state.ring = ring.get();
+			t_ringOwner.ring = std::move (ring);
+		}
+
+		static void record (const ThreadTrace &state, uint64_t spanId, uint64_t parentId, uint64_t start,
+		                    TraceStage stage, uint16_t index, std::string_view detail) noexcept
+		{
+			TraceSpan span;
+			span.traceId          = state.traceId;
+			span.spanId           = spanId;
+			span.parentId         = parentId;
+			span.startNanoseconds = start;
+			span.endNanoseconds   = nowNanoseconds();
+			span.thread           = state.thread;
+			span.stage            = stage;
+			span.index            = index;
+			span.detailSize       = static_cast<uint8_t> (std::min (detail.size(), span.detail.size()));
+			std::copy_n (detail.data(), span.detailSize, span.detail.data());
+			state.ring->push (span);
+		}
+#endif
+
+		static void appendDecimal (std::string &out, uint64_t value)
+		{
+			char buffer [24];
+			out.append (buffer, std::to_chars (buffer, buffer + sizeof (buffer), value).ptr);
+		}
+
+		// Fixed width, lowercase (OTLP/JSON ids)
+		static void appendHex (std::string &out, uint64_t value)
+		{
+			static constexpr char kDigits [] = "0123456789abcdef";
+			for (int shift = 60; shift >= 0; shift -= 4)
+			{
+				out.push_back (kDigits [(value >> shift) & 0xF]);
+			}
+		}
+
+		// Nanoseconds as microseconds with three decimals (Chrome trace time unit)
+		static void appendMicroseconds (std::string &out, uint64_t nanoseconds)
+		{
+			appendDecimal (out, nanoseconds / 1000);
+			const uint64_t fraction = nanoseconds % 1000;
+			out.push_back ('.');
+			out.push_back (static_cast<char> ('0' + fraction / 100));
+			out.push_back (static_cast<char> ('0' + fraction / 10 % 10));
+			out.push_back (static_cast<char> ('0' + fraction % 10));
+		}
+
+		// Quoted and escaped
+		static void appendString (std::string &out, std::string_view text)
+		{
+			jwt::jsontext::appendEscaped (out, text);
+		}
+
+		// High half of the OTLP trace ids: traces of different processes do not collide
+		static uint64_t processTraceSeed ()
+		{
+			static const uint64_t seed = [] {
+				std::random_device device;
+				return (static_cast<uint64_t> (device()) << 32) | device();
+			}();
+			return seed;
+		}
+
+		// Wall clock minus steady clock, in nanoseconds
+		static int64_t steadyToUnixOffset ()
+		{
+			using namespace std::chrono;
+			const auto unixNow   = duration_cast<nanoseconds> (system_clock::now().time_since_epoch()).count();
+			const auto steadyNow = duration_cast<nanoseconds> (steady_clock::now().time_since_epoch()).count();
+			return static_cast<int64_t> (unixNow - steadyNow);
+		}
+	}    // namespace
+
+	void setTraceSampleRate (uint32_t oneIn) noexcept
+	{
+		g_sampleRate.store (oneIn, std::memory_order_relaxed);
+#if defined(HAPP_TRACING)
+		t_trace.countdown = 1;
+#endif
+	}
+
+	uint32_t traceSampleRate () noexcept
+	{
+		return g_sampleRate.load (std::memory_order_relaxed);
+	}
+
+	std::vector<TraceSpan> drainTraceSpans ()
+	{
+		std::vector<TraceSpan> spans;
+#if defined(HAPP_TRACING)
+		RingRegistry &rings = registry();
+		std::lock_guard<std::mutex> lock (rings.mutex);
+		// The ring of an exited thread is dropped once drained (retired before the drain: nothing comes after it)
+		std::erase_if (rings.rings, [&spans] (const std::shared_ptr<TraceRing> &ring) {
+			const bool exited = ring->retired();
+			ring->drainInto (spans);
+			return exited;
+		});
+#endif
+		return spans;
+	}
+
+	std::string traceSpanName (const TraceSpan &span)
+	{
+		switch (span.stage)
+		{
+		case TraceStage::Request: return "request";
+		case TraceStage::Match: return "match";
+		case TraceStage::Middleware:
+		{
+			std::string name = "middleware[";
+			appendDecimal (name, span.index);
+			name.push_back (']');
+			return name;
+		}
+		case TraceStage::Handler: return "handler";
+		case TraceStage::JwtDecode: return "jwt.decode";
+		case TraceStage::JwtParse: return "jwt.parse";
+		case TraceStage::JwtSignature: return "jwt.signature";
+		}
+		return "unknown";
+	}
+
+	std::string toChromeTrace (std::span<const TraceSpan> spans)
+	{
+		std::string out;
+		out.reserve (64 + spans.size() * 192);
+		out.append ("{\"traceEvents\":[");
+		for (size_t i = 0; i < spans.size(); ++i)
+		{
+			const TraceSpan &span = spans [i];
+			if (i != 0)
+			{
+				out.push_back (',');
+			}
+			out.append ("{\"name\":");
+			appendString (out, traceSpanName (span));
+			out.append (",\"cat\":\"httplibapp\",\"ph\":\"X\",\"ts\":");
+			appendMicroseconds (out, span.startNanoseconds);
+			out.append (",\"dur\":");
+			appendMicroseconds (out, span.endNanoseconds - span.startNanoseconds);
+			out.append (",\"pid\":1,\"tid\":");
+			appendDecimal (out, span.thread);
+			out.append (",\"args\":{\"trace\":\"");
+			appendHex (out, span.traceId);
+			out.append ("\",\"span\":\"");
+			appendHex (out, span.spanId);
+			out.push_back ('"');
+			if (span.parentId != 0)
+			{
+				out.append (",\"parent\":\"");
+				appendHex (out, span.parentId);
+				out.push_back ('"');
+			}
+			if (span.detailSize != 0)
+			{
+				out.append (",\"detail\":");
+				appendString (out, span.detailView());
+			}
+			out.append ("}}");
+		}
+		out.append ("],\"displayTimeUnit\":\"ns\"}");
+		return out;
+	}
+
+	std::string toOtlpJson (std::span<const TraceSpan> spans, std::string_view serviceName)
+	{
+		const int64_t offset = steadyToUnixOffset();
+		const uint64_t seed  = processTraceSeed();
+
+		std::string out;
+		out.reserve (256 + spans.size() * 320);
+		out.append ("{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":"
+		            "{\"stringValue\":");
+		appendString (out, serviceName);
+		out.append ("}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"ipb.http\"},\"spans\":[");
+		for (size_t i = 0; i < spans.size(); ++i)
+		{
+			const TraceSpan &span = spans [i];
+			if (i != 0)
+			{
+				out.push_back (',');
+			}
+			out.append ("{\"traceId\":\"");
+			appendHex (out, seed);
+			appendHex (out, span.traceId);
+			out.append ("\",\"spanId\":\"");
+			appendHex (out, span.spanId);
+			out.push_back ('"');
+			if (span.parentId != 0)
+			{
+				out.append (",\"parentSpanId\":\"");
+				appendHex (out, span.parentId);
+				out.push_back ('"');
+			}
+			out.append (",\"name\":");
+			appendString (out, traceSpanName (span));
+
+			// SPAN_KIND_SERVER for the request, SPAN_KIND_INTERNAL for its stages
+			out.append (span.parentId == 0 ? ",\"kind\":2" : ",\"kind\":1");
+			out.append (",\"startTimeUnixNano\":\"");
+			appendDecimal (out, static_cast<uint64_t> (static_cast<int64_t> (span.startNanoseconds) + offset));
+			out.append ("\",\"endTimeUnixNano\":\"");
+			appendDecimal (out, static_cast<uint64_t> (static_cast<int64_t> (span.endNanoseconds) + offset));
+			out.append ("\",\"attributes\":[{\"key\":\"thread.id\",\"value\":{\"intValue\":\"");
+			appendDecimal (out, span.thread);
+			out.append ("\"}}");
+			if (span.detailSize != 0)
+			{
+				out.append (",{\"key\":");
+				appendString (out, span.stage == TraceStage::Match ? "http.route" : "detail");
+				out.append (",\"value\":{\"stringValue\":");
+				appendString (out, span.detailView());
+				out.append ("}}");
+			}
+			out.append ("]}");
+		}
+		out.append ("]}]}]}");
+		return out;
+	}
+
+#if defined(HAPP_TRACING)
+	RequestTrace::RequestTrace () noexcept
+	{
+		ThreadTrace &state = t_trace;
+		if (state.active) [[unlikely]]
+		{
+			// Nested in a sampled request: a child span of it
+			spanId_       = newSpanId (state);
+			parentId_     = state.parentId;
+			start_        = nowNanoseconds();
+			state.parentId = spanId_;
+			return;
+		}
+		if (--state.countdown != 0) [[likely]]
+		{
+			return;
+		}
+
+		const uint32_t rate = g_sampleRate.load (std::memory_order_relaxed);
+		if (rate == 0)
+		{
+			state.countdown = kRecheckWhenOff;
+			return;
+		}
+		state.countdown = rate;
+
+		if (state.ring == nullptr)
+		{
+			try
+			{
+				attachRing (state);
+			}
+			catch (...)
+			{
+				return;    // Out of memory: this request is not traced
+			}
+		}
+		state.active   = true;
+		state.traceId  = newSpanId (state);
+		spanId_        = state.traceId;
+		parentId_      = 0;
+		start_         = nowNanoseconds();
+		state.parentId = spanId_;
+	}
+
+	RequestTrace::~RequestTrace ()
+	{
+		if (spanId_ == 0) [[likely]]
+		{
+			return;
+		}
+
+		ThreadTrace &state = t_trace;
+		record (state, spanId_, parentId_, start_, TraceStage::Request, 0, {});
+		state.parentId = parentId_;
+		if (parentId_ == 0)
+		{
+			state.active = false;
+		}
+	}
+
+	void StageScope::open (TraceStage stage, uint16_t index) noexcept
+	{
+		ThreadTrace &state = t_trace;
+		spanId_            = newSpanId (state);
+		parentId_          = state.parentId;
+		stage_             = stage;
+		index_             = index;
+		state.parentId     = spanId_;
+		start_             = nowNanoseconds();
+	}
+
+	void StageScope::close () noexcept
+	{
+		ThreadTrace &state = t_trace;
+		record (state, spanId_, parentId_, start_, stage_, index_, detail_);
+		state.parentId = parentId_;
+		spanId_        = 0;
+	}
+#endif
+
+}    // namespace ipb::http
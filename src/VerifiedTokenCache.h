@@ -0,0 +1,98 @@
+/*********************************************************************************************
+ *  Description : VerifiedTokenCache - Bounded, sharded cache of verified JWTs
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+#ifndef _VERIFIED_TOKEN_CACHE_H_
+#	define _VERIFIED_TOKEN_CACHE_H_
+
+#	include <atomic>
+#	include <cstddef>
+#	include <cstdint>
+#	include <optional>
+#	include <string>
+#	include <string_view>
+#	include <utility>
+
+#	include "Jwt.h"
+#	include "ShardedLru.h"
+
+namespace ipb::http::jwt
+{
+	/**
+	 * @brief Verified tokens indexed by the hash of the full token.
+	 * A hit requires the stored token to be equal to the looked-up one (hash collisions are misses).
+	 * Entries expire at exp + leeway and are purged per kid when its key changes; each shard is an LRU
+	 * protected by its own mutex (skipped when the engine is not thread-safe).
+	 */
+	class VerifiedTokenCache
+	{
+		public:
+			VerifiedTokenCache (size_t capacity, bool synchronized)
+			    : lru_ (capacity, synchronized)
+			{
+			}
+
+			/**
+			 * Changes on every purge: a result verified before a purge must not be inserted after it.
+			 */
+			uint64_t generation () const noexcept
+			{
+				return generation_.load (std::memory_order_acquire);
+			}
+
+			/**
+			 * Copy the cached result for `token` into `out`. Expired entries are dropped.
+			 * @return True on hit.
+			 */
+			bool lookup (std::string_view token, int64_t now, Verifier &out)
+			{
+				return lru_.lookup (token, now, [&out] (const Entry &entry) { out = entry.verifier; });
+			}
+
+			/**
+			 * Store a verified token (replacing a colliding entry).
+			 * @param expiresAt Last second the entry may be served (exp + leeway), if the token expires.
+			 * @param observedGeneration `generation()` read before the signature was checked.
+			 */
+			void insert (std::string_view token, std::string_view kid, std::optional<int64_t> expiresAt,
+			             Verifier verifier, uint64_t observedGeneration)
+			{
+				lru_.insert (token, expiresAt.value_or (Lru::kNoExpiry),
+				             Entry {.kid = std::string (kid), .verifier = std::move (verifier)},
+				             [&] { return generation() == observedGeneration; });
+			}
+
+			/**
+			 * Drop every entry verified with `kid`.
+			 */
+			void purgeKid (std::string_view kid)
+			{
+				// Bumped before scanning: inserts checked afterwards are rejected, earlier ones are purged
+				generation_.fetch_add (1, std::memory_order_acq_rel);
+				lru_.eraseIf ([kid] (const std::string &, const Entry &entry) { return entry.kid == kid; });
+			}
+
+			size_t size ()
+			{
+				return lru_.size();
+			}
+
+		private:
+			struct Entry
+			{
+					std::string kid;
+					Verifier verifier;
+			};
+
+			using Lru = ShardedLru<std::string, Entry>;
+
+			Lru lru_;
+			std::atomic<uint64_t> generation_ {0};
+	};
+
+}    // namespace ipb::http::jwt
+
+#endif
@@ -0,0 +1,40 @@
+﻿/*********************************************************************************************
+ *  Description : Counting replacement of the global operator new for allocation tests
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace ipb::http::testutil
+{
+	std::atomic<bool> g_count_allocations {false};
+	std::atomic<size_t> g_allocations {0};
+}    // namespace ipb::http::testutil
+
+void *operator new (std::size_t size)
+{
+	if (ipb::http::testutil::g_count_allocations)
+	{
+		++ipb::http::testutil::g_allocations;
+	}
+
+	if (void *ptr = std::malloc (size != 0 ? size : 1))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete (void *ptr) noexcept
+{
+	std::free (ptr);
+}
+
+void operator delete (void *ptr, std::size_t) noexcept
+{
+	std::free (ptr);
+}
@@ -0,0 +1,41 @@
+/*********************************************************************************************
+ *  Description : AllocationCounter - Counts the global operator new calls of a scope (tests and benchmarks)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace ipb::http::testutil
+{
+	extern std::atomic<bool> g_count_allocations;
+	extern std::atomic<size_t> g_allocations;
+
+	/**
+	 * Counts the heap allocations (global operator new) performed while alive.
+	 * The replacement operator new lives in AllocationCounter.cpp (on Windows it only sees the
+	 * allocations of the tester module, not the ones done inside HttplibApp.dll).
+	 */
+	class AllocationCounter
+	{
+		public:
+			AllocationCounter ()
+			{
+				g_allocations       = 0;
+				g_count_allocations = true;
+			}
+
+			~AllocationCounter ()
+			{
+				g_count_allocations = false;
+			}
+
+			size_t count () const
+			{
+				return g_allocations;
+			}
+	};
+}    // namespace ipb::http::testutil
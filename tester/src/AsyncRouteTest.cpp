@@ -0,0 +1,288 @@
+/*********************************************************************************************
+ *  Description : Unit tests for coroutine handlers and middlewares
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "AsyncTask.h"
+#include "Route.h"
+
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ipb::http
+{
+	namespace
+	{
+		class NullCtx : public ICtx
+		{
+			public:
+				void setParam (std::string_view, std::string_view) override
+				{
+				}
+		};
+
+		// Single-threaded event loop: suspended coroutines wait in a queue until `drain`
+		class ManualLoop
+		{
+			public:
+				auto suspend ()
+				{
+					struct Awaiter
+					{
+							ManualLoop &loop;
+
+							bool await_ready () const noexcept
+							{
+								return false;
+							}
+
+							void await_suspend (std::coroutine_handle<> handle)
+							{
+								loop.pending_.push_back (handle);
+							}
+
+							void await_resume () const noexcept
+							{
+							}
+					};
+					return Awaiter {*this};
+				}
+
+				size_t pending () const noexcept
+				{
+					return pending_.size();
+				}
+
+				void drain ()
+				{
+					while (!pending_.empty())
+					{
+						auto handle = pending_.front();
+						pending_.pop_front();
+						handle.resume();
+					}
+				}
+
+			private:
+				std::deque<std::coroutine_handle<>> pending_;
+		};
+
+		// Resumes the awaiting coroutine from another thread (an I/O completion)
+		struct ResumeOnOtherThread
+		{
+				bool await_ready () const noexcept
+				{
+					return false;
+				}
+
+				void await_suspend (std::coroutine_handle<> handle) const
+				{
+					std::thread (
+					    [handle]
+					    {
+						    std::this_thread::sleep_for (std::chrono::milliseconds (5));
+						    handle.resume();
+					    })
+					    .detach();
+				}
+
+				void await_resume () const noexcept
+				{
+				}
+		};
+	}    // namespace
+
+	TEST (AsyncRouteTest, MiddlewaresSuspendAndKeepTheOnionOrder)
+	{
+		ManualLoop loop;
+		std::vector<std::string> calls;
+
+		Router router;
+		router.addAsyncMiddleware (
+		    [&] (ICtx &, IAsyncMiddlewareNext &next) -> AsyncTask
+		    {
+			    calls.push_back ("auth:before");
+			    co_await loop.suspend();    // e.g. a remote auth call
+			    co_await next();
+			    calls.push_back ("auth:after");
+		    });
+		auto &route = router.addAsync (HttpMethod::GET, "/users/<id:int>",
+		                               [&] (ICtx &) -> AsyncTask
+		                               {
+			                               co_await loop.suspend();
+			                               calls.push_back ("handler");
+		                               });
+		router.addAsyncMiddleware (route,
+		                           [&] (ICtx &, IAsyncMiddlewareNext &next) -> AsyncTask
+		                           {
+			                           calls.push_back ("route:before");
+			                           co_await next();
+			                           calls.push_back ("route:after");
+		                           });
+
+		for (bool frozen : {false, true})
+		{
+			if (frozen)
+			{
+				router.freeze();
+			}
+			calls.clear();
+
+			NullCtx ctx;
+			const RouteInfo &matched = router.match (HttpMethod::GET, "/users/7", ctx)->get();
+			AsyncTask task = router.executeAsync (matched, ctx);
+			EXPECT_TRUE (calls.empty());    // Lazy
+
+			task.start();
+			EXPECT_FALSE (task.done());
+			EXPECT_EQ (calls, std::vector<std::string> {"auth:before"});
+
+			loop.drain();
+			ASSERT_TRUE (task.done());
+			const std::vector<std::string> expected = {"auth:before", "route:before", "handler", "route:after",
+			                                           "auth:after"};
+			EXPECT_EQ (calls, expected);
+		}
+	}
+
+	TEST (AsyncRouteTest, OneThreadServesManyRequestsInFlight)
+	{
+		ManualLoop loop;
+		int completed = 0;
+
+		Router router;
+		router.addAsync (HttpMethod::GET, "/slow",
+		                 [&] (ICtx &) -> AsyncTask
+		                 {
+			                 co_await loop.suspend();
+			                 ++completed;
+		                 });
+		router.freeze();
+
+		NullCtx ctx;
+		const RouteInfo &route = router.match (HttpMethod::GET, "/slow", ctx)->get();
+		std::vector<AsyncTask> tasks;
+		for (int i = 0; i < 100; ++i)
+		{
+			tasks.push_back (router.executeAsync (route, ctx));
+			tasks.back().start();
+		}
+
+		EXPECT_EQ (loop.pending(), 100u);
+		EXPECT_EQ (completed, 0);
+		loop.drain();
+		EXPECT_EQ (completed, 100);
+	}
+
+	TEST (AsyncRouteTest, NextRunsTheRestOfTheChainOnce)
+	{
+		int handler_calls = 0;
+		bool short_circuit_reached = false;
+
+		Router router;
+		router.addAsyncMiddleware (
+		    [] (ICtx &, IAsyncMiddlewareNext &next) -> AsyncTask
+		    {
+			    co_await next();
+			    co_await next();
+		    });
+		router.addAsync (HttpMethod::GET, "/once",
+		                 [&] (ICtx &) -> AsyncTask
+		                 {
+			                 ++handler_calls;
+			                 co_return;
+		                 });
+		auto &blocked = router.add (HttpMethod::GET, "/blocked",
+		                            [&] (ICtx &)
+		                            {
+			                            short_circuit_reached = true;
+		                            });
+		router.addAsyncMiddleware (blocked,
+		                           [] (ICtx &, IAsyncMiddlewareNext &) -> AsyncTask
+		                           {
+			                           co_return;    // Does not call next
+		                           });
+		router.freeze();
+
+		NullCtx ctx;
+		router.executeAsync (router.match (HttpMethod::GET, "/once", ctx)->get(), ctx).wait();
+		EXPECT_EQ (handler_calls, 1);
+
+		router.executeAsync (router.match (HttpMethod::GET, "/blocked", ctx)->get(), ctx).wait();
+		EXPECT_FALSE (short_circuit_reached);
+	}
+
+	TEST (AsyncRouteTest, SynchronousStepsMixWithCoroutines)
+	{
+		std::vector<std::string> calls;
+
+		Router router;
+		router.addMiddleware (
+		    [&] (ICtx &, IMiddlewareNext &next)
+		    {
+			    calls.push_back ("sync:before");
+			    next.next();    // Holds the thread while the coroutine is suspended
+			    calls.push_back ("sync:after");
+		    });
+		router.addAsync (HttpMethod::GET, "/io",
+		                 [&] (ICtx &) -> AsyncTask
+		                 {
+			                 co_await ResumeOnOtherThread {};
+			                 calls.push_back ("handler");
+		                 });
+		router.freeze();
+
+		const std::vector<std::string> expected = {"sync:before", "handler", "sync:after"};
+		NullCtx ctx;
+		const RouteInfo &route = router.match (HttpMethod::GET, "/io", ctx)->get();
+
+		// The synchronous API blocks until the coroutine completes
+		router.execute (route, ctx);
+		EXPECT_EQ (calls, expected);
+
+		calls.clear();
+		router.executeAsync (route, ctx).wait();
+		EXPECT_EQ (calls, expected);
+	}
+
+	TEST (AsyncRouteTest, ExceptionsReachTheAwaiter)
+	{
+		Router router;
+		router.addAsync (HttpMethod::GET, "/fail",
+		                 [] (ICtx &) -> AsyncTask
+		                 {
+			                 co_await std::suspend_never {};
+			                 throw std::runtime_error ("backend down");
+		                 });
+		router.freeze();
+
+		NullCtx ctx;
+		const RouteInfo &route = router.match (HttpMethod::GET, "/fail", ctx)->get();
+		EXPECT_THROW (router.executeAsync (route, ctx).wait(), std::runtime_error);
+		EXPECT_THROW (router.execute (route, ctx), std::runtime_error);
+	}
+
+	TEST (AsyncRouteTest, FreezeFlagsTheRoutesWithCoroutineSteps)
+	{
+		Router router;
+		router.add (HttpMethod::GET, "/sync", [] (ICtx &) {});
+		router.addAsync (HttpMethod::GET, "/handler", [] (ICtx &) -> AsyncTask { co_return; });
+		auto &route = router.add (HttpMethod::GET, "/middleware", [] (ICtx &) {});
+		router.addAsyncMiddleware (route, [] (ICtx &, IAsyncMiddlewareNext &next) -> AsyncTask { co_await next(); });
+		router.freeze();
+
+		NullCtx ctx;
+		EXPECT_FALSE (router.match (HttpMethod::GET, "/sync", ctx)->get().async);
+		EXPECT_TRUE (router.match (HttpMethod::GET, "/handler", ctx)->get().async);
+		EXPECT_TRUE (router.match (HttpMethod::GET, "/middleware", ctx)->get().async);
+	}
+
+}    // namespace ipb::http
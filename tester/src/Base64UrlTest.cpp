@@ -0,0 +1,152 @@
+/*********************************************************************************************
+ *  Description : Unit tests for the Base64URL codec
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Base64Url.h"
+#include "Jwt.h"
+#include "JwtTestProviders.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ipb::http
+{
+	namespace
+	{
+		std::string encodeToString (std::string_view bytes)
+		{
+			std::string text (base64url::encodedSize (bytes.size()), '\0');
+			const auto *data = reinterpret_cast<const uint8_t *> (bytes.data());
+			EXPECT_EQ (base64url::encode ({data, bytes.size()}, text), text.size());
+			return text;
+		}
+
+		std::optional<std::string> decodeToString (std::string_view text)
+		{
+			std::vector<uint8_t> bytes (base64url::decodedSize (text.size()));
+			auto size = base64url::decode (text, bytes);
+			if (!size.has_value())
+			{
+				return std::nullopt;
+			}
+			return std::string (bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t> (size.value()));
+		}
+
+		// Bit-by-bit reference encoder
+		std::string referenceEncode (const std::vector<uint8_t> &bytes)
+		{
+			static constexpr char kAlphabet [] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+			std::string text;
+			uint32_t buffer = 0;
+			int bits        = 0;
+			for (uint8_t byte : bytes)
+			{
+				buffer = (buffer << 8) | byte;
+				bits += 8;
+				while (bits >= 6)
+				{
+					bits -= 6;
+					text.push_back (kAlphabet [(buffer >> bits) & 0x3F]);
+				}
+			}
+			if (bits > 0)
+			{
+				text.push_back (kAlphabet [(buffer << (6 - bits)) & 0x3F]);
+			}
+			return text;
+		}
+	}    // namespace
+
+	TEST (Base64UrlTest, Rfc4648Vectors)
+	{
+		EXPECT_EQ (encodeToString (""), "");
+		EXPECT_EQ (encodeToString ("f"), "Zg");
+		EXPECT_EQ (encodeToString ("fo"), "Zm8");
+		EXPECT_EQ (encodeToString ("foo"), "Zm9v");
+		EXPECT_EQ (encodeToString ("foob"), "Zm9vYg");
+		EXPECT_EQ (encodeToString ("fooba"), "Zm9vYmE");
+		EXPECT_EQ (encodeToString ("foobar"), "Zm9vYmFy");
+		EXPECT_EQ (encodeToString ("\xFB\xFF\xBF"), "-_-_");
+
+		EXPECT_EQ (decodeToString ("Zm9vYmFy"), "foobar");
+		EXPECT_EQ (decodeToString ("Zm9vYmE"), "fooba");
+		EXPECT_EQ (decodeToString ("Zm9vYg"), "foob");
+		EXPECT_EQ (decodeToString ("-_-_"), "\xFB\xFF\xBF");
+	}
+
+	TEST (Base64UrlTest, RoundTripsEverySizeAcrossTheVectorBlocks)
+	{
+		std::mt19937 random (1234);
+		for (size_t size = 0; size <= 300; ++size)
+		{
+			std::vector<uint8_t> bytes (size);
+			for (auto &byte : bytes)
+			{
+				byte = static_cast<uint8_t> (random());
+			}
+
+			std::string text (base64url::encodedSize (size), '\0');
+			ASSERT_EQ (base64url::encode (bytes, text), text.size());
+			ASSERT_EQ (text, referenceEncode (bytes)) << size;
+
+			std::vector<uint8_t> decoded (base64url::decodedSize (text.size()));
+			ASSERT_EQ (base64url::decode (text, decoded), size) << size;
+			ASSERT_EQ (decoded, bytes) << size;
+		}
+	}
+
+	TEST (Base64UrlTest, RejectsInvalidTextAtAnyPosition)
+	{
+		const std::string valid = encodeToString (std::string (200, 'x'));
+		for (size_t position = 0; position < valid.size(); ++position)
+		{
+			for (char bad : {'+', '/', '=', ' ', '\0', '\x80', '\xFF', '@', '[', '`', '{'})
+			{
+				std::string text = valid;
+				text [position]  = bad;
+				ASSERT_FALSE (decodeToString (text).has_value()) << position << " " << int (bad);
+			}
+		}
+		EXPECT_TRUE (decodeToString (valid).has_value());
+	}
+
+	TEST (Base64UrlTest, IsStrict)
+	{
+		EXPECT_FALSE (decodeToString ("Zm9vYg==").has_value());    // Padding
+		EXPECT_FALSE (decodeToString ("Zm9vY").has_value());       // 4n+1 characters
+		EXPECT_FALSE (decodeToString ("Zh").has_value());          // Non-zero unused bits ("Zg" is canonical)
+		EXPECT_FALSE (decodeToString ("Zm9").has_value());         // Same, 2 bytes ("Zm8")
+
+		std::vector<uint8_t> small (2);
+		EXPECT_FALSE (base64url::decode ("Zm9v", small).has_value());
+
+		std::string text (3, '\0');
+		const uint8_t bytes [] = {'f', 'o', 'o'};
+		EXPECT_EQ (base64url::encode (bytes, text), 0u);
+	}
+
+	TEST (Base64UrlTest, ProviderDefaultsUseTheCodec)
+	{
+		jwt::FakeCryptoProvider crypto;
+		const jwt::ICryptoProvider &provider = crypto;
+
+		std::string text;
+		const uint8_t bytes [] = {'f', 'o', 'o', 'b'};
+		ASSERT_EQ (provider.ICryptoProvider::base64UrlEncode (bytes, text).code, jwt::ErrorCode::Ok);
+		EXPECT_EQ (text, "Zm9vYg");
+
+		jwt::ByteBuffer decoded;
+		ASSERT_EQ (provider.ICryptoProvider::base64UrlDecode ("Zm9vYg", decoded).code, jwt::ErrorCode::Ok);
+		EXPECT_EQ (decoded, jwt::ByteBuffer (std::begin (bytes), std::end (bytes)));
+
+		EXPECT_EQ (provider.ICryptoProvider::base64UrlDecode ("Zm9vYg==", decoded).code, jwt::ErrorCode::InvalidBase64Url);
+		EXPECT_TRUE (decoded.empty());
+	}
+
+}    // namespace ipb::http
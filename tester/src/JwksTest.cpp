@@ -0,0 +1,283 @@
+/*********************************************************************************************
+ *  Description : Unit tests for the JWKS client
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Jwks.h"
+#include "Jwt.h"
+#include "JwtTestProviders.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace ipb::http::jwt
+{
+	namespace
+	{
+		class FakeJwksSource final : public IJwksSource
+		{
+			public:
+				std::atomic<int> fetchCalls {0};
+
+				void set (std::string body, std::string cacheControl = {})
+				{
+					std::lock_guard lock (mutex_);
+					document_.body         = std::move (body);
+					document_.cacheControl = std::move (cacheControl);
+				}
+
+				void fail (bool failing)
+				{
+					std::lock_guard lock (mutex_);
+					failing_ = failing;
+				}
+
+				Error fetch (JwksDocument &outDocument) override
+				{
+					++fetchCalls;
+					std::lock_guard lock (mutex_);
+					if (failing_)
+					{
+						return {.code = ErrorCode::IOError, .message = "unreachable"};
+					}
+					outDocument = document_;
+					return {.code = ErrorCode::Ok, .message = {}};
+				}
+
+			private:
+				std::mutex mutex_;
+				JwksDocument document_;
+				bool failing_ = false;
+		};
+
+		// Tokens signed by the issuer (the fake signature only depends on alg, kid and data)
+		std::string issue (std::string_view kid)
+		{
+			FakeCryptoProvider crypto;
+			FakeJsonProvider json;
+			Jwt issuer {crypto, json};
+			issuer.generateKeyPair (kid, JwtAlg::HS256);
+
+			std::string token;
+			issuer.token()
+			    .kid (std::string (kid))
+			    .subject ("user")
+			    .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 600)
+			    .sign (token);
+			return token;
+		}
+
+		template <typename Predicate> bool waitFor (Predicate predicate)
+		{
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds (5);
+			while (!predicate())
+			{
+				if (std::chrono::steady_clock::now() > deadline)
+				{
+					return false;
+				}
+				std::this_thread::sleep_for (std::chrono::milliseconds (1));
+			}
+			return true;
+		}
+	}    // namespace
+
+	TEST (JwksTest, ParseMaxAge)
+	{
+		EXPECT_EQ (parseMaxAge ("public, max-age=600"), 600);
+		EXPECT_EQ (parseMaxAge ("MAX-AGE=\"60\", must-revalidate"), 60);
+		EXPECT_EQ (parseMaxAge ("max-age=60, no-cache"), 0);
+		EXPECT_EQ (parseMaxAge ("no-store"), 0);
+		EXPECT_FALSE (parseMaxAge ("").has_value());
+		EXPECT_FALSE (parseMaxAge ("public").has_value());
+		EXPECT_FALSE (parseMaxAge ("max-age=soon").has_value());
+		EXPECT_FALSE (parseMaxAge ("max-age=-1").has_value());
+	}
+
+	TEST (JwksTest, RefreshLoadsChangedKeysAndRemovesMissingOnes)
+	{
+		FakeCryptoProvider crypto;
+		FakeJsonProvider json;
+		Jwt engine {crypto, json};
+		FakeJwksSource source;
+		JwksClient client {engine, source};
+
+		source.set ("k1=jwk-1\nk2=jwk-2");
+		ASSERT_EQ (client.refresh().code, ErrorCode::Ok);
+		EXPECT_EQ (client.keyCount(), 2u);
+		EXPECT_EQ (crypto.loadJwkCalls, 2);
+
+		Verifier verifier;
+		EXPECT_EQ (engine.verify (issue ("k2"), verifier).code, ErrorCode::Ok);
+
+		// k1 unchanged (not reloaded), k2 gone, k3 new
+		source.set ("k1=jwk-1\nk3=jwk-3");
+		ASSERT_EQ (client.refresh().code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.loadJwkCalls, 3);
+		EXPECT_TRUE (client.hasKey ("k1"));
+		EXPECT_FALSE (client.hasKey ("k2"));
+		EXPECT_TRUE (client.hasKey ("k3"));
+
+		EXPECT_EQ (engine.verify (issue ("k1"), verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (engine.verify (issue ("k2"), verifier).code, ErrorCode::KeyNotFound);
+		EXPECT_EQ (engine.verify (issue ("k3"), verifier).code, ErrorCode::Ok);
+	}
+
+	TEST (JwksTest, KeysThatFailToLoadAreSkipped)
+	{
+		FakeCryptoProvider crypto;
+		FakeJsonProvider json;
+		Jwt engine {crypto, json};
+		FakeJwksSource source;
+		JwksClient client {engine, source};
+
+		source.set ("k1=jwk-1\nk2=");
+		EXPECT_EQ (client.refresh().code, ErrorCode::CryptoError);
+		EXPECT_TRUE (client.hasKey ("k1"));
+		EXPECT_FALSE (client.hasKey ("k2"));
+	}
+
+	TEST (JwksTest, RefreshDelayFollowsCacheControl)
+	{
+		FakeCryptoProvider crypto;
+		FakeJsonProvider json;
+		Jwt engine {crypto, json};
+		FakeJwksSource source;
+		JwksOptions options {.refreshInterval    = std::chrono::seconds (300),
+		                     .minRefreshInterval = std::chrono::seconds (30),
+		                     .maxRefreshInterval = std::chrono::seconds (3600),
+		                     .retryInterval      = std::chrono::seconds (5)};
+		JwksClient client {engine, source, options};
+
+		source.set ("k1=jwk-1", "public, max-age=120");
+		ASSERT_EQ (client.refresh().code, ErrorCode::Ok);
+		EXPECT_EQ (client.refreshDelay(), std::chrono::seconds (120));
+
+		source.set ("k1=jwk-1", "no-cache");
+		ASSERT_EQ (client.refresh().code, ErrorCode::Ok);
+		EXPECT_EQ (client.refreshDelay(), std::chrono::seconds (30));
+
+		source.set ("k1=jwk-1", "max-age=86400");
+		ASSERT_EQ (client.refresh().code, ErrorCode::Ok);
+		EXPECT_EQ (client.refreshDelay(), std::chrono::seconds (3600));
+
+		source.set ("k1=jwk-1");
+		ASSERT_EQ (client.refresh().code, ErrorCode::Ok);
+		EXPECT_EQ (client.refreshDelay(), std::chrono::seconds (300));
+
+		source.fail (true);
+		EXPECT_EQ (client.refresh().code, ErrorCode::IOError);
+		EXPECT_EQ (client.refreshDelay(), std::chrono::seconds (5));
+		EXPECT_TRUE (client.hasKey ("k1"));
+	}
+
+	TEST (JwksTest, UnknownKidTriggersBackgroundRefresh)
+	{
+		FakeCryptoProvider crypto;
+		FakeJsonProvider json;
+		Jwt engine {crypto, json};
+		FakeJwksSource source;
+		JwksClient client {engine, source,
+		                   JwksOptions {.refreshInterval    = std::chrono::seconds (3600),
+		                                .minRefreshInterval = std::chrono::seconds (0),
+		                                .maxRefreshInterval = std::chrono::seconds (3600),
+		                                .retryInterval      = std::chrono::seconds (3600)}};
+
+		source.set ("k1=jwk-1");
+		client.start();
+		ASSERT_TRUE (waitFor ([&] { return client.hasKey ("k1"); }));
+		EXPECT_EQ (source.fetchCalls, 1);
+
+		// The key is rotated: verify fails without blocking, then succeeds once the refresher catches up
+		source.set ("k1=jwk-1\nk2=jwk-2");
+		const std::string token = issue ("k2");
+		Verifier verifier;
+		EXPECT_EQ (engine.verify (token, verifier).code, ErrorCode::KeyNotFound);
+		ASSERT_TRUE (waitFor ([&] { return client.hasKey ("k2"); }));
+		EXPECT_EQ (engine.verify (token, verifier).code, ErrorCode::Ok);
+
+		client.stop();
+		EXPECT_FALSE (static_cast<bool> (engine.options().onUnknownKid));
+	}
+
+	TEST (JwksTest, StartChainsToThePreviousUnknownKidCallback)
+	{
+		FakeCryptoProvider crypto;
+		FakeJsonProvider json;
+		std::atomic<int> calls {0};
+		EngineOptions options;
+		options.onUnknownKid = [&] (std::string_view kid) { calls += kid == "k2" ? 1 : 0; };
+		Jwt engine {crypto, json, options};
+		FakeJwksSource source;
+		JwksClient client {engine, source,
+		                   JwksOptions {.refreshInterval    = std::chrono::seconds (3600),
+		                                .minRefreshInterval = std::chrono::seconds (0),
+		                                .maxRefreshInterval = std::chrono::seconds (3600),
+		                                .retryInterval      = std::chrono::seconds (3600)}};
+
+		source.set ("k1=jwk-1");
+		client.start();
+		ASSERT_TRUE (waitFor ([&] { return client.hasKey ("k1"); }));
+
+		// Both the refresher and the application callback see the unknown kid
+		source.set ("k1=jwk-1\nk2=jwk-2");
+		const std::string token = issue ("k2");
+		Verifier verifier;
+		EXPECT_EQ (engine.verify (token, verifier).code, ErrorCode::KeyNotFound);
+		EXPECT_EQ (calls.load(), 1);
+		ASSERT_TRUE (waitFor ([&] { return client.hasKey ("k2"); }));
+
+		// stop puts the application callback back
+		client.stop();
+		ASSERT_TRUE (static_cast<bool> (engine.options().onUnknownKid));
+		engine.options().onUnknownKid ("k2");
+		EXPECT_EQ (calls.load(), 2);
+	}
+
+	TEST (JwksTest, UnknownKidRefreshesAreRateLimited)
+	{
+		FakeCryptoProvider crypto;
+		FakeJsonProvider json;
+		Jwt engine {crypto, json};
+		FakeJwksSource source;
+		JwksClient client {engine, source,
+		                   JwksOptions {.refreshInterval    = std::chrono::seconds (3600),
+		                                .minRefreshInterval = std::chrono::seconds (3600),
+		                                .maxRefreshInterval = std::chrono::seconds (3600),
+		                                .retryInterval      = std::chrono::seconds (3600)}};
+
+		source.set ("k1=jwk-1");
+		client.start();
+		ASSERT_TRUE (waitFor ([&] { return client.hasKey ("k1"); }));
+
+		const std::string token = issue ("unknown");
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t)
+		{
+			threads.emplace_back (
+			    [&]
+			    {
+				    Verifier verifier;
+				    for (int i = 0; i < 200; ++i)
+				    {
+					    EXPECT_EQ (engine.verify (token, verifier).code, ErrorCode::KeyNotFound);
+				    }
+			    });
+		}
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		std::this_thread::sleep_for (std::chrono::milliseconds (20));
+		EXPECT_EQ (source.fetchCalls, 1);
+	}
+
+}    // namespace ipb::http::jwt
@@ -0,0 +1,244 @@
+/*********************************************************************************************
+ *  Description : Unit tests for the built-in JWT JSON provider
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Jwt.h"
+#include "JwtJsonProvider.h"
+#include "JwtTestProviders.h"
+
+#include <ctime>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ipb::http::jwt
+{
+	namespace
+	{
+		const std::string *stringOf (const ClaimMap &map, std::string_view name)
+		{
+			auto it = map.find (name);
+			return it == map.end() ? nullptr : std::get_if<std::string> (&it->second);
+		}
+	}    // namespace
+
+	TEST (JwtJsonProviderTest, ParsesScalarMembers)
+	{
+		JwtJsonProvider json;
+		ClaimMap claims;
+		ASSERT_EQ (json.parseClaims (R"( { "sub" : "user-1", "exp":1700000000, "ratio":-2.5e1,
+		                                   "admin":true, "guest":false, "nothing":null,
+		                                   "huge":18446744073709551616 } )",
+		                             claims)
+		               .code,
+		           ErrorCode::Ok);
+
+		ASSERT_EQ (claims.size(), 7u);
+		EXPECT_EQ (*stringOf (claims, "sub"), "user-1");
+		EXPECT_EQ (std::get<int64_t> (claims.find ("exp")->second), 1700000000);
+		EXPECT_EQ (std::get<double> (claims.find ("ratio")->second), -25.0);
+		EXPECT_TRUE (std::get<bool> (claims.find ("admin")->second));
+		EXPECT_FALSE (std::get<bool> (claims.find ("guest")->second));
+		EXPECT_TRUE (std::holds_alternative<std::nullptr_t> (claims.find ("nothing")->second));
+		EXPECT_EQ (std::get<double> (claims.find ("huge")->second), 18446744073709551616.0);
+	}
+
+	TEST (JwtJsonProviderTest, UnescapesStrings)
+	{
+		JwtJsonProvider json;
+		ClaimMap claims;
+		ASSERT_EQ (json.parseClaims (R"({"a":"q\"b\\s\/n\nt\t","u":"é€😀",
+		                                 "long":"a string that is longer than one sixteen-byte block \" end"})",
+		                             claims)
+		               .code,
+		           ErrorCode::Ok);
+
+		EXPECT_EQ (*stringOf (claims, "a"), "q\"b\\s/n\nt\t");
+		EXPECT_EQ (*stringOf (claims, "u"), "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+		EXPECT_EQ (*stringOf (claims, "long"), "a string that is longer than one sixteen-byte block \" end");
+	}
+
+	TEST (JwtJsonProviderTest, ReadsStringArraysAndKeepsOtherNestedValuesAsJson)
+	{
+		JwtJsonProvider json;
+		ClaimMap claims;
+		ASSERT_EQ (json.parseClaims (R"({"aud":[ "a" , "b\"" ],"none":[],"mixed":["a",1],
+		                                 "realm":{"roles":["x"],"n":{"deep":[1,2.5,"}"]}},"sub":"s"})",
+		                             claims)
+		               .code,
+		           ErrorCode::Ok);
+
+		EXPECT_EQ (std::get<ClaimStrings> (claims.find ("aud")->second), (ClaimStrings {"a", "b\""}));
+		EXPECT_TRUE (std::get<ClaimStrings> (claims.find ("none")->second).empty());
+		EXPECT_EQ (std::get<ClaimJson> (claims.find ("mixed")->second).text, R"(["a",1])");
+		EXPECT_EQ (std::get<ClaimJson> (claims.find ("realm")->second).text, R"({"roles":["x"],"n":{"deep":[1,2.5,"}"]}})");
+		EXPECT_EQ (stringOf (claims, "realm"), nullptr);
+		EXPECT_EQ (*stringOf (claims, "sub"), "s");
+	}
+
+	TEST (JwtJsonProviderTest, RejectsMalformedDocuments)
+	{
+		JwtJsonProvider json;
+		ClaimMap claims;
+		const char *invalid [] = {
+		    "",
+		    "[]",
+		    "{",
+		    R"({"a":1,})",
+		    R"({"a" 1})",
+		    R"({"a":01})",
+		    R"({"a":1.})",
+		    R"({"a":-})",
+		    R"({"a":tru})",
+		    R"({"a":"unterminated})",
+		    "{\"a\":\"raw\ncontrol\"}",
+		    R"({"a":"\x"})",
+		    R"({"a":"\ud83d"})",
+		    R"({"a":"\ude00"})",
+		    R"({"a":1} trailing)",
+		    R"({"a":1,"a":2})",
+		    R"({"a":[1,2})",
+		    R"({"a":1e400})",
+		};
+
+		for (const char *text : invalid)
+		{
+			EXPECT_EQ (json.parseClaims (text, claims).code, ErrorCode::InvalidJson) << text;
+			EXPECT_TRUE (claims.empty()) << text;
+		}
+
+		std::string deep (100, '[');
+		EXPECT_EQ (json.parseClaims ("{\"a\":" + deep + std::string (100, ']') + "}", claims).code, ErrorCode::InvalidJson);
+	}
+
+	TEST (JwtJsonProviderTest, WritesAndReadsBack)
+	{
+		JwtJsonProvider json;
+		ClaimMap claims;
+		claims ["sub"]     = std::string ("quote \" backslash \\ newline \n bell \x07");
+		claims ["exp"]     = int64_t {-42};
+		claims ["ratio"]   = 0.1;
+		claims ["admin"]   = true;
+		claims ["nothing"] = nullptr;
+
+		std::string text;
+		ASSERT_EQ (json.toJson (claims, text).code, ErrorCode::Ok);
+		EXPECT_EQ (text,
+		           R"({"sub":"quote \" backslash \\ newline \n bell \u0007","exp":-42,"ratio":0.1,"admin":true,"nothing":null})");
+
+		ClaimMap parsed;
+		ASSERT_EQ (json.parseClaims (text, parsed).code, ErrorCode::Ok);
+		EXPECT_EQ (parsed.size(), claims.size());
+		EXPECT_EQ (*stringOf (parsed, "sub"), std::get<std::string> (claims ["sub"]));
+		EXPECT_EQ (std::get<double> (parsed.find ("ratio")->second), 0.1);
+
+		claims ["bad"] = std::numeric_limits<double>::infinity();
+		EXPECT_EQ (json.toJson (claims, text).code, ErrorCode::JsonError);
+	}
+
+	TEST (JwtJsonProviderTest, NestedValuesRoundTripUnquoted)
+	{
+		JwtJsonProvider json;
+		const std::string_view original = R"({"aud":["a","b \"c\""],"empty":[],"realm":{"roles":["x",{"n":1}]},"list":[1,"two",null]})";
+
+		ClaimMap claims;
+		ASSERT_EQ (json.parseClaims (original, claims).code, ErrorCode::Ok);
+		std::string text;
+		ASSERT_EQ (json.toJson (claims, text).code, ErrorCode::Ok);
+		EXPECT_EQ (text, original);
+
+		ClaimMap parsed;
+		ASSERT_EQ (json.parseClaims (text, parsed).code, ErrorCode::Ok);
+		EXPECT_EQ (parsed.find ("aud")->second, claims.find ("aud")->second);
+		EXPECT_EQ (parsed.find ("realm")->second, claims.find ("realm")->second);
+	}
+
+	TEST (JwtJsonProviderTest, ParsesJwks)
+	{
+		JwtJsonProvider json;
+		std::vector<JwkEntry> keys;
+		ASSERT_EQ (json.parseJwks (R"({"keys":[
+		                                  {"kty":"RSA","kid":"k1","use":"sig","alg":"RS256","n":"0vx","e":"AQAB"},
+		                                  {"kty":"EC","kid":"k2","use":"enc","crv":"P-256","x_list":[1,{"y":2}]}
+		                              ],"other":{"ignored":true}})",
+		                           keys)
+		               .code,
+		           ErrorCode::Ok);
+
+		ASSERT_EQ (keys.size(), 2u);
+		EXPECT_EQ (keys [0].kid, "k1");
+		EXPECT_EQ (keys [0].alg, "RS256");
+		EXPECT_EQ (keys [0].use, JwtUse::Sig);
+		EXPECT_EQ (keys [0].json, R"({"kty":"RSA","kid":"k1","use":"sig","alg":"RS256","n":"0vx","e":"AQAB"})");
+		EXPECT_EQ (keys [1].kid, "k2");
+		EXPECT_EQ (keys [1].use, JwtUse::Enc);
+
+		EXPECT_EQ (json.parseJwks (R"({"other":[]})", keys).code, ErrorCode::InvalidJson);
+		EXPECT_EQ (json.parseJwks (R"({"keys":[1]})", keys).code, ErrorCode::InvalidJson);
+		EXPECT_TRUE (keys.empty());
+	}
+
+	TEST (JwtJsonProviderTest, SignsAndVerifiesWithTheEngine)
+	{
+		FakeCryptoProvider crypto;
+		JwtJsonProvider json;
+		Jwt engine {crypto, json};
+		ASSERT_EQ (engine.generateKeyPair ("k-json", JwtAlg::HS256).code, ErrorCode::Ok);
+
+		std::string token;
+		ASSERT_EQ (engine.token()
+		               .kid ("k-json")
+		               .issuer ("auth0")
+		               .subject ("user \"1\"")
+		               .claim ("scope", "read write")
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 60)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+
+		Verifier verifier;
+		ASSERT_EQ (engine.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (verifier.subject(), "user \"1\"");
+		EXPECT_EQ (verifier.claimView ("scope"), "read write");
+		EXPECT_EQ (verifier.rawHeaderJson().front(), '{');
+	}
+
+	TEST (JwtJsonProviderTest, ArrayAudienceMatchesAnyOfItsEntries)
+	{
+		FakeCryptoProvider crypto;
+		JwtJsonProvider json;
+		EngineOptions options;
+		options.policy.expectedAud = "api";
+		Jwt engine {crypto, json, options};
+		ASSERT_EQ (engine.generateKeyPair ("k-aud", JwtAlg::HS256).code, ErrorCode::Ok);
+
+		const auto issue = [&] (ClaimStrings audience)
+		{
+			std::string token;
+			EXPECT_EQ (engine.token()
+			               .kid ("k-aud")
+			               .audience (std::move (audience))
+			               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 60)
+			               .sign (token)
+			               .code,
+			           ErrorCode::Ok);
+			return token;
+		};
+
+		Verifier verifier;
+		ASSERT_EQ (engine.verify (issue ({"web", "api"}), verifier).code, ErrorCode::Ok);
+		EXPECT_FALSE (verifier.audience().has_value());    // Several audiences: read them with claim("aud")
+		EXPECT_EQ (std::get<ClaimStrings> (*verifier.claim ("aud")), (ClaimStrings {"web", "api"}));
+
+		ASSERT_EQ (engine.verify (issue ({"api"}), verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (verifier.audience(), "api");
+
+		EXPECT_EQ (engine.verify (issue ({"web", "admin"}), verifier).code, ErrorCode::InvalidAudience);
+		EXPECT_EQ (engine.verify (issue ({}), verifier).code, ErrorCode::InvalidAudience);
+	}
+
+}    // namespace ipb::http::jwt
@@ -3,9 +3,12 @@
 #include "Jwt.h"
 
 #include <algorithm>
+#include <atomic>
 #include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <unordered_set>
 
@@ -21,6 +24,13 @@ namespace ipb::http::jwt
 			int generateCalls    = 0;
 			std::string lastPrivatePath;
 			std::string lastPublicPath;
+			// Recorded by verify (atomics: the provider is used from several threads in some tests)
+			mutable std::atomic<const uint8_t *> lastVerifyData {nullptr};
+			mutable std::atomic<size_t> lastVerifySize {0};
+			mutable std::atomic<int> verifyCalls {0};
+			mutable std::atomic<int> verifyBatchCalls {0};
+			mutable std::atomic<int> resolveCalls {0};
+			std::atomic<int> loadJwkCalls {0};
 
 			void resetCounters ()
 			{
@@ -41,7 +51,7 @@ namespace ipb::http::jwt
 				{
 					return {.code = ErrorCode::IOError, .message = "private key path missing"};
 				}
-				keys_.insert (std::string (kid));
+				addKey (kid);
 				return {.code = ErrorCode::Ok, .message = {}};
 			}
 
@@ -53,7 +63,7 @@ namespace ipb::http::jwt
 				{
 					return {.code = ErrorCode::IOError, .message = "public key path missing"};
 				}
-				keys_.insert (std::string (kid));
+				addKey (kid);
 				return {.code = ErrorCode::Ok, .message = {}};
 			}
 
@@ -63,7 +73,7 @@ namespace ipb::http::jwt
 				{
 					return {.code = ErrorCode::CertificateNotFound, .message = "certificate path empty"};
 				}
-				keys_.insert (std::string (kid));
+				addKey (kid);
 				return {.code = ErrorCode::Ok, .message = {}};
 			}
 
@@ -71,7 +81,7 @@ namespace ipb::http::jwt
 			{
 				++savePrivateCalls;
 				lastPrivatePath = std::string (pemPath);
-				if (pemPath.empty() || keys_.find (std::string (kid)) == keys_.end())
+				if (pemPath.empty() || !hasKey (kid))
 				{
 					return {.code = ErrorCode::KeyNotFound, .message = "key not found"};
 				}
@@ -88,7 +98,7 @@ namespace ipb::http::jwt
 			{
 				++savePublicCalls;
 				lastPublicPath = std::string (pemPath);
-				if (pemPath.empty() || keys_.find (std::string (kid)) == keys_.end())
+				if (pemPath.empty() || !hasKey (kid))
 				{
 					return {.code = ErrorCode::KeyNotFound, .message = "key not found"};
 				}
@@ -104,20 +114,31 @@ namespace ipb::http::jwt
 			Error generateKeyPair (std::string_view kid, JwtAlg, std::string_view) override
 			{
 				++generateCalls;
-				keys_.insert (std::string (kid));
+				addKey (kid);
+				return {.code = ErrorCode::Ok, .message = {}};
+			}
+
+			Error loadPublicKeyFromJwk (std::string_view kid, std::string_view jwkJson, JwtUse) override
+			{
+				++loadJwkCalls;
+				if (jwkJson.empty())
+				{
+					return {.code = ErrorCode::CryptoError, .message = "empty jwk"};
+				}
+				addKey (kid);
 				return {.code = ErrorCode::Ok, .message = {}};
 			}
 
 			Error removeKey (std::string_view kid) override
 			{
-				keys_.erase (std::string (kid));
+				dropKey (kid);
 				return {.code = ErrorCode::Ok, .message = {}};
 			}
 
 			Error sign (JwtAlg alg, std::string_view kid, std::span<const uint8_t> data,
 			            ByteBuffer &outSignature) const override
 			{
-				if (keys_.find (std::string (kid)) == keys_.end())
+				if (!hasKey (kid))
 				{
 					return {.code = ErrorCode::KeyNotFound, .message = "missing kid"};
 				}
@@ -131,7 +152,10 @@ namespace ipb::http::jwt
 			Error verify (JwtAlg alg, std::string_view kid, std::span<const uint8_t> data,
 			              std::span<const uint8_t> signature) const override
 			{
-				if (keys_.find (std::string (kid)) == keys_.end())
+				lastVerifyData = data.data();
+				lastVerifySize = data.size();
+				++verifyCalls;
+				if (!hasKey (kid))
 				{
 					return {.code = ErrorCode::KeyNotFound, .message = "missing kid"};
 				}
@@ -152,6 +176,25 @@ namespace ipb::http::jwt
 				return {.code = ErrorCode::Ok, .message = {}};
 			}
 
+			// Unknown kids fail here, so the engine does not get a handle for them
+			Error resolveKey (std::string_view kid, JwtAlg alg, std::shared_ptr<const KeyHandle> &outKey) const override
+			{
+				++resolveCalls;
+				if (!hasKey (kid))
+				{
+					return {.code = ErrorCode::KeyNotFound, .message = "missing kid"};
+				}
+				outKey = std::make_shared<const KeyHandle> (std::string (kid), alg);
+				return {.code = ErrorCode::Ok, .message = {}};
+			}
+
+			void verifyBatch (const KeyHandle &key, std::span<const SignatureCheck> checks,
+			                  std::span<Error> outResults) const override
+			{
+				++verifyBatchCalls;
+				ICryptoProvider::verifyBatch (key, checks, outResults);
+			}
+
 			Error base64UrlEncode (std::span<const uint8_t> data, std::string &outText) const override
 			{
 				static constexpr char hex [] = "0123456789ABCDEF";
@@ -206,7 +249,26 @@ namespace ipb::http::jwt
 			}
 
 		private:
-			mutable std::unordered_set<std::string> keys_;
+			bool hasKey (std::string_view kid) const
+			{
+				std::shared_lock lock (keysMutex_);
+				return keys_.find (std::string (kid)) != keys_.end();
+			}
+
+			void addKey (std::string_view kid)
+			{
+				std::unique_lock lock (keysMutex_);
+				keys_.insert (std::string (kid));
+			}
+
+			void dropKey (std::string_view kid)
+			{
+				std::unique_lock lock (keysMutex_);
+				keys_.erase (std::string (kid));
+			}
+
+			mutable std::shared_mutex keysMutex_;
+			std::unordered_set<std::string> keys_;
 	};
 
 	class FakeJsonProvider final : public IJsonProvider
@@ -227,6 +289,29 @@ namespace ipb::http::jwt
 				return writeMap (claims, outJson);
 			}
 
+			// One "kid=jwk" pair per line
+			Error parseJwks (std::string_view text, std::vector<JwkEntry> &outKeys) const override
+			{
+				outKeys.clear();
+				while (!text.empty())
+				{
+					const size_t end            = text.find ('\n');
+					const std::string_view line = text.substr (0, end);
+					text = end == std::string_view::npos ? std::string_view {} : text.substr (end + 1);
+
+					const size_t eq = line.find ('=');
+					if (eq == std::string_view::npos)
+					{
+						return {.code = ErrorCode::InvalidJson, .message = "invalid jwks line"};
+					}
+					outKeys.push_back (JwkEntry {.kid  = std::string (line.substr (0, eq)),
+					                             .alg  = "HS256",
+					                             .use  = JwtUse::Sig,
+					                             .json = std::string (line.substr (eq + 1))});
+				}
+				return {.code = ErrorCode::Ok, .message = {}};
+			}
+
 		private:
 			template <typename TMap> static Error writeMap (const TMap &map, std::string &out)
 			{
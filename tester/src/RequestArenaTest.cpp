@@ -0,0 +1,163 @@
+﻿/*********************************************************************************************
+ *  Description : Unit tests for RequestArena (per-request memory)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+#include "Jwt.h"
+#include "JwtTestProviders.h"
+#include "RequestArena.h"
+#include "Route.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace ipb::http
+{
+	namespace
+	{
+		class ArenaCtx : public ICtx
+		{
+			public:
+				RequestArena arena;
+				std::pmr::vector<std::pmr::string> values {&arena};
+
+				void setParam (std::string_view, std::string_view value) override
+				{
+					values.emplace_back (value);
+				}
+
+				std::pmr::memory_resource &memory () noexcept override
+				{
+					return arena;
+				}
+		};
+	}    // namespace
+
+	TEST (RequestArenaTest, AllocationsInsideTheBlockDoNotUseTheHeap)
+	{
+		RequestArena arena;
+		std::pmr::vector<int> numbers (&arena);
+
+		testutil::AllocationCounter counter;
+		numbers.reserve (64);
+		std::pmr::string text ("a string long enough to skip the small string buffer", &arena);
+
+		EXPECT_EQ (counter.count(), 0u);
+		EXPECT_EQ (arena.overflowBytes(), 0u);
+	}
+
+	TEST (RequestArenaTest, ResetRewindsTheBlock)
+	{
+		RequestArena arena;
+
+		void *first  = arena.allocate (128, alignof (std::max_align_t));
+		void *second = arena.allocate (256, alignof (std::max_align_t));
+		ASSERT_NE (first, nullptr);
+		ASSERT_NE (second, nullptr);
+		EXPECT_GE (static_cast<char *> (second) - static_cast<char *> (first), 128);
+		EXPECT_EQ (reinterpret_cast<uintptr_t> (second) % alignof (std::max_align_t), 0u);
+		arena.reset();
+
+		EXPECT_EQ (arena.allocate (128, alignof (std::max_align_t)), first);
+	}
+
+	TEST (RequestArenaTest, BlockGrowsAfterOverflow)
+	{
+		RequestArena arena (1024);
+
+		void *overflow = arena.allocate (4096, alignof (std::max_align_t));
+		ASSERT_NE (overflow, nullptr);
+		EXPECT_EQ (reinterpret_cast<uintptr_t> (overflow) % alignof (std::max_align_t), 0u);
+		EXPECT_GT (arena.overflowBytes(), 0u);
+
+		arena.reset();
+		EXPECT_GE (arena.blockBytes(), 4096u);
+		EXPECT_EQ (arena.overflowBytes(), 0u);
+
+		// The same request now fits in the block
+		testutil::AllocationCounter counter;
+		void *inBlock = arena.allocate (4096, alignof (std::max_align_t));
+		EXPECT_EQ (counter.count(), 0u);
+		EXPECT_NE (inBlock, nullptr);
+		EXPECT_EQ (reinterpret_cast<uintptr_t> (inBlock) % alignof (std::max_align_t), 0u);
+		EXPECT_EQ (arena.overflowBytes(), 0u);
+	}
+
+	TEST (RequestArenaTest, BlockGrowthIsBounded)
+	{
+		RequestArena arena (RequestArena::kMaxBlockBytes);
+
+		void *large = arena.allocate (RequestArena::kMaxBlockBytes * 2, alignof (std::max_align_t));
+		ASSERT_NE (large, nullptr);
+		arena.reset();
+
+		EXPECT_EQ (arena.blockBytes(), RequestArena::kMaxBlockBytes);
+	}
+
+	TEST (RequestArenaTest, RouterCapturesCanLiveInTheContextArena)
+	{
+		Router router;
+		router.add (HttpMethod::GET, "/users/<id:int>/<name>", [] (ICtx &) {});
+		router.freeze();
+
+		ArenaCtx ctx;
+		testutil::AllocationCounter counter;
+		ASSERT_TRUE (router.match (HttpMethod::GET, "/users/42/a-rather-long-user-name-value", ctx).has_value());
+
+		EXPECT_EQ (counter.count(), 0u);
+		ASSERT_EQ (ctx.values.size(), 2u);
+		EXPECT_EQ (ctx.values [1], "a-rather-long-user-name-value");
+	}
+
+	TEST (RequestArenaTest, DefaultContextMemoryIsTheDefaultResource)
+	{
+		class PlainCtx : public ICtx
+		{
+			public:
+				void setParam (std::string_view, std::string_view) override {}
+		} ctx;
+
+		EXPECT_EQ (&ctx.memory(), std::pmr::get_default_resource());
+	}
+
+	TEST (RequestArenaTest, VerifierCopiesLiveInTheArena)
+	{
+		jwt::FakeCryptoProvider crypto;
+		jwt::FakeJsonProvider json;
+		jwt::Jwt engine {crypto, json};
+		ASSERT_EQ (engine.generateKeyPair ("k-arena", jwt::JwtAlg::HS256).code, jwt::ErrorCode::Ok);
+
+		std::string token;
+		ASSERT_EQ (engine.token()
+		               .kid ("k-arena")
+		               .subject ("user-with-a-long-subject-identifier")
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 60)
+		               .sign (token)
+		               .code,
+		           jwt::ErrorCode::Ok);
+
+		RequestArena arena;
+		jwt::Verifier verifier (arena);
+		ASSERT_EQ (engine.verify (token, verifier).code, jwt::ErrorCode::Ok);
+
+		EXPECT_EQ (verifier.rawToken(), token);
+		EXPECT_EQ (verifier.claimString ("sub"), "user-with-a-long-subject-identifier");
+
+		// Verifying again reuses the verifier (and its arena)
+		ASSERT_EQ (engine.verify (token, verifier).code, jwt::ErrorCode::Ok);
+		EXPECT_TRUE (verifier.ok());
+
+		// Copies do not depend on the arena
+		jwt::Verifier copy = verifier;
+		arena.reset();
+		EXPECT_EQ (copy.rawToken(), token);
+	}
+
+}    // namespace ipb::http
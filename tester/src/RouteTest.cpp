@@ -6,7 +6,17 @@
 
 #include <gtest/gtest.h>
 #include "Route.h"
+#include "AllocationCounter.h"
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 namespace ipb::http
@@ -47,6 +57,35 @@ namespace ipb::http
 			}
 	};
 
+	// Ctx that keeps parameter views in fixed storage (never allocates)
+	class FixedCtx : public ICtx
+	{
+		public:
+			std::array<std::pair<std::string_view, std::string_view>, 8> params_ {};
+			size_t count_ = 0;
+
+			void setParam (std::string_view name, std::string_view value) override
+			{
+				if (count_ < params_.size())
+				{
+					params_ [count_++] = {name, value};
+				}
+			}
+	};
+
+	// Ctx that keeps the decoded values of typed parameters
+	class TypedCtx : public MockCtx
+	{
+		public:
+			std::unordered_map<std::string, ParamValue> decoded_;
+
+			void setTypedParam (std::string_view name, std::string_view value, const ParamValue &decoded) override
+			{
+				setParam (name, value);
+				decoded_ [std::string (name)] = decoded;
+			}
+	};
+
 }    // namespace ipb::http
 
 using namespace ipb::http;
@@ -404,6 +443,14 @@ TEST_F (RouterTest, FromMethodString_InvalidDefaultsToGET)
 	EXPECT_EQ (Router::fromMethodString ("get"), HttpMethod::GET);    // Case sensitive
 }
 
+TEST_F (RouterTest, ParseMethod_InvalidIsNullopt)
+{
+	EXPECT_EQ (Router::parseMethod ("DELETE"), HttpMethod::DELETE_);
+	EXPECT_FALSE (Router::parseMethod ("INVALID").has_value());
+	EXPECT_FALSE (Router::parseMethod ("").has_value());
+	EXPECT_FALSE (Router::parseMethod ("get").has_value());    // Case sensitive
+}
+
 // ============================================================================
 // Router::addMiddleware() Tests
 // ============================================================================
@@ -684,3 +731,1045 @@ TEST_F (RouterTest, GlobalMiddlewareCanInterruptChain)
 	const std::vector<std::string> expected = {"g.block"};
 	EXPECT_EQ (calls, expected);
 }
+
+// ============================================================================
+// Router::freeze() Tests
+// ============================================================================
+
+TEST_F (RouterTest, FrozenRouterKeepsMatchingPriorities)
+{
+	router.add (HttpMethod::GET, "/users/<id:int>", dummyHandler);
+	router.add (HttpMethod::GET, "/users/<alias:string>", dummyHandler);
+	router.add (HttpMethod::GET, "/users/new", dummyHandler);
+	router.add (HttpMethod::ANY, "/users/<id:int>/posts", dummyHandler);
+	router.add (HttpMethod::POST, "/users/<id:int>/posts", dummyHandler);
+	router.freeze();
+
+	ASSERT_TRUE (router.isFrozen());
+
+	auto literal = router.match (HttpMethod::GET, "/users/new", ctx);
+	ASSERT_TRUE (literal.has_value());
+	EXPECT_EQ (literal.value().get().pattern, "/users/new");
+	EXPECT_TRUE (ctx.empty());
+
+	ctx.clear();
+	auto typed = router.match (HttpMethod::GET, "/users/42", ctx);
+	ASSERT_TRUE (typed.has_value());
+	EXPECT_EQ (typed.value().get().pattern, "/users/<id:int>");
+	EXPECT_EQ (ctx.get ("id").value(), "42");
+
+	ctx.clear();
+	auto fallback = router.match (HttpMethod::GET, "/users/john", ctx);
+	ASSERT_TRUE (fallback.has_value());
+	EXPECT_EQ (fallback.value().get().pattern, "/users/<alias:string>");
+	EXPECT_EQ (ctx.get ("alias").value(), "john");
+
+	ctx.clear();
+	auto any = router.match (HttpMethod::GET, "/users/42/posts/", ctx);
+	ASSERT_TRUE (any.has_value());
+	EXPECT_EQ (any.value().get().method, HttpMethod::ANY);
+
+	ctx.clear();
+	auto specific = router.match (HttpMethod::POST, "/users/42/posts", ctx);
+	ASSERT_TRUE (specific.has_value());
+	EXPECT_EQ (specific.value().get().method, HttpMethod::POST);
+
+	ctx.clear();
+	EXPECT_FALSE (router.match (HttpMethod::GET, "/users/42/comments", ctx).has_value());
+	EXPECT_FALSE (router.match (HttpMethod::GET, "/posts", ctx).has_value());
+}
+
+TEST_F (RouterTest, FrozenRouterMatchesRootPath)
+{
+	router.add (HttpMethod::GET, "/", dummyHandler);
+	router.freeze();
+
+	auto result = router.match (HttpMethod::GET, "/", ctx);
+
+	ASSERT_TRUE (result.has_value());
+	EXPECT_EQ (result.value().get().pattern, "/");
+}
+
+TEST_F (RouterTest, FrozenRouterMatchesCompressedLiteralChains)
+{
+	router.add (HttpMethod::GET, "/api/v2/tenants/<tid:uuid>/projects/settings/general", dummyHandler);
+	router.add (HttpMethod::GET, "/api/v2/tenants/<tid:uuid>/projects/settings/billing", dummyHandler);
+	router.add (HttpMethod::GET, "/api/v2/tenants/<tid:uuid>/projects/<name>/settings", dummyHandler);
+	router.add (HttpMethod::GET, "/api/v2/health/live", dummyHandler);
+	router.add (HttpMethod::GET, "/api/v2/health", dummyHandler);
+	router.freeze();
+
+	const std::string tenant = "/api/v2/tenants/550e8400-e29b-41d4-a716-446655440000/projects";
+	const std::pair<std::string, const char *> cases [] = {
+	    {tenant + "/settings/general",   "/api/v2/tenants/<tid:uuid>/projects/settings/general"},
+	    {tenant + "/settings/billing/",  "/api/v2/tenants/<tid:uuid>/projects/settings/billing"},
+	    {tenant + "/web/settings",       "/api/v2/tenants/<tid:uuid>/projects/<name>/settings"},
+	    {"/api/v2/health",                "/api/v2/health"                                     },
+	    {"/api/v2/health/live",           "/api/v2/health/live"                                },
+	    {"/api/v2/tenants",               nullptr                                               },
+	    {"/api/v2/tenantsX/x",            nullptr                                               },
+	    {"/api/v2//tenants",              nullptr                                               },
+	    {tenant + "/settings",            nullptr                                               },
+	    {tenant + "/settings/generalX",   nullptr                                               },
+	    {tenant + "/settings/general/x",  nullptr                                               },
+	    {"/api/v2/health/liveness",       nullptr                                               },
+	};
+
+	for (const auto &[path, pattern] : cases)
+	{
+		ctx.clear();
+		auto result = router.match (HttpMethod::GET, path, ctx);
+		ASSERT_EQ (result.has_value(), pattern != nullptr) << path;
+		if (pattern != nullptr)
+		{
+			EXPECT_EQ (result.value().get().pattern, pattern) << path;
+		}
+	}
+
+	// The literal edge wins even when only a parameter could complete the path (no backtracking)
+	ctx.clear();
+	EXPECT_FALSE (router.match (HttpMethod::GET, tenant + "/settings/other", ctx).has_value());
+}
+
+TEST_F (RouterTest, RoutesAddedAfterFreezeNeedNewFreeze)
+{
+	router.add (HttpMethod::GET, "/users", dummyHandler);
+	router.freeze();
+	router.add (HttpMethod::GET, "/posts", dummyHandler);
+
+	EXPECT_TRUE (router.match (HttpMethod::GET, "/users", ctx).has_value());
+	EXPECT_FALSE (router.match (HttpMethod::GET, "/posts", ctx).has_value());
+
+	router.freeze();
+	EXPECT_TRUE (router.match (HttpMethod::GET, "/posts", ctx).has_value());
+}
+
+TEST_F (RouterTest, FrozenRouterExecutesMiddlewareChain)
+{
+	std::vector<std::string> calls;
+
+	router.addMiddleware (
+	    [&] (ICtx &, IMiddlewareNext &next)
+	    {
+		    calls.push_back ("g1");
+		    next.next();
+	    });
+
+	auto &route = router.add (HttpMethod::GET, "/frozen",
+	                          [&] (ICtx &)
+	                          {
+		                          calls.push_back ("handler");
+	                          });
+
+	router.addMiddleware (route,
+	                      [&] (ICtx &, IMiddlewareNext &next)
+	                      {
+		                      calls.push_back ("r1");
+		                      next.next();
+	                      });
+	router.freeze();
+
+	auto result = router.match (HttpMethod::GET, "/frozen", ctx);
+	ASSERT_TRUE (result.has_value());
+
+	router.execute (result.value().get(), ctx);
+
+	const std::vector<std::string> expected = {"g1", "r1", "handler"};
+	EXPECT_EQ (calls, expected);
+}
+
+// ============================================================================
+// Router::publish() Tests - Atomic table swap
+// ============================================================================
+
+TEST_F (RouterTest, PublishServesStagedRoutes)
+{
+	router.add (HttpMethod::GET, "/old", dummyHandler);
+	router.freeze();
+
+	Router staged;
+	staged.add (HttpMethod::GET, "/new", dummyHandler);
+	router.publish (staged);
+
+	EXPECT_TRUE (router.isFrozen());
+	EXPECT_FALSE (router.match (HttpMethod::GET, "/old", ctx).has_value());
+	EXPECT_TRUE (router.match (HttpMethod::GET, "/new", ctx).has_value());
+
+	// The staged router keeps its own routes untouched
+	EXPECT_FALSE (staged.isFrozen());
+	EXPECT_TRUE (staged.match (HttpMethod::GET, "/new", ctx).has_value());
+}
+
+TEST_F (RouterTest, PublishWaitsForReadGuards)
+{
+	router.add (HttpMethod::GET, "/generation", dummyHandler);
+	router.freeze();
+
+	Router staged;
+	staged.add (HttpMethod::GET, "/generation", dummyHandler);
+
+	std::atomic<bool> published {false};
+	std::thread writer;
+	{
+		Router::ReadGuard guard (router);
+		auto result = router.match (HttpMethod::GET, "/generation", ctx);
+		ASSERT_TRUE (result.has_value());
+
+		writer = std::thread (
+		    [&]
+		    {
+			    router.publish (staged);
+			    published = true;
+		    });
+
+		std::this_thread::sleep_for (std::chrono::milliseconds (50));
+		EXPECT_FALSE (published.load());
+
+		// The old generation is still alive while the guard is held
+		EXPECT_EQ (result.value().get().pattern, "/generation");
+	}
+
+	writer.join();
+	EXPECT_TRUE (published.load());
+}
+
+TEST_F (RouterTest, ConcurrentReadersSeeCompleteGenerations)
+{
+	constexpr int kGenerations = 200;
+	constexpr int kReaders     = 4;
+
+	auto makeGeneration = [] (int generation)
+	{
+		auto staged = std::make_unique<Router>();
+		staged->add (HttpMethod::GET, "/feature/<id:int>",
+		             [generation] (ICtx &context)
+		             {
+			             static_cast<MockCtx &> (context).params_ ["generation"] = std::to_string (generation);
+		             });
+		if (generation % 2 == 0)
+		{
+			staged->add (HttpMethod::GET, "/even", dummyHandler);
+		}
+		return staged;
+	};
+
+	router.publish (*makeGeneration (0));
+
+	std::atomic<bool> stop {false};
+	std::atomic<int> failures {0};
+	std::vector<std::thread> readers;
+	for (int i = 0; i < kReaders; ++i)
+	{
+		readers.emplace_back (
+		    [&]
+		    {
+			    while (!stop.load())
+			    {
+				    MockCtx local;
+				    Router::ReadGuard guard (router);
+				    auto result = router.match (HttpMethod::GET, "/feature/42", local);
+				    if (!result.has_value())
+				    {
+					    ++failures;
+					    continue;
+				    }
+				    router.execute (result.value().get(), local);
+				    if (local.params_ ["id"] != "42" || local.params_ ["generation"].empty())
+				    {
+					    ++failures;
+				    }
+			    }
+		    });
+	}
+
+	for (int generation = 1; generation <= kGenerations; ++generation)
+	{
+		router.publish (*makeGeneration (generation));
+	}
+
+	stop = true;
+	for (auto &reader : readers)
+	{
+		reader.join();
+	}
+
+	EXPECT_EQ (failures.load(), 0);
+	EXPECT_TRUE (router.match (HttpMethod::GET, "/even", ctx).has_value());
+}
+
+TEST_F (RouterTest, FrozenPipelineStopsWhenNextIsNotCalled)
+{
+	bool handler_called = false;
+
+	router.addMiddleware ([] (ICtx &, IMiddlewareNext &) {});
+	router.add (HttpMethod::GET, "/blocked",
+	            [&] (ICtx &)
+	            {
+		            handler_called = true;
+	            });
+	router.freeze();
+
+	auto result = router.match (HttpMethod::GET, "/blocked", ctx);
+	ASSERT_TRUE (result.has_value());
+
+	router.execute (result.value().get(), ctx);
+	EXPECT_FALSE (handler_called);
+}
+
+TEST_F (RouterTest, FrozenPipelineRunsHandlerOnce)
+{
+	int handler_calls = 0;
+
+	router.addMiddleware (
+	    [] (ICtx &, IMiddlewareNext &next)
+	    {
+		    next.next();
+		    next.next();
+	    });
+	router.add (HttpMethod::GET, "/once",
+	            [&] (ICtx &)
+	            {
+		            ++handler_calls;
+	            });
+	router.freeze();
+
+	auto result = router.match (HttpMethod::GET, "/once", ctx);
+	ASSERT_TRUE (result.has_value());
+
+	router.execute (result.value().get(), ctx);
+	EXPECT_EQ (handler_calls, 1);
+}
+
+// ============================================================================
+// Route metrics
+// ============================================================================
+
+TEST (RouteMetricsTest, FormatsOpenMetrics)
+{
+	RouteMetricsSnapshot route {.pattern = "/say/\"hi\"", .method = "GET", .matches = 3, .invocations = 2,
+	                            .shortCircuits = 1, .matchNanoseconds = 1500, .latencyNanoseconds = 2'000'000'000};
+	route.latencyBuckets [0]      = 2;
+	route.latencyBuckets.back()   = 1;
+
+	const std::string text = toOpenMetrics ({&route, 1});
+	EXPECT_NE (text.find ("# TYPE happ_route_matches counter\n"), std::string::npos);
+	EXPECT_NE (text.find ("happ_route_matches_total{method=\"GET\",route=\"/say/\\\"hi\\\"\"} 3\n"), std::string::npos);
+	EXPECT_NE (text.find ("happ_route_short_circuits_total{method=\"GET\",route=\"/say/\\\"hi\\\"\"} 1\n"),
+	           std::string::npos);
+	EXPECT_NE (text.find ("happ_route_match_seconds_total{method=\"GET\",route=\"/say/\\\"hi\\\"\"} 1.5e-06\n"),
+	           std::string::npos);
+	EXPECT_NE (text.find ("le=\"0.00001\"} 2\n"), std::string::npos);
+	EXPECT_NE (text.find ("le=\"1\"} 2\n"), std::string::npos);
+	EXPECT_NE (text.find ("le=\"+Inf\"} 3\n"), std::string::npos);
+	EXPECT_NE (text.find ("happ_route_latency_seconds_count{method=\"GET\",route=\"/say/\\\"hi\\\"\"} 3\n"),
+	           std::string::npos);
+	EXPECT_NE (text.find ("happ_route_latency_seconds_sum{method=\"GET\",route=\"/say/\\\"hi\\\"\"} 2\n"),
+	           std::string::npos);
+	EXPECT_TRUE (text.ends_with ("# EOF\n"));
+}
+
+#if defined(HAPP_ROUTE_METRICS)
+TEST_F (RouterTest, MetricsCountHitsInvocationsAndShortCircuits)
+{
+	router.addMiddleware (
+	    [] (ICtx &ctx, IMiddlewareNext &next)
+	    {
+		    if (static_cast<MockCtx &> (ctx).get ("id") != "0")
+		    {
+			    next.next();
+		    }
+	    });
+	router.add (HttpMethod::GET, "/users/<id:int>", dummyHandler);
+	router.add (HttpMethod::POST, "/users", dummyHandler);
+
+	// Counted before and after freeze: the compiled copies share the counters of the registered route
+	for (const char *path : {"/users/1", "/users/0"})
+	{
+		ctx.clear();
+		router.execute (router.match (HttpMethod::GET, path, ctx)->get(), ctx);
+	}
+	router.freeze();
+	for (const char *path : {"/users/2", "/users/0", "/users/x"})
+	{
+		ctx.clear();
+		if (auto route = router.match (HttpMethod::GET, path, ctx))
+		{
+			router.execute (route->get(), ctx);
+		}
+	}
+
+	const auto metrics = router.metrics();
+	ASSERT_EQ (metrics.size(), 2u);
+	EXPECT_EQ (metrics [0].pattern, "/users");
+	EXPECT_EQ (metrics [0].method, "POST");
+	EXPECT_EQ (metrics [0].matches, 0u);
+
+	const RouteMetricsSnapshot &users = metrics [1];
+	EXPECT_EQ (users.pattern, "/users/<id:int>");
+	EXPECT_EQ (users.method, "GET");
+	EXPECT_EQ (users.matches, 4u);
+	EXPECT_EQ (users.invocations, 2u);
+	EXPECT_EQ (users.shortCircuits, 2u);
+	uint64_t executions = 0;
+	for (uint64_t bucket : users.latencyBuckets)
+	{
+		executions += bucket;
+	}
+	EXPECT_EQ (executions, 4u);
+}
+
+TEST_F (RouterTest, MetricsCanBeReadWhileServing)
+{
+	router.add (HttpMethod::GET, "/hot", dummyHandler);
+	router.freeze();
+
+	std::atomic<bool> stop {false};
+	std::vector<std::thread> workers;
+	for (int i = 0; i < 4; ++i)
+	{
+		workers.emplace_back (
+		    [&]
+		    {
+			    MockCtx local;
+			    for (int n = 0; n < 1000; ++n)
+			    {
+				    Router::ReadGuard guard (router);
+				    router.execute (router.match (HttpMethod::GET, "/hot", local)->get(), local);
+			    }
+		    });
+	}
+	while (router.metrics() [0].matches < 1000)
+	{
+		std::this_thread::yield();
+	}
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+
+	const auto metrics = router.metrics();
+	EXPECT_EQ (metrics [0].matches, 4000u);
+	EXPECT_EQ (metrics [0].invocations, 4000u);
+}
+#else
+TEST_F (RouterTest, MetricsAreEmptyWhenCompiledOut)
+{
+	router.add (HttpMethod::GET, "/users", dummyHandler);
+	router.freeze();
+	EXPECT_TRUE (router.metrics().empty());
+}
+#endif
+
+namespace
+{
+	std::vector<std::string> g_static_calls;
+
+	struct FirstMiddleware
+	{
+			void operator() (ICtx &, IMiddlewareNext &next) const
+			{
+				g_static_calls.push_back ("first");
+				next.next();
+				g_static_calls.push_back ("first-after");
+			}
+	};
+
+	struct SecondMiddleware
+	{
+			void operator() (ICtx &, IMiddlewareNext &next) const
+			{
+				g_static_calls.push_back ("second");
+				next.next();
+				next.next();    // Ignored: each step forwards once
+			}
+	};
+}    // namespace
+
+TEST_F (RouterTest, StaticMiddlewareChainRunsInOrder)
+{
+	g_static_calls.clear();
+
+	router.use<FirstMiddleware, SecondMiddleware>();
+	auto &route = router.add (HttpMethod::GET, "/static",
+	                          [] (ICtx &)
+	                          {
+		                          g_static_calls.push_back ("handler");
+	                          });
+	router.use (route,
+	            [] (ICtx &, IMiddlewareNext &next)
+	            {
+		            g_static_calls.push_back ("route");
+		            next.next();
+	            });
+
+	for (bool frozen : {false, true})
+	{
+		SCOPED_TRACE (frozen ? "frozen" : "trie");
+		g_static_calls.clear();
+		if (frozen)
+		{
+			router.freeze();
+		}
+
+		auto result = router.match (HttpMethod::GET, "/static", ctx);
+		ASSERT_TRUE (result.has_value());
+		router.execute (result.value().get(), ctx);
+
+		const std::vector<std::string> expected = {"first", "second", "route", "handler", "first-after"};
+		EXPECT_EQ (g_static_calls, expected);
+	}
+}
+
+TEST_F (RouterTest, StaticMiddlewareChainCanInterrupt)
+{
+	std::vector<std::string> calls;
+	bool handler_called = false;
+
+	router.use (
+	    [&] (ICtx &, IMiddlewareNext &next)
+	    {
+		    calls.push_back ("auth");
+		    next.next();
+	    },
+	    [&] (ICtx &, IMiddlewareNext &)
+	    {
+		    calls.push_back ("deny");
+	    },
+	    [&] (ICtx &, IMiddlewareNext &next)
+	    {
+		    calls.push_back ("unreachable");
+		    next.next();
+	    });
+	router.add (HttpMethod::GET, "/denied",
+	            [&] (ICtx &)
+	            {
+		            handler_called = true;
+	            });
+	router.freeze();
+
+	auto result = router.match (HttpMethod::GET, "/denied", ctx);
+	ASSERT_TRUE (result.has_value());
+	router.execute (result.value().get(), ctx);
+
+	const std::vector<std::string> expected = {"auth", "deny"};
+	EXPECT_EQ (calls, expected);
+	EXPECT_FALSE (handler_called);
+}
+
+// ============================================================================
+// Router::match() Tests - Decoded typed parameters
+// ============================================================================
+
+TEST_F (RouterTest, TypedParametersAreDecodedDuringMatch)
+{
+	router.add (HttpMethod::GET, "/users/<id:int>/resources/<rid:uuid>/tokens/<tid:base64id>/values/<amount:float>/<name>",
+	            dummyHandler);
+
+	for (bool frozen : {false, true})
+	{
+		if (frozen)
+		{
+			router.freeze();
+		}
+
+		TypedCtx typed;
+		auto result = router.match (HttpMethod::GET,
+		                            "/users/-42/resources/550E8400-e29b-41d4-a716-446655440000/tokens/"
+		                            "VQ6EAOKbQdSnFkRmVUQAAA/values/+123.5/john",
+		                            typed);
+		ASSERT_TRUE (result.has_value());
+
+		EXPECT_EQ (std::get<int64_t> (typed.decoded_.at ("id")), -42);
+		EXPECT_DOUBLE_EQ (std::get<double> (typed.decoded_.at ("amount")), 123.5);
+		EXPECT_TRUE (std::holds_alternative<std::monostate> (typed.decoded_.at ("name")));
+		EXPECT_EQ (typed.get ("name").value(), "john");
+
+		const Uuid expected = {0x55, 0x0e, 0x84, 0x00, 0xe2, 0x9b, 0x41, 0xd4,
+		                       0xa7, 0x16, 0x44, 0x66, 0x55, 0x44, 0x00, 0x00};
+		EXPECT_EQ (std::get<Uuid> (typed.decoded_.at ("rid")), expected);
+		// Same UUID, Base64URL encoded
+		EXPECT_EQ (std::get<Uuid> (typed.decoded_.at ("tid")), expected);
+	}
+}
+
+TEST_F (RouterTest, PathParameterCapturesTheRestOfThePath)
+{
+	router.add (HttpMethod::GET, "/static/<file:path>", dummyHandler);
+	router.add (HttpMethod::GET, "/files/<id:int>", dummyHandler);
+	router.add (HttpMethod::GET, "/files/<rest:path>", dummyHandler);
+	router.add (HttpMethod::GET, "/files/index", dummyHandler);
+
+	for (bool frozen : {false, true})
+	{
+		if (frozen)
+		{
+			router.freeze();
+		}
+
+		const std::string path = "/static/css/themes/dark.css/";
+		FixedCtx views;
+		auto result = router.match (HttpMethod::GET, path, views);
+		ASSERT_TRUE (result.has_value());
+		EXPECT_EQ (result.value().get().pattern, "/static/<file:path>");
+		ASSERT_EQ (views.count_, 1u);
+		EXPECT_EQ (views.params_ [0].first, "file");
+		EXPECT_EQ (views.params_ [0].second, "css/themes/dark.css");
+		EXPECT_EQ (views.params_ [0].second.data(), path.data() + 8);    // Zero-copy view into the path
+
+		ctx.clear();
+		EXPECT_EQ (router.match (HttpMethod::GET, "/static/a//b", ctx).value().get().pattern, "/static/<file:path>");
+		EXPECT_EQ (ctx.get ("file").value(), "a//b");
+		EXPECT_FALSE (router.match (HttpMethod::GET, "/static", ctx).has_value());
+		EXPECT_FALSE (router.match (HttpMethod::GET, "/static/", ctx).has_value());
+
+		// Literals and the other parameter types are tried first, segment by segment
+		ctx.clear();
+		EXPECT_EQ (router.match (HttpMethod::GET, "/files/index", ctx).value().get().pattern, "/files/index");
+		EXPECT_EQ (router.match (HttpMethod::GET, "/files/12", ctx).value().get().pattern, "/files/<id:int>");
+		EXPECT_FALSE (router.match (HttpMethod::GET, "/files/12/raw", ctx).has_value());
+		EXPECT_EQ (router.match (HttpMethod::GET, "/files/docs/12", ctx).value().get().pattern, "/files/<rest:path>");
+		EXPECT_EQ (ctx.get ("rest").value(), "docs/12");
+	}
+}
+
+TEST_F (RouterTest, PathParameterMustBeTheLastSegment)
+{
+	// The capture would take the rest of the path, so the route could never match
+	EXPECT_THROW (router.add (HttpMethod::GET, "/a/<p:path>/b", dummyHandler), std::invalid_argument);
+	EXPECT_THROW (router.add (HttpMethod::GET, "/<p:path>/<id:int>", dummyHandler), std::invalid_argument);
+
+	router.add (HttpMethod::GET, "/a/<p:path>", dummyHandler);
+	router.freeze();
+	EXPECT_EQ (router.match (HttpMethod::GET, "/a/x/b", ctx).value().get().pattern, "/a/<p:path>");
+	EXPECT_FALSE (router.match (HttpMethod::GET, "/7", ctx).has_value());
+}
+
+TEST_F (RouterTest, IntParameterOutOfRangeMatchesWithoutDecodedValue)
+{
+	router.add (HttpMethod::GET, "/n/<id:int>", dummyHandler);
+
+	TypedCtx min_ctx;
+	ASSERT_TRUE (router.match (HttpMethod::GET, "/n/-9223372036854775808", min_ctx).has_value());
+	EXPECT_EQ (std::get<int64_t> (min_ctx.decoded_.at ("id")), INT64_MIN);
+
+	TypedCtx max_ctx;
+	ASSERT_TRUE (router.match (HttpMethod::GET, "/n/9223372036854775807", max_ctx).has_value());
+	EXPECT_EQ (std::get<int64_t> (max_ctx.decoded_.at ("id")), INT64_MAX);
+
+	TypedCtx overflow_ctx;
+	ASSERT_TRUE (router.match (HttpMethod::GET, "/n/9223372036854775808", overflow_ctx).has_value());
+	EXPECT_TRUE (std::holds_alternative<std::monostate> (overflow_ctx.decoded_.at ("id")));
+	EXPECT_EQ (overflow_ctx.get ("id").value(), "9223372036854775808");
+}
+
+// ============================================================================
+// Router::match() Tests - Allocations
+// ============================================================================
+
+TEST_F (RouterTest, MatchDoesNotAllocate)
+{
+	router.add (HttpMethod::GET, "/api/v1/users/<id:int>/posts/<slug:string>", dummyHandler);
+	router.add (HttpMethod::GET, "/api/v1/users/new", dummyHandler);
+	router.add (HttpMethod::ANY, "/api/v1/resources/<id:uuid>", dummyHandler);
+	router.add (HttpMethod::GET, "/api/v1/tokens/<id:base64id>/<rest>", dummyHandler);
+
+	auto matchAll = [this] ()
+	{
+		FixedCtx fixed;
+		size_t hits = 0;
+		hits += router.match (HttpMethod::GET, "/api/v1/users/42/posts/my-article/", fixed).has_value();
+		hits += router.match (HttpMethod::GET, "/api/v1/users/new", fixed).has_value();
+		hits += router.match (HttpMethod::PUT, "/api/v1/resources/550e8400-e29b-41d4-a716-446655440000", fixed)
+		            .has_value();
+		hits += router.match (HttpMethod::GET, "/api/v1/tokens/AbCdEfGhIjKlMnOpQrStUv/x", fixed).has_value();
+		hits += router.match (HttpMethod::GET, "/api/v1/users/john/posts/x", fixed).has_value();
+		hits += router.match (HttpMethod::GET, "/missing/path/with/many/segments", fixed).has_value();
+		return hits;
+	};
+
+	{
+		testutil::AllocationCounter counter;
+		EXPECT_EQ (matchAll(), 4);
+		EXPECT_EQ (counter.count(), 0);
+	}
+
+	router.freeze();
+
+	{
+		testutil::AllocationCounter counter;
+		EXPECT_EQ (matchAll(), 4);
+		EXPECT_EQ (counter.count(), 0);
+	}
+}
+
+// ============================================================================
+// Route table images
+// ============================================================================
+
+namespace
+{
+	// Routes of every edge kind (compressed literal chains, typed and generic parameters, path tail, ANY)
+	constexpr std::array<std::pair<HttpMethod, const char *>, 8> kImageRoutes = {{
+	    {HttpMethod::GET, "/api/v1/users/<id:int>"},
+	    {HttpMethod::POST, "/api/v1/users"},
+	    {HttpMethod::GET, "/api/v1/users/new"},
+	    {HttpMethod::ANY, "/api/v1/resources/<id:uuid>"},
+	    {HttpMethod::GET, "/api/v1/tokens/<id:base64id>/<rest>"},
+	    {HttpMethod::GET, "/files/<file:path>"},
+	    {HttpMethod::GET, "/prices/<amount:float>"},
+	    {HttpMethod::GET, "/"},
+	}};
+
+	// Handlers by route ID that record the ID of the route they serve
+	std::vector<RouteHandler> recordingHandlers (size_t count, int &served)
+	{
+		std::vector<RouteHandler> handlers;
+		for (size_t id = 0; id < count; ++id)
+		{
+			handlers.push_back ([&served, id] (ICtx &) { served = static_cast<int> (id); });
+		}
+		return handlers;
+	}
+
+	// ID of the route that serves the request (-1 if none), with its parameters in `ctx`
+	int serve (const Router &router, HttpMethod method, std::string_view path, MockCtx &ctx, int &served)
+	{
+		ctx.clear();
+		served     = -1;
+		auto route = router.match (method, path, ctx);
+		if (route.has_value())
+		{
+			router.execute (route->get(), ctx);
+		}
+		return served;
+	}
+}    // namespace
+
+TEST_F (RouterTest, ImageServesTheSameRoutesByRouteId)
+{
+	int served = -1;
+	const auto handlers = recordingHandlers (kImageRoutes.size(), served);
+	for (size_t id = 0; id < kImageRoutes.size(); ++id)
+	{
+		EXPECT_EQ (router.add (kImageRoutes [id].first, kImageRoutes [id].second, handlers [id]).id, id);
+	}
+	EXPECT_TRUE (router.image().empty());    // Not frozen yet
+	router.freeze();
+	const std::string image = router.image();
+	ASSERT_FALSE (image.empty());
+
+	Router loaded;
+	ASSERT_TRUE (loaded.loadImageBytes (image, handlers));
+	EXPECT_TRUE (loaded.isFrozen());
+
+	const std::array<std::pair<HttpMethod, const char *>, 11> requests = {{
+	    {HttpMethod::GET, "/api/v1/users/42"},
+	    {HttpMethod::POST, "/api/v1/users/"},
+	    {HttpMethod::GET, "/api/v1/users/new"},
+	    {HttpMethod::DELETE_, "/api/v1/resources/550e8400-e29b-41d4-a716-446655440000"},
+	    {HttpMethod::GET, "/api/v1/tokens/AbCdEfGhIjKlMnOpQrStUv/x"},
+	    {HttpMethod::GET, "/files/css/site.css"},
+	    {HttpMethod::GET, "/prices/9.5"},
+	    {HttpMethod::GET, "/"},
+	    {HttpMethod::GET, "/api/v1/users/john"},
+	    {HttpMethod::PUT, "/api/v1/users"},
+	    {HttpMethod::GET, "/api/v2/users"},
+	}};
+	MockCtx loadedCtx;
+	for (const auto &[method, path] : requests)
+	{
+		const int expected = serve (router, method, path, ctx, served);
+		EXPECT_EQ (serve (loaded, method, path, loadedCtx, served), expected) << path;
+		EXPECT_EQ (loadedCtx.params_, ctx.params_) << path;
+	}
+	EXPECT_EQ (serve (loaded, HttpMethod::GET, "/files/css/site.css", loadedCtx, served), 5);
+	EXPECT_EQ (loadedCtx.get ("file").value(), "css/site.css");
+
+	// The patterns and IDs come from the image, and saving it again gives the same bytes
+	auto route = loaded.match (HttpMethod::GET, "/api/v1/users/7", loadedCtx);
+	ASSERT_TRUE (route.has_value());
+	EXPECT_EQ (route->get().pattern, "/api/v1/users/<id:int>");
+	EXPECT_EQ (route->get().id, 0u);
+	EXPECT_EQ (loaded.image(), image);
+}
+
+TEST_F (RouterTest, ImageFileIsMappedAndKeptByFreeze)
+{
+	int served = -1;
+	const auto handlers = recordingHandlers (kImageRoutes.size(), served);
+	for (size_t id = 0; id < kImageRoutes.size(); ++id)
+	{
+		router.add (kImageRoutes [id].first, kImageRoutes [id].second, handlers [id]);
+	}
+	const std::filesystem::path file = std::filesystem::temp_directory_path() / "happ_route_image_test.bin";
+	EXPECT_FALSE (router.saveImage (file));    // Not frozen yet
+	router.freeze();
+	ASSERT_TRUE (router.saveImage (file));
+
+	Router loaded;
+	ASSERT_TRUE (loaded.loadImage (file, handlers));
+	std::filesystem::remove (file);    // The mapping outlives the name (POSIX)
+
+	// Global middlewares added after the load are composed in by freeze (no Trie to rebuild)
+	int middleware_calls = 0;
+	loaded.addMiddleware (
+	    [&middleware_calls] (ICtx &, IMiddlewareNext &next)
+	    {
+		    ++middleware_calls;
+		    next.next();
+	    });
+	loaded.freeze();
+	MockCtx loadedCtx;
+	EXPECT_EQ (serve (loaded, HttpMethod::GET, "/prices/9.5", loadedCtx, served), 6);
+	EXPECT_EQ (middleware_calls, 1);
+
+	// Routes added after the load replace the image on the next freeze
+	loaded.add (HttpMethod::GET, "/health", handlers [0]);
+	loaded.freeze();
+	EXPECT_EQ (serve (loaded, HttpMethod::GET, "/health", loadedCtx, served), 0);
+	EXPECT_EQ (serve (loaded, HttpMethod::GET, "/prices/9.5", loadedCtx, served), -1);
+}
+
+TEST_F (RouterTest, InvalidImagesAreRejected)
+{
+	int served = -1;
+	const auto handlers = recordingHandlers (kImageRoutes.size(), served);
+	for (size_t id = 0; id < kImageRoutes.size(); ++id)
+	{
+		router.add (kImageRoutes [id].first, kImageRoutes [id].second, handlers [id]);
+	}
+	router.freeze();
+	const std::string image = router.image();
+
+	Router loaded;
+	loaded.add (HttpMethod::GET, "/previous", handlers [0]);
+	loaded.freeze();
+
+	std::string badMagic = image;
+	badMagic [0]         = 'X';
+	std::string badIndex = image;
+	// First literal edge: its child index (the last field) points past the nodes
+	const uint32_t nodeCount = *reinterpret_cast<const uint32_t *> (image.data() + 20);
+	const size_t literals    = 48 + ((nodeCount * 24 + 7) & ~size_t {7});
+	const uint32_t outside   = 0xFFFFFF;
+	std::memcpy (badIndex.data() + literals + 12, &outside, sizeof (outside));
+
+	EXPECT_FALSE (loaded.loadImageBytes ({}, handlers));
+	EXPECT_FALSE (loaded.loadImageBytes (std::string_view (image).substr (0, image.size() - 8), handlers));
+	EXPECT_FALSE (loaded.loadImageBytes (badMagic, handlers));
+	EXPECT_FALSE (loaded.loadImageBytes (badIndex, handlers));
+	EXPECT_FALSE (loaded.loadImageBytes (image, std::span (handlers).first (3)));    // Missing handlers
+	EXPECT_FALSE (loaded.loadImage (std::filesystem::temp_directory_path() / "happ_missing_image.bin", handlers));
+
+	// The served table is untouched
+	MockCtx loadedCtx;
+	EXPECT_EQ (serve (loaded, HttpMethod::GET, "/previous", loadedCtx, served), 0);
+	EXPECT_EQ (serve (loaded, HttpMethod::GET, "/prices/9.5", loadedCtx, served), -1);
+}
+
+// ============================================================================
+// Typed parameter validators - Differential fuzzing
+// ============================================================================
+
+namespace
+{
+	// Reference validators: the original per-character implementations ("C" locale)
+	bool referenceUuid (std::string_view value)
+	{
+		if (value.size() != 36)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < value.size(); ++i)
+		{
+			const char c = value [i];
+			if (i == 8 || i == 13 || i == 18 || i == 23)
+			{
+				if (c != '-')
+				{
+					return false;
+				}
+			}
+			else if (!std::isxdigit (static_cast<unsigned char> (c)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool referenceBase64Id (std::string_view value)
+	{
+		if (value.size() != 22 && value.size() != 24)
+		{
+			return false;
+		}
+		size_t payload_len = value.size();
+		if (value.size() == 24)
+		{
+			if (value [22] != '=' || value [23] != '=')
+			{
+				return false;
+			}
+			payload_len = 22;
+		}
+		for (size_t i = 0; i < payload_len; ++i)
+		{
+			const unsigned char c = static_cast<unsigned char> (value [i]);
+			if (std::isalnum (c) == 0 && c != '-' && c != '_')
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool referenceInt (std::string_view value)
+	{
+		if (value.empty())
+		{
+			return false;
+		}
+		size_t start = (value [0] == '-' || value [0] == '+') ? 1 : 0;
+		if (start >= value.size())
+		{
+			return false;
+		}
+		for (size_t i = start; i < value.size(); ++i)
+		{
+			if (!std::isdigit (static_cast<unsigned char> (value [i])))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool referenceFloat (std::string_view value)
+	{
+		if (value.empty())
+		{
+			return false;
+		}
+		size_t i = (value [0] == '-' || value [0] == '+') ? 1 : 0;
+		if (i >= value.size())
+		{
+			return false;
+		}
+		bool has_digit = false;
+		bool has_dot   = false;
+		for (; i < value.size(); ++i)
+		{
+			const char c = value [i];
+			if (std::isdigit (static_cast<unsigned char> (c)))
+			{
+				has_digit = true;
+			}
+			else if (c == '.' && !has_dot)
+			{
+				has_dot = true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return has_digit;
+	}
+
+	// Produces segments close to a valid seed: random byte substitutions, truncations and extensions.
+	// '/' is never produced, so each candidate stays a single path segment.
+	class SegmentFuzzer
+	{
+		public:
+			explicit SegmentFuzzer (uint32_t seed)
+			    : rng_ (seed)
+			{
+			}
+
+			std::string mutate (std::string_view seed)
+			{
+				std::string value (seed);
+				const int edits = static_cast<int> (rng_() % 4);
+				for (int e = 0; e < edits; ++e)
+				{
+					switch (rng_() % 4)
+					{
+					case 0:
+					case 1:
+						if (!value.empty())
+						{
+							value [rng_() % value.size()] = randomChar();
+						}
+						break;
+					case 2:
+						if (!value.empty())
+						{
+							value.erase (rng_() % value.size(), 1);
+						}
+						break;
+					default: value.insert (value.begin() + (rng_() % (value.size() + 1)), randomChar()); break;
+					}
+				}
+				return value.empty() ? std::string (1, randomChar()) : value;
+			}
+
+		private:
+			char randomChar ()
+			{
+				// Bias towards the characters the validators care about
+				static constexpr std::string_view interesting = "0123456789abcdefABCDEFgzGZ-_=.+ \x7f\x80\xff";
+				if (rng_() % 2 == 0)
+				{
+					return interesting [rng_() % interesting.size()];
+				}
+				char c = '/';
+				while (c == '/' || c == '\0')
+				{
+					c = static_cast<char> (rng_() % 256);
+				}
+				return c;
+			}
+
+			std::mt19937 rng_;
+	};
+
+	void expectSameAcceptance (std::string_view pattern, std::string_view prefix,
+	                           const std::vector<std::string_view> &seeds, bool (*reference) (std::string_view))
+	{
+		Router router;
+		router.add (HttpMethod::GET, pattern, [] (ICtx &) {});
+
+		SegmentFuzzer fuzzer (12345);
+		for (int i = 0; i < 50000; ++i)
+		{
+			const std::string candidate = fuzzer.mutate (seeds [static_cast<size_t> (i) % seeds.size()]);
+			FixedCtx ctx;
+			const bool matched = router.match (HttpMethod::GET, std::string (prefix) + candidate, ctx).has_value();
+			ASSERT_EQ (matched, reference (candidate)) << "segment: " << ::testing::PrintToString (candidate);
+		}
+	}
+}    // namespace
+
+TEST (RouteValidatorsFuzz, UuidMatchesReference)
+{
+	expectSameAcceptance ("/r/<id:uuid>", "/r/",
+	                      {"550e8400-e29b-41d4-a716-446655440000", "ABCDEF01-2345-6789-abcd-ef0123456789"},
+	                      referenceUuid);
+}
+
+TEST (RouteValidatorsFuzz, Base64IdMatchesReference)
+{
+	expectSameAcceptance ("/r/<id:base64id>", "/r/", {"AbCdEfGhIjKlMnOpQrStUv", "Zz09-_xyXY12ab-_cdAB==", "AAAA"},
+	                      referenceBase64Id);
+}
+
+TEST (RouteValidatorsFuzz, IntMatchesReference)
+{
+	expectSameAcceptance ("/r/<id:int>", "/r/", {"12345", "-42", "+7", "0"}, referenceInt);
+}
+
+TEST (RouteValidatorsFuzz, FloatMatchesReference)
+{
+	expectSameAcceptance ("/r/<v:float>", "/r/", {"123.45", "-0.5", "+.5", "7."}, referenceFloat);
+}
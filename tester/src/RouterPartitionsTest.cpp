@@ -0,0 +1,155 @@
+/*********************************************************************************************
+ *  Description : Unit tests for the per-host / per-version router partitions
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+#include "Route.h"
+#include "RouterPartitions.h"
+
+#include <string>
+#include <vector>
+
+namespace ipb::http
+{
+	namespace
+	{
+		class NullCtx : public ICtx
+		{
+			public:
+				void setParam (std::string_view, std::string_view) override
+				{
+				}
+		};
+
+		RouteHandler record (std::vector<std::string> &calls, std::string name)
+		{
+			return [&calls, name = std::move (name)] (ICtx &)
+			{
+				calls.push_back (name);
+			};
+		}
+
+		// Match and run `path` on the router selected for the request
+		bool serve (const RouterPartitions &partitions, std::string_view host, std::string_view path)
+		{
+			const Router *router = partitions.select (host, path);
+			if (router == nullptr)
+			{
+				return false;
+			}
+
+			NullCtx context;
+			auto result = router->match (HttpMethod::GET, path, context);
+			if (!result.has_value())
+			{
+				return false;
+			}
+			router->execute (result.value().get(), context);
+			return true;
+		}
+	}    // namespace
+
+	TEST (RouterPartitionsTest, KeyOfStripsPortsAndTakesTheFirstSegment)
+	{
+		EXPECT_EQ (RouterPartitions::keyOf (PartitionKey::HOST, "api.example.com:8443", "/x"), "api.example.com");
+		EXPECT_EQ (RouterPartitions::keyOf (PartitionKey::HOST, "api.example.com.", "/x"), "api.example.com");
+		EXPECT_EQ (RouterPartitions::keyOf (PartitionKey::HOST, "[::1]:8080", "/x"), "[::1]");
+		EXPECT_EQ (RouterPartitions::keyOf (PartitionKey::PATH_PREFIX, "h", "/v2/users/7"), "v2");
+		EXPECT_EQ (RouterPartitions::keyOf (PartitionKey::PATH_PREFIX, "h", "/v2"), "v2");
+		EXPECT_EQ (RouterPartitions::keyOf (PartitionKey::PATH_PREFIX, "h", "/"), "");
+	}
+
+	TEST (RouterPartitionsTest, HostsSelectTheirOwnRouter)
+	{
+		std::vector<std::string> calls;
+		RouterPartitions partitions;
+		partitions.partition ("a.example.com").add (HttpMethod::GET, "/users", record (calls, "a"));
+		partitions.partition ("B.example.com:80").add (HttpMethod::GET, "/users", record (calls, "b"));
+		partitions.freeze();
+
+		EXPECT_EQ (partitions.size(), 2u);
+		EXPECT_TRUE (serve (partitions, "a.example.com", "/users"));
+		EXPECT_TRUE (serve (partitions, "b.EXAMPLE.com:8080", "/users"));
+		EXPECT_FALSE (serve (partitions, "c.example.com", "/users"));
+		EXPECT_EQ (calls, (std::vector<std::string> {"a", "b"}));
+
+		EXPECT_EQ (partitions.find ("A.Example.Com"), partitions.select ("a.example.com", {}));
+		EXPECT_EQ (partitions.find ("c.example.com"), nullptr);
+	}
+
+	TEST (RouterPartitionsTest, GlobalMiddlewaresStayInTheirPartition)
+	{
+		std::vector<std::string> calls;
+		RouterPartitions partitions (PartitionKey::PATH_PREFIX);
+
+		Router &v1 = partitions.partition ("v1");
+		v1.addMiddleware (
+		    [&calls] (ICtx &, IMiddlewareNext &next)
+		    {
+			    calls.push_back ("v1 middleware");
+			    next.next();
+		    });
+		v1.add (HttpMethod::GET, "/v1/users", record (calls, "v1"));
+		partitions.partition ("v2").add (HttpMethod::GET, "/v2/users", record (calls, "v2"));
+		partitions.freeze();
+
+		EXPECT_TRUE (serve (partitions, {}, "/v2/users"));
+		EXPECT_TRUE (serve (partitions, {}, "/v1/users"));
+		EXPECT_FALSE (serve (partitions, {}, "/V1/users"));
+		EXPECT_EQ (calls, (std::vector<std::string> {"v2", "v1 middleware", "v1"}));
+	}
+
+	TEST (RouterPartitionsTest, PathPrefixNamesMayStartWithASlash)
+	{
+		std::vector<std::string> calls;
+		RouterPartitions partitions (PartitionKey::PATH_PREFIX);
+		partitions.partition ("/v2").add (HttpMethod::GET, "/v2/users", record (calls, "v2"));
+		partitions.freeze();
+
+		EXPECT_EQ (&partitions.partition ("v2"), &partitions.partition ("/v2"));
+		EXPECT_EQ (partitions.size(), 1u);
+		EXPECT_NE (partitions.select ("h", "/v2/users"), nullptr);
+		EXPECT_EQ (partitions.find ("/v2"), partitions.select ("h", "/v2/users"));
+		EXPECT_EQ (partitions.find ("v2"), partitions.find ("/v2"));
+		EXPECT_TRUE (serve (partitions, {}, "/v2/users"));
+		EXPECT_EQ (calls, (std::vector<std::string> {"v2"}));
+	}
+
+	TEST (RouterPartitionsTest, PublishReloadsOnePartition)
+	{
+		std::vector<std::string> calls;
+		RouterPartitions partitions;
+		partitions.partition ("a.example.com").add (HttpMethod::GET, "/old", record (calls, "a old"));
+		partitions.partition ("b.example.com").add (HttpMethod::GET, "/old", record (calls, "b old"));
+		partitions.freeze();
+
+		Router staged;
+		staged.add (HttpMethod::GET, "/new", record (calls, "a new"));
+		partitions.partition ("a.example.com").publish (staged);
+
+		EXPECT_FALSE (serve (partitions, "a.example.com", "/old"));
+		EXPECT_TRUE (serve (partitions, "a.example.com", "/new"));
+		EXPECT_TRUE (serve (partitions, "b.example.com", "/old"));
+		EXPECT_EQ (calls, (std::vector<std::string> {"a new", "b old"}));
+	}
+
+	TEST (RouterPartitionsTest, SelectDoesNotAllocate)
+	{
+		RouterPartitions partitions;
+		partitions.partition ("tenant.example.com").add (HttpMethod::GET, "/", [] (ICtx &) {});
+		partitions.freeze();
+
+		const Router *selected = nullptr;
+		{
+			testutil::AllocationCounter counter;
+			selected = partitions.select ("Tenant.Example.com:443", "/");
+			EXPECT_EQ (counter.count(), 0u);
+		}
+		EXPECT_NE (selected, nullptr);
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,200 @@
+/*********************************************************************************************
+ *  Description : Unit tests for the compile-time route table
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+#include "Route.h"
+#include "StaticRoutes.h"
+
+#include <array>
+#include <string>
+#include <utility>
+
+namespace ipb::http
+{
+	namespace
+	{
+		// Keeps parameter views and decoded values in fixed storage
+		class StaticCtx : public ICtx
+		{
+			public:
+				std::array<std::pair<std::string_view, std::string_view>, 8> params {};
+				std::array<ParamValue, 8> decoded {};
+				size_t count = 0;
+
+				void setParam (std::string_view name, std::string_view value) override
+				{
+					setTypedParam (name, value, ParamValue {});
+				}
+
+				void setTypedParam (std::string_view name, std::string_view value, const ParamValue &value_decoded) override
+				{
+					if (count < params.size())
+					{
+						decoded [count]  = value_decoded;
+						params [count++] = {name, value};
+					}
+				}
+		};
+
+		using Users = RoutePattern<"/users/<id:int>/">;
+		static_assert (Users::size == 2);
+		static_assert (!Users::segments [0].param && Users::segments [0].text == "users");
+		static_assert (Users::segments [1].param && Users::segments [1].type == ParamType::INT);
+		static_assert (Users::segments [1].text == "id");
+		static_assert (RoutePattern<"/">::size == 0);
+		static_assert (RoutePattern<"/files/<name>">::segments [1].type == ParamType::GENERIC);
+		static_assert (RoutePattern<"/files/<rest:path>">::segments [1].type == ParamType::PATH);
+		// Malformed patterns do not compile, e.g. RoutePattern<"/a//b">, "/<id:integer>", "/<>", "/a<b"
+		// or "/<rest:path>/b"
+	}    // namespace
+
+	TEST (StaticRoutesTest, MatchesWithRouterPriorities)
+	{
+		int hit = -1;
+		const StaticRouteTable table {
+		    route<"/users/me"> (HttpMethod::GET, [&] (ICtx &) { hit = 0; }),
+		    route<"/users/<id:int>"> (HttpMethod::GET, [&] (ICtx &) { hit = 1; }),
+		    route<"/users/<id:uuid>"> (HttpMethod::GET, [&] (ICtx &) { hit = 2; }),
+		    route<"/users/<name>"> (HttpMethod::GET, [&] (ICtx &) { hit = 3; }),
+		    route<"/users/<id:int>/posts"> ([&] (ICtx &) { hit = 4; }),
+		    route<"/"> (HttpMethod::GET, [&] (ICtx &) { hit = 5; }),
+		};
+		static_assert (decltype (table)::size() == 6);
+
+		const std::pair<const char *, int> cases [] = {
+		    {"/users/me",                                   0 },
+		    {"/users/42",                                   1 },
+		    {"/users/550e8400-e29b-41d4-a716-446655440000", 2 },
+		    {"/users/alice",                                3 },
+		    {"/users/42/posts/",                            4 },
+		    {"/",                                           5 },
+		    {"",                                            5 },
+		    {"/users/alice/posts",                          -1},
+		    {"/users/42/posts/extra",                       -1},
+		    {"/unknown",                                    -1},
+		};
+		for (const auto &[path, expected] : cases)
+		{
+			StaticCtx ctx;
+			hit = -1;
+			EXPECT_EQ (table.dispatch (HttpMethod::GET, path, ctx), expected >= 0) << path;
+			EXPECT_EQ (hit, expected) << path;
+		}
+	}
+
+	TEST (StaticRoutesTest, PassesDecodedParametersOnlyOnMatch)
+	{
+		const StaticRouteTable table {
+		    route<"/orders/<order:int>/items/<item:uuid>"> (HttpMethod::GET, [] (ICtx &) {}),
+		};
+
+		StaticCtx ctx;
+		auto route = table.match (HttpMethod::GET, "/orders/-7/items/550e8400-e29b-41d4-a716-446655440000", ctx);
+		ASSERT_TRUE (route.has_value());
+		EXPECT_EQ (table.pattern (*route), "/orders/<order:int>/items/<item:uuid>");
+		ASSERT_EQ (ctx.count, 2u);
+		EXPECT_EQ (ctx.params [0].first, "order");
+		EXPECT_EQ (ctx.params [0].second, "-7");
+		EXPECT_EQ (std::get<int64_t> (ctx.decoded [0]), -7);
+		EXPECT_EQ (ctx.params [1].first, "item");
+		EXPECT_EQ (std::get<Uuid> (ctx.decoded [1]) [0], 0x55);
+
+		StaticCtx miss;
+		EXPECT_FALSE (table.match (HttpMethod::GET, "/orders/7/items/not-a-uuid", miss).has_value());
+		EXPECT_EQ (miss.count, 0u);
+	}
+
+	TEST (StaticRoutesTest, PathParameterCapturesTheTail)
+	{
+		const StaticRouteTable table {
+		    route<"/assets/<file:path>"> (HttpMethod::GET, [] (ICtx &) {}),
+		    route<"/assets/<id:int>"> (HttpMethod::GET, [] (ICtx &) {}),
+		    route<"/assets/logo"> (HttpMethod::GET, [] (ICtx &) {}),
+		};
+
+		const std::string path = "/assets/img/icons/a.svg";
+		StaticCtx ctx;
+		auto route = table.match (HttpMethod::GET, path, ctx);
+		ASSERT_TRUE (route.has_value());
+		EXPECT_EQ (table.pattern (*route), "/assets/<file:path>");
+		ASSERT_EQ (ctx.count, 1u);
+		EXPECT_EQ (ctx.params [0].second, "img/icons/a.svg");
+		EXPECT_EQ (ctx.params [0].second.data(), path.data() + 8);
+
+		StaticCtx other;
+		EXPECT_EQ (table.pattern (*table.match (HttpMethod::GET, "/assets/7", other)), "/assets/<id:int>");
+		EXPECT_EQ (table.pattern (*table.match (HttpMethod::GET, "/assets/logo", other)), "/assets/logo");
+		EXPECT_EQ (table.pattern (*table.match (HttpMethod::GET, "/assets/a/b/c/d/e/f", other)), "/assets/<file:path>");
+		EXPECT_FALSE (table.match (HttpMethod::GET, "/assets", other).has_value());
+		EXPECT_FALSE (table.match (HttpMethod::GET, "/assets/7/x", other).has_value());
+	}
+
+	TEST (StaticRoutesTest, PrefersTheMethodThenAny)
+	{
+		int hit = -1;
+		const StaticRouteTable table {
+		    route<"/items"> ([&] (ICtx &) { hit = 0; }),
+		    route<"/items"> (HttpMethod::POST, [&] (ICtx &) { hit = 1; }),
+		    route<"/only-get"> (HttpMethod::GET, [&] (ICtx &) { hit = 2; }),
+		};
+
+		StaticCtx ctx;
+		EXPECT_TRUE (table.dispatch (HttpMethod::POST, "/items", ctx));
+		EXPECT_EQ (hit, 1);
+		EXPECT_TRUE (table.dispatch (HttpMethod::DELETE_, "/items", ctx));
+		EXPECT_EQ (hit, 0);
+		EXPECT_FALSE (table.dispatch (HttpMethod::PUT, "/only-get", ctx));
+	}
+
+	TEST (StaticRoutesTest, AgreesWithTheRuntimeRouter)
+	{
+		Router router;
+		router.add (HttpMethod::GET, "/api/<version:int>/status", [] (ICtx &) {});
+		router.add (HttpMethod::GET, "/api/<version:float>/status", [] (ICtx &) {});
+		router.add (HttpMethod::GET, "/api/<name:string>/status", [] (ICtx &) {});
+		router.add (HttpMethod::GET, "/api/v1/<id:base64id>", [] (ICtx &) {});
+		router.add (HttpMethod::GET, "/api/v1/<rest>", [] (ICtx &) {});
+		router.freeze();
+
+		const StaticRouteTable table {
+		    route<"/api/<version:int>/status"> (HttpMethod::GET, [] (ICtx &) {}),
+		    route<"/api/<version:float>/status"> (HttpMethod::GET, [] (ICtx &) {}),
+		    route<"/api/<name:string>/status"> (HttpMethod::GET, [] (ICtx &) {}),
+		    route<"/api/v1/<id:base64id>"> (HttpMethod::GET, [] (ICtx &) {}),
+		    route<"/api/v1/<rest>"> (HttpMethod::GET, [] (ICtx &) {}),
+		};
+
+		for (const char *path : {"/api/2/status", "/api/2.5/status", "/api/beta/status", "/api/v1/AbCdEfGhIjKlMnOpQrStUv",
+		                         "/api/v1/other", "/api/v1/status", "/api/2", "/api/v1/a/b"})
+		{
+			StaticCtx dynamicCtx;
+			StaticCtx staticCtx;
+			auto expected = router.match (HttpMethod::GET, path, dynamicCtx);
+			auto actual   = table.match (HttpMethod::GET, path, staticCtx);
+			ASSERT_EQ (actual.has_value(), expected.has_value()) << path;
+			if (actual.has_value())
+			{
+				EXPECT_EQ (table.pattern (*actual), expected->get().pattern) << path;
+			}
+		}
+	}
+
+	TEST (StaticRoutesTest, MatchingDoesNotAllocate)
+	{
+		const StaticRouteTable table {
+		    route<"/a/<id:int>/b/<name>"> (HttpMethod::GET, [] (ICtx &) {}),
+		    route<"/a/<id:uuid>"> (HttpMethod::GET, [] (ICtx &) {}),
+		};
+
+		StaticCtx ctx;
+		testutil::AllocationCounter counter;
+		EXPECT_TRUE (table.dispatch (HttpMethod::GET, "/a/12/b/some-long-name-beyond-small-buffers", ctx));
+		EXPECT_EQ (counter.count(), 0u);
+	}
+
+}    // namespace ipb::http
@@ -0,0 +1,242 @@
+/*********************************************************************************************
+ *  Description : Unit tests for the sampled request tracing and its exporters
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Jwt.h"
+#include "JwtTestProviders.h"
+#include "Route.h"
+#include "Tracing.h"
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace ipb::http
+{
+	namespace
+	{
+		class NullCtx : public ICtx
+		{
+			public:
+				void setParam (std::string_view, std::string_view) override
+				{
+				}
+		};
+
+		TraceSpan makeSpan (TraceStage stage, uint64_t spanId, uint64_t parentId, uint64_t start, uint64_t end)
+		{
+			TraceSpan span;
+			span.traceId          = 0x10;
+			span.spanId           = spanId;
+			span.parentId         = parentId;
+			span.startNanoseconds = start;
+			span.endNanoseconds   = end;
+			span.thread           = 3;
+			span.stage            = stage;
+			return span;
+		}
+
+#if defined(HAPP_TRACING)
+		const TraceSpan *findSpan (const std::vector<TraceSpan> &spans, TraceStage stage, uint16_t index = 0)
+		{
+			const auto it = std::find_if (spans.begin(), spans.end(), [&] (const TraceSpan &span)
+			                              { return span.stage == stage && span.index == index; });
+			return it != spans.end() ? &*it : nullptr;
+		}
+#endif
+
+		// Leaves tracing off and the rings empty for the next test
+		class TracingTest : public ::testing::Test
+		{
+			protected:
+				void SetUp () override
+				{
+					setTraceSampleRate (0);
+					drainTraceSpans();
+				}
+
+				void TearDown () override
+				{
+					setTraceSampleRate (0);
+					drainTraceSpans();
+				}
+		};
+	}    // namespace
+
+	TEST_F (TracingTest, SpanNamesFollowTheStage)
+	{
+		TraceSpan span = makeSpan (TraceStage::Middleware, 1, 0, 0, 0);
+		span.index     = 2;
+		EXPECT_EQ (traceSpanName (span), "middleware[2]");
+		EXPECT_EQ (traceSpanName (makeSpan (TraceStage::Match, 1, 0, 0, 0)), "match");
+		EXPECT_EQ (traceSpanName (makeSpan (TraceStage::JwtSignature, 1, 0, 0, 0)), "jwt.signature");
+	}
+
+	TEST_F (TracingTest, ChromeTraceHasOneCompleteEventPerSpan)
+	{
+		std::vector<TraceSpan> spans {makeSpan (TraceStage::Request, 0x1, 0, 1500, 9000),
+		                              makeSpan (TraceStage::Match, 0x2, 0x1, 2000, 2250)};
+		const std::string_view pattern = "/users/<id:int>";
+		std::copy (pattern.begin(), pattern.end(), spans [1].detail.begin());
+		spans [1].detailSize = static_cast<uint8_t> (pattern.size());
+
+		const std::string json = toChromeTrace (spans);
+		EXPECT_EQ (json.rfind ("{\"traceEvents\":[{\"name\":\"request\",\"cat\":\"httplibapp\",\"ph\":\"X\",\"ts\":1.500,"
+		                       "\"dur\":7.500,\"pid\":1,\"tid\":3,",
+		                       0),
+		           0u);
+		EXPECT_NE (json.find ("{\"name\":\"match\""), std::string::npos);
+		EXPECT_NE (json.find ("\"parent\":\"0000000000000001\""), std::string::npos);
+		EXPECT_NE (json.find ("\"detail\":\"/users/<id:int>\""), std::string::npos);
+		EXPECT_EQ (toChromeTrace ({}), "{\"traceEvents\":[],\"displayTimeUnit\":\"ns\"}");
+	}
+
+	TEST_F (TracingTest, OtlpJsonNestsTheSpansUnderTheService)
+	{
+		const std::vector<TraceSpan> spans {makeSpan (TraceStage::Request, 0x1, 0, 1000, 5000),
+		                                    makeSpan (TraceStage::Handler, 0x2, 0x1, 2000, 4000)};
+
+		const std::string json = toOtlpJson (spans, "orders");
+		EXPECT_EQ (json.rfind ("{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\","
+		                       "\"value\":{\"stringValue\":\"orders\"}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"ipb.http\"}",
+		                       0),
+		           0u);
+
+		// 32 hex digits per trace id: the process seed, then the trace id of the span
+		const size_t traceId = json.find ("\"traceId\":\"");
+		ASSERT_NE (traceId, std::string::npos);
+		EXPECT_EQ (json.substr (traceId + 27, 18), "0000000000000010\",");
+		EXPECT_NE (json.find ("\"spanId\":\"0000000000000002\",\"parentSpanId\":\"0000000000000001\""), std::string::npos);
+		EXPECT_NE (json.find ("\"name\":\"request\",\"kind\":2"), std::string::npos);
+		EXPECT_NE (json.find ("\"name\":\"handler\",\"kind\":1"), std::string::npos);
+		EXPECT_NE (json.find ("\"startTimeUnixNano\":\""), std::string::npos);
+	}
+
+#if defined(HAPP_TRACING)
+	TEST_F (TracingTest, SampledRequestRecordsMatchMiddlewaresAndHandler)
+	{
+		Router router;
+		router.addMiddleware ([] (ICtx &, IMiddlewareNext &next) { next.next(); });
+		auto &route = router.add (HttpMethod::GET, "/users/<id:int>", [] (ICtx &) {});
+		router.addMiddleware (route, [] (ICtx &, IMiddlewareNext &next) { next.next(); });
+		router.freeze();
+
+		setTraceSampleRate (1);
+		NullCtx ctx;
+		{
+			RequestTrace trace;
+			ASSERT_TRUE (trace.sampled());
+			router.execute (router.match (HttpMethod::GET, "/users/7", ctx)->get(), ctx);
+		}
+
+		const std::vector<TraceSpan> spans = drainTraceSpans();
+		ASSERT_EQ (spans.size(), 5u);
+		const TraceSpan *request = findSpan (spans, TraceStage::Request);
+		const TraceSpan *match   = findSpan (spans, TraceStage::Match);
+		const TraceSpan *first   = findSpan (spans, TraceStage::Middleware, 0);
+		const TraceSpan *second  = findSpan (spans, TraceStage::Middleware, 1);
+		const TraceSpan *handler = findSpan (spans, TraceStage::Handler);
+		ASSERT_TRUE (request && match && first && second && handler);
+
+		EXPECT_EQ (request->parentId, 0u);
+		EXPECT_EQ (match->parentId, request->spanId);
+		EXPECT_EQ (match->detailView(), "/users/<id:int>");
+		EXPECT_EQ (first->parentId, request->spanId);
+		EXPECT_EQ (second->parentId, first->spanId);
+		EXPECT_EQ (handler->parentId, second->spanId);
+		for (const TraceSpan &span : spans)
+		{
+			EXPECT_EQ (span.traceId, request->traceId);
+			EXPECT_LE (span.startNanoseconds, span.endNanoseconds);
+			EXPECT_GE (span.startNanoseconds, request->startNanoseconds);
+			EXPECT_LE (span.endNanoseconds, request->endNanoseconds);
+		}
+	}
+
+	TEST_F (TracingTest, SamplesOneRequestInTheRate)
+	{
+		Router router;
+		router.add (HttpMethod::GET, "/ping", [] (ICtx &) {});
+		router.freeze();
+		NullCtx ctx;
+
+		const auto serve = [&] (int count)
+		{
+			int sampled = 0;
+			for (int i = 0; i < count; ++i)
+			{
+				RequestTrace trace;
+				sampled += trace.sampled() ? 1 : 0;
+				router.execute (router.match (HttpMethod::GET, "/ping", ctx)->get(), ctx);
+			}
+			return sampled;
+		};
+
+		EXPECT_EQ (serve (100), 0);
+		EXPECT_TRUE (drainTraceSpans().empty());
+
+		setTraceSampleRate (4);
+		EXPECT_EQ (serve (100), 25);
+		const std::vector<TraceSpan> spans = drainTraceSpans();
+		EXPECT_EQ (std::count_if (spans.begin(), spans.end(),
+		                          [] (const TraceSpan &span) { return span.stage == TraceStage::Request; }),
+		           25);
+
+		// Stages outside a request are never recorded
+		router.match (HttpMethod::GET, "/ping", ctx);
+		EXPECT_TRUE (drainTraceSpans().empty());
+	}
+
+	TEST_F (TracingTest, JwtVerificationRecordsItsStages)
+	{
+		jwt::FakeCryptoProvider crypto;
+		jwt::FakeJsonProvider json;
+		jwt::EngineOptions options;
+		jwt::Jwt engine {crypto, json, options};
+		ASSERT_EQ (engine.generateKeyPair ("k-trace", jwt::JwtAlg::HS256).code, jwt::ErrorCode::Ok);
+
+		std::string token;
+		const int64_t exp = static_cast<int64_t> (std::time (nullptr)) + 3600;
+		ASSERT_EQ (engine.token().kid ("k-trace").expiresAt (exp).sign (token).code, jwt::ErrorCode::Ok);
+
+		setTraceSampleRate (1);
+		{
+			RequestTrace trace;
+			jwt::Verifier verifier;
+			ASSERT_EQ (engine.verify (token, verifier).code, jwt::ErrorCode::Ok);
+		}
+
+		const std::vector<TraceSpan> spans = drainTraceSpans();
+		const TraceSpan *request           = findSpan (spans, TraceStage::Request);
+		ASSERT_NE (request, nullptr);
+		for (TraceStage stage : {TraceStage::JwtDecode, TraceStage::JwtParse, TraceStage::JwtSignature})
+		{
+			const TraceSpan *span = findSpan (spans, stage);
+			ASSERT_NE (span, nullptr) << static_cast<int> (stage);
+			EXPECT_EQ (span->parentId, request->spanId);
+		}
+	}
+#else
+	TEST_F (TracingTest, NothingIsRecordedWithoutTracing)
+	{
+		Router router;
+		router.add (HttpMethod::GET, "/ping", [] (ICtx &) {});
+		NullCtx ctx;
+
+		setTraceSampleRate (1);
+		EXPECT_EQ (traceSampleRate(), 1u);
+		{
+			RequestTrace trace;
+			EXPECT_FALSE (trace.sampled());
+			router.execute (router.match (HttpMethod::GET, "/ping", ctx)->get(), ctx);
+		}
+		EXPECT_TRUE (drainTraceSpans().empty());
+	}
+#endif
+
+}    // namespace ipb::http
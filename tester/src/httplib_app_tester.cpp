@@ -1,17 +1,26 @@
-﻿#include <gtest/gtest.h>
-#include "../include/httplib_app.hpp"
-#include "../include/ctx.hpp"
-
-#ifdef _DEBUG
-#	define END_LIB_STD "d.lib"
-#else
-#	define END_LIB_STD ".lib"
-#endif
-
-// #pragma comment(lib, "HttplibApp" END_LIB_STD)
-
-#pragma comment(lib, "gtest" END_LIB_STD)
-#pragma comment(lib, "gtest_main" END_LIB_STD)
+﻿/*********************************************************************************************
+ *  Description : Unit tests for the cpp-httplib integration (HttplibApp / Ctx)
+ *  License     : The unlicense (https://unlicense.org)
+ *	Copyright	(C) 2026  Ignacio Pomar Ballestero
+ ********************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <httplib.h>
+
+#include "HttplibApp.h"
+#include "Ctx.h"
+#include "JwtAuth.h"
+#include "JwtTestProviders.h"
+#include "ResponseCache.h"
+
+#include <chrono>
+#include <coroutine>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace ipb::http;
 
@@ -71,12 +80,11 @@ TEST_F (HttplibAppTest, RegisterGetRoute)
 
 	bool handler_called = false;
 	app.get ("/test",
-	         [&] (Ctx &ctx)
+	         [&] (Ctx &)
 	         {
 		         handler_called = true;
 	         });
 
-	// La ruta se registra sin error
 	SUCCEED();
 }
 
@@ -85,7 +93,7 @@ TEST_F (HttplibAppTest, RegisterPostRoute)
 	HttplibApp app (default_config);
 
 	app.post ("/users",
-	          [] (Ctx &ctx)
+	          [] (Ctx &)
 	          {
 	          });
 
@@ -97,7 +105,7 @@ TEST_F (HttplibAppTest, RegisterPutRoute)
 	HttplibApp app (default_config);
 
 	app.put ("/users/<id>",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 
@@ -109,7 +117,7 @@ TEST_F (HttplibAppTest, RegisterPatchRoute)
 	HttplibApp app (default_config);
 
 	app.patch ("/users/<id>",
-	           [] (Ctx &ctx)
+	           [] (Ctx &)
 	           {
 	           });
 
@@ -121,7 +129,7 @@ TEST_F (HttplibAppTest, RegisterDeleteRoute)
 	HttplibApp app (default_config);
 
 	app.del ("/users/<id>",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 
@@ -133,7 +141,7 @@ TEST_F (HttplibAppTest, RegisterOptionsRoute)
 	HttplibApp app (default_config);
 
 	app.options ("/api",
-	             [] (Ctx &ctx)
+	             [] (Ctx &)
 	             {
 	             });
 
@@ -145,7 +153,7 @@ TEST_F (HttplibAppTest, RegisterAnyRoute)
 	HttplibApp app (default_config);
 
 	app.any ("/wildcard",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 
@@ -157,15 +165,15 @@ TEST_F (HttplibAppTest, RegisterMultipleRoutes)
 	HttplibApp app (default_config);
 
 	app.get ("/users",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 	app.post ("/users",
-	          [] (Ctx &ctx)
+	          [] (Ctx &)
 	          {
 	          });
 	app.get ("/posts",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 
@@ -177,15 +185,15 @@ TEST_F (HttplibAppTest, ChainedRouteRegistration)
 	HttplibApp app (default_config);
 
 	app.get ("/a",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         })
 	    .post ("/b",
-	           [] (Ctx &ctx)
+	           [] (Ctx &)
 	           {
 	           })
 	    .put ("/c",
-	          [] (Ctx &ctx)
+	          [] (Ctx &)
 	          {
 	          });
 
@@ -202,7 +210,7 @@ TEST_F (HttplibAppTest, UseGlobalMiddleware)
 
 	bool middleware_called = false;
 	app.use (
-	    [&] (Ctx &ctx, Next next)
+	    [&] (Ctx &, Next next)
 	    {
 		    middleware_called = true;
 		    next();
@@ -216,17 +224,17 @@ TEST_F (HttplibAppTest, UseMultipleGlobalMiddlewares)
 	HttplibApp app (default_config);
 
 	app.use (
-	    [] (Ctx &ctx, Next next)
+	    [] (Ctx &, Next next)
 	    {
 		    next();
 	    });
 	app.use (
-	    [] (Ctx &ctx, Next next)
+	    [] (Ctx &, Next next)
 	    {
 		    next();
 	    });
 	app.use (
-	    [] (Ctx &ctx, Next next)
+	    [] (Ctx &, Next next)
 	    {
 		    next();
 	    });
@@ -238,16 +246,16 @@ TEST_F (HttplibAppTest, RouteSpecificMiddleware)
 {
 	HttplibApp app (default_config);
 
-	std::vector<Middleware> mws;
+	std::vector<AppMiddleware> mws;
 	mws.push_back (
-	    [] (Ctx &ctx, Next next)
+	    [] (Ctx &, Next next)
 	    {
 		    next();
 	    });
 
 	app.get (
 	    "/protected",
-	    [] (Ctx &ctx)
+	    [] (Ctx &)
 	    {
 	    },
 	    mws);
@@ -281,7 +289,7 @@ TEST_F (HttplibAppTest, ModifyConfig)
 }
 
 // ============================================================================
-// Path Normalization Tests (métodos privados - test indirecto)
+// Path Normalization Tests
 // ============================================================================
 
 TEST_F (HttplibAppTest, RouteWithTrailingSlash)
@@ -290,7 +298,7 @@ TEST_F (HttplibAppTest, RouteWithTrailingSlash)
 	app.config().normalize_trailing_slash = true;
 
 	app.get ("/users/",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 
@@ -302,7 +310,7 @@ TEST_F (HttplibAppTest, RouteWithoutTrailingSlash)
 	HttplibApp app (default_config);
 
 	app.get ("/users",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 
@@ -314,9 +322,969 @@ TEST_F (HttplibAppTest, RouteWithParameters)
 	HttplibApp app (default_config);
 
 	app.get ("/users/<id>/posts/<postId>",
-	         [] (Ctx &ctx)
+	         [] (Ctx &)
 	         {
 	         });
 
 	SUCCEED();
 }
+
+// ============================================================================
+// Dispatch Tests (no sockets: requests built by hand)
+// ============================================================================
+
+namespace
+{
+	httplib::Request makeRequest (std::string method, std::string path)
+	{
+		httplib::Request request;
+		request.method = std::move (method);
+		request.path   = std::move (path);
+		return request;
+	}
+}    // namespace
+
+TEST_F (HttplibAppTest, DispatchRunsMatchedRoute)
+{
+	HttplibApp app (default_config);
+
+	app.get ("/users/<id:int>",
+	         [] (Ctx &ctx)
+	         {
+		         ctx.status (200).send (ctx.param ("id"));
+	         });
+	app.router().freeze();
+
+	auto request = makeRequest ("GET", "/users/42");
+	httplib::Response response;
+
+	EXPECT_TRUE (app.dispatch (request, response));
+	EXPECT_EQ (response.status, 200);
+	EXPECT_EQ (response.body, "42");
+}
+
+TEST_F (HttplibAppTest, DispatchReturnsFalseWithoutMatch)
+{
+	HttplibApp app (default_config);
+
+	app.get ("/users",
+	         [] (Ctx &ctx)
+	         {
+		         ctx.status (200);
+	         });
+
+	auto request = makeRequest ("POST", "/users");
+	httplib::Response response;
+
+	EXPECT_FALSE (app.dispatch (request, response));
+	EXPECT_EQ (response.status, -1);
+}
+
+TEST_F (HttplibAppTest, DispatchLeavesUnknownMethodsUnhandled)
+{
+	HttplibApp app (default_config);
+
+	bool called = false;
+	app.any ("/files",
+	         [&called] (Ctx &ctx)
+	         {
+		         called = true;
+		         ctx.status (200);
+	         });
+	app.router().freeze();
+
+	// Neither taken as GET nor caught by the ANY route
+	httplib::Response response;
+	EXPECT_FALSE (app.dispatch (makeRequest ("PROPFIND", "/files"), response));
+	EXPECT_FALSE (called);
+	EXPECT_EQ (response.status, -1);
+}
+
+TEST_F (HttplibAppTest, HandlerCanPublishNewRoutes)
+{
+	HttplibApp app (default_config);
+
+	int served = 0;
+	Router staged;
+	staged.add (HttpMethod::GET, "/v2",
+	            [&served] (ICtx &)
+	            {
+		            ++served;
+	            });
+
+	// The dispatch guard is still held: the replaced table is freed when it is released
+	app.post ("/reload",
+	          [&app, &staged] (Ctx &ctx)
+	          {
+		          app.router().publish (staged);
+		          ctx.status (204);
+	          });
+	app.router().freeze();
+
+	httplib::Response reloaded;
+	ASSERT_TRUE (app.dispatch (makeRequest ("POST", "/reload"), reloaded));
+	EXPECT_EQ (reloaded.status, 204);
+
+	httplib::Response response;
+	EXPECT_TRUE (app.dispatch (makeRequest ("GET", "/v2"), response));
+	EXPECT_EQ (served, 1);
+	EXPECT_FALSE (app.dispatch (makeRequest ("POST", "/reload"), response));
+}
+
+TEST_F (HttplibAppTest, DispatchAwaitsCoroutineRoutes)
+{
+	HttplibApp app (default_config);
+
+	// Suspends and completes on another thread, as an I/O completion would
+	struct ResumeOnOtherThread
+	{
+			bool await_ready () const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend (std::coroutine_handle<> handle) const
+			{
+				std::thread ([handle] { handle.resume(); }).detach();
+			}
+
+			void await_resume () const noexcept
+			{
+			}
+	};
+
+	app.router().addAsync (HttpMethod::GET, "/io",
+	                       [] (ICtx &context) -> AsyncTask
+	                       {
+		                       co_await ResumeOnOtherThread {};
+		                       static_cast<Ctx &> (context).status (200).send ("done");
+	                       });
+	app.router().freeze();
+
+	// dispatch returns once the task has completed, with the response filled
+	httplib::Response response;
+	EXPECT_TRUE (app.dispatch (makeRequest ("GET", "/io"), response));
+	EXPECT_EQ (response.status, 200);
+	EXPECT_EQ (response.body, "done");
+}
+
+TEST_F (HttplibAppTest, CtxExposesRequestWithoutCopies)
+{
+	HttplibApp app (default_config);
+
+	const std::string *body_storage = nullptr;
+	bool views_into_request        = false;
+	app.post ("/items/<name>",
+	          [&] (Ctx &ctx)
+	          {
+		          views_into_request = ctx.body().data() == body_storage->data()
+		                               && ctx.param ("name").data() == ctx.request().path.data() + 7;
+		          EXPECT_EQ (ctx.header ("X-Trace"), "abc");
+		          EXPECT_EQ (ctx.query ("page"), "2");
+		          EXPECT_EQ (ctx.method(), "POST");
+	          });
+
+	auto request = makeRequest ("POST", "/items/pen");
+	request.body = "{\"qty\":1}";
+	request.headers.emplace ("X-Trace", "abc");
+	request.params.emplace ("page", "2");
+	body_storage = &request.body;
+	httplib::Response response;
+
+	EXPECT_TRUE (app.dispatch (request, response));
+	EXPECT_TRUE (views_into_request);
+}
+
+TEST_F (HttplibAppTest, DecodedParametersReachTheHandler)
+{
+	HttplibApp app (default_config);
+
+	int64_t id = 0;
+	app.get ("/orders/<id:int>",
+	         [&] (Ctx &ctx)
+	         {
+		         const ParamValue *decoded = ctx.typedParam ("id");
+		         ASSERT_NE (decoded, nullptr);
+		         id = std::get<int64_t> (*decoded);
+	         });
+
+	auto request = makeRequest ("GET", "/orders/1234");
+	httplib::Response response;
+
+	EXPECT_TRUE (app.dispatch (request, response));
+	EXPECT_EQ (id, 1234);
+}
+
+TEST_F (HttplibAppTest, MiddlewaresWrapTheHandler)
+{
+	HttplibApp app (default_config);
+
+	std::vector<std::string> calls;
+	app.use (
+	    [&] (Ctx &, Next next)
+	    {
+		    calls.push_back ("global");
+		    next();
+	    });
+	app.get (
+	    "/guarded",
+	    [&] (Ctx &)
+	    {
+		    calls.push_back ("handler");
+	    },
+	    {[&] (Ctx &ctx, Next next)
+	     {
+		     calls.push_back ("route");
+		     if (ctx.header ("Authorization").empty())
+		     {
+			     ctx.status (401);
+			     return;
+		     }
+		     next();
+	     }});
+	app.router().freeze();
+
+	auto denied = makeRequest ("GET", "/guarded");
+	httplib::Response denied_response;
+	EXPECT_TRUE (app.dispatch (denied, denied_response));
+	EXPECT_EQ (denied_response.status, 401);
+
+	auto allowed = makeRequest ("GET", "/guarded");
+	allowed.headers.emplace ("Authorization", "Bearer x");
+	httplib::Response allowed_response;
+	EXPECT_TRUE (app.dispatch (allowed, allowed_response));
+
+	const std::vector<std::string> expected = {"global", "route", "global", "route", "handler"};
+	EXPECT_EQ (calls, expected);
+}
+
+TEST_F (HttplibAppTest, ContextIsResetBetweenRequests)
+{
+	HttplibApp app (default_config);
+
+	size_t params_seen = 0;
+	app.get ("/a/<x>/<y>",
+	         [] (Ctx &)
+	         {
+	         });
+	app.get ("/b/<z>",
+	         [&] (Ctx &ctx)
+	         {
+		         params_seen = ctx.params().size();
+	         });
+
+	auto first = makeRequest ("GET", "/a/1/2");
+	auto second = makeRequest ("GET", "/b/3");
+	httplib::Response response;
+
+	EXPECT_TRUE (app.dispatch (first, response));
+	EXPECT_TRUE (app.dispatch (second, response));
+	EXPECT_EQ (params_seen, 1u);
+}
+
+TEST_F (HttplibAppTest, TrailingSlashIsRejectedWhenNormalizationIsOff)
+{
+	HttplibApp app (default_config);
+	app.config().normalize_trailing_slash = false;
+
+	app.get ("/users",
+	         [] (Ctx &)
+	         {
+	         });
+
+	auto request = makeRequest ("GET", "/users/");
+	httplib::Response response;
+
+	EXPECT_FALSE (app.dispatch (request, response));
+}
+
+TEST_F (HttplibAppTest, RoutesLoadedFromAnImageAreBoundById)
+{
+	const std::filesystem::path image = std::filesystem::temp_directory_path() / "happ_app_routes.bin";
+	{
+		// Written once by the build (here: a router with placeholder handlers)
+		Router staged;
+		staged.add (HttpMethod::GET, "/users/<id:int>", [] (ICtx &) {});
+		staged.add (HttpMethod::POST, "/users", [] (ICtx &) {});
+		staged.freeze();
+		ASSERT_TRUE (staged.saveImage (image));
+	}
+
+	HttplibApp app (default_config);
+	const std::vector<AppHandler> handlers = {
+	    [] (Ctx &ctx)
+	    {
+		    ctx.send (std::string ("user ") + std::string (ctx.param ("id")));
+	    },
+	    [] (Ctx &ctx)
+	    {
+		    ctx.status (201).send ("created");
+	    }};
+	ASSERT_TRUE (app.loadRoutes (image, handlers));
+	EXPECT_FALSE (app.loadRoutes (image, std::span (handlers).first (1)));
+	std::filesystem::remove (image);
+	app.router().freeze();
+
+	auto request = makeRequest ("GET", "/users/7");
+	httplib::Response response;
+	ASSERT_TRUE (app.dispatch (request, response));
+	EXPECT_EQ (response.body, "user 7");
+
+	request = makeRequest ("POST", "/users");
+	httplib::Response created;
+	ASSERT_TRUE (app.dispatch (request, created));
+	EXPECT_EQ (created.status, 201);
+}
+
+TEST_F (HttplibAppTest, ScopedRoutesAreServedByTheirHost)
+{
+	HttplibApp app (default_config);
+
+	app.use (
+	       [] (Ctx &ctx, Next next)
+	       {
+		       ctx.setHeader ("X-Scope", "default");
+		       next();
+	       })
+	    .get ("/whoami",
+	          [] (Ctx &ctx)
+	          {
+		          ctx.send ("default");
+	          });
+	app.scope ("tenant.example.com")
+	    .get ("/whoami",
+	          [] (Ctx &ctx)
+	          {
+		          ctx.send ("tenant");
+	          })
+	    .scope ({});
+	app.router().freeze();
+	app.router ("tenant.example.com").freeze();
+
+	auto dispatchAs = [&app] (std::string host)
+	{
+		auto request = makeRequest ("GET", "/whoami");
+		request.headers.emplace ("Host", std::move (host));
+		httplib::Response response;
+		EXPECT_TRUE (app.dispatch (request, response));
+		return response;
+	};
+
+	const httplib::Response tenant = dispatchAs ("Tenant.example.com:8080");
+	EXPECT_EQ (tenant.body, "tenant");
+	EXPECT_FALSE (tenant.has_header ("X-Scope"));
+
+	const httplib::Response other = dispatchAs ("other.example.com");
+	EXPECT_EQ (other.body, "default");
+	EXPECT_EQ (other.get_header_value ("X-Scope"), "default");
+}
+
+// ============================================================================
+// Static file Tests
+// ============================================================================
+
+namespace
+{
+	// Directory tree under the system temporary directory, removed with the fixture
+	class StaticFilesTest : public ::testing::Test
+	{
+		protected:
+			std::filesystem::path root;
+
+			void SetUp () override
+			{
+				root = std::filesystem::temp_directory_path()
+				     / ("happ_static_" + std::string (::testing::UnitTest::GetInstance()->current_test_info()->name()));
+				std::filesystem::remove_all (root);
+				std::filesystem::create_directories (root / "css");
+				write ("css/site.css", "body{color:red}");
+				write ("index.html", "<h1>home</h1>");
+				write ("empty.txt", "");
+				write (".." + std::string ("/outside_") + ::testing::UnitTest::GetInstance()->current_test_info()->name(), "secret");
+			}
+
+			void TearDown () override
+			{
+				std::filesystem::remove (root.parent_path()
+				                         / ("outside_" + std::string (::testing::UnitTest::GetInstance()->current_test_info()->name())));
+				std::filesystem::remove_all (root);
+			}
+
+			void write (const std::string &relative, const std::string &content) const
+			{
+				std::ofstream (root / relative, std::ios::binary) << content;
+			}
+
+			// Body written by the content provider (or the plain body)
+			static std::string bodyOf (httplib::Response &response)
+			{
+				if (!response.content_provider_)
+				{
+					return response.body;
+				}
+
+				std::string body;
+				httplib::DataSink sink;
+				sink.write = [&body] (const char *data, size_t length)
+				{
+					body.append (data, length);
+					return true;
+				};
+				EXPECT_TRUE (response.content_provider_ (0, response.content_length_, sink));
+				return body;
+			}
+	};
+}    // namespace
+
+TEST_F (StaticFilesTest, ServesFilesFromTheMapping)
+{
+	HttplibApp app (HttpServerConfig {});
+	app.serveStatic ("/static", root.string(), StaticFilesConfig {.index_file = "index.html", .cache_control = "max-age=60"});
+	app.router().freeze();
+
+	auto request = makeRequest ("GET", "/static/css/site.css");
+	httplib::Response response;
+	ASSERT_TRUE (app.dispatch (request, response));
+	EXPECT_EQ (response.status, 200);
+	EXPECT_EQ (response.content_length_, 15u);
+	EXPECT_EQ (bodyOf (response), "body{color:red}");
+	EXPECT_EQ (response.get_header_value ("Content-Type"), "text/css; charset=utf-8");
+	EXPECT_EQ (response.get_header_value ("Cache-Control"), "max-age=60");
+	EXPECT_FALSE (response.get_header_value ("ETag").empty());
+
+	auto head = makeRequest ("HEAD", "/static/css/site.css");
+	httplib::Response head_response;
+	ASSERT_TRUE (app.dispatch (head, head_response));
+	EXPECT_EQ (head_response.content_length_, 15u);
+
+	httplib::Response index_response;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/static/index.html"), index_response));
+	EXPECT_EQ (bodyOf (index_response), "<h1>home</h1>");
+	EXPECT_EQ (index_response.get_header_value ("Content-Type"), "text/html; charset=utf-8");
+
+	httplib::Response empty_response;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/static/empty.txt"), empty_response));
+	EXPECT_EQ (empty_response.status, 200);
+	EXPECT_EQ (bodyOf (empty_response), "");
+}
+
+TEST_F (StaticFilesTest, ServesTheIndexOfDirectories)
+{
+	HttplibApp app (HttpServerConfig {});
+	app.get ("/site/<path:path>", staticFiles (root.string()));
+	app.get ("/bare/<file:path>", staticFiles (root.string(), "file", StaticFilesConfig {.index_file = "", .cache_control = ""}));
+	app.router().freeze();
+
+	std::filesystem::create_directories (root / "docs");
+	write ("docs/index.html", "docs");
+
+	httplib::Response response;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/site/docs/"), response));
+	EXPECT_EQ (response.status, 200);
+	EXPECT_EQ (bodyOf (response), "docs");
+
+	httplib::Response bare;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/bare/docs"), bare));
+	EXPECT_EQ (bare.status, 404);
+}
+
+TEST_F (StaticFilesTest, RejectsPathsOutsideTheRoot)
+{
+	HttplibApp app (HttpServerConfig {});
+	app.serveStatic ("/static/", root.string());
+	app.router().freeze();
+
+	const std::string outside = std::string ("outside_") + ::testing::UnitTest::GetInstance()->current_test_info()->name();
+	const std::vector<std::string> paths = {"/static/../" + outside,  "/static/css/../../" + outside,
+	                                        "/static/./index.html",   "/static/css//site.css",
+	                                        "/static/css\\site.css", "/static/C:/index.html",
+	                                        "/static/missing.css",    "/static/css/site.css/more"};
+	for (const std::string &path : paths)
+	{
+		httplib::Response response;
+		ASSERT_TRUE (app.dispatch (makeRequest ("GET", path), response)) << path;
+		EXPECT_EQ (response.status, 404) << path;
+		EXPECT_FALSE (response.content_provider_) << path;
+	}
+}
+
+TEST_F (StaticFilesTest, AnswersNotModifiedForAMatchingETag)
+{
+	HttplibApp app (HttpServerConfig {});
+	app.serveStatic ("/static", root.string());
+	app.router().freeze();
+
+	httplib::Response first;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/static/index.html"), first));
+	const std::string tag = first.get_header_value ("ETag");
+
+	auto request = makeRequest ("GET", "/static/index.html");
+	request.headers.emplace ("If-None-Match", tag);
+	httplib::Response second;
+	ASSERT_TRUE (app.dispatch (request, second));
+	EXPECT_EQ (second.status, 304);
+	EXPECT_FALSE (second.content_provider_);
+	EXPECT_EQ (second.get_header_value ("ETag"), tag);
+}
+
+TEST_F (StaticFilesTest, MatchesIfNoneMatchListsWeakly)
+{
+	HttplibApp app (HttpServerConfig {});
+	app.serveStatic ("/static", root.string());
+	app.router().freeze();
+
+	httplib::Response first;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/static/index.html"), first));
+	const std::string tag = first.get_header_value ("ETag");
+	ASSERT_TRUE (tag.starts_with ("W/\""));
+
+	const auto statusFor = [&] (const std::string &ifNoneMatch)
+	{
+		auto request = makeRequest ("GET", "/static/index.html");
+		request.headers.emplace ("If-None-Match", ifNoneMatch);
+		httplib::Response response;
+		EXPECT_TRUE (app.dispatch (request, response));
+		return response.status;
+	};
+	EXPECT_EQ (statusFor ("\"other\", " + tag), 304);
+	EXPECT_EQ (statusFor (tag.substr (2) + " , \"other\""), 304);
+	EXPECT_EQ (statusFor ("*"), 304);
+	EXPECT_EQ (statusFor ("\"other\", W/\"stale\""), 200);
+}
+
+// ============================================================================
+// Response cache Tests
+// ============================================================================
+
+TEST_F (HttplibAppTest, ResponseCacheServesStoredResponses)
+{
+	ResponseCache cache;
+	int calls = 0;
+
+	HttplibApp app (default_config);
+	app.get (
+	    "/users/<id:int>",
+	    [&calls] (Ctx &ctx)
+	    {
+		    ++calls;
+		    ctx.status (200).setHeader ("X-Served", "handler").send (ctx.param ("id"), "application/json");
+	    },
+	    {cache.appMiddleware ("/users/<id:int>")});
+	app.router().freeze();
+
+	httplib::Response first;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/users/42"), first));
+	EXPECT_EQ (first.body, "42");
+	EXPECT_FALSE (first.get_header_value ("ETag").empty());
+
+	httplib::Response second;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/users/42"), second));
+	EXPECT_EQ (calls, 1);
+	EXPECT_EQ (second.status, 200);
+	EXPECT_EQ (second.body, "42");
+	EXPECT_EQ (second.get_header_value ("Content-Type"), "application/json");
+	EXPECT_EQ (second.get_header_value ("X-Served"), "handler");
+	EXPECT_EQ (second.get_header_value ("ETag"), first.get_header_value ("ETag"));
+
+	// Other parameter values are other keys
+	httplib::Response other;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/users/7"), other));
+	EXPECT_EQ (calls, 2);
+	EXPECT_EQ (other.body, "7");
+	EXPECT_NE (other.get_header_value ("ETag"), first.get_header_value ("ETag"));
+
+	EXPECT_EQ (cache.size(), 2u);
+	EXPECT_EQ (cache.stats().hits, 1u);
+	EXPECT_EQ (cache.stats().misses, 2u);
+	EXPECT_EQ (cache.invalidate ("/users/<id:int>"), 2u);
+
+	httplib::Response refreshed;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/users/42"), refreshed));
+	EXPECT_EQ (calls, 3);
+}
+
+TEST_F (HttplibAppTest, ResponseCacheAnswersNotModified)
+{
+	ResponseCache cache;
+	int calls = 0;
+
+	HttplibApp app (default_config);
+	RouteInfo &route = app.router().add (HttpMethod::GET, "/feed",
+	                                     [&calls] (ICtx &context)
+	                                     {
+		                                     ++calls;
+		                                     static_cast<Ctx &> (context).status (200).send ("feed");
+	                                     });
+	app.use (route, cache.middleware (route));
+	app.head (
+	    "/feed",
+	    [&calls] (Ctx &)
+	    {
+		    ++calls;
+	    },
+	    {cache.appMiddleware ("/feed")});
+	app.router().freeze();
+
+	httplib::Response first;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/feed"), first));
+	const std::string tag = first.get_header_value ("ETag");
+	ASSERT_FALSE (tag.empty());
+
+	auto request = makeRequest ("GET", "/feed");
+	request.headers.emplace ("If-None-Match", "\"other\", W/" + tag);
+	httplib::Response second;
+	ASSERT_TRUE (app.dispatch (request, second));
+	EXPECT_EQ (second.status, 304);
+	EXPECT_TRUE (second.body.empty());
+	EXPECT_EQ (second.get_header_value ("ETag"), tag);
+	EXPECT_EQ (calls, 1);
+	EXPECT_EQ (cache.stats().notModified, 1u);
+
+	// The HEAD route shares the key of the GET one, so it is answered from the GET response
+	httplib::Response head;
+	ASSERT_TRUE (app.dispatch (makeRequest ("HEAD", "/feed"), head));
+	EXPECT_EQ (head.status, 200);
+	EXPECT_EQ (head.get_header_value ("ETag"), tag);
+	EXPECT_EQ (calls, 1);
+}
+
+TEST_F (HttplibAppTest, ResponseCacheKeepsHostPartitionsApart)
+{
+	ResponseCache cache;
+	int calls = 0;
+
+	HttplibApp app (default_config);
+	const auto serve = [&calls] (std::string body)
+	{
+		return [&calls, body = std::move (body)] (Ctx &ctx)
+		{
+			++calls;
+			ctx.status (200).send (body);
+		};
+	};
+	app.get ("/feed", serve ("default"), {cache.appMiddleware ("/feed")});
+	app.scope ("a.example.com").get ("/feed", serve ("tenant a"), {cache.appMiddleware ("/feed")});
+	app.scope ("b.example.com").get ("/feed", serve ("tenant b"), {cache.appMiddleware ("/feed")}).scope ({});
+	app.router().freeze();
+	app.router ("a.example.com").freeze();
+	app.router ("b.example.com").freeze();
+
+	auto dispatchAs = [&app] (std::string host)
+	{
+		auto request = makeRequest ("GET", "/feed");
+		request.headers.emplace ("Host", std::move (host));
+		httplib::Response response;
+		EXPECT_TRUE (app.dispatch (request, response));
+		return response.body;
+	};
+
+	// Same pattern in three routers: one entry each
+	EXPECT_EQ (dispatchAs ("a.example.com"), "tenant a");
+	EXPECT_EQ (dispatchAs ("b.example.com"), "tenant b");
+	EXPECT_EQ (dispatchAs ("other.example.com"), "default");
+	EXPECT_EQ (calls, 3);
+	EXPECT_EQ (cache.size(), 3u);
+
+	EXPECT_EQ (dispatchAs ("A.example.com:8080"), "tenant a");
+	EXPECT_EQ (dispatchAs ("b.example.com"), "tenant b");
+	EXPECT_EQ (calls, 3);
+
+	EXPECT_EQ (cache.invalidate ("/feed"), 3u);
+}
+
+TEST_F (HttplibAppTest, ResponseCacheKeysDoNotMixValuesHoldingNul)
+{
+	ResponseCache cache (ResponseCacheConfig {.capacity      = 16,
+	                                          .max_body_size = 1 << 20,
+	                                          .ttl           = std::chrono::milliseconds (60'000),
+	                                          .query_keys    = {"a", "b"}});
+	int calls = 0;
+
+	HttplibApp app (default_config);
+	app.get (
+	    "/pair",
+	    [&calls] (Ctx &ctx)
+	    {
+		    ++calls;
+		    ctx.status (200).send (std::to_string (calls));
+	    },
+	    {cache.appMiddleware ("/pair")});
+	app.router().freeze();
+
+	auto dispatchWith = [&app] (std::string a, std::string b)
+	{
+		auto request = makeRequest ("GET", "/pair");
+		request.params.emplace ("a", std::move (a));
+		request.params.emplace ("b", std::move (b));
+		httplib::Response response;
+		EXPECT_TRUE (app.dispatch (request, response));
+		return response.body;
+	};
+
+	// Decoded values may hold NUL: "x\0y" + "z" must not share a key with "x" + "y\0z"
+	EXPECT_EQ (dispatchWith (std::string ("x\0y", 3), "z"), "1");
+	EXPECT_EQ (dispatchWith ("x", std::string ("y\0z", 3)), "2");
+	EXPECT_EQ (dispatchWith (std::string ("x\0y", 3), "z"), "1");
+	EXPECT_EQ (calls, 2);
+	EXPECT_EQ (cache.size(), 2u);
+}
+
+TEST_F (HttplibAppTest, ResponseCacheSkipsUncacheableResponses)
+{
+	ResponseCache cache (ResponseCacheConfig {.capacity      = 16,
+	                                          .max_body_size = 4,
+	                                          .ttl           = std::chrono::milliseconds (60'000),
+	                                          .query_keys    = {"page"}});
+	int calls = 0;
+
+	HttplibApp app (default_config);
+	app.get (
+	    "/items",
+	    [&calls] (Ctx &ctx)
+	    {
+		    ++calls;
+		    ctx.status (200).send (ctx.query ("page"));
+	    },
+	    {cache.appMiddleware ("/items")});
+	app.get (
+	    "/private",
+	    [&calls] (Ctx &ctx)
+	    {
+		    ++calls;
+		    ctx.status (200).setHeader ("Cache-Control", "Private, max-age=0").send ("me");
+	    },
+	    {cache.appMiddleware ("/private")});
+	app.get (
+	    "/large",
+	    [&calls] (Ctx &ctx)
+	    {
+		    ++calls;
+		    ctx.status (200).send ("too large");
+	    },
+	    {cache.appMiddleware ("/large")});
+	app.get (
+	    "/missing",
+	    [&calls] (Ctx &ctx)
+	    {
+		    ++calls;
+		    ctx.status (404);
+	    },
+	    {cache.appMiddleware ("/missing")});
+	app.router().freeze();
+
+	for (int i = 0; i < 2; ++i)
+	{
+		for (const char *path : {"/private", "/large", "/missing"})
+		{
+			httplib::Response response;
+			ASSERT_TRUE (app.dispatch (makeRequest ("GET", path), response));
+		}
+	}
+	EXPECT_EQ (calls, 6);
+	EXPECT_EQ (cache.size(), 0u);
+
+	// Query keys are part of the key
+	for (const char *page : {"1", "2", "1"})
+	{
+		auto request = makeRequest ("GET", "/items");
+		request.params.emplace ("page", page);
+		httplib::Response response;
+		ASSERT_TRUE (app.dispatch (request, response));
+		EXPECT_EQ (response.body, page);
+	}
+	EXPECT_EQ (calls, 8);
+}
+
+TEST_F (HttplibAppTest, ResponseCacheExpiresEntries)
+{
+	ResponseCache cache (ResponseCacheConfig {.capacity      = 1024,
+	                                          .max_body_size = 1 << 20,
+	                                          .ttl           = std::chrono::milliseconds (1),
+	                                          .query_keys    = {}});
+	int calls = 0;
+
+	HttplibApp app (default_config);
+	app.get (
+	    "/now",
+	    [&calls] (Ctx &ctx)
+	    {
+		    ++calls;
+		    ctx.status (200).send ("now");
+	    },
+	    {cache.appMiddleware ("/now")});
+	app.router().freeze();
+
+	for (int i = 0; i < 2; ++i)
+	{
+		httplib::Response response;
+		ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/now"), response));
+		std::this_thread::sleep_for (std::chrono::milliseconds (5));
+	}
+	EXPECT_EQ (calls, 2);
+}
+
+// ============================================================================
+// JWT auth Tests
+// ============================================================================
+
+namespace
+{
+	class JwtAuthTest : public HttplibAppTest
+	{
+		protected:
+			jwt::FakeCryptoProvider crypto;
+			jwt::FakeJsonProvider json;
+			jwt::Jwt engine {crypto, json};
+			CoarseClock clock;
+
+			void SetUp () override
+			{
+				HttplibAppTest::SetUp();
+				ASSERT_EQ (engine.generateKeyPair ("k-auth", jwt::JwtAlg::HS256).code, jwt::ErrorCode::Ok);
+				ASSERT_EQ (engine.generateKeyPair ("k-other", jwt::JwtAlg::HS256).code, jwt::ErrorCode::Ok);
+			}
+
+			std::string sign (std::string kid, int64_t expiresIn = 3600) const
+			{
+				std::string token;
+				EXPECT_EQ (engine.token()
+				               .kid (std::move (kid))
+				               .subject ("user-1")
+				               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + expiresIn)
+				               .sign (token)
+				               .code,
+				           jwt::ErrorCode::Ok);
+				return token;
+			}
+
+			static jwt::Policy allowing (jwt::JwtAlg alg)
+			{
+				jwt::Policy policy;
+				policy.allowedAlgs = {alg};
+				return policy;
+			}
+
+			static httplib::Request withToken (std::string path, const std::string &token)
+			{
+				auto request = makeRequest ("GET", std::move (path));
+				request.headers.emplace ("Authorization", "Bearer " + token);
+				return request;
+			}
+	};
+}    // namespace
+
+TEST_F (JwtAuthTest, AuthenticatedRequestsReadTheClaimsInPlace)
+{
+	JwtAuth auth (engine, clock);
+
+	HttplibApp app (default_config);
+	app.get (
+	    "/me",
+	    [] (Ctx &ctx)
+	    {
+		    ASSERT_NE (ctx.auth(), nullptr);
+		    EXPECT_EQ (ctx.auth()->rawToken().data(), ctx.header ("Authorization").data() + 7);
+		    ctx.status (200).send (ctx.auth()->subject().value_or (""));
+	    },
+	    {auth.middleware (allowing (jwt::JwtAlg::HS256), "k-auth")});
+	app.get ("/public",
+	         [] (Ctx &ctx)
+	         {
+		         EXPECT_EQ (ctx.auth(), nullptr);
+		         ctx.status (200);
+	         });
+	app.router().freeze();
+
+	httplib::Response response;
+	ASSERT_TRUE (app.dispatch (withToken ("/me", sign ("k-auth")), response));
+	EXPECT_EQ (response.status, 200);
+	EXPECT_EQ (response.body, "user-1");
+
+	// The pooled context forgets the token with the request
+	httplib::Response open;
+	ASSERT_TRUE (app.dispatch (withToken ("/public", sign ("k-auth")), open));
+	EXPECT_EQ (open.status, 200);
+}
+
+TEST_F (JwtAuthTest, RejectedRequestsGetUnauthorized)
+{
+	JwtAuth auth (engine, clock);
+	int calls = 0;
+
+	HttplibApp app (default_config);
+	RouteInfo &route = app.router().add (HttpMethod::GET, "/admin",
+	                                     [&calls] (ICtx &)
+	                                     {
+		                                     ++calls;
+	                                     });
+	app.use (route, auth.middleware (allowing (jwt::JwtAlg::HS256), "k-auth"));
+	app.get (
+	    "/es256",
+	    [&calls] (Ctx &)
+	    {
+		    ++calls;
+	    },
+	    {auth.middleware (allowing (jwt::JwtAlg::ES256))});
+	app.router().freeze();
+
+	httplib::Response missing;
+	ASSERT_TRUE (app.dispatch (makeRequest ("GET", "/admin"), missing));
+	EXPECT_EQ (missing.status, 401);
+	EXPECT_EQ (missing.get_header_value ("WWW-Authenticate"), "Bearer");
+
+	auto basic = makeRequest ("GET", "/admin");
+	basic.headers.emplace ("Authorization", "Basic dXNlcjpwYXNz");
+	httplib::Response basicResponse;
+	ASSERT_TRUE (app.dispatch (basic, basicResponse));
+	EXPECT_EQ (basicResponse.status, 401);
+
+	for (const auto &[path, token] : std::vector<std::pair<std::string, std::string>> {
+	         {"/admin", sign ("k-other")}, {"/admin", sign ("k-auth", -3600)}, {"/es256", sign ("k-auth")}})
+	{
+		httplib::Response response;
+		ASSERT_TRUE (app.dispatch (withToken (path, token), response));
+		EXPECT_EQ (response.status, 401) << path;
+		EXPECT_EQ (response.get_header_value ("WWW-Authenticate"), "Bearer error=\"invalid_token\"") << path;
+	}
+	EXPECT_EQ (calls, 0);
+
+	httplib::Response accepted;
+	ASSERT_TRUE (app.dispatch (withToken ("/admin", sign ("k-auth")), accepted));
+	EXPECT_EQ (calls, 1);
+}
+
+TEST_F (JwtAuthTest, PinnedKeyHandlesAreResolvedWhenTheMiddlewareIsBuilt)
+{
+	JwtAuth auth (engine, clock);
+	const std::string token = sign ("k-auth");
+
+	// A key change retires the handle cached by signing
+	ASSERT_EQ (engine.generateKeyPair ("k-auth", jwt::JwtAlg::HS256).code, jwt::ErrorCode::Ok);
+	crypto.resolveCalls = 0;
+
+	HttplibApp app (default_config);
+	app.get (
+	    "/me",
+	    [] (Ctx &ctx)
+	    {
+		    ctx.status (200);
+	    },
+	    {auth.middleware (allowing (jwt::JwtAlg::HS256), "k-auth")});
+	app.router().freeze();
+	EXPECT_EQ (crypto.resolveCalls.load(), 1);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		httplib::Response response;
+		ASSERT_TRUE (app.dispatch (withToken ("/me", token), response));
+		EXPECT_EQ (response.status, 200);
+	}
+	EXPECT_EQ (crypto.resolveCalls.load(), 1);
+
+	// Retired with the key: the engine cache resolves the new one
+	ASSERT_EQ (engine.generateKeyPair ("k-auth", jwt::JwtAlg::HS256).code, jwt::ErrorCode::Ok);
+	httplib::Response rotated;
+	ASSERT_TRUE (app.dispatch (withToken ("/me", token), rotated));
+	EXPECT_EQ (rotated.status, 200);
+	EXPECT_EQ (crypto.resolveCalls.load(), 2);
+}
@@ -6,7 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include "AllocationCounter.h"
 #include "Jwt.h"
+#include "JwtJsonProvider.h"
 #include "JwtTestProviders.h"
 #include "TestUtils.h"
 
@@ -14,7 +16,10 @@
 #include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 namespace ipb::http::jwt
 {
@@ -109,6 +114,432 @@ namespace ipb::http::jwt
 		EXPECT_FALSE (verifier.ok());
 	}
 
+	/**
+	 * Verifies the zero-copy path.
+	 * The signature is checked over the "header.payload" prefix of the
+	 * caller's token, and a borrowing verifier views that same token.
+	 */
+	TEST_F (JwtTester, VerifyBorrowsTokenAndSignsOverItsPrefix)
+	{
+		std::string token;
+		ASSERT_EQ (jwt.token()
+		               .kid (kKid)
+		               .subject ("user-1")
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 3600)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+
+		Verifier verifier;
+		ASSERT_EQ (jwt.verify (token, verifier, TokenStorage::Borrow).code, ErrorCode::Ok);
+
+		const auto signingInputSize = token.rfind ('.');
+		EXPECT_EQ (reinterpret_cast<const char *> (crypto.lastVerifyData.load()), token.data());
+		EXPECT_EQ (crypto.lastVerifySize.load(), signingInputSize);
+		EXPECT_EQ (verifier.rawToken().data(), token.data());
+		EXPECT_EQ (verifier.claimString ("sub").value_or (""), "user-1");
+		EXPECT_FALSE (verifier.rawHeaderJson().empty());
+		EXPECT_FALSE (verifier.rawPayloadJson().empty());
+	}
+
+	/**
+	 * Verifies the default (copying) storage and verifier reuse.
+	 * The verifier outlives the token it verified, and verifying another
+	 * token into it replaces the previous result, including on failure.
+	 */
+	TEST_F (JwtTester, VerifierCopiesTokenAndCanBeReused)
+	{
+		const int64_t exp = static_cast<int64_t> (std::time (nullptr)) + 3600;
+		Verifier verifier;
+		std::string firstHeader;
+		{
+			std::string token;
+			ASSERT_EQ (jwt.token().kid (kKid).subject ("first").expiresAt (exp).sign (token).code, ErrorCode::Ok);
+			ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+			EXPECT_NE (verifier.rawToken().data(), token.data());
+			firstHeader = std::string (verifier.rawHeaderJson());
+			token.assign (token.size(), 'x');
+		}
+		EXPECT_NE (verifier.rawToken().find ('.'), std::string_view::npos);
+
+		std::string second;
+		ASSERT_EQ (jwt.token().kid (kKid).subject ("second").expiresAt (exp).sign (second).code, ErrorCode::Ok);
+		ASSERT_EQ (jwt.verify (second, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (verifier.claimString ("sub").value_or (""), "second");
+		EXPECT_EQ (verifier.rawHeaderJson(), firstHeader);
+
+		Verifier copy = verifier;
+		EXPECT_EQ (copy.rawToken(), second);
+		EXPECT_EQ (copy.rawPayloadJson(), verifier.rawPayloadJson());
+
+		EXPECT_EQ (jwt.verify ("not-a-token", verifier).code, ErrorCode::InvalidFormat);
+		EXPECT_FALSE (verifier.ok());
+		EXPECT_FALSE (verifier.hasClaim ("sub"));
+	}
+
+	/**
+	 * Verifies registered-claim access.
+	 * Registered claims are indexed when the token is decoded: the accessors,
+	 * claimView and claimInt read them without allocating, and copies keep them.
+	 */
+	TEST_F (JwtTester, RegisteredClaimsAreIndexedOnDecode)
+	{
+		const int64_t now = static_cast<int64_t> (std::time (nullptr));
+		std::string token;
+		ASSERT_EQ (jwt.token()
+		               .kid (kKid)
+		               .claim ("role", "admin")
+		               .issuer ("auth0")
+		               .subject ("a-subject-longer-than-the-small-string-buffer")
+		               .audience ("api")
+		               .jwtId ("id-1")
+		               .issuedAt (now)
+		               .expiresAt (now + 3600)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+
+		Verifier verifier;
+		ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+
+		{
+			testutil::AllocationCounter counter;
+			EXPECT_EQ (verifier.issuer(), "auth0");
+			EXPECT_EQ (verifier.subject(), "a-subject-longer-than-the-small-string-buffer");
+			EXPECT_EQ (verifier.audience(), "api");
+			EXPECT_EQ (verifier.jwtId(), "id-1");
+			EXPECT_EQ (verifier.issuedAt(), now);
+			EXPECT_EQ (verifier.expiresAt(), now + 3600);
+			EXPECT_FALSE (verifier.notBefore().has_value());
+			EXPECT_EQ (verifier.claimView ("role"), "admin");
+			EXPECT_EQ (verifier.claimInt ("exp"), now + 3600);
+			EXPECT_TRUE (verifier.hasClaim ("sub"));
+			EXPECT_EQ (verifier.claim ("missing"), nullptr);
+			EXPECT_EQ (counter.count(), 0u);
+		}
+
+		Verifier copy = verifier;
+		EXPECT_EQ (copy.subject(), verifier.subject());
+		EXPECT_NE (copy.subject()->data(), verifier.subject()->data());
+
+		// Reusing the verifier re-indexes it
+		std::string other;
+		ASSERT_EQ (jwt.token().kid (kKid).expiresAt (now + 60).sign (other).code, ErrorCode::Ok);
+		ASSERT_EQ (jwt.verify (other, verifier).code, ErrorCode::Ok);
+		EXPECT_FALSE (verifier.subject().has_value());
+		EXPECT_EQ (verifier.expiresAt(), now + 60);
+	}
+
+	/**
+	 * Verifies integer claims given as doubles.
+	 * An integral double is read as an integer only within the int64 range:
+	 * a far larger exp is not a valid expiry, and the token is rejected.
+	 */
+	TEST_F (JwtTester, DoubleTimeClaimsOutOfRangeAreNotIntegers)
+	{
+		std::string token;
+		ASSERT_EQ (jwt.token().kid (kKid).claim ("exp", ClaimValue {1e300}).sign (token).code, ErrorCode::Ok);
+
+		Verifier verifier;
+		EXPECT_EQ (jwt.verify (token, verifier).code, ErrorCode::PolicyViolation);
+		EXPECT_FALSE (verifier.expiresAt().has_value());
+
+		const double inRange = 4.1e9;
+		ASSERT_EQ (jwt.token().kid (kKid).claim ("exp", ClaimValue {inRange}).sign (token).code, ErrorCode::Ok);
+		ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (verifier.expiresAt(), int64_t {4100000000});
+	}
+
+	/**
+	 * Verifies the verified-token cache.
+	 * The second verification of the same token is served from the cache
+	 * (no signature check), into a borrowing or copying verifier alike.
+	 */
+	TEST_F (JwtTester, VerifiedCacheSkipsSignatureCheck)
+	{
+		options.verifiedCacheCapacity = 64;
+		jwt.setOptions (options);
+
+		std::string token;
+		ASSERT_EQ (jwt.token()
+		               .kid (kKid)
+		               .subject ("cached")
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 3600)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+
+		crypto.verifyCalls = 0;
+		Verifier first;
+		ASSERT_EQ (jwt.verify (token, first, TokenStorage::Borrow).code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.verifyCalls.load(), 1);
+		EXPECT_EQ (jwt.cachedTokenCount(), 1u);
+
+		Verifier second;
+		ASSERT_EQ (jwt.verify (token, second).code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.verifyCalls.load(), 1);
+		EXPECT_TRUE (second.ok());
+		EXPECT_EQ (second.claimString ("sub").value_or (""), "cached");
+		EXPECT_EQ (second.rawToken(), token);
+		EXPECT_NE (second.rawToken().data(), token.data());
+
+		Verifier borrowed;
+		ASSERT_EQ (jwt.verify (token, borrowed, TokenStorage::Borrow).code, ErrorCode::Ok);
+		EXPECT_EQ (borrowed.rawToken().data(), token.data());
+		EXPECT_EQ (crypto.verifyCalls.load(), 1);
+	}
+
+	/**
+	 * Verifies cache invalidation.
+	 * Changing a key drops the entries verified with its kid, tampered
+	 * tokens never hit, and setOptions empties the cache.
+	 */
+	TEST_F (JwtTester, VerifiedCacheIsInvalidatedByKeyChanges)
+	{
+		options.verifiedCacheCapacity = 64;
+		jwt.setOptions (options);
+
+		std::string token;
+		ASSERT_EQ (jwt.token()
+		               .kid (kKid)
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 3600)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+
+		Verifier verifier;
+		ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+
+		std::string tampered = token;
+		tampered.back()      = (tampered.back() == 'A') ? 'B' : 'A';
+		EXPECT_EQ (jwt.verify (tampered, verifier).code, ErrorCode::SignatureMismatch);
+		EXPECT_EQ (jwt.cachedTokenCount(), 1u);
+
+		jwt.setOptions (options);
+		EXPECT_EQ (jwt.cachedTokenCount(), 0u);
+
+		// A failed key change purges the entries too (the provider may have dropped the key)
+		ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (jwt.cachedTokenCount(), 1u);
+		EXPECT_EQ (jwt.loadPublicKeyFromJwk (kKid, "").code, ErrorCode::CryptoError);
+		EXPECT_EQ (jwt.cachedTokenCount(), 0u);
+
+		ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		ASSERT_EQ (jwt.removeKey (kKid).code, ErrorCode::Ok);
+		EXPECT_EQ (jwt.cachedTokenCount(), 0u);
+		EXPECT_EQ (jwt.verify (token, verifier).code, ErrorCode::KeyNotFound);
+	}
+
+	/**
+	 * Verifies the leeway near the end of the time range.
+	 * An exp close to INT64_MAX plus the leeway saturates instead of
+	 * wrapping around into an expired token, on fresh and cached tokens.
+	 */
+	TEST_F (JwtTester, LeewayDoesNotOverflowFarExpiry)
+	{
+		options.policy.leewaySeconds  = 60;
+		options.verifiedCacheCapacity = 16;
+		jwt.setOptions (options);
+
+		std::string token;
+		ASSERT_EQ (jwt.token().kid (kKid).expiresAt (std::numeric_limits<int64_t>::max() - 1).sign (token).code,
+		           ErrorCode::Ok);
+
+		crypto.verifyCalls = 0;
+		Verifier verifier;
+		EXPECT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.verifyCalls.load(), 1);
+	}
+
+	/**
+	 * Verifies the cache bound.
+	 * Verifying more distinct tokens than the capacity evicts the least
+	 * recently used entries instead of growing the cache.
+	 */
+	TEST_F (JwtTester, VerifiedCacheIsBounded)
+	{
+		options.verifiedCacheCapacity = 4;
+		jwt.setOptions (options);
+
+		const int64_t now = static_cast<int64_t> (std::time (nullptr));
+		for (int i = 0; i < 10; ++i)
+		{
+			std::string token;
+			ASSERT_EQ (jwt.token().kid (kKid).claim ("n", int64_t {i}).expiresAt (now + 3600).sign (token).code,
+			           ErrorCode::Ok);
+			Verifier verifier;
+			ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		}
+		EXPECT_EQ (jwt.cachedTokenCount(), 4u);
+	}
+
+	/**
+	 * Verifies batch verification.
+	 * Signature checks are grouped per kid into one provider call each,
+	 * and every verifier gets its own result (including the failures).
+	 */
+	TEST_F (JwtTester, VerifyBatchGroupsSignatureChecksByKid)
+	{
+		ASSERT_EQ (jwt.generateKeyPair ("k-second", JwtAlg::HS256).code, ErrorCode::Ok);
+
+		const int64_t exp = static_cast<int64_t> (std::time (nullptr)) + 3600;
+		std::vector<std::string> storage;
+		for (int i = 0; i < 5; ++i)
+		{
+			std::string token;
+			ASSERT_EQ (jwt.token()
+			               .kid (i % 2 == 0 ? kKid : "k-second")
+			               .claim ("n", int64_t {i})
+			               .expiresAt (exp)
+			               .sign (token)
+			               .code,
+			           ErrorCode::Ok);
+			storage.push_back (std::move (token));
+		}
+		storage.push_back ("malformed");
+		storage.push_back (storage [0]);
+		storage.back().back() = (storage.back().back() == 'A') ? 'B' : 'A';
+
+		std::vector<std::string_view> tokens (storage.begin(), storage.end());
+		std::vector<Verifier> verifiers (tokens.size());
+
+		crypto.verifyBatchCalls = 0;
+		crypto.verifyCalls      = 0;
+		ASSERT_EQ (jwt.verifyBatch (tokens, verifiers).code, ErrorCode::Ok);
+
+		EXPECT_EQ (crypto.verifyBatchCalls.load(), 2);
+		EXPECT_EQ (crypto.verifyCalls.load(), 6);
+		for (int i = 0; i < 5; ++i)
+		{
+			EXPECT_TRUE (verifiers [i].ok()) << i;
+			EXPECT_EQ (verifiers [i].claimInt ("n").value_or (-1), i);
+		}
+		EXPECT_EQ (verifiers [5].error().code, ErrorCode::InvalidFormat);
+		EXPECT_EQ (verifiers [6].error().code, ErrorCode::SignatureMismatch);
+
+		std::vector<Verifier> tooFew (1);
+		EXPECT_EQ (jwt.verifyBatch (tokens, tooFew).code, ErrorCode::InvalidFormat);
+	}
+
+	/**
+	 * Verifies that batches use the verified-token cache.
+	 * Tokens already verified are served from the cache and never reach
+	 * the provider again.
+	 */
+	TEST_F (JwtTester, VerifyBatchSkipsCachedTokens)
+	{
+		options.verifiedCacheCapacity = 16;
+		jwt.setOptions (options);
+
+		std::string token;
+		ASSERT_EQ (jwt.token()
+		               .kid (kKid)
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 3600)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+
+		std::vector<std::string_view> tokens {token, token};
+		std::vector<Verifier> verifiers (2);
+		ASSERT_EQ (jwt.verifyBatch (tokens, verifiers).code, ErrorCode::Ok);
+		EXPECT_TRUE (verifiers [0].ok());
+		EXPECT_TRUE (verifiers [1].ok());
+
+		crypto.verifyBatchCalls = 0;
+		ASSERT_EQ (jwt.verifyBatch (tokens, verifiers, TokenStorage::Borrow).code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.verifyBatchCalls.load(), 0);
+		EXPECT_TRUE (verifiers [0].ok());
+		EXPECT_EQ (verifiers [1].rawToken().data(), token.data());
+	}
+
+	/**
+	 * Verifies the concurrent mode.
+	 * Worker threads keep verifying while options are replaced and other
+	 * keys are created and removed; every verification must succeed.
+	 */
+	TEST_F (JwtTester, ConcurrentVerifyWhileKeysAndOptionsChange)
+	{
+		std::string token;
+		ASSERT_EQ (jwt.token()
+		               .kid (kKid)
+		               .subject ("concurrent")
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 3600)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+
+		std::atomic<bool> stop {false};
+		std::atomic<int> failures {0};
+		std::vector<std::thread> workers;
+		for (int i = 0; i < 4; ++i)
+		{
+			workers.emplace_back (
+			    [&]
+			    {
+				    Verifier verifier;
+				    std::string signedToken;
+				    while (!stop.load())
+				    {
+					    if (jwt.verify (token, verifier).code != ErrorCode::Ok
+					        || verifier.claimString ("sub").value_or ("") != "concurrent")
+					    {
+						    ++failures;
+					    }
+					    if (jwt.token().kid (kKid).subject ("worker").sign (signedToken).code != ErrorCode::Ok)
+					    {
+						    ++failures;
+					    }
+				    }
+			    });
+		}
+
+		for (int i = 0; i < 200; ++i)
+		{
+			EngineOptions next;
+			next.verifiedCacheCapacity = (i % 2 == 0) ? 64 : 0;
+			jwt.setOptions (next);
+			ASSERT_EQ (jwt.generateKeyPair ("k-rotating", JwtAlg::HS256).code, ErrorCode::Ok);
+			ASSERT_EQ (jwt.removeKey ("k-rotating").code, ErrorCode::Ok);
+		}
+
+		stop = true;
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+		EXPECT_EQ (failures.load(), 0);
+	}
+
+	/**
+	 * Verifies that the threading mode cannot change after construction.
+	 * A single-threaded engine keeps skipping synchronization even if
+	 * later options ask for thread safety.
+	 */
+	TEST_F (JwtTester, ThreadSafeModeIsFixedAtConstruction)
+	{
+		EngineOptions singleThreaded;
+		singleThreaded.threadSafe            = false;
+		singleThreaded.verifiedCacheCapacity = 8;
+		Jwt local {crypto, json, singleThreaded};
+		EXPECT_FALSE (local.options().threadSafe);
+
+		EngineOptions next;
+		next.threadSafe = true;
+		local.setOptions (next);
+		EXPECT_FALSE (local.options().threadSafe);
+
+		std::string token;
+		ASSERT_EQ (local.token()
+		               .kid (kKid)
+		               .expiresAt (static_cast<int64_t> (std::time (nullptr)) + 3600)
+		               .sign (token)
+		               .code,
+		           ErrorCode::Ok);
+		Verifier verifier;
+		EXPECT_EQ (local.verify (token, verifier).code, ErrorCode::Ok);
+	}
+
 	/**
 	 * Verifies issuer policy enforcement.
 	 * A token signed correctly but with an unexpected issuer must be
@@ -127,6 +558,45 @@ namespace ipb::http::jwt
 		EXPECT_EQ (verifyError.code, ErrorCode::InvalidIssuer);
 	}
 
+	/**
+	 * Verifies compiled policies.
+	 * The algorithm mask and the pinned kid are checked on fresh and on
+	 * cached tokens, and expiry uses the time given by the caller.
+	 */
+	TEST_F (JwtTester, VerifyWithCompiledPolicy)
+	{
+		options.verifiedCacheCapacity = 16;
+		jwt.setOptions (options);
+
+		const int64_t now = static_cast<int64_t> (std::time (nullptr));
+		std::string token;
+		ASSERT_EQ (jwt.token().alg (JwtAlg::HS256).kid (kKid).expiresAt (now + 60).sign (token).code, ErrorCode::Ok);
+
+		Policy hsOnly;
+		hsOnly.allowedAlgs = {JwtAlg::HS256};
+		Policy rsOrEs;
+		rsOrEs.allowedAlgs = {JwtAlg::RS256, JwtAlg::ES256};
+
+		const CompiledPolicy hs256  = compilePolicy (hsOnly, kKid);
+		const CompiledPolicy rs256  = compilePolicy (rsOrEs);
+		const CompiledPolicy pinned = compilePolicy (Policy {}, "k-other");
+		EXPECT_EQ (hs256.algMask, algBit (JwtAlg::HS256));
+		EXPECT_EQ (pinned.algMask, 0xFF);
+
+		// Twice: the second time the token comes from the verified-token cache
+		for (int i = 0; i < 2; ++i)
+		{
+			Verifier verifier;
+			EXPECT_EQ (jwt.verify (token, verifier, hs256, now).code, ErrorCode::Ok);
+			EXPECT_EQ (jwt.verify (token, verifier, rs256, now).code, ErrorCode::UnsupportedAlg);
+			EXPECT_EQ (jwt.verify (token, verifier, pinned, now).code, ErrorCode::KeyNotFound);
+		}
+		EXPECT_EQ (jwt.cachedTokenCount(), 1u);
+
+		Verifier late;
+		EXPECT_EQ (jwt.verify (token, late, hs256, now + 120).code, ErrorCode::Expired);
+	}
+
 	/**
 	 * Verifies key lifecycle behavior.
 	 * Once the signing key is removed, previously signed tokens can no
@@ -144,6 +614,103 @@ namespace ipb::http::jwt
 		EXPECT_EQ (verifyError.code, ErrorCode::KeyNotFound);
 	}
 
+	/**
+	 * Verifies key handle caching.
+	 * The kid is resolved once and its handle reused by sign and verify;
+	 * a key change retires it, and unknown kids are never cached.
+	 */
+	TEST_F (JwtTester, KeyHandlesAreResolvedOncePerKid)
+	{
+		std::string token;
+		crypto.resolveCalls = 0;
+		const int64_t exp = static_cast<int64_t> (std::time (nullptr)) + 3600;
+		ASSERT_EQ (jwt.token().kid (kKid).subject ("handle").expiresAt (exp).sign (token).code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.resolveCalls.load(), 1);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			Verifier verifier;
+			ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		}
+		EXPECT_EQ (crypto.resolveCalls.load(), 1);
+
+		std::shared_ptr<const KeyHandle> pinned;
+		ASSERT_EQ (jwt.resolveKey (kKid, JwtAlg::HS256, pinned).code, ErrorCode::Ok);
+		EXPECT_EQ (pinned->kid(), kKid);
+		EXPECT_FALSE (pinned->retired());
+
+		ASSERT_EQ (jwt.generateKeyPair (kKid, JwtAlg::HS256).code, ErrorCode::Ok);
+		EXPECT_TRUE (pinned->retired());
+
+		Verifier verifier;
+		ASSERT_EQ (jwt.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.resolveCalls.load(), 2);
+
+		std::string unknown;
+		ASSERT_EQ (jwt.generateKeyPair ("k-gone", JwtAlg::HS256).code, ErrorCode::Ok);
+		ASSERT_EQ (jwt.token().kid ("k-gone").expiresAt (exp).sign (unknown).code, ErrorCode::Ok);
+		ASSERT_EQ (jwt.removeKey ("k-gone").code, ErrorCode::Ok);
+		crypto.resolveCalls = 0;
+		for (int i = 0; i < 2; ++i)
+		{
+			EXPECT_EQ (jwt.verify (unknown, verifier).code, ErrorCode::KeyNotFound);
+		}
+		EXPECT_EQ (crypto.resolveCalls.load(), 2);
+	}
+
+	/**
+	 * Verifies that batches share the key handle cache.
+	 * Each (alg, kid) group resolves its handle once and later batches and
+	 * single verifications reuse it; a group without a valid signature
+	 * caches nothing, and a group of an unknown kid fails every token.
+	 */
+	TEST_F (JwtTester, VerifyBatchResolvesOneHandlePerGroup)
+	{
+		ASSERT_EQ (jwt.generateKeyPair ("k-second", JwtAlg::HS256).code, ErrorCode::Ok);
+		ASSERT_EQ (jwt.generateKeyPair ("k-forged", JwtAlg::HS256).code, ErrorCode::Ok);
+
+		const int64_t exp = static_cast<int64_t> (std::time (nullptr)) + 3600;
+		std::vector<std::string> storage;
+		for (const char *kid : {kKid, "k-second", kKid, "k-second", "k-forged"})
+		{
+			std::string token;
+			ASSERT_EQ (jwt.token().kid (kid).expiresAt (exp).sign (token).code, ErrorCode::Ok);
+			storage.push_back (std::move (token));
+		}
+		storage.back().back() = (storage.back().back() == 'A') ? 'B' : 'A';
+		std::vector<std::string_view> tokens (storage.begin(), storage.end());
+		std::vector<Verifier> verifiers (tokens.size());
+
+		// Signing cached the three handles: key changes retire them
+		for (const char *kid : {kKid, "k-second", "k-forged"})
+		{
+			ASSERT_EQ (jwt.generateKeyPair (kid, JwtAlg::HS256).code, ErrorCode::Ok);
+		}
+		crypto.resolveCalls = 0;
+		for (int round = 0; round < 2; ++round)
+		{
+			ASSERT_EQ (jwt.verifyBatch (tokens, verifiers).code, ErrorCode::Ok);
+			for (size_t i = 0; i < 4; ++i)
+			{
+				EXPECT_TRUE (verifiers [i].ok()) << i;
+			}
+			EXPECT_EQ (verifiers [4].error().code, ErrorCode::SignatureMismatch);
+		}
+		EXPECT_EQ (crypto.resolveCalls.load(), 4);
+
+		Verifier single;
+		ASSERT_EQ (jwt.verify (tokens [1], single).code, ErrorCode::Ok);
+		EXPECT_EQ (crypto.resolveCalls.load(), 4);
+
+		ASSERT_EQ (jwt.removeKey ("k-second").code, ErrorCode::Ok);
+		crypto.resolveCalls = 0;
+		ASSERT_EQ (jwt.verifyBatch (tokens, verifiers).code, ErrorCode::Ok);
+		EXPECT_TRUE (verifiers [0].ok());
+		EXPECT_EQ (verifiers [1].error().code, ErrorCode::KeyNotFound);
+		EXPECT_EQ (verifiers [3].error().code, ErrorCode::KeyNotFound);
+		EXPECT_EQ (crypto.resolveCalls.load(), 2);
+	}
+
 	/**
 	 * Verifies that PEM persistence methods are callable and succeed
 	 * for a key that is already available in the Jwt instance.
@@ -242,4 +809,123 @@ namespace ipb::http::jwt
 		std::filesystem::remove (pubPath, ec);
 	}
 
+	TEST (SigningTemplateTest, SignsTheSameTokensAsTheBuilder)
+	{
+		FakeCryptoProvider crypto;
+		JwtJsonProvider json;
+		Jwt engine {crypto, json};
+		ASSERT_EQ (engine.generateKeyPair ("k-template", JwtAlg::HS256).code, ErrorCode::Ok);
+
+		ClaimMap fixed;
+		fixed ["iss"]   = std::string ("auth0");
+		fixed ["scope"] = std::string ("read write");
+		const SigningTemplate signer = engine.signingTemplate (JwtAlg::HS256, "k-template", fixed);
+		ASSERT_EQ (signer.error().code, ErrorCode::Ok);
+
+		const int64_t now = static_cast<int64_t> (std::time (nullptr));
+		std::string token;
+		ASSERT_EQ (signer.sign ({.subject = "user \"1\"", .expiresAt = now + 60, .issuedAt = now, .jwtId = "id-1"}, token)
+		               .code,
+		           ErrorCode::Ok);
+		EXPECT_TRUE (token.starts_with (signer.headerSegment()));
+
+		std::string expected;
+		ASSERT_EQ (engine.token()
+		               .kid ("k-template")
+		               .issuer ("auth0")
+		               .claim ("scope", "read write")
+		               .subject ("user \"1\"")
+		               .expiresAt (now + 60)
+		               .issuedAt (now)
+		               .jwtId ("id-1")
+		               .sign (expected)
+		               .code,
+		           ErrorCode::Ok);
+		EXPECT_EQ (token, expected);
+
+		Verifier verifier;
+		ASSERT_EQ (engine.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (verifier.subject(), "user \"1\"");
+		EXPECT_EQ (verifier.issuer(), "auth0");
+		EXPECT_EQ (verifier.expiresAt(), now + 60);
+
+		// Only the per-token claims that are set are written
+		ASSERT_EQ (signer.sign ({.subject = "user-2", .expiresAt = now + 60, .issuedAt = std::nullopt, .jwtId = {}}, token)
+		               .code,
+		           ErrorCode::Ok);
+		ASSERT_EQ (engine.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (verifier.subject(), "user-2");
+		EXPECT_FALSE (verifier.jwtId().has_value());
+		EXPECT_EQ (verifier.claims().size(), 4u);
+
+		const SigningTemplate bare = engine.signingTemplate (JwtAlg::HS256, "k-template");
+		ASSERT_EQ (bare.sign ({.subject = {}, .expiresAt = now + 60, .issuedAt = std::nullopt, .jwtId = {}}, token).code,
+		           ErrorCode::Ok);
+		ASSERT_EQ (engine.verify (token, verifier).code, ErrorCode::Ok);
+		EXPECT_EQ (verifier.claims().size(), 1u);
+	}
+
+	TEST (SigningTemplateTest, PinsItsKeyHandleUntilTheKeyChanges)
+	{
+		FakeCryptoProvider crypto;
+		JwtJsonProvider json;
+		Jwt engine {crypto, json};
+		ASSERT_EQ (engine.generateKeyPair ("k-template", JwtAlg::HS256).code, ErrorCode::Ok);
+
+		const SigningTemplate signer = engine.signingTemplate (JwtAlg::HS256, "k-template");
+		ASSERT_EQ (crypto.resolveCalls.load(), 1);
+
+		const auto claimsOf = [] (std::string_view subject)
+		{
+			return SigningClaims {.subject = subject, .expiresAt = std::nullopt, .issuedAt = std::nullopt, .jwtId = {}};
+		};
+
+		std::string token;
+		for (int i = 0; i < 3; ++i)
+		{
+			ASSERT_EQ (signer.sign (claimsOf ("pinned"), token).code, ErrorCode::Ok);
+		}
+		EXPECT_EQ (crypto.resolveCalls.load(), 1);
+
+		// The pinned handle is retired: the template goes through the engine cache from now on
+		ASSERT_EQ (engine.generateKeyPair ("k-template", JwtAlg::HS256).code, ErrorCode::Ok);
+		for (int i = 0; i < 3; ++i)
+		{
+			ASSERT_EQ (signer.sign (claimsOf ("rotated"), token).code, ErrorCode::Ok);
+		}
+		EXPECT_EQ (crypto.resolveCalls.load(), 2);
+
+		ASSERT_EQ (engine.removeKey ("k-template").code, ErrorCode::Ok);
+		EXPECT_EQ (signer.sign (claimsOf ("removed"), token).code, ErrorCode::KeyNotFound);
+	}
+
+	TEST (SigningTemplateTest, RejectsDuplicatesAndNonJsonProviders)
+	{
+		FakeCryptoProvider crypto;
+		JwtJsonProvider json;
+		Jwt engine {crypto, json};
+		ASSERT_EQ (engine.generateKeyPair ("k-template", JwtAlg::HS256).code, ErrorCode::Ok);
+
+		ClaimMap fixed;
+		fixed ["sub"] = std::string ("service");
+		const SigningTemplate signer = engine.signingTemplate (JwtAlg::HS256, "k-template", fixed);
+		std::string token;
+		EXPECT_EQ (signer.sign ({.subject = "user-1", .expiresAt = std::nullopt, .issuedAt = std::nullopt, .jwtId = {}}, token)
+		               .code,
+		           ErrorCode::JsonError);
+		EXPECT_EQ (signer.sign ({.subject = {}, .expiresAt = std::nullopt, .issuedAt = std::nullopt, .jwtId = "id-1"}, token)
+		               .code,
+		           ErrorCode::Ok);
+
+		EXPECT_EQ (engine.signingTemplate (JwtAlg::HS256, "missing").sign ({}, token).code, ErrorCode::KeyNotFound);
+		EXPECT_TRUE (token.empty());
+
+		FakeJsonProvider fakeJson;
+		Jwt fakeEngine {crypto, fakeJson};
+		fixed ["sub"] = std::string ("service");
+		const SigningTemplate fakeSigner = fakeEngine.signingTemplate (JwtAlg::HS256, "k-template", fixed);
+		EXPECT_EQ (fakeSigner.error().code, ErrorCode::JsonError);
+		EXPECT_EQ (fakeSigner.sign ({}, token).code, ErrorCode::JsonError);
+	}
+
 } /* namespace ipb::http::jwt */